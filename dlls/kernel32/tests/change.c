@@ -1085,6 +1085,125 @@ static void test_ffcn_directory_overlap(void)
     ok(ret, "RemoveDirectoryA error: %ld\n", GetLastError());
 }
 
+/* count the entries of a notification buffer, and check whether one of them matches name */
+static unsigned int count_notifications(const char *buffer, DWORD size, const WCHAR *name, BOOL *found)
+{
+    const FILE_NOTIFY_INFORMATION *info = (const FILE_NOTIFY_INFORMATION *)buffer;
+    unsigned int count = 0;
+
+    if (!size) return 0;
+    for (;;)
+    {
+        count++;
+        if (name && info->FileNameLength == wcslen(name) * sizeof(WCHAR) &&
+            !memcmp(info->FileName, name, info->FileNameLength))
+            *found = TRUE;
+        if (!info->NextEntryOffset) break;
+        info = (const FILE_NOTIFY_INFORMATION *)((const char *)info + info->NextEntryOffset);
+    }
+    return count;
+}
+
+static void test_readdirectorychanges_subtree_burst(void)
+{
+    unsigned int dirs = 20, files = 10, i, j, count, overflows;
+    char temp_path[MAX_PATH], root[MAX_PATH], path[MAX_PATH];
+    static char buffer[0x10000];
+    WCHAR name[MAX_PATH];
+    BOOL ret, found;
+    HANDLE dir, file;
+    OVERLAPPED ov;
+    DWORD size;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    ret = GetTempFileNameA(temp_path, "fcn", 0, root);
+    ok(ret, "GetTempFileNameA error: %ld\n", GetLastError());
+    DeleteFileA(root);
+    ret = CreateDirectoryA(root, NULL);
+    ok(ret, "CreateDirectoryA error: %ld\n", GetLastError());
+
+    for (i = 0; i < dirs; i++)
+    {
+        sprintf(path, "%s\\d%u", root, i);
+        CreateDirectoryA(path, NULL);
+        for (j = 0; j < files; j++)
+        {
+            sprintf(path, "%s\\d%u\\f%u", root, i, j);
+            file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+            ok(file != INVALID_HANDLE_VALUE, "CreateFileA error: %ld\n", GetLastError());
+            CloseHandle(file);
+        }
+    }
+
+    dir = CreateFileA(root, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                      NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    ok(dir != INVALID_HANDLE_VALUE, "CreateFileA error: %ld\n", GetLastError());
+    memset(&ov, 0, sizeof(ov));
+    ov.hEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+
+    ret = ReadDirectoryChangesW(dir, buffer, sizeof(buffer), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &ov, NULL);
+    ok(ret, "ReadDirectoryChangesW error: %ld\n", GetLastError());
+
+    /* changes in directories that existed before the watch are reported */
+    sprintf(path, "%s\\d%u\\new", root, dirs - 1);
+    file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFileA error: %ld\n", GetLastError());
+    CloseHandle(file);
+
+    ret = WaitForSingleObject(ov.hEvent, 5000);
+    ok(ret == WAIT_OBJECT_0, "got %d\n", ret);
+    ret = GetOverlappedResult(dir, &ov, &size, FALSE);
+    ok(ret, "GetOverlappedResult error: %ld\n", GetLastError());
+    swprintf(name, ARRAY_SIZE(name), L"d%u\\new", dirs - 1);
+    found = FALSE;
+    count_notifications(buffer, size, name, &found);
+    ok(found, "missing notification for %s\n", wine_dbgstr_w(name));
+
+    /* a burst of changes is batched into a few buffer fills */
+    for (i = 0; i < dirs; i++)
+    {
+        sprintf(path, "%s\\d%u\\f0", root, i);
+        ret = DeleteFileA(path);
+        ok(ret, "DeleteFileA error: %ld\n", GetLastError());
+    }
+
+    count = overflows = 0;
+    while (count < dirs)
+    {
+        ret = ReadDirectoryChangesW(dir, buffer, sizeof(buffer), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME, NULL, &ov, NULL);
+        ok(ret, "ReadDirectoryChangesW error: %ld\n", GetLastError());
+        if (WaitForSingleObject(ov.hEvent, 5000)) break;
+        if (!GetOverlappedResult(dir, &ov, &size, FALSE) || !size)
+        {
+            /* the buffer overflowed, the changes are lost */
+            overflows++;
+            break;
+        }
+        count += count_notifications(buffer, size, NULL, NULL);
+    }
+    ok(count >= dirs || overflows, "got %u notifications for %u changes\n", count, dirs);
+
+    CancelIo(dir);
+    CloseHandle(dir);
+    CloseHandle(ov.hEvent);
+
+    for (i = 0; i < dirs; i++)
+    {
+        for (j = 0; j < files; j++)
+        {
+            sprintf(path, "%s\\d%u\\f%u", root, i, j);
+            DeleteFileA(path);
+        }
+        sprintf(path, "%s\\d%u\\new", root, i);
+        DeleteFileA(path);
+        sprintf(path, "%s\\d%u", root, i);
+        ret = RemoveDirectoryA(path);
+        ok(ret, "RemoveDirectoryA error: %ld\n", GetLastError());
+    }
+    ret = RemoveDirectoryA(root);
+    ok(ret, "RemoveDirectoryA error: %ld\n", GetLastError());
+}
+
 START_TEST(change)
 {
     test_ffcnMultipleThreads();
@@ -1098,4 +1217,5 @@ START_TEST(change)
     test_readdirectorychanges_filedir();
     test_readdirectorychanges_cr();
     test_ffcn_directory_overlap();
+    test_readdirectorychanges_subtree_burst();
 }
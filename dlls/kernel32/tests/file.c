@@ -1241,6 +1241,60 @@ static void test_CopyFileEx(void)
     ok(!ret, "DeleteFileA unexpectedly succeeded\n");
 }
 
+static void test_CopyFile_large(void)
+{
+    static const DWORD size = 3 * 1024 * 1024 + 4097;
+    char temp_path[MAX_PATH];
+    char source[MAX_PATH], dest[MAX_PATH];
+    static const char prefix[] = "pfx";
+    unsigned char *buffer, *buffer2;
+    HANDLE hfile;
+    DWORD ret, i;
+
+    ret = GetTempPathA(MAX_PATH, temp_path);
+    ok(ret != 0, "GetTempPathA error %ld\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, source);
+    ok(ret != 0, "GetTempFileNameA error %ld\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, dest);
+    ok(ret != 0, "GetTempFileNameA error %ld\n", GetLastError());
+
+    buffer = malloc(size);
+    buffer2 = malloc(size);
+    for (i = 0; i < size; i++) buffer[i] = i % 251;
+
+    hfile = CreateFileA(source, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "failed to create source file, error %ld\n", GetLastError());
+    ret = WriteFile(hfile, buffer, size, &i, NULL);
+    ok(ret && i == size, "WriteFile failed, error %ld\n", GetLastError());
+    CloseHandle(hfile);
+
+    /* the destination is larger than the source and must be truncated */
+    hfile = CreateFileA(dest, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "failed to create destination file, error %ld\n", GetLastError());
+    SetFilePointer(hfile, size * 2, NULL, FILE_BEGIN);
+    SetEndOfFile(hfile);
+    CloseHandle(hfile);
+
+    ret = CopyFileA(source, dest, FALSE);
+    ok(ret, "CopyFileA failed, error %ld\n", GetLastError());
+
+    hfile = CreateFileA(dest, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, 0);
+    ok(hfile != INVALID_HANDLE_VALUE, "failed to open destination file, error %ld\n", GetLastError());
+    ok(GetFileSize(hfile, NULL) == size, "wrong size %lu\n", GetFileSize(hfile, NULL));
+    memset(buffer2, 0, size);
+    ret = ReadFile(hfile, buffer2, size, &i, NULL);
+    ok(ret && i == size, "ReadFile failed, error %ld, size %lu\n", GetLastError(), i);
+    ok(!memcmp(buffer, buffer2, size), "file contents differ\n");
+    CloseHandle(hfile);
+
+    free(buffer);
+    free(buffer2);
+    ret = DeleteFileA(source);
+    ok(ret, "DeleteFileA failed with error %ld\n", GetLastError());
+    ret = DeleteFileA(dest);
+    ok(ret, "DeleteFileA failed with error %ld\n", GetLastError());
+}
+
 /*
  *   Debugging routine to dump a buffer in a hexdump-like fashion.
  */
@@ -5810,6 +5864,340 @@ static void test_overlapped_read(void)
     ok(ret, "Unexpected error %lu.\n", GetLastError());
 }
 
+#define QUEUE_DEPTH_BLOCK_SIZE 4096
+#define QUEUE_DEPTH_MAX 64
+
+static void submit_queue_depth_io(HANDLE file, BOOL write, unsigned char *buffer, OVERLAPPED *ov, unsigned int block)
+{
+    BOOL ret;
+
+    memset(ov, 0, sizeof(*ov));
+    ov->Offset = block * QUEUE_DEPTH_BLOCK_SIZE;
+    if (write)
+    {
+        memset(buffer, block & 0xff, QUEUE_DEPTH_BLOCK_SIZE);
+        ret = WriteFile(file, buffer, QUEUE_DEPTH_BLOCK_SIZE, NULL, ov);
+    }
+    else
+    {
+        memset(buffer, 0xcc, QUEUE_DEPTH_BLOCK_SIZE);
+        ret = ReadFile(file, buffer, QUEUE_DEPTH_BLOCK_SIZE, NULL, ov);
+    }
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "block %u: got error %lu\n", block, GetLastError());
+}
+
+/* keep depth reads or writes in flight until all the blocks are transferred */
+static void do_queue_depth_io(HANDLE file, HANDLE port, BOOL write, unsigned char *buffers,
+                              OVERLAPPED *ovs, unsigned int depth, unsigned int blocks)
+{
+    unsigned int next = 0, done = 0, i, block;
+    OVERLAPPED *ov;
+    ULONG_PTR key;
+    DWORD count;
+    BOOL ret;
+
+    for (i = 0; i < depth && next < blocks; i++)
+        submit_queue_depth_io(file, write, buffers + i * QUEUE_DEPTH_BLOCK_SIZE, &ovs[i], next++);
+
+    while (done < blocks)
+    {
+        ret = GetQueuedCompletionStatus(port, &count, &key, &ov, 10000);
+        ok(ret, "GetQueuedCompletionStatus failed, error %lu\n", GetLastError());
+        if (!ret) break;
+        ok(key == 0xdeadbeef, "got key %#Ix\n", key);
+        ok(count == QUEUE_DEPTH_BLOCK_SIZE, "got count %lu\n", count);
+
+        i = ov - ovs;
+        block = ov->Offset / QUEUE_DEPTH_BLOCK_SIZE;
+        if (!write)
+            ok(buffers[i * QUEUE_DEPTH_BLOCK_SIZE] == (block & 0xff) &&
+               buffers[(i + 1) * QUEUE_DEPTH_BLOCK_SIZE - 1] == (block & 0xff),
+               "block %u: got data %#x\n", block, buffers[i * QUEUE_DEPTH_BLOCK_SIZE]);
+        done++;
+        if (next < blocks)
+            submit_queue_depth_io(file, write, buffers + i * QUEUE_DEPTH_BLOCK_SIZE, &ovs[i], next++);
+    }
+}
+
+static void test_overlapped_queue_depth(void)
+{
+    static const char prefix[] = "pfx";
+    unsigned int blocks = 256, depth;
+    char temp_path[MAX_PATH], file_name[MAX_PATH];
+    OVERLAPPED ovs[QUEUE_DEPTH_MAX];
+    unsigned char *buffers;
+    HANDLE file, port;
+    DWORD ret;
+
+    ret = GetTempPathA(MAX_PATH, temp_path);
+    ok(ret, "Unexpected error %lu.\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, file_name);
+    ok(ret, "Unexpected error %lu.\n", GetLastError());
+
+    file = CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_FLAG_OVERLAPPED | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFile failed, error %lu\n", GetLastError());
+    port = CreateIoCompletionPort(file, NULL, 0xdeadbeef, 0);
+    ok(port != NULL, "CreateIoCompletionPort failed, error %lu\n", GetLastError());
+
+    buffers = VirtualAlloc(NULL, QUEUE_DEPTH_MAX * QUEUE_DEPTH_BLOCK_SIZE, MEM_COMMIT, PAGE_READWRITE);
+
+    do_queue_depth_io(file, port, TRUE, buffers, ovs, 16, blocks);
+
+    for (depth = 1; depth <= QUEUE_DEPTH_MAX; depth *= 4)
+    {
+        winetest_push_context("depth %u", depth);
+        do_queue_depth_io(file, port, FALSE, buffers, ovs, depth, blocks);
+        winetest_pop_context();
+    }
+
+    VirtualFree(buffers, 0, MEM_RELEASE);
+    CloseHandle(port);
+    CloseHandle(file);
+}
+
+/* run the overlapped file I/O tests in a child process that submits them to io_uring */
+static void test_io_uring(void)
+{
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = { sizeof(si) };
+    char cmdline[MAX_PATH * 2];
+    char **argv;
+    BOOL ret;
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "%s %s io_uring", argv[0], argv[1]);
+    SetEnvironmentVariableA("WINEIOURING", "1");
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "CreateProcess failed, error %lu\n", GetLastError());
+    SetEnvironmentVariableA("WINEIOURING", NULL);
+    if (!ret) return;
+    wait_child_process(pi.hProcess);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+}
+
+#define SCATTER_GATHER_PAGES 64
+
+static void do_scatter_gather_io(HANDLE file, HANDLE port, BOOL write, FILE_SEGMENT_ELEMENT *segments,
+                                 DWORD size, DWORD offset)
+{
+    OVERLAPPED ov, *pov;
+    ULONG_PTR key;
+    DWORD count;
+    BOOL ret;
+
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = offset;
+    if (write)
+        ret = WriteFileGather(file, segments, size, NULL, &ov);
+    else
+        ret = ReadFileScatter(file, segments, size, NULL, &ov);
+    ok(ret || GetLastError() == ERROR_IO_PENDING, "got error %lu\n", GetLastError());
+
+    ret = GetQueuedCompletionStatus(port, &count, &key, &pov, 10000);
+    ok(ret, "GetQueuedCompletionStatus failed, error %lu\n", GetLastError());
+    ok(pov == &ov, "got overlapped %p\n", pov);
+    ok(count == size, "got count %lu\n", count);
+}
+
+static void test_scatter_gather_segments(void)
+{
+    static const char prefix[] = "pfx";
+    FILE_SEGMENT_ELEMENT segments[SCATTER_GATHER_PAGES + 1];
+    unsigned int loops = 4, i, j, stride;
+    char temp_path[MAX_PATH], file_name[MAX_PATH];
+    unsigned char *buffers;
+    HANDLE file, port;
+    SYSTEM_INFO si;
+    DWORD ret, size;
+
+    GetSystemInfo(&si);
+    size = SCATTER_GATHER_PAGES * si.dwPageSize;
+
+    ret = GetTempPathA(MAX_PATH, temp_path);
+    ok(ret, "Unexpected error %lu.\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, file_name);
+    ok(ret, "Unexpected error %lu.\n", GetLastError());
+
+    file = CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_FLAG_NO_BUFFERING | FILE_FLAG_OVERLAPPED | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFile failed, error %lu\n", GetLastError());
+    port = CreateIoCompletionPort(file, NULL, 0xdeadbeef, 0);
+    ok(port != NULL, "CreateIoCompletionPort failed, error %lu\n", GetLastError());
+
+    buffers = VirtualAlloc(NULL, 2 * size, MEM_COMMIT, PAGE_READWRITE);
+
+    /* contiguous segments, then every other page */
+    for (stride = 1; stride <= 2; stride++)
+    {
+        memset(segments, 0, sizeof(segments));
+        for (i = 0; i < SCATTER_GATHER_PAGES; i++)
+        {
+            segments[i].Buffer = buffers + i * stride * si.dwPageSize;
+            memset(buffers + i * stride * si.dwPageSize, i + stride, si.dwPageSize);
+        }
+
+        for (j = 0; j < loops; j++)
+            do_scatter_gather_io(file, port, TRUE, segments, size, j * size);
+
+        memset(buffers, 0xcc, 2 * size);
+        for (j = 0; j < loops; j++)
+            do_scatter_gather_io(file, port, FALSE, segments, size, j * size);
+
+        for (i = 0; i < SCATTER_GATHER_PAGES; i++)
+        {
+            unsigned char *page = buffers + i * stride * si.dwPageSize;
+            ok(page[0] == ((i + stride) & 0xff) && page[si.dwPageSize - 1] == ((i + stride) & 0xff),
+               "stride %u, page %u: got data %#x\n", stride, i, page[0]);
+        }
+    }
+
+    VirtualFree(buffers, 0, MEM_RELEASE);
+    CloseHandle(port);
+    CloseHandle(file);
+}
+
+static void test_miscased_lookup(void)
+{
+    unsigned int count = 200, lookups = 100, i, pass;
+    char temp_path[MAX_PATH], dir[MAX_PATH], path[MAX_PATH];
+    HANDLE file;
+    BOOL ret;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    ret = GetTempFileNameA(temp_path, "pfx", 0, dir);
+    ok(ret, "GetTempFileNameA error %lu\n", GetLastError());
+    DeleteFileA(dir);
+    ret = CreateDirectoryA(dir, NULL);
+    ok(ret, "CreateDirectoryA error %lu\n", GetLastError());
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf(path, "%s\\file%05u.dat", dir, i);
+        file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+        CloseHandle(file);
+    }
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < lookups; i++)
+        {
+            sprintf(path, "%s\\FILE%05u.DAT", dir, (i * 7919) % count);
+            file = CreateFileA(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+            ok(file != INVALID_HANDLE_VALUE, "CreateFileA %s error %lu\n", path, GetLastError());
+            CloseHandle(file);
+        }
+    }
+
+    /* changes to the directory are picked up */
+    sprintf(path, "%s\\new.dat", dir);
+    file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+    CloseHandle(file);
+    sprintf(path, "%s\\NEW.DAT", dir);
+    file = CreateFileA(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+    CloseHandle(file);
+
+    ret = DeleteFileA(path);
+    ok(ret, "DeleteFileA error %lu\n", GetLastError());
+    SetLastError(0xdeadbeef);
+    file = CreateFileA(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+    ok(file == INVALID_HANDLE_VALUE, "file still exists\n");
+    ok(GetLastError() == ERROR_FILE_NOT_FOUND, "got error %lu\n", GetLastError());
+
+    sprintf(path, "%s\\file00000.dat", dir);
+    sprintf(temp_path, "%s\\renamed.dat", dir);
+    ret = MoveFileA(path, temp_path);
+    ok(ret, "MoveFileA error %lu\n", GetLastError());
+    sprintf(path, "%s\\FILE00000.DAT", dir);
+    file = CreateFileA(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+    ok(file == INVALID_HANDLE_VALUE, "renamed file still exists\n");
+    sprintf(path, "%s\\RENAMED.DAT", dir);
+    file = CreateFileA(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+    CloseHandle(file);
+    ret = DeleteFileA(path);
+    ok(ret, "DeleteFileA error %lu\n", GetLastError());
+
+    for (i = 1; i < count; i++)
+    {
+        sprintf(path, "%s\\file%05u.dat", dir, i);
+        DeleteFileA(path);
+    }
+    ret = RemoveDirectoryA(dir);
+    ok(ret, "RemoveDirectoryA error %lu\n", GetLastError());
+}
+
+static unsigned int count_directory_files(const char *dir, const char *mask)
+{
+    char path[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    unsigned int count = 0;
+    HANDLE find;
+
+    sprintf(path, "%s\\%s", dir, mask);
+    find = FindFirstFileA(path, &data);
+    if (find == INVALID_HANDLE_VALUE) return 0;
+    do count++; while (FindNextFileA(find, &data));
+    FindClose(find);
+    return count;
+}
+
+static void test_repeated_enumeration(void)
+{
+    unsigned int count = 200, loops = 4, i, found;
+    char temp_path[MAX_PATH], dir[MAX_PATH], path[MAX_PATH];
+    HANDLE file;
+    BOOL ret;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    ret = GetTempFileNameA(temp_path, "pfx", 0, dir);
+    ok(ret, "GetTempFileNameA error %lu\n", GetLastError());
+    DeleteFileA(dir);
+    ret = CreateDirectoryA(dir, NULL);
+    ok(ret, "CreateDirectoryA error %lu\n", GetLastError());
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf(path, "%s\\%s%05u.dat", dir, i % 2 ? "odd" : "even", i);
+        file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+        CloseHandle(file);
+    }
+
+    for (i = 0; i < loops; i++)
+    {
+        found = count_directory_files(dir, "*");
+        ok(found == count + 2, "got %u files\n", found);
+        found = count_directory_files(dir, "odd*.dat");
+        ok(found == count / 2, "got %u files\n", found);
+    }
+
+    /* changes to the directory are picked up */
+    sprintf(path, "%s\\odd_new.dat", dir);
+    file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "CreateFileA error %lu\n", GetLastError());
+    CloseHandle(file);
+    found = count_directory_files(dir, "odd*.dat");
+    ok(found == count / 2 + 1, "got %u files\n", found);
+
+    ret = DeleteFileA(path);
+    ok(ret, "DeleteFileA error %lu\n", GetLastError());
+    found = count_directory_files(dir, "*");
+    ok(found == count + 2, "got %u files\n", found);
+
+    for (i = 0; i < count; i++)
+    {
+        sprintf(path, "%s\\%s%05u.dat", dir, i % 2 ? "odd" : "even", i);
+        DeleteFileA(path);
+    }
+    ret = RemoveDirectoryA(dir);
+    ok(ret, "RemoveDirectoryA error %lu\n", GetLastError());
+}
+
 static void test_file_readonly_access(void)
 {
     static const DWORD default_sharing = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
@@ -6320,10 +6708,21 @@ static void test_eof(void)
 START_TEST(file)
 {
     char temp_path[MAX_PATH];
+    char **argv;
     DWORD ret;
+    int argc;
 
     InitFunctionPointers();
 
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "io_uring"))
+    {
+        test_overlapped_read();
+        test_overlapped_queue_depth();
+        test_WriteFileGather();
+        return;
+    }
+
     ret = GetTempPathA(MAX_PATH, temp_path);
     ok(ret != 0, "GetTempPath error %lu\n", GetLastError());
     ret = GetTempFileNameA(temp_path, "tmp", 0, filename);
@@ -6344,6 +6743,7 @@ START_TEST(file)
     test_CopyFileW();
     test_CopyFile2();
     test_CopyFileEx();
+    test_CopyFile_large();
     test_CreateFile();
     test_CreateFileA();
     test_CreateFileW();
@@ -6388,6 +6788,11 @@ START_TEST(file)
     test_GetFileAttributesExW();
     test_post_completion();
     test_overlapped_read();
+    test_overlapped_queue_depth();
+    test_io_uring();
+    test_scatter_gather_segments();
+    test_miscased_lookup();
+    test_repeated_enumeration();
     test_file_readonly_access();
     test_find_file_stream();
     test_SetFileTime();
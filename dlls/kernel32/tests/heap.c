@@ -28,6 +28,7 @@
 #include "winbase.h"
 #include "winreg.h"
 #include "winternl.h"
+#include "wine/heapinfo.h"
 #include "wine/test.h"
 
 /* some undocumented flags (names are made up) */
@@ -3740,6 +3741,178 @@ static void test_heap_sizes(void)
     }
 }
 
+static void test_heap_statistics(void)
+{
+    ULONG i, rate = 1, alloc_count = 0, free_count = 0, sample_count;
+    SIZE_T size, allocated;
+    HEAP_WINE_STATISTICS *stats;
+    HEAP_WINE_PROFILE *profile;
+    HEAP_SUMMARY summary;
+    void *ptrs[64];
+    HANDLE heap;
+    BOOL ret;
+
+    heap = HeapCreate( 0, 0, 0 );
+    ok( heap != NULL, "HeapCreate failed, error %lu\n", GetLastError() );
+
+    memset( &summary, 0, sizeof(summary) );
+    summary.cb = sizeof(summary);
+    ret = HeapSummary( heap, 0, &summary );
+    ok( ret, "HeapSummary failed, error %lu\n", GetLastError() );
+    ok( summary.cbCommitted && summary.cbCommitted <= summary.cbReserved, "got committed %#Ix, reserved %#Ix\n",
+        summary.cbCommitted, summary.cbReserved );
+    allocated = summary.cbAllocated;
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++) ptrs[i] = HeapAlloc( heap, 0, 0x100 );
+    ret = HeapSummary( heap, 0, &summary );
+    ok( ret, "HeapSummary failed, error %lu\n", GetLastError() );
+    ok( summary.cbAllocated >= allocated + ARRAY_SIZE(ptrs) * 0x100, "got allocated %#Ix, was %#Ix\n",
+        summary.cbAllocated, allocated );
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++) HeapFree( heap, 0, ptrs[i] );
+
+    /* Wine-specific statistics and allocation profiling */
+    if (!HeapSetInformation( heap, HeapWineProfiling, &rate, sizeof(rate) ) ||
+        !HeapQueryInformation( heap, HeapWineStatistics, NULL, 0, &size ) ||
+        GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+    {
+        win_skip( "HeapWineProfiling not supported\n" );
+        HeapDestroy( heap );
+        return;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++) ptrs[i] = HeapAlloc( heap, 0, 0x20 + i );
+    for (i = 0; i < ARRAY_SIZE(ptrs) / 2; i++) HeapFree( heap, 0, ptrs[i] );
+
+    ret = HeapQueryInformation( heap, HeapWineStatistics, NULL, 0, &size );
+    ok( !ret, "HeapQueryInformation succeeded\n" );
+    ok( size > sizeof(*stats), "got size %#Ix\n", size );
+    stats = HeapAlloc( GetProcessHeap(), 0, size );
+    ret = HeapQueryInformation( heap, HeapWineStatistics, stats, size, &size );
+    ok( ret, "HeapQueryInformation failed, error %lu\n", GetLastError() );
+    ok( stats->Version == HEAP_WINE_STATISTICS_VERSION, "got version %lu\n", stats->Version );
+    ok( stats->Flags & HEAP_WINE_FLAG_PROFILING, "got flags %#lx\n", stats->Flags );
+    ok( stats->SubheapCount >= 1, "got %lu subheaps\n", stats->SubheapCount );
+    ok( stats->BinCount == (size - offsetof( HEAP_WINE_STATISTICS, Bins )) / sizeof(*stats->Bins),
+        "got %lu bins\n", stats->BinCount );
+    ok( stats->UsedSize + stats->FreeSize + stats->OverheadSize <= stats->CommittedSize,
+        "got used %#Ix, free %#Ix, overhead %#Ix, committed %#Ix\n", stats->UsedSize, stats->FreeSize,
+        stats->OverheadSize, stats->CommittedSize );
+    for (i = 0; i < stats->BinCount; i++)
+    {
+        alloc_count += stats->Bins[i].AllocCount;
+        free_count += stats->Bins[i].FreeCount;
+    }
+    ok( alloc_count == ARRAY_SIZE(ptrs), "got %lu allocations\n", alloc_count );
+    ok( free_count == ARRAY_SIZE(ptrs) / 2, "got %lu frees\n", free_count );
+    HeapFree( GetProcessHeap(), 0, stats );
+
+    ret = HeapQueryInformation( heap, HeapWineProfiling, NULL, 0, &size );
+    ok( !ret, "HeapQueryInformation succeeded\n" );
+    profile = HeapAlloc( GetProcessHeap(), 0, size );
+    ret = HeapQueryInformation( heap, HeapWineProfiling, profile, size, &size );
+    ok( ret, "HeapQueryInformation failed, error %lu\n", GetLastError() );
+    ok( profile->Version == HEAP_WINE_PROFILE_VERSION, "got version %lu\n", profile->Version );
+    ok( profile->SampleRate == rate, "got sample rate %lu\n", profile->SampleRate );
+    ok( profile->SampleCount == ARRAY_SIZE(ptrs), "got %lu samples\n", profile->SampleCount );
+    ok( profile->SiteCount >= 1, "got %lu call sites\n", profile->SiteCount );
+    for (i = 0, sample_count = 0; i < profile->SiteCount; i++)
+    {
+        ok( profile->Sites[i].Count && profile->Sites[i].Frames[0], "site %lu: got count %lu, frame %p\n",
+            i, profile->Sites[i].Count, profile->Sites[i].Frames[0] );
+        sample_count += profile->Sites[i].Count;
+    }
+    ok( sample_count + profile->DroppedCount == profile->SampleCount, "got %lu samples in sites\n", sample_count );
+    HeapFree( GetProcessHeap(), 0, profile );
+
+    for (i = ARRAY_SIZE(ptrs) / 2; i < ARRAY_SIZE(ptrs); i++) HeapFree( heap, 0, ptrs[i] );
+    HeapDestroy( heap );
+}
+
+struct alloc_free_params
+{
+    HANDLE ready;
+    HANDLE start;
+    unsigned int loops;
+    unsigned int failures;
+    void **exchange;
+};
+
+static DWORD WINAPI alloc_free_thread_proc( void *arg )
+{
+    static const SIZE_T sizes[] = {0x8, 0x18, 0x30, 0x50, 0x80, 0xf0, 0x200};
+    struct alloc_free_params *params = arg;
+    HANDLE heap = GetProcessHeap();
+    unsigned int i, j;
+    BYTE *ptrs[16];
+
+    SetEvent( params->ready );
+    WaitForSingleObject( params->start, INFINITE );
+
+    for (i = 0; i < params->loops; i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(ptrs); j++)
+        {
+            SIZE_T size = sizes[(i + j) % ARRAY_SIZE(sizes)];
+            if (!(ptrs[j] = HeapAlloc( heap, 0, size ))) params->failures++;
+            else memset( ptrs[j], j, size );
+        }
+        for (j = 0; j < ARRAY_SIZE(ptrs); j++)
+        {
+            SIZE_T size = sizes[(i + j) % ARRAY_SIZE(sizes)];
+            if (!ptrs[j]) continue;
+            if (ptrs[j][0] != j || ptrs[j][size - 1] != j) params->failures++;
+            /* hand some blocks over to be freed by another thread */
+            if (!(j % 8)) ptrs[j] = InterlockedExchangePointer( params->exchange, ptrs[j] );
+            if (!HeapFree( heap, 0, ptrs[j] )) params->failures++;
+        }
+    }
+
+    return 0;
+}
+
+static void test_alloc_free_threads(void)
+{
+    unsigned int loops = 500, i, j, failures = 0;
+    struct alloc_free_params params[8];
+    HANDLE threads[8], ready[8];
+    void *exchange = NULL;
+    BOOL ret;
+
+    for (i = 1; i <= ARRAY_SIZE(threads); i *= 2)
+    {
+        HANDLE start_event = CreateEventW( NULL, TRUE, FALSE, NULL );
+
+        for (j = 0; j < i; j++)
+        {
+            params[j].ready = ready[j] = CreateEventW( NULL, FALSE, FALSE, NULL );
+            params[j].start = start_event;
+            params[j].loops = loops;
+            params[j].failures = 0;
+            params[j].exchange = &exchange;
+            threads[j] = CreateThread( NULL, 0, alloc_free_thread_proc, &params[j], 0, NULL );
+            ok( !!threads[j], "CreateThread failed, error %lu\n", GetLastError() );
+        }
+        WaitForMultipleObjects( i, ready, TRUE, INFINITE );
+
+        SetEvent( start_event );
+        WaitForMultipleObjects( i, threads, TRUE, INFINITE );
+
+        for (j = 0; j < i; j++)
+        {
+            failures += params[j].failures;
+            CloseHandle( threads[j] );
+            CloseHandle( ready[j] );
+        }
+        CloseHandle( start_event );
+    }
+
+    ok( !failures, "got %u failures\n", failures );
+    ret = HeapFree( GetProcessHeap(), 0, exchange );
+    ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    ret = HeapValidate( GetProcessHeap(), 0, NULL );
+    ok( ret, "HeapValidate failed\n" );
+}
+
 START_TEST(heap)
 {
     int argc;
@@ -3777,4 +3950,6 @@ START_TEST(heap)
     }
     else win_skip( "RtlGetNtGlobalFlags not found, skipping heap debug tests\n" );
     test_heap_sizes();
+    test_heap_statistics();
+    test_alloc_free_threads();
 }
@@ -4733,6 +4733,83 @@ static void test_FlushProcessWriteBuffers(void)
     ok( !reorderings, "expected sequential consistency with FlushProcessWriteBuffers (got %ld reorderings)\n", reorderings );
 }
 
+struct query_protect_params
+{
+    HANDLE start;
+    char *base;
+    unsigned int loops;
+    unsigned int failures;
+};
+
+static DWORD WINAPI query_protect_thread_proc( void *arg )
+{
+    struct query_protect_params *params = arg;
+    MEMORY_BASIC_INFORMATION info;
+    unsigned int i, page;
+    DWORD old_prot, prot;
+
+    WaitForSingleObject( params->start, INFINITE );
+
+    for (i = 0; i < params->loops; i++)
+    {
+        page = i % 16;
+        prot = (i / 16) % 2 ? PAGE_READWRITE : PAGE_READONLY;
+
+        if (!VirtualProtect( params->base + page * si.dwPageSize, si.dwPageSize, prot, &old_prot ) ||
+            old_prot != (prot == PAGE_READONLY ? PAGE_READWRITE : PAGE_READONLY))
+            params->failures++;
+        if (VirtualQuery( params->base + page * si.dwPageSize, &info, sizeof(info) ) != sizeof(info) ||
+            info.State != MEM_COMMIT || info.Protect != prot || info.AllocationBase != params->base)
+            params->failures++;
+        /* also query the main thread stack and the module */
+        if (VirtualQuery( params, &info, sizeof(info) ) != sizeof(info) || info.State != MEM_COMMIT)
+            params->failures++;
+        if (VirtualQuery( query_protect_thread_proc, &info, sizeof(info) ) != sizeof(info) ||
+            info.Type != MEM_IMAGE)
+            params->failures++;
+    }
+
+    return 0;
+}
+
+static void test_concurrent_query_protect(void)
+{
+    unsigned int i, j, failures = 0, loops = 512;
+    struct query_protect_params params[8];
+    HANDLE threads[8], start_event;
+    DWORD ret;
+
+    for (i = 1; i <= ARRAY_SIZE(threads); i *= 2)
+    {
+        start_event = CreateEventW( NULL, TRUE, FALSE, NULL );
+        for (j = 0; j < i; j++)
+        {
+            params[j].start = start_event;
+            params[j].loops = loops;
+            params[j].failures = 0;
+            params[j].base = VirtualAlloc( NULL, 16 * si.dwPageSize, MEM_COMMIT, PAGE_READWRITE );
+            ok( params[j].base != NULL, "VirtualAlloc failed: %lu\n", GetLastError() );
+            threads[j] = CreateThread( NULL, 0, query_protect_thread_proc, &params[j], 0, NULL );
+            ok( threads[j] != NULL, "CreateThread failed: %lu\n", GetLastError() );
+        }
+
+        SetEvent( start_event );
+        ret = WaitForMultipleObjects( i, threads, TRUE, INFINITE );
+        ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects failed: %lu\n", GetLastError() );
+
+        for (j = 0; j < i; j++)
+        {
+            failures += params[j].failures;
+            CloseHandle( threads[j] );
+            ret = VirtualFree( params[j].base, 0, MEM_RELEASE );
+            ok( ret, "VirtualFree failed: %lu\n", GetLastError() );
+        }
+        CloseHandle( start_event );
+    }
+
+    ok( !failures, "got %u failures\n", failures );
+}
+
 START_TEST(virtual)
 {
     int argc;
@@ -4817,6 +4894,7 @@ START_TEST(virtual)
     test_PrefetchVirtualMemory();
     test_ReadProcessMemory();
     test_FlushProcessWriteBuffers();
+    test_concurrent_query_protect();
 #if defined(__i386__) || defined(__x86_64__)
     test_stack_commit();
 #endif
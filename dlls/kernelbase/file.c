@@ -492,6 +492,37 @@ static BOOL is_same_file( HANDLE h1, HANDLE h2 )
 }
 
 
+/***********************************************************************
+ *           copy_file_extents
+ *
+ * Copy the file data without going through a user space buffer. Returns the number of bytes copied.
+ */
+static LONGLONG copy_file_extents( HANDLE source, HANDLE dest, LONGLONG size )
+{
+    static const LONGLONG chunk_size = 64 * 1024 * 1024;
+    FILE_END_OF_FILE_INFORMATION eof;
+    DUPLICATE_EXTENTS_DATA data;
+    IO_STATUS_BLOCK io;
+    LONGLONG pos;
+
+    /* the target range has to be within the file, it isn't extended by the copy */
+    eof.EndOfFile.QuadPart = size;
+    if (NtSetInformationFile( dest, &io, &eof, sizeof(eof), FileEndOfFileInformation )) return 0;
+
+    data.FileHandle = source;
+    for (pos = 0; pos < size; pos += data.ByteCount.QuadPart)
+    {
+        data.SourceFileOffset.QuadPart = pos;
+        data.TargetFileOffset.QuadPart = pos;
+        data.ByteCount.QuadPart = min( chunk_size, size - pos );
+        if (NtFsControlFile( dest, 0, NULL, NULL, &io, FSCTL_DUPLICATE_EXTENTS_TO_FILE,
+                             &data, sizeof(data), NULL, 0 ))
+            break;
+    }
+    return pos;
+}
+
+
 /******************************************************************************
  *	AreFileApisANSI   (kernelbase.@)
  */
@@ -509,13 +540,14 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
     BOOL *cancel_ptr = params ? params->pfCancel : NULL;
     PCOPYFILE2_PROGRESS_ROUTINE progress = params ? params->pProgressRoutine : NULL;
 
-    static const int buffer_size = 65536;
     HANDLE h1, h2;
     FILE_BASIC_INFORMATION info;
+    FILE_STANDARD_INFORMATION std_info;
     IO_STATUS_BLOCK io;
-    DWORD count;
+    LARGE_INTEGER pos;
+    DWORD count, buffer_size;
     BOOL ret = FALSE;
-    char *buffer;
+    char *buffer = NULL;
 
     if (cancel_ptr)
         FIXME("pfCancel is not supported\n");
@@ -527,11 +559,6 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
         SetLastError( ERROR_INVALID_PARAMETER );
         return FALSE;
     }
-    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size )))
-    {
-        SetLastError( ERROR_NOT_ENOUGH_MEMORY );
-        return FALSE;
-    }
 
     TRACE("%s -> %s, %lx\n", debugstr_w(source), debugstr_w(dest), flags);
 
@@ -550,10 +577,10 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
         return FALSE;
     }
 
-    if (!set_ntstatus( NtQueryInformationFile( h1, &io, &info, sizeof(info), FileBasicInformation )))
+    if (!set_ntstatus( NtQueryInformationFile( h1, &io, &info, sizeof(info), FileBasicInformation )) ||
+        !set_ntstatus( NtQueryInformationFile( h1, &io, &std_info, sizeof(std_info), FileStandardInformation )))
     {
         WARN("GetFileInformationByHandle returned error for %s\n", debugstr_w(source));
-        HeapFree( GetProcessHeap(), 0, buffer );
         CloseHandle( h1 );
         return FALSE;
     }
@@ -569,7 +596,6 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
         }
         if (same_file)
         {
-            HeapFree( GetProcessHeap(), 0, buffer );
             CloseHandle( h1 );
             SetLastError( ERROR_SHARING_VIOLATION );
             return FALSE;
@@ -581,11 +607,26 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
                            info.FileAttributes, h1 )) == INVALID_HANDLE_VALUE)
     {
         WARN("Unable to open dest %s\n", debugstr_w(dest));
-        HeapFree( GetProcessHeap(), 0, buffer );
         CloseHandle( h1 );
         return FALSE;
     }
 
+    /* let the file system copy or share the data blocks if it can, and copy the rest by hand */
+    if ((pos.QuadPart = copy_file_extents( h1, h2, std_info.EndOfFile.QuadPart )))
+    {
+        TRACE("copied %s bytes without buffering\n", wine_dbgstr_longlong(pos.QuadPart));
+        if (!SetFilePointerEx( h1, pos, NULL, FILE_BEGIN ) || !SetFilePointerEx( h2, pos, NULL, FILE_BEGIN ))
+            goto done;
+    }
+
+    /* use a larger buffer for large files to reduce the number of calls */
+    buffer_size = min( max( std_info.EndOfFile.QuadPart - pos.QuadPart, 65536 ), 1024 * 1024 );
+    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size )))
+    {
+        SetLastError( ERROR_NOT_ENOUGH_MEMORY );
+        goto done;
+    }
+
     while (ReadFile( h1, buffer, buffer_size, &count, NULL ) && count)
     {
         char *p = buffer;
@@ -597,7 +638,8 @@ static BOOL copy_file( const WCHAR *source, const WCHAR *dest, COPYFILE2_EXTENDE
             count -= res;
         }
     }
-    ret = TRUE;
+    /* drop the end of the preallocated data if the source file has shrunk meanwhile */
+    ret = SetEndOfFile( h2 );
 done:
     /* Maintain the timestamp of source file to destination file and read-only attribute */
     info.FileAttributes &= FILE_ATTRIBUTE_READONLY;
@@ -35,6 +35,7 @@
 
 #include "kernelbase.h"
 #include "wine/exception.h"
+#include "wine/heapinfo.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(heap);
@@ -777,6 +778,30 @@ BOOL WINAPI HeapSetInformation( HANDLE heap, HEAP_INFORMATION_CLASS infoclass, P
 }
 
 
+/***********************************************************************
+ *           HeapSummary   (kernelbase.@)
+ */
+BOOL WINAPI HeapSummary( HANDLE heap, DWORD flags, HEAP_SUMMARY *summary )
+{
+    HEAP_WINE_STATISTICS stats;
+
+    if (!summary || summary->cb != sizeof(*summary))
+    {
+        SetLastError( ERROR_INVALID_PARAMETER );
+        return FALSE;
+    }
+    if (!set_ntstatus( RtlQueryHeapInformation( heap, HeapWineStatistics, &stats,
+                                                offsetof( HEAP_WINE_STATISTICS, Bins ), NULL )))
+        return FALSE;
+
+    summary->cbAllocated  = stats.UsedSize;
+    summary->cbCommitted  = stats.CommittedSize;
+    summary->cbReserved   = stats.ReservedSize;
+    summary->cbMaxReserve = stats.ReservedSize;
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           HeapUnlock   (kernelbase.@)
  */
@@ -33,6 +33,7 @@
 #include "winnt.h"
 #include "winternl.h"
 #include "ntdll_misc.h"
+#include "wine/heapinfo.h"
 #include "wine/list.h"
 #include "wine/debug.h"
 
@@ -300,6 +301,7 @@ struct heap
     RTL_CRITICAL_SECTION cs;
     struct entry     free_lists[FREE_LIST_COUNT];
     struct bin      *bins;
+    struct heap_profile *profile;   /* Allocation profiling data, if enabled */
     SUBHEAP          subheap;
 };
 
@@ -654,6 +656,126 @@ static inline struct entry *find_free_list( struct heap *heap, SIZE_T block_size
     return &heap->free_lists[index];
 }
 
+/* opt-in allocation profiling, enabled with FLG_USER_STACK_TRACE_DB or HeapWineProfiling */
+
+#define HEAP_PROFILE_SAMPLE_RATE  64   /* default rate of allocations with a recorded call stack */
+#define HEAP_PROFILE_SITE_COUNT   512  /* size of the call site hash table, must be a power of 2 */
+
+struct heap_profile
+{
+    LONG        alloc_count[BLOCK_SIZE_BIN_COUNT];
+    LONG        free_count[BLOCK_SIZE_BIN_COUNT];
+    LONG64      alloc_size[BLOCK_SIZE_BIN_COUNT];
+    LONG        sample_rate;
+    LONG        sample_pos;
+    ULONG       sample_count;
+    ULONG       dropped_count;
+    ULONG       site_count;
+    RTL_SRWLOCK sites_lock;
+    HEAP_WINE_PROFILE_SITE sites[HEAP_PROFILE_SITE_COUNT];
+};
+
+static inline SIZE_T block_get_bin( const struct block *block )
+{
+    if (block_get_flags( block ) & BLOCK_FLAG_LARGE) return BLOCK_SIZE_BIN_COUNT - 1;
+    return BLOCK_SIZE_BIN( block_get_size( block ) );
+}
+
+static NTSTATUS heap_enable_profiling( struct heap *heap, ULONG sample_rate )
+{
+    struct heap_profile *profile = NULL;
+    SIZE_T size = sizeof(*profile);
+    NTSTATUS status;
+
+    if (!heap->profile)
+    {
+        if ((status = NtAllocateVirtualMemory( NtCurrentProcess(), (void **)&profile, 0, &size,
+                                               MEM_COMMIT, PAGE_READWRITE )))
+            return status;
+        RtlInitializeSRWLock( &profile->sites_lock );
+        if (InterlockedCompareExchangePointer( (void **)&heap->profile, profile, NULL ))
+        {
+            size = 0;
+            NtFreeVirtualMemory( NtCurrentProcess(), (void **)&profile, &size, MEM_RELEASE );
+        }
+    }
+
+    WriteNoFence( &heap->profile->sample_rate, sample_rate );
+    return STATUS_SUCCESS;
+}
+
+static void heap_profile_sample( struct heap_profile *profile, SIZE_T size )
+{
+    void *frames[HEAP_WINE_PROFILE_STACK_DEPTH] = {0};
+    HEAP_WINE_PROFILE_SITE *site;
+    ULONG hash, i;
+
+    RtlCaptureStackBackTrace( 1, ARRAY_SIZE(frames), frames, &hash );
+
+    RtlAcquireSRWLockExclusive( &profile->sites_lock );
+    profile->sample_count++;
+    for (i = 0; i < HEAP_PROFILE_SITE_COUNT; i++)
+    {
+        site = profile->sites + ((hash + i) & (HEAP_PROFILE_SITE_COUNT - 1));
+        if (!site->Count) break;
+        if (site->Hash == hash && !memcmp( site->Frames, frames, sizeof(frames) )) break;
+    }
+    if (i == HEAP_PROFILE_SITE_COUNT) profile->dropped_count++;
+    else
+    {
+        if (!site->Count++)
+        {
+            site->Hash = hash;
+            memcpy( site->Frames, frames, sizeof(frames) );
+            profile->site_count++;
+        }
+        site->Size += size;
+    }
+    RtlReleaseSRWLockExclusive( &profile->sites_lock );
+}
+
+static void heap_profile_alloc( struct heap *heap, const void *ptr, SIZE_T size )
+{
+    struct heap_profile *profile = heap->profile;
+    SIZE_T bin = block_get_bin( (const struct block *)ptr - 1 );
+    LONG rate = ReadNoFence( &profile->sample_rate );
+
+    InterlockedIncrement( &profile->alloc_count[bin] );
+    InterlockedExchangeAdd64( &profile->alloc_size[bin], size );
+    if (rate && !(InterlockedIncrement( &profile->sample_pos ) % rate)) heap_profile_sample( profile, size );
+}
+
+static void heap_profile_free( struct heap *heap, const struct block *block )
+{
+    InterlockedIncrement( &heap->profile->free_count[block_get_bin( block )] );
+}
+
+static void heap_dump_profile( const struct heap *heap )
+{
+    struct heap_profile *profile = heap->profile;
+    unsigned int i, j;
+
+    TRACE( "  profile: rate %lu, samples %lu, dropped %lu, sites %lu\n", ReadNoFence( &profile->sample_rate ),
+           profile->sample_count, profile->dropped_count, profile->site_count );
+
+    for (i = 0; i < BLOCK_SIZE_BIN_COUNT; i++)
+    {
+        ULONG alloc = ReadNoFence( &profile->alloc_count[i] ), freed = ReadNoFence( &profile->free_count[i] );
+        if (!alloc && !freed) continue;
+        TRACE( "    %3u: size %#4Ix, alloc %lu, freed %lu, live %ld, total size %#I64x\n", i, BLOCK_BIN_SIZE( i ),
+               alloc, freed, (LONG)(alloc - freed), profile->alloc_size[i] );
+    }
+
+    for (i = 0; i < HEAP_PROFILE_SITE_COUNT; i++)
+    {
+        const HEAP_WINE_PROFILE_SITE *site = profile->sites + i;
+        if (!site->Count) continue;
+        TRACE( "    site %08lx: count %lu, size %#Ix, frames", site->Hash, site->Count, site->Size );
+        for (j = 0; j < ARRAY_SIZE(site->Frames) && site->Frames[j]; j++) TRACE( " %p", site->Frames[j] );
+        TRACE( "\n" );
+    }
+}
+
 static void heap_dump( const struct heap *heap )
 {
     const struct block *block;
@@ -742,6 +864,8 @@ static void heap_dump( const struct heap *heap )
             else TRACE( ", back %p\n", *((struct block **)block - 1) );
         }
     }
+
+    if (heap->profile) heap_dump_profile( heap );
 }
 
 static const char *debugstr_heap_entry( struct rtl_heap_entry *entry )
@@ -1448,6 +1572,7 @@ static void heap_set_debug_flags( HANDLE handle )
     if (!(global_flags & FLG_HEAP_PAGE_ALLOCS)) force_flags &= ~(HEAP_GROWABLE|HEAP_PRIVATE);
 
     if (RUNNING_ON_VALGRIND) flags = 0; /* no sense in validating since Valgrind catches accesses */
+    if (global_flags & FLG_USER_STACK_TRACE_DB) heap_enable_profiling( heap, HEAP_PROFILE_SAMPLE_RATE );
 
     heap->flags |= flags;
     heap->force_flags |= force_flags;
@@ -1673,6 +1798,11 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE handle )
         size = 0;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if ((addr = heap->profile))
+    {
+        size = 0;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heap;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1839,6 +1969,62 @@ static NTSTATUS group_release( struct heap *heap, ULONG flags, struct bin *bin,
     return status;
 }
 
+/* per-thread cache of free LFH blocks of the process heap, in front of the bin groups */
+
+#define HEAP_TCACHE_BIN_COUNT  0x30
+#define HEAP_TCACHE_DEPTH      16
+#define HEAP_TCACHE_MAX_BYTES  0x1000  /* approximate size limit of the blocks cached in a bin */
+
+/* flags that need every freed block to go through the heap checks */
+#define HEAP_TCACHE_CHECK_FLAGS (HEAP_TAIL_CHECKING_ENABLED | HEAP_FREE_CHECKING_ENABLED | HEAP_VALIDATE | \
+                                 HEAP_VALIDATE_ALL | HEAP_VALIDATE_PARAMS | HEAP_CHECKING_ENABLED)
+
+struct heap_tcache
+{
+    BYTE          count[HEAP_TCACHE_BIN_COUNT];  /* number of cached blocks in each bin */
+    struct block *blocks[HEAP_TCACHE_BIN_COUNT][HEAP_TCACHE_DEPTH];
+};
+
+/* placeholder for threads that went through heap_thread_detach, nothing gets cached there */
+static struct heap_tcache detached_tcache;
+
+static inline struct heap_tcache *heap_get_tcache(void)
+{
+    return NtCurrentTeb()->ReservedForPerf;
+}
+
+static inline UINT heap_tcache_depth( SIZE_T bin )
+{
+    return min( HEAP_TCACHE_DEPTH, max( 2, HEAP_TCACHE_MAX_BYTES / BLOCK_BIN_SIZE( bin ) ) );
+}
+
+/* take a free block from the thread cache, the block is still marked as free */
+static inline struct block *heap_tcache_pop( struct heap *heap, SIZE_T bin )
+{
+    struct heap_tcache *cache;
+
+    if (heap != process_heap || bin >= HEAP_TCACHE_BIN_COUNT) return NULL;
+    if (!(cache = heap_get_tcache()) || !cache->count[bin]) return NULL;
+    return cache->blocks[bin][--cache->count[bin]];
+}
+
+/* keep a freed block in the thread cache instead of returning it to its group */
+static BOOL heap_tcache_push( struct heap *heap, ULONG flags, SIZE_T bin, struct block *block )
+{
+    struct heap_tcache *cache;
+
+    if (heap != process_heap || bin >= HEAP_TCACHE_BIN_COUNT || (flags & HEAP_TCACHE_CHECK_FLAGS)) return FALSE;
+    if (!(cache = heap_get_tcache()))
+    {
+        /* the cache allocation can't recurse, as there is no cache to allocate from yet */
+        if (!(cache = RtlAllocateHeap( heap, HEAP_ZERO_MEMORY, sizeof(*cache) ))) return FALSE;
+        NtCurrentTeb()->ReservedForPerf = cache;
+    }
+    if (cache == &detached_tcache || cache->count[bin] >= heap_tcache_depth( bin )) return FALSE;
+    cache->blocks[bin][cache->count[bin]++] = block;
+    return TRUE;
+}
+
 static inline ULONG heap_current_thread_affinity(void)
 {
     ULONG affinity;
@@ -1929,7 +2115,8 @@ static NTSTATUS heap_allocate_block_lfh( struct heap *heap, ULONG flags, SIZE_T
 
     block_size = BLOCK_BIN_SIZE( BLOCK_SIZE_BIN( block_size ) );
 
-    if ((block = find_free_bin_block( heap, flags, block_size, bin )))
+    if ((block = heap_tcache_pop( heap, bin - heap->bins )) ||
+        (block = find_free_bin_block( heap, flags, block_size, bin )))
     {
         block_set_type( block, BLOCK_TYPE_USED );
         block_set_flags( block, (BYTE)~BLOCK_FLAG_LFH, BLOCK_USER_FLAGS( flags ) );
@@ -1942,33 +2129,41 @@ static NTSTATUS heap_allocate_block_lfh( struct heap *heap, ULONG flags, SIZE_T
     return block ? STATUS_SUCCESS : STATUS_NO_MEMORY;
 }
 
-static NTSTATUS heap_free_block_lfh( struct heap *heap, ULONG flags, struct block *block )
+/* return a block marked as free to its group */
+static NTSTATUS group_free_block( struct heap *heap, ULONG flags, struct bin *bin, struct block *block )
 {
-    struct bin *bin, *last = heap->bins + BLOCK_SIZE_BIN_COUNT - 1;
-    SIZE_T i, block_size = block_get_size( block );
     struct group *group = block_get_group( block );
+    SIZE_T i = block_get_group_index( block );
     NTSTATUS status = STATUS_SUCCESS;
 
+    /* if this was the last used block in a group and GROUP_FLAG_FREE was set */
+    if (InterlockedOr( &group->free_bits, 1 << i ) == ~(1 << i))
+    {
+        /* thread now owns the group, and can release it to its bin */
+        group->free_bits = ~GROUP_FLAG_FREE;
+        status = heap_release_bin_group( heap, flags, bin, group );
+    }
+
+    return status;
+}
+
+static NTSTATUS heap_free_block_lfh( struct heap *heap, ULONG flags, struct block *block )
+{
+    struct bin *bin, *last = heap->bins + BLOCK_SIZE_BIN_COUNT - 1;
+    SIZE_T block_size = block_get_size( block );
+
     if (!(block_get_flags( block ) & BLOCK_FLAG_LFH)) return STATUS_UNSUCCESSFUL;
 
     bin = heap->bins + BLOCK_SIZE_BIN( block_size );
     if (bin == last) return STATUS_UNSUCCESSFUL;
 
-    i = block_get_group_index( block );
     valgrind_make_writable( block, sizeof(*block) );
     block_set_type( block, BLOCK_TYPE_FREE );
     block_set_flags( block, (BYTE)~BLOCK_FLAG_LFH, BLOCK_FLAG_FREE );
     mark_block_free( block + 1, (char *)block + block_size - (char *)(block + 1), flags );
 
-    /* if this was the last used block in a group and GROUP_FLAG_FREE was set */
-    if (InterlockedOr( &group->free_bits, 1 << i ) == ~(1 << i))
-    {
-        /* thread now owns the group, and can release it to its bin */
-        group->free_bits = ~GROUP_FLAG_FREE;
-        status = heap_release_bin_group( heap, flags, bin, group );
-    }
-
-    return status;
+    if (heap_tcache_push( heap, flags, bin - heap->bins, block )) return STATUS_SUCCESS;
+    return group_free_block( heap, flags, bin, block );
 }
 
 static void bin_try_enable( struct heap *heap, struct bin *bin )
@@ -2015,10 +2210,29 @@ static void heap_thread_detach_bin_groups( struct heap *heap )
     }
 }
 
+/* return the blocks of the thread cache to their groups, and stop caching for this thread */
+static void heap_thread_detach_tcache(void)
+{
+    struct heap_tcache *cache = heap_get_tcache();
+    SIZE_T i;
+
+    if (!cache || cache == &detached_tcache) return;
+    NtCurrentTeb()->ReservedForPerf = &detached_tcache;
+
+    for (i = 0; i < HEAP_TCACHE_BIN_COUNT; i++)
+        while (cache->count[i])
+            group_free_block( process_heap, process_heap->flags, process_heap->bins + i,
+                              cache->blocks[i][--cache->count[i]] );
+
+    RtlFreeHeap( process_heap, 0, cache );
+}
+
 void heap_thread_detach(void)
 {
     struct heap *heap;
 
+    heap_thread_detach_tcache();
+
     RtlEnterCriticalSection( &process_heap->cs );
 
     LIST_FOR_EACH_ENTRY( heap, &process_heap->entry, struct heap, entry )
@@ -2062,6 +2276,7 @@ void *WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE handle, ULONG flags, SIZE
     }
 
     if (!status) valgrind_notify_alloc( ptr, size, flags & HEAP_ZERO_MEMORY );
+    if (!status && heap->profile) heap_profile_alloc( heap, ptr, size );
 
     TRACE( "handle %p, flags %#lx, size %#Ix, return %p, status %#lx.\n", handle, flags, size, ptr, status );
     heap_set_status( heap, flags, status );
@@ -2069,6 +2284,28 @@ void *WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE handle, ULONG flags, SIZE
 }
 
 
+static NTSTATUS heap_free( struct heap *heap, ULONG flags, struct block *block )
+{
+    SIZE_T block_size, bin;
+    NTSTATUS status;
+
+    if (heap->profile) heap_profile_free( heap, block );
+
+    if (block_get_flags( block ) & BLOCK_FLAG_LARGE) return heap_free_large( heap, flags, block );
+    if (!(block = heap_delay_free( heap, flags, block ))) return STATUS_SUCCESS;
+    if (!heap_free_block_lfh( heap, flags, block )) return STATUS_SUCCESS;
+
+    block_size = block_get_size( block );
+    bin = BLOCK_SIZE_BIN( block_size );
+
+    heap_lock( heap, flags );
+    status = heap_free_block( heap, flags, block );
+    heap_unlock( heap, flags );
+
+    if (!status && heap->bins) InterlockedIncrement( &heap->bins[bin].count_freed );
+    return status;
+}
+
 /***********************************************************************
  *           RtlFreeHeap   (NTDLL.@)
  */
@@ -2087,22 +2324,8 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE handle, ULONG flags, void *
         status = STATUS_INVALID_PARAMETER;
     else if (!(block = unsafe_block_from_ptr( heap, heap_flags, ptr )))
         status = STATUS_INVALID_PARAMETER;
-    else if (block_get_flags( block ) & BLOCK_FLAG_LARGE)
-        status = heap_free_large( heap, heap_flags, block );
-    else if (!(block = heap_delay_free( heap, heap_flags, block )))
-        status = STATUS_SUCCESS;
-    else if (!heap_free_block_lfh( heap, heap_flags, block ))
-        status = STATUS_SUCCESS;
     else
-    {
-        SIZE_T block_size = block_get_size( block ), bin = BLOCK_SIZE_BIN( block_size );
-
-        heap_lock( heap, heap_flags );
-        status = heap_free_block( heap, heap_flags, block );
-        heap_unlock( heap, heap_flags );
-
-        if (!status && heap->bins) InterlockedIncrement( &heap->bins[bin].count_freed );
-    }
+        status = heap_free( heap, heap_flags, block );
 
     TRACE( "handle %p, flags %#lx, ptr %p, return %u, status %#lx.\n", handle, flags, ptr, !status, status );
     heap_set_status( heap, flags, status );
@@ -2189,31 +2412,41 @@ static NTSTATUS heap_resize_block_lfh( struct block *block, ULONG flags, SIZE_T
 static NTSTATUS heap_resize_in_place( struct heap *heap, ULONG flags, struct block *block, SIZE_T block_size,
                                       SIZE_T size, SIZE_T *old_size, void **ret )
 {
-    SIZE_T old_bin, old_block_size;
+    SIZE_T old_bin = block_get_bin( block ), old_block_size;
     NTSTATUS status;
 
     if (block_get_flags( block ) & BLOCK_FLAG_LARGE)
-        return heap_resize_large( heap, flags, block, block_size, size, old_size, ret );
-
-    old_block_size = block_get_size( block );
-    *old_size = old_block_size - block_get_overhead( block );
-    old_bin = BLOCK_SIZE_BIN( old_block_size );
+        status = heap_resize_large( heap, flags, block, block_size, size, old_size, ret );
+    else
+    {
+        old_block_size = block_get_size( block );
+        *old_size = old_block_size - block_get_overhead( block );
 
-    if (block_size >= HEAP_MIN_LARGE_BLOCK_SIZE) return STATUS_NO_MEMORY;  /* growing small block to large block */
+        if (block_size >= HEAP_MIN_LARGE_BLOCK_SIZE) return STATUS_NO_MEMORY;  /* growing small block to large block */
 
-    if (block_get_flags( block ) & BLOCK_FLAG_LFH)
-        return heap_resize_block_lfh( block, flags, block_size, size, old_size, ret );
+        if (block_get_flags( block ) & BLOCK_FLAG_LFH)
+            status = heap_resize_block_lfh( block, flags, block_size, size, old_size, ret );
+        else
+        {
+            heap_lock( heap, flags );
+            status = heap_resize_block( heap, flags, block, block_size, size, old_block_size, old_size, ret );
+            heap_unlock( heap, flags );
 
-    heap_lock( heap, flags );
-    status = heap_resize_block( heap, flags, block, block_size, size, old_block_size, old_size, ret );
-    heap_unlock( heap, flags );
+            if (!status && heap->bins)
+            {
+                SIZE_T new_bin = BLOCK_SIZE_BIN( block_size );
+                InterlockedIncrement( &heap->bins[old_bin].count_freed );
+                InterlockedIncrement( &heap->bins[new_bin].count_alloc );
+                if (!ReadNoFence( &heap->bins[new_bin].enabled )) bin_try_enable( heap, &heap->bins[new_bin] );
+            }
+        }
+    }
 
-    if (!status && heap->bins)
+    /* count every resize as a free and an allocation, whichever kind of block it is */
+    if (!status && heap->profile)
     {
-        SIZE_T new_bin = BLOCK_SIZE_BIN( block_size );
-        InterlockedIncrement( &heap->bins[old_bin].count_freed );
-        InterlockedIncrement( &heap->bins[new_bin].count_alloc );
-        if (!ReadNoFence( &heap->bins[new_bin].enabled )) bin_try_enable( heap, &heap->bins[new_bin] );
+        InterlockedIncrement( &heap->profile->free_count[old_bin] );
+        heap_profile_alloc( heap, *ret, size );
     }
 
     return status;
@@ -2549,6 +2782,107 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
     return total;
 }
 
+static void heap_get_statistics( struct heap *heap, HEAP_WINE_STATISTICS *stats, ULONG bin_count )
+{
+    const ARENA_LARGE *large;
+    const struct block *block;
+    const SUBHEAP *subheap;
+    ULONG i;
+
+    memset( stats, 0, offsetof( HEAP_WINE_STATISTICS, Bins ) );
+    stats->Version = HEAP_WINE_STATISTICS_VERSION;
+    if (ReadNoFence( &heap->compat_info ) == HEAP_LFH) stats->Flags |= HEAP_WINE_FLAG_LFH;
+    if (heap->profile) stats->Flags |= HEAP_WINE_FLAG_PROFILING;
+
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        const char *base = subheap_base( subheap ), *commit_end = subheap_commit_end( subheap );
+
+        stats->SubheapCount++;
+        stats->ReservedSize += subheap_size( subheap );
+        stats->CommittedSize += commit_end - base;
+        stats->OverheadSize += subheap_overhead( subheap );
+
+        for (block = first_block( subheap ); block; block = next_block( subheap, block ))
+        {
+            const char *end = (const char *)block + block_get_size( block );
+
+            stats->OverheadSize += block_get_overhead( block );
+            if (!(block_get_flags( block ) & BLOCK_FLAG_FREE))
+                stats->UsedSize += block_get_size( block ) - block_get_overhead( block );
+            else if ((const char *)block + block_get_overhead( block ) < commit_end)
+                stats->FreeSize += min( end, commit_end ) - ((const char *)block + block_get_overhead( block ));
+        }
+    }
+
+    LIST_FOR_EACH_ENTRY( large, &heap->large_list, ARENA_LARGE, entry )
+    {
+        stats->LargeCount++;
+        stats->LargeSize += large->block_size;
+        stats->ReservedSize += large->block_size;
+        stats->CommittedSize += large->block_size;
+        stats->UsedSize += large->data_size;
+        stats->OverheadSize += large->block_size - large->data_size;
+    }
+
+    stats->BinCount = min( bin_count, BLOCK_SIZE_BIN_COUNT );
+    for (i = 0; i < stats->BinCount; i++)
+    {
+        HEAP_WINE_BIN_STATISTICS *info = stats->Bins + i;
+
+        memset( info, 0, sizeof(*info) );
+        info->BlockSize = BLOCK_BIN_SIZE( i );
+        if (heap->bins)
+        {
+            info->LfhEnabled = ReadNoFence( &heap->bins[i].enabled );
+            info->BackendAllocCount = ReadNoFence( &heap->bins[i].count_alloc );
+            info->BackendFreeCount = ReadNoFence( &heap->bins[i].count_freed );
+        }
+        if (heap->profile)
+        {
+            info->AllocCount = ReadNoFence( &heap->profile->alloc_count[i] );
+            info->FreeCount = ReadNoFence( &heap->profile->free_count[i] );
+            info->AllocSize = heap->profile->alloc_size[i];
+        }
+    }
+}
+
+static NTSTATUS heap_get_profile( struct heap *heap, HEAP_WINE_PROFILE *info, SIZE_T size_in, SIZE_T *size_out )
+{
+    struct heap_profile *profile = heap->profile;
+    NTSTATUS status = STATUS_SUCCESS;
+    SIZE_T size;
+    ULONG i, count = 0;
+
+    if (!profile)
+    {
+        if (size_out) *size_out = offsetof( HEAP_WINE_PROFILE, Sites );
+        if (size_in < offsetof( HEAP_WINE_PROFILE, Sites )) return STATUS_BUFFER_TOO_SMALL;
+        memset( info, 0, offsetof( HEAP_WINE_PROFILE, Sites ) );
+        info->Version = HEAP_WINE_PROFILE_VERSION;
+        return STATUS_SUCCESS;
+    }
+
+    RtlAcquireSRWLockShared( &profile->sites_lock );
+
+    size = offsetof( HEAP_WINE_PROFILE, Sites[profile->site_count] );
+    if (size_out) *size_out = size;
+    if (size_in < size) status = STATUS_BUFFER_TOO_SMALL;
+    else
+    {
+        info->Version = HEAP_WINE_PROFILE_VERSION;
+        info->SampleRate = ReadNoFence( &profile->sample_rate );
+        info->SampleCount = profile->sample_count;
+        info->DroppedCount = profile->dropped_count;
+        info->SiteCount = profile->site_count;
+        for (i = 0; i < HEAP_PROFILE_SITE_COUNT; i++)
+            if (profile->sites[i].Count) info->Sites[count++] = profile->sites[i];
+    }
+
+    RtlReleaseSRWLockShared( &profile->sites_lock );
+    return status;
+}
+
 /***********************************************************************
  *           RtlQueryHeapInformation    (NTDLL.@)
  */
@@ -2560,7 +2894,7 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE handle, HEAP_INFORMATION_CLASS i
 
     TRACE( "handle %p, info_class %u, info %p, size_in %Iu, size_out %p.\n", handle, info_class, info, size_in, size_out );
 
-    switch (info_class)
+    switch ((ULONG)info_class)
     {
     case HeapCompatibilityInformation:
         if (!(heap = unsafe_heap_from_handle( handle, 0, &flags ))) return STATUS_ACCESS_VIOLATION;
@@ -2569,6 +2903,26 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE handle, HEAP_INFORMATION_CLASS i
         *(ULONG *)info = ReadNoFence( &heap->compat_info );
         return STATUS_SUCCESS;
 
+    case HeapWineStatistics:
+    {
+        SIZE_T bin_count;
+
+        if (!(heap = unsafe_heap_from_handle( handle, 0, &flags ))) return STATUS_INVALID_HANDLE;
+        if (size_out) *size_out = offsetof( HEAP_WINE_STATISTICS, Bins[BLOCK_SIZE_BIN_COUNT] );
+        if (size_in < offsetof( HEAP_WINE_STATISTICS, Bins )) return STATUS_BUFFER_TOO_SMALL;
+        /* return as many size classes as fit in the buffer */
+        bin_count = (size_in - offsetof( HEAP_WINE_STATISTICS, Bins )) / sizeof(HEAP_WINE_BIN_STATISTICS);
+
+        heap_lock( heap, flags );
+        heap_get_statistics( heap, info, min( bin_count, BLOCK_SIZE_BIN_COUNT ) );
+        heap_unlock( heap, flags );
+        return STATUS_SUCCESS;
+    }
+
+    case HeapWineProfiling:
+        if (!(heap = unsafe_heap_from_handle( handle, 0, &flags ))) return STATUS_INVALID_HANDLE;
+        return heap_get_profile( heap, info, size_in, size_out );
+
     default:
         FIXME( "HEAP_INFORMATION_CLASS %u not implemented!\n", info_class );
         return STATUS_INVALID_INFO_CLASS;
@@ -2585,7 +2939,7 @@ NTSTATUS WINAPI RtlSetHeapInformation( HANDLE handle, HEAP_INFORMATION_CLASS inf
 
     TRACE( "handle %p, info_class %u, info %p, size %Iu.\n", handle, info_class, info, size );
 
-    switch (info_class)
+    switch ((ULONG)info_class)
     {
     case HeapCompatibilityInformation:
     {
@@ -2606,6 +2960,12 @@ NTSTATUS WINAPI RtlSetHeapInformation( HANDLE handle, HEAP_INFORMATION_CLASS inf
         return STATUS_SUCCESS;
     }
 
+    case HeapWineProfiling:
+        /* the value is the call stack sampling rate, 0 only counts allocations; profiling can't be disabled */
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heap = unsafe_heap_from_handle( handle, 0, &flags ))) return STATUS_INVALID_HANDLE;
+        return heap_enable_profiling( heap, *(ULONG *)info );
+
     default:
         FIXME( "HEAP_INFORMATION_CLASS %u not implemented!\n", info_class );
         return STATUS_SUCCESS;
@@ -1117,6 +1117,91 @@ static void test_set_io_completion(void)
     pNtClose( h );
 }
 
+static void test_io_completion_order(void)
+{
+    FILE_IO_COMPLETION_INFORMATION info[7];
+    LARGE_INTEGER timeout = {{0}};
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    ULONG count, i, j, next = 0;
+    NTSTATUS res;
+    HANDLE h;
+
+    res = pNtCreateIoCompletion( &h, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( res == STATUS_SUCCESS, "NtCreateIoCompletion failed: %#lx\n", res );
+
+    /* post more packets than fit in the 128 entries of the shared memory ring */
+    for (i = 0; i < 300; i++)
+    {
+        res = pNtSetIoCompletion( h, i, ~i, STATUS_SUCCESS, i * 2 );
+        ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %#lx\n", res );
+    }
+    count = get_pending_msgs(h);
+    ok( count == 300, "Unexpected msg count: %ld\n", count );
+
+    res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletion failed: %#lx\n", res );
+    ok( key == next, "Invalid completion key: %#Ix\n", key );
+    ok( value == ~next, "Invalid completion value: %#Ix\n", value );
+    ok( iosb.Information == next * 2, "Invalid iosb.Information: %Iu\n", iosb.Information );
+    next++;
+
+    if (pNtRemoveIoCompletionEx)
+    {
+        while (next < 300)
+        {
+            count = 0xdeadbeef;
+            res = pNtRemoveIoCompletionEx( h, info, ARRAY_SIZE(info), &count, &timeout, FALSE );
+            ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#lx\n", res );
+            if (res) break;
+            ok( count && count <= ARRAY_SIZE(info), "wrong count %lu\n", count );
+            for (j = 0; j < count; j++, next++)
+            {
+                ok( info[j].CompletionKey == next, "expected key %#lx, got %#Ix\n", next, info[j].CompletionKey );
+                ok( info[j].CompletionValue == ~next, "wrong value %#Ix\n", info[j].CompletionValue );
+                ok( info[j].IoStatusBlock.Information == next * 2, "wrong information %#Ix\n",
+                    info[j].IoStatusBlock.Information );
+                ok( info[j].IoStatusBlock.Status == STATUS_SUCCESS, "wrong status %#lx\n",
+                    info[j].IoStatusBlock.Status );
+            }
+        }
+    }
+    else win_skip( "NtRemoveIoCompletionEx() not present\n" );
+
+    for (; next < 300; next++)
+    {
+        res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+        ok( res == STATUS_SUCCESS, "NtRemoveIoCompletion failed: %#lx\n", res );
+        ok( key == next, "Invalid completion key: %#Ix\n", key );
+    }
+
+    count = get_pending_msgs(h);
+    ok( !count, "Unexpected msg count: %ld\n", count );
+    res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+    ok( res == STATUS_TIMEOUT, "NtRemoveIoCompletion failed: %#lx\n", res );
+
+    pNtClose( h );
+}
+
+/* run the completion order test again with the packets going through the Wine shared memory ring */
+static void test_completion_ring( char **argv )
+{
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    char cmdline[MAX_PATH];
+    BOOL ret;
+
+    si.cb = sizeof(si);
+    sprintf( cmdline, "%s %s completion_ring", argv[0], argv[1] );
+    SetEnvironmentVariableA( "WINECOMPLETIONRING", "1" );
+    ret = CreateProcessA( NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi );
+    ok( ret, "failed to create process, error %lu\n", GetLastError() );
+    SetEnvironmentVariableA( "WINECOMPLETIONRING", NULL );
+    wait_child_process( pi.hProcess );
+    CloseHandle( pi.hProcess );
+    CloseHandle( pi.hThread );
+}
+
 static void test_file_io_completion(void)
 {
     static const char pipe_name[] = "\\\\.\\pipe\\iocompletiontestnamedpipe";
@@ -6058,6 +6143,8 @@ START_TEST(file)
 {
     HMODULE hkernel32 = GetModuleHandleA("kernel32.dll");
     HMODULE hntdll = GetModuleHandleA("ntdll.dll");
+    char **argv;
+    int argc;
     if (!hntdll)
     {
         skip("not running on NT, skipping test\n");
@@ -6098,6 +6185,13 @@ START_TEST(file)
     pNtFlushBuffersFile = (void *)GetProcAddress(hntdll, "NtFlushBuffersFile");
     pNtQueryEaFile          = (void *)GetProcAddress(hntdll, "NtQueryEaFile");
 
+    argc = winetest_get_mainargs( &argv );
+    if (argc > 2)
+    {
+        if (!strcmp( argv[2], "completion_ring" )) test_io_completion_order();
+        return;
+    }
+
     test_read_write();
     test_NtCreateFile();
     create_file_test();
@@ -6108,6 +6202,8 @@ START_TEST(file)
     nt_mailslot_test();
     test_set_io_completion();
     test_set_io_completion_ex();
+    test_io_completion_order();
+    test_completion_ring( argv );
     test_file_io_completion();
     test_file_basic_information();
     test_file_all_information();
@@ -142,6 +142,7 @@ static NTSTATUS (WINAPI * pNtQueryKey)(HANDLE,KEY_INFORMATION_CLASS,PVOID,ULONG,
 static NTSTATUS (WINAPI * pNtQueryLicenseValue)(const UNICODE_STRING *,ULONG *,PVOID,ULONG,ULONG *);
 static NTSTATUS (WINAPI * pNtQueryObject)(HANDLE, OBJECT_INFORMATION_CLASS, void *, ULONG, ULONG *);
 static NTSTATUS (WINAPI * pNtQueryValueKey)(HANDLE,const UNICODE_STRING *,KEY_VALUE_INFORMATION_CLASS,void *,DWORD,DWORD *);
+static NTSTATUS (WINAPI * pNtQueryMultipleValueKey)(HANDLE,KEY_MULTIPLE_VALUE_INFORMATION *,ULONG,void *,ULONG,ULONG *);
 static NTSTATUS (WINAPI * pNtSetValueKey)(HANDLE, const PUNICODE_STRING, ULONG,
                                ULONG, const void*, ULONG  );
 static NTSTATUS (WINAPI * pRtlFormatCurrentUserKeyPath)(PUNICODE_STRING);
@@ -196,6 +197,7 @@ static BOOL InitFunctionPtrs(void)
     NTDLL_GET_PROC(NtQueryKey)
     NTDLL_GET_PROC(NtQueryObject)
     NTDLL_GET_PROC(NtQueryValueKey)
+    NTDLL_GET_PROC(NtQueryMultipleValueKey)
     NTDLL_GET_PROC(NtSetValueKey)
     NTDLL_GET_PROC(NtOpenKey)
     NTDLL_GET_PROC(NtNotifyChangeKey)
@@ -642,7 +644,7 @@ static void test_NtFlushKey(void)
 
 static void test_NtQueryValueKey(void)
 {
-    HANDLE key;
+    HANDLE key, key2;
     NTSTATUS status;
     OBJECT_ATTRIBUTES attr;
     UNICODE_STRING ValName;
@@ -650,7 +652,8 @@ static void test_NtQueryValueKey(void)
     KEY_VALUE_PARTIAL_INFORMATION *partial_info, pi;
     KEY_VALUE_PARTIAL_INFORMATION_ALIGN64 *aligned_info;
     KEY_VALUE_FULL_INFORMATION *full_info;
-    DWORD len, expected;
+    DWORD len, expected, i;
+    BYTE buffer[64];
 
     pRtlCreateUnicodeStringFromAsciiz(&ValName, "deletetest");
 
@@ -798,6 +801,95 @@ static void test_NtQueryValueKey(void)
     ok(pi.DataLength == 0, "DataLength=%lu\n", pi.DataLength);
     pRtlFreeUnicodeString(&ValName);
 
+    /* changes made through another handle must be visible */
+    status = pNtOpenKey(&key2, KEY_READ|KEY_SET_VALUE, &attr);
+    ok(status == STATUS_SUCCESS, "NtOpenKey Failed: 0x%08lx\n", status);
+    pRtlCreateUnicodeStringFromAsciiz(&ValName, "cachetest");
+
+    len = sizeof(buffer);
+    status = pNtQueryValueKey(key, &ValName, KeyValuePartialInformation, buffer, len, &len);
+    ok(status == STATUS_OBJECT_NAME_NOT_FOUND, "NtQueryValueKey wrong status 0x%08lx\n", status);
+
+    for (i = 1; i <= 3; i++)
+    {
+        status = pNtSetValueKey(key2, &ValName, 0, REG_DWORD, &i, sizeof(i));
+        ok(status == STATUS_SUCCESS, "NtSetValueKey Failed: 0x%08lx\n", status);
+        len = sizeof(buffer);
+        status = pNtQueryValueKey(key, &ValName, KeyValuePartialInformation, buffer, len, &len);
+        ok(status == STATUS_SUCCESS, "NtQueryValueKey wrong status 0x%08lx\n", status);
+        partial_info = (KEY_VALUE_PARTIAL_INFORMATION *)buffer;
+        ok(partial_info->DataLength == sizeof(i), "DataLength=%lu\n", partial_info->DataLength);
+        ok(*(DWORD *)partial_info->Data == i, "got %lu, expected %lu\n", *(DWORD *)partial_info->Data, i);
+    }
+
+    status = pNtDeleteValueKey(key2, &ValName);
+    ok(status == STATUS_SUCCESS, "NtDeleteValueKey Failed: 0x%08lx\n", status);
+    len = sizeof(buffer);
+    status = pNtQueryValueKey(key, &ValName, KeyValuePartialInformation, buffer, len, &len);
+    ok(status == STATUS_OBJECT_NAME_NOT_FOUND, "NtQueryValueKey wrong status 0x%08lx\n", status);
+
+    pRtlFreeUnicodeString(&ValName);
+    pNtClose(key2);
+    pNtClose(key);
+}
+
+static void test_NtQueryMultipleValueKey(void)
+{
+    static const BYTE binary[4] = {1, 2, 3, 4};
+    UNICODE_STRING names[3];
+    KEY_MULTIPLE_VALUE_INFORMATION info[3];
+    OBJECT_ATTRIBUTES attr;
+    DWORD dword = 0xdeadbeef;
+    BYTE buffer[64];
+    NTSTATUS status;
+    ULONG len;
+    HANDLE key;
+
+    InitializeObjectAttributes(&attr, &winetestpath, 0, 0, 0);
+    status = pNtOpenKey(&key, KEY_READ|KEY_SET_VALUE, &attr);
+    ok(status == STATUS_SUCCESS, "NtOpenKey Failed: 0x%08lx\n", status);
+
+    pRtlInitUnicodeString(&names[0], L"multi1");
+    pRtlInitUnicodeString(&names[1], L"multi2");
+    pRtlInitUnicodeString(&names[2], L"multimissing");
+    status = pNtSetValueKey(key, &names[0], 0, REG_BINARY, binary, sizeof(binary));
+    ok(status == STATUS_SUCCESS, "NtSetValueKey Failed: 0x%08lx\n", status);
+    status = pNtSetValueKey(key, &names[1], 0, REG_DWORD, &dword, sizeof(dword));
+    ok(status == STATUS_SUCCESS, "NtSetValueKey Failed: 0x%08lx\n", status);
+
+    memset(info, 0xcc, sizeof(info));
+    info[0].ValueName = &names[0];
+    info[1].ValueName = &names[1];
+    memset(buffer, 0xcc, sizeof(buffer));
+    len = 0xdeadbeef;
+    status = pNtQueryMultipleValueKey(key, info, 2, buffer, sizeof(buffer), &len);
+    ok(status == STATUS_SUCCESS, "got 0x%08lx\n", status);
+    ok(len == sizeof(binary) + sizeof(dword), "got length %lu\n", len);
+    ok(info[0].Type == REG_BINARY, "got type %lu\n", info[0].Type);
+    ok(info[0].DataLength == sizeof(binary), "got data length %lu\n", info[0].DataLength);
+    ok(info[1].Type == REG_DWORD, "got type %lu\n", info[1].Type);
+    ok(info[1].DataLength == sizeof(dword), "got data length %lu\n", info[1].DataLength);
+    ok(info[0].DataOffset + sizeof(binary) <= len, "got offset %lu\n", info[0].DataOffset);
+    ok(info[1].DataOffset + sizeof(dword) <= len, "got offset %lu\n", info[1].DataOffset);
+    if (!status)
+    {
+        ok(!memcmp(buffer + info[0].DataOffset, binary, sizeof(binary)), "got wrong data\n");
+        ok(*(DWORD *)(buffer + info[1].DataOffset) == dword, "got %#lx\n",
+           *(DWORD *)(buffer + info[1].DataOffset));
+    }
+
+    /* the total length is returned when the buffer is too small */
+    len = 0xdeadbeef;
+    status = pNtQueryMultipleValueKey(key, info, 2, buffer, sizeof(binary), &len);
+    ok(status == STATUS_BUFFER_TOO_SMALL, "got 0x%08lx\n", status);
+    ok(len == sizeof(binary) + sizeof(dword), "got length %lu\n", len);
+
+    info[2].ValueName = &names[2];
+    status = pNtQueryMultipleValueKey(key, info, 3, buffer, sizeof(buffer), &len);
+    ok(status == STATUS_OBJECT_NAME_NOT_FOUND, "got 0x%08lx\n", status);
+
+    pNtDeleteValueKey(key, &names[0]);
+    pNtDeleteValueKey(key, &names[1]);
     pNtClose(key);
 }
 
@@ -3093,6 +3185,7 @@ START_TEST(reg)
     test_NtQueryKey();
     test_NtQueryLicenseKey();
     test_NtQueryValueKey();
+    test_NtQueryMultipleValueKey();
     test_long_value_name();
     test_notify();
     test_RtlCreateRegistryKey();
@@ -27,11 +27,16 @@
 #include "wine/test.h"
 
 static NTSTATUS (WINAPI *pNtAlertThreadByThreadId)( HANDLE );
+static NTSTATUS (WINAPI *pNtAssociateWaitCompletionPacket)( HANDLE, HANDLE, HANDLE, void *, void *, NTSTATUS, ULONG_PTR, BOOLEAN * );
+static NTSTATUS (WINAPI *pNtCancelWaitCompletionPacket)( HANDLE, BOOLEAN );
+static NTSTATUS (WINAPI *pNtCancelTimer)( HANDLE, BOOLEAN * );
 static NTSTATUS (WINAPI *pNtClose)( HANDLE );
 static NTSTATUS (WINAPI *pNtCreateEvent) ( PHANDLE, ACCESS_MASK, const OBJECT_ATTRIBUTES *, EVENT_TYPE, BOOLEAN);
 static NTSTATUS (WINAPI *pNtCreateKeyedEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, ULONG );
 static NTSTATUS (WINAPI *pNtCreateMutant)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, BOOLEAN );
 static NTSTATUS (WINAPI *pNtCreateSemaphore)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, LONG, LONG );
+static NTSTATUS (WINAPI *pNtCreateTimer)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, TIMER_TYPE );
+static NTSTATUS (WINAPI *pNtCreateWaitCompletionPacket)( HANDLE *, ACCESS_MASK, OBJECT_ATTRIBUTES * );
 static NTSTATUS (WINAPI *pNtDelayExecution)( BOOLEAN, const LARGE_INTEGER * );
 static NTSTATUS (WINAPI *pNtOpenEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES * );
 static NTSTATUS (WINAPI *pNtOpenKeyedEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES * );
@@ -45,6 +50,7 @@ static NTSTATUS (WINAPI *pNtReleaseMutant)( HANDLE, LONG * );
 static NTSTATUS (WINAPI *pNtReleaseSemaphore)( HANDLE, ULONG, ULONG * );
 static NTSTATUS (WINAPI *pNtResetEvent)( HANDLE, LONG * );
 static NTSTATUS (WINAPI *pNtSetEvent)( HANDLE, LONG * );
+static NTSTATUS (WINAPI *pNtSetTimer)( HANDLE, const LARGE_INTEGER *, PTIMER_APC_ROUTINE, void *, BOOLEAN, ULONG, BOOLEAN * );
 static NTSTATUS (WINAPI *pNtWaitForAlertByThreadId)( void *, const LARGE_INTEGER * );
 static NTSTATUS (WINAPI *pNtWaitForKeyedEvent)( HANDLE, const void *, BOOLEAN, const LARGE_INTEGER * );
 static BOOLEAN  (WINAPI *pRtlAcquireResourceExclusive)( RTL_RWLOCK *, BOOLEAN );
@@ -520,6 +526,131 @@ static void test_semaphore(void)
     NtClose( semaphore );
 }
 
+struct contention_params
+{
+    HANDLE mutant;
+    HANDLE semaphore;
+    LONG   counter;
+};
+
+static DWORD WINAPI contention_thread( void *arg )
+{
+    struct contention_params *params = arg;
+    NTSTATUS status;
+    DWORD ret;
+    LONG val;
+    int i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        ret = WaitForSingleObject( params->mutant, INFINITE );
+        ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+        val = params->counter;
+        if (!(i % 16)) Sleep( 0 );
+        params->counter = val + 1;
+        status = pNtReleaseMutant( params->mutant, NULL );
+        ok( status == STATUS_SUCCESS, "NtReleaseMutant failed %08lx\n", status );
+
+        ret = WaitForSingleObject( params->semaphore, INFINITE );
+        ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+        status = pNtReleaseSemaphore( params->semaphore, 1, NULL );
+        ok( status == STATUS_SUCCESS, "NtReleaseSemaphore failed %08lx\n", status );
+    }
+    return 0;
+}
+
+static void test_contention(void)
+{
+    struct contention_params params;
+    HANDLE threads[4];
+    NTSTATUS status;
+    DWORD ret;
+    ULONG prev;
+    int i;
+
+    status = pNtCreateMutant( &params.mutant, GENERIC_ALL, NULL, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateMutant failed %08lx\n", status );
+    status = pNtCreateSemaphore( &params.semaphore, GENERIC_ALL, NULL, 2, 2 );
+    ok( status == STATUS_SUCCESS, "NtCreateSemaphore failed %08lx\n", status );
+    params.counter = 0;
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+        threads[i] = CreateThread( NULL, 0, contention_thread, &params, 0, NULL );
+    ret = WaitForMultipleObjects( ARRAY_SIZE(threads), threads, TRUE, 30000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects failed %08lx\n", ret );
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle( threads[i] );
+
+    ok( params.counter == 4000, "got counter %ld\n", params.counter );
+
+    /* the semaphore count must be back to its initial value */
+    prev = 0xdeadbeef;
+    status = pNtReleaseSemaphore( params.semaphore, 1, &prev );
+    ok( status == STATUS_SEMAPHORE_LIMIT_EXCEEDED, "NtReleaseSemaphore failed %08lx\n", status );
+    ret = WaitForSingleObject( params.mutant, 0 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+
+    NtClose( params.mutant );
+    NtClose( params.semaphore );
+}
+
+/* objects reusing the handle value or the shared state of a closed one must not see its state */
+static void test_handle_reuse(void)
+{
+    HANDLE event, dup;
+    NTSTATUS status;
+    DWORD ret;
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, NotificationEvent, TRUE );
+        ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+        ret = WaitForSingleObject( event, 0 );
+        ok( ret == WAIT_OBJECT_0, "got %lu\n", ret );
+        NtClose( event );
+
+        status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE );
+        ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+        ret = WaitForSingleObject( event, 0 );
+        ok( ret == WAIT_TIMEOUT, "got %lu\n", ret );
+        NtClose( event );
+    }
+
+    status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+    ret = DuplicateHandle( GetCurrentProcess(), event, GetCurrentProcess(), &dup, SYNCHRONIZE, FALSE, 0 );
+    ok( ret, "DuplicateHandle failed %lu\n", GetLastError() );
+    status = pNtSetEvent( dup, NULL );
+    ok( status == STATUS_ACCESS_DENIED, "NtSetEvent failed %08lx\n", status );
+    ret = WaitForSingleObject( dup, 0 );
+    ok( ret == WAIT_TIMEOUT, "got %lu\n", ret );
+    status = pNtSetEvent( event, NULL );
+    ok( status == STATUS_SUCCESS, "NtSetEvent failed %08lx\n", status );
+    ret = WaitForSingleObject( dup, 0 );
+    ok( ret == WAIT_OBJECT_0, "got %lu\n", ret );
+    NtClose( dup );
+    NtClose( event );
+}
+
+/* run the synchronization tests again in a process that uses in-process synchronization */
+static void test_inproc_sync( char **argv )
+{
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    char cmdline[MAX_PATH];
+    BOOL ret;
+
+    si.cb = sizeof(si);
+    sprintf( cmdline, "%s %s inproc_sync", argv[0], argv[1] );
+    SetEnvironmentVariableA( "WINEINPROCSYNC", "1" );
+    ret = CreateProcessA( NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi );
+    ok( ret, "failed to create process, error %lu\n", GetLastError() );
+    SetEnvironmentVariableA( "WINEINPROCSYNC", NULL );
+    wait_child_process( pi.hProcess );
+    CloseHandle( pi.hProcess );
+    CloseHandle( pi.hThread );
+}
+
 static void test_wait_on_address(void)
 {
     SIZE_T size;
@@ -1119,6 +1250,152 @@ static void test_delayexecution(void)
     }
 }
 
+static void test_timer_timeouts(void)
+{
+    unsigned int i, count = 256;
+    LARGE_INTEGER due;
+    NTSTATUS status;
+    BOOLEAN state;
+    HANDLE *timers;
+    DWORD ret;
+
+    timers = malloc( count * sizeof(*timers) );
+    for (i = 0; i < count; i++)
+    {
+        status = pNtCreateTimer( &timers[i], TIMER_ALL_ACCESS, NULL, NotificationTimer );
+        ok( status == STATUS_SUCCESS, "NtCreateTimer failed %08lx\n", status );
+    }
+
+    /* set many timers in increasing order of expiry, then cancel them */
+    for (i = 0; i < count; i++)
+    {
+        due.QuadPart = -(LONGLONG)3600 * 10000000 - (LONGLONG)i * 10000;
+        status = pNtSetTimer( timers[i], &due, NULL, NULL, FALSE, 0, NULL );
+        ok( status == STATUS_SUCCESS, "NtSetTimer failed %08lx\n", status );
+    }
+    for (i = 0; i < count; i++)
+    {
+        state = TRUE;
+        status = pNtCancelTimer( timers[i], &state );
+        ok( status == STATUS_SUCCESS, "NtCancelTimer failed %08lx\n", status );
+        ok( !state, "timer %u is signaled\n", i );
+    }
+
+    /* the earliest timeout must expire first, whatever the insertion order */
+    for (i = 0; i < 4; i++)
+    {
+        due.QuadPart = -(LONGLONG)(i % 2 ? 1000 : 50 + 50 * i) * 10000;
+        status = pNtSetTimer( timers[i], &due, NULL, NULL, FALSE, 0, NULL );
+        ok( status == STATUS_SUCCESS, "NtSetTimer failed %08lx\n", status );
+    }
+    ret = WaitForMultipleObjects( 4, timers, FALSE, 5000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects returned %lu\n", ret );
+    ret = WaitForSingleObject( timers[1], 0 );
+    ok( ret == WAIT_TIMEOUT, "WaitForSingleObject returned %lu\n", ret );
+    ret = WaitForSingleObject( timers[2], 5000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject returned %lu\n", ret );
+    ret = WaitForMultipleObjects( 4, timers, TRUE, 5000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects returned %lu\n", ret );
+
+    for (i = 0; i < count; i++) pNtClose( timers[i] );
+    free( timers );
+}
+
+static void test_wait_completion_packet(void)
+{
+    FILE_IO_COMPLETION_INFORMATION info;
+    HANDLE port, packet, event, sem;
+    LARGE_INTEGER timeout;
+    ULONG count, prev_count;
+    BOOLEAN signaled;
+    NTSTATUS status;
+    LONG prev;
+
+    if (!pNtCreateWaitCompletionPacket)
+    {
+        win_skip( "NtCreateWaitCompletionPacket is not available\n" );
+        return;
+    }
+
+    status = NtCreateIoCompletion( &port, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( !status, "got %#lx.\n", status );
+    status = pNtCreateWaitCompletionPacket( &packet, GENERIC_ALL, NULL );
+    ok( !status, "got %#lx.\n", status );
+    status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, SynchronizationEvent, FALSE );
+    ok( !status, "got %#lx.\n", status );
+    timeout.QuadPart = 0;
+
+    /* the packet is queued once the object is signaled */
+    signaled = 0xcc;
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)0x1234, (void *)0x5678,
+                                               STATUS_TIMEOUT, 0xdead, &signaled );
+    ok( !status, "got %#lx.\n", status );
+    ok( !signaled, "got %u.\n", signaled );
+    status = NtRemoveIoCompletionEx( port, &info, 1, &count, &timeout, FALSE );
+    ok( status == STATUS_TIMEOUT, "got %#lx.\n", status );
+
+    pNtSetEvent( event, NULL );
+    memset( &info, 0xcc, sizeof(info) );
+    status = NtRemoveIoCompletionEx( port, &info, 1, &count, &timeout, FALSE );
+    ok( !status, "got %#lx.\n", status );
+    ok( count == 1, "got %lu.\n", count );
+    ok( info.CompletionKey == 0x1234, "got %#Ix.\n", info.CompletionKey );
+    ok( info.CompletionValue == 0x5678, "got %#Ix.\n", info.CompletionValue );
+    ok( info.IoStatusBlock.Status == STATUS_TIMEOUT, "got %#lx.\n", info.IoStatusBlock.Status );
+    ok( info.IoStatusBlock.Information == 0xdead, "got %#Ix.\n", info.IoStatusBlock.Information );
+
+    /* the wait has been satisfied */
+    status = pNtResetEvent( event, &prev );
+    ok( !status, "got %#lx.\n", status );
+    ok( !prev, "got %ld.\n", prev );
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( status == STATUS_CANCELLED, "got %#lx.\n", status );
+
+    /* already signaled object */
+    pNtSetEvent( event, NULL );
+    signaled = 0xcc;
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)1, NULL, 0, 0, &signaled );
+    ok( !status, "got %#lx.\n", status );
+    ok( signaled == TRUE, "got %u.\n", signaled );
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( status == STATUS_PENDING, "got %#lx.\n", status );
+    status = pNtCancelWaitCompletionPacket( packet, TRUE );
+    ok( !status, "got %#lx.\n", status );
+    status = NtRemoveIoCompletionEx( port, &info, 1, &count, &timeout, FALSE );
+    ok( status == STATUS_TIMEOUT, "got %#lx.\n", status );
+
+    /* cancelling the wait leaves the object untouched */
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)2, NULL, 0, 0, NULL );
+    ok( !status, "got %#lx.\n", status );
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( !status, "got %#lx.\n", status );
+    pNtSetEvent( event, NULL );
+    status = NtRemoveIoCompletionEx( port, &info, 1, &count, &timeout, FALSE );
+    ok( status == STATUS_TIMEOUT, "got %#lx.\n", status );
+    status = pNtResetEvent( event, &prev );
+    ok( !status, "got %#lx.\n", status );
+    ok( prev == 1, "got %ld.\n", prev );
+
+    /* a semaphore count is consumed by the wait */
+    status = pNtCreateSemaphore( &sem, SEMAPHORE_ALL_ACCESS, NULL, 0, 2 );
+    ok( !status, "got %#lx.\n", status );
+    status = pNtAssociateWaitCompletionPacket( packet, port, sem, (void *)3, NULL, 0, 0, NULL );
+    ok( !status, "got %#lx.\n", status );
+    status = pNtReleaseSemaphore( sem, 2, NULL );
+    ok( !status, "got %#lx.\n", status );
+    status = NtRemoveIoCompletionEx( port, &info, 1, &count, &timeout, FALSE );
+    ok( !status, "got %#lx.\n", status );
+    ok( info.CompletionKey == 3, "got %#Ix.\n", info.CompletionKey );
+    status = pNtReleaseSemaphore( sem, 1, &prev_count );
+    ok( !status, "got %#lx.\n", status );
+    ok( prev_count == 1, "got %lu.\n", prev_count );
+
+    pNtClose( sem );
+    pNtClose( event );
+    pNtClose( packet );
+    pNtClose( port );
+}
+
 START_TEST(sync)
 {
     HMODULE module = GetModuleHandleA("ntdll.dll");
@@ -1127,14 +1404,17 @@ START_TEST(sync)
 
     argc = winetest_get_mainargs( &argv );
 
-    if (argc > 2) return;
-
     pNtAlertThreadByThreadId        = (void *)GetProcAddress(module, "NtAlertThreadByThreadId");
+    pNtAssociateWaitCompletionPacket = (void *)GetProcAddress(module, "NtAssociateWaitCompletionPacket");
+    pNtCancelWaitCompletionPacket   = (void *)GetProcAddress(module, "NtCancelWaitCompletionPacket");
+    pNtCancelTimer                  = (void *)GetProcAddress(module, "NtCancelTimer");
     pNtClose                        = (void *)GetProcAddress(module, "NtClose");
     pNtCreateEvent                  = (void *)GetProcAddress(module, "NtCreateEvent");
     pNtCreateKeyedEvent             = (void *)GetProcAddress(module, "NtCreateKeyedEvent");
     pNtCreateMutant                 = (void *)GetProcAddress(module, "NtCreateMutant");
     pNtCreateSemaphore              = (void *)GetProcAddress(module, "NtCreateSemaphore");
+    pNtCreateTimer                  = (void *)GetProcAddress(module, "NtCreateTimer");
+    pNtCreateWaitCompletionPacket   = (void *)GetProcAddress(module, "NtCreateWaitCompletionPacket");
     pNtDelayExecution               = (void *)GetProcAddress(module, "NtDelayExecution");
     pNtOpenEvent                    = (void *)GetProcAddress(module, "NtOpenEvent");
     pNtOpenKeyedEvent               = (void *)GetProcAddress(module, "NtOpenKeyedEvent");
@@ -1148,6 +1428,7 @@ START_TEST(sync)
     pNtReleaseSemaphore             = (void *)GetProcAddress(module, "NtReleaseSemaphore");
     pNtResetEvent                   = (void *)GetProcAddress(module, "NtResetEvent");
     pNtSetEvent                     = (void *)GetProcAddress(module, "NtSetEvent");
+    pNtSetTimer                     = (void *)GetProcAddress(module, "NtSetTimer");
     pNtWaitForAlertByThreadId       = (void *)GetProcAddress(module, "NtWaitForAlertByThreadId");
     pNtWaitForKeyedEvent            = (void *)GetProcAddress(module, "NtWaitForKeyedEvent");
     pRtlAcquireResourceExclusive    = (void *)GetProcAddress(module, "RtlAcquireResourceExclusive");
@@ -1160,13 +1441,31 @@ START_TEST(sync)
     pRtlWakeAddressAll              = (void *)GetProcAddress(module, "RtlWakeAddressAll");
     pRtlWakeAddressSingle           = (void *)GetProcAddress(module, "RtlWakeAddressSingle");
 
+    if (argc > 2)
+    {
+        if (!strcmp( argv[2], "inproc_sync" ))
+        {
+            test_event();
+            test_mutant();
+            test_semaphore();
+            test_contention();
+            test_handle_reuse();
+        }
+        return;
+    }
+
     test_wait_on_address();
     test_event();
     test_mutant();
     test_semaphore();
+    test_contention();
+    test_handle_reuse();
+    test_inproc_sync( argv );
     test_keyed_events();
     test_resource();
     test_tid_alert( argv );
     test_completion_port_scheduling();
     test_delayexecution();
+    test_timer_timeouts();
+    test_wait_completion_packet();
 }
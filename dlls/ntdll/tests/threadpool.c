@@ -838,6 +838,94 @@ static void test_tp_work_scheduler(void)
     pTpReleasePool(pool);
 }
 
+struct work_concurrent_info
+{
+    HANDLE start_event;
+    TP_WORK *work;
+    LONG count;
+    int iterations;
+};
+
+static void CALLBACK work_concurrent_cb(TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WORK *work)
+{
+    struct work_concurrent_info *info = userdata;
+    InterlockedIncrement(&info->count);
+}
+
+static DWORD CALLBACK work_concurrent_thread(void *arg)
+{
+    struct work_concurrent_info *info = arg;
+    int i;
+
+    WaitForSingleObject(info->start_event, INFINITE);
+    for (i = 0; i < info->iterations; i++)
+        pTpPostWork(info->work);
+    pTpWaitForWork(info->work, FALSE);
+    return 0;
+}
+
+static void test_tp_work_concurrent(void)
+{
+    struct work_concurrent_info info[8];
+    TP_CALLBACK_ENVIRON environment;
+    HANDLE threads[8], start_event;
+    unsigned int max_threads, num_threads, i;
+    SYSTEM_INFO sysinfo;
+    TP_POOL *pool;
+    NTSTATUS status;
+    int iterations = 2000;
+
+    GetSystemInfo(&sysinfo);
+    max_threads = min(max(sysinfo.dwNumberOfProcessors, 2), ARRAY_SIZE(threads));
+
+    /* each submitting thread posts to its own work object, the pool has as
+     * many worker threads as there are submitters */
+    for (num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+        pool = NULL;
+        status = pTpAllocPool(&pool, NULL);
+        ok(!status, "TpAllocPool failed with status %lx\n", status);
+        ok(pool != NULL, "expected pool != NULL\n");
+        pTpSetPoolMaxThreads(pool, num_threads);
+
+        start_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+        ok(start_event != NULL, "CreateEvent failed with error %lu\n", GetLastError());
+
+        memset(&environment, 0, sizeof(environment));
+        environment.Version = 1;
+        environment.Pool = pool;
+        for (i = 0; i < num_threads; i++)
+        {
+            info[i].start_event = start_event;
+            info[i].count = 0;
+            info[i].iterations = iterations;
+            info[i].work = NULL;
+            status = pTpAllocWork(&info[i].work, work_concurrent_cb, &info[i], &environment);
+            ok(!status, "TpAllocWork failed with status %lx\n", status);
+            ok(info[i].work != NULL, "expected work != NULL\n");
+            threads[i] = CreateThread(NULL, 0, work_concurrent_thread, &info[i], 0, NULL);
+            ok(threads[i] != NULL, "CreateThread failed with error %lu\n", GetLastError());
+        }
+
+        SetEvent(start_event);
+        for (i = 0; i < num_threads; i++)
+        {
+            WaitForSingleObject(threads[i], INFINITE);
+            CloseHandle(threads[i]);
+        }
+
+        for (i = 0; i < num_threads; i++)
+        {
+            ok(info[i].count == iterations, "thread %u: expected %d callbacks, got %ld\n",
+               i, iterations, info[i].count);
+            pTpReleaseWork(info[i].work);
+        }
+
+        CloseHandle(start_event);
+        pTpReleasePool(pool);
+    }
+}
+
 static void CALLBACK simple_release_cb(TP_CALLBACK_INSTANCE *instance, void *userdata)
 {
     HANDLE *semaphores = userdata;
@@ -2398,6 +2486,7 @@ START_TEST(threadpool)
     test_tp_simple();
     test_tp_work();
     test_tp_work_scheduler();
+    test_tp_work_concurrent();
     test_tp_group_wait();
     test_tp_group_cancel();
     test_tp_instance();
@@ -97,7 +97,18 @@ struct timer_queue
  */
 
 #define THREADPOOL_WORKER_TIMEOUT 5000
-#define MAXIMUM_WAITQUEUE_OBJECTS (MAXIMUM_WAIT_OBJECTS - 1)
+#define THREADPOOL_MAX_QUEUES 64
+#define MAXIMUM_WAITQUEUE_PACKETS 64
+
+/* queue of work items; a pool has one per processor, and its objects are
+ * spread among them so that submitting threads and workers don't all
+ * contend on the same lock */
+struct threadpool_queue
+{
+    CRITICAL_SECTION        cs;
+    /* Pools of work items, locked via .cs, order matches TP_CALLBACK_PRIORITY - high, normal, low. */
+    struct list             pools[3];
+};
 
 /* internal threadpool representation */
 struct threadpool
@@ -106,16 +117,20 @@ struct threadpool
     LONG                    objcount;
     BOOL                    shutdown;
     CRITICAL_SECTION        cs;
-    /* Pools of work items, locked via .cs, order matches TP_CALLBACK_PRIORITY - high, normal, low. */
-    struct list             pools[3];
     RTL_CONDITION_VARIABLE  update_event;
     /* information about worker threads, locked via .cs */
     int                     max_workers;
     int                     min_workers;
     int                     num_workers;
-    int                     num_busy_workers;
+    /* interlocked counters, they are read without holding a lock */
+    LONG                    num_busy_workers;
+    LONG                    num_idle_workers;
+    LONG                    num_queued[3];
+    LONG                    next_queue;
     HANDLE                  compl_port;
     TP_POOL_STACK_INFORMATION stack_info;
+    unsigned int            num_queues;
+    struct threadpool_queue queues[1];
 };
 
 enum threadpool_objtype
@@ -152,7 +167,8 @@ struct threadpool_object
     /* information about the group, locked via .group->cs */
     struct list             group_entry;
     BOOL                    is_group_member;
-    /* information about the pool, locked via .pool->cs */
+    /* information about the pool, locked via .queue->cs */
+    struct threadpool_queue *queue;
     struct list             pool_entry;
     RTL_CONDITION_VARIABLE  finished_event;
     RTL_CONDITION_VARIABLE  group_finished_event;
@@ -160,7 +176,6 @@ struct threadpool_object
     LONG                    num_pending_callbacks;
     LONG                    num_running_callbacks;
     LONG                    num_associated_callbacks;
-    LONG                    update_serial;
     /* arguments for callback */
     union
     {
@@ -191,6 +206,8 @@ struct threadpool_object
             /* information about the wait object, locked via waitqueue.cs */
             struct waitqueue_bucket *bucket;
             BOOL            wait_pending;
+            BOOL            associated;
+            HANDLE          packet;
             struct list     wait_entry;
             ULONGLONG       timeout;
             HANDLE          handle;
@@ -200,7 +217,7 @@ struct threadpool_object
         struct
         {
             PTP_IO_CALLBACK callback;
-            /* locked via .pool->cs */
+            /* locked via .queue->cs */
             unsigned int    pending_count, skipped_count, completion_count, completion_max;
             BOOL            shutting_down;
             struct io_completion *completions;
@@ -286,13 +303,15 @@ static RTL_CRITICAL_SECTION_DEBUG waitqueue_debug =
       0, 0, { (DWORD_PTR)(__FILE__ ": waitqueue.cs") }
 };
 
+/* A bucket waits for any number of objects through wait completion packets
+ * queued to its port; there is one per alertable state. */
 struct waitqueue_bucket
 {
     struct list             bucket_entry;
     LONG                    objcount;
     struct list             reserved;
     struct list             waiting;
-    HANDLE                  update_event;
+    HANDLE                  port;
     BOOL                    alertable;
 };
 
@@ -1238,18 +1257,55 @@ static void tp_timerqueue_unlock( struct threadpool_object *timer )
     RtlLeaveCriticalSection( &timerqueue.cs );
 }
 
+/***********************************************************************
+ *           tp_waitqueue_associate    (internal)
+ *
+ * Starts waiting for the object handle, the wait completion packet is
+ * queued to the bucket port once it is signaled. Holds a reference to
+ * the wait object until the packet is removed from the port or cancelled.
+ */
+static void tp_waitqueue_associate( struct waitqueue_bucket *bucket, struct threadpool_object *wait )
+{
+    NTSTATUS status;
+
+    InterlockedIncrement( &wait->refcount );
+    status = NtAssociateWaitCompletionPacket( wait->u.wait.packet, bucket->port, wait->u.wait.handle,
+                                              wait, NULL, STATUS_SUCCESS, 0, NULL );
+    if (status)
+    {
+        WARN( "failed to wait for handle %p, status %#lx.\n", wait->u.wait.handle, status );
+        tp_object_release( wait );
+        return;
+    }
+    wait->u.wait.associated = TRUE;
+}
+
+/***********************************************************************
+ *           tp_waitqueue_cancel    (internal)
+ *
+ * Stops waiting for the object handle. If the packet has already been
+ * removed from the port, the wait queue thread ignores it and releases
+ * the reference.
+ */
+static void tp_waitqueue_cancel( struct threadpool_object *wait )
+{
+    if (!wait->u.wait.associated) return;
+
+    wait->u.wait.associated = FALSE;
+    if (!NtCancelWaitCompletionPacket( wait->u.wait.packet, TRUE ))
+        tp_object_release( wait );
+}
+
 /***********************************************************************
  *           waitqueue_thread_proc    (internal)
  */
 static void CALLBACK waitqueue_thread_proc( void *param )
 {
-    struct threadpool_object *objects[MAXIMUM_WAITQUEUE_OBJECTS];
-    LONG update_serials[MAXIMUM_WAITQUEUE_OBJECTS];
-    HANDLE handles[MAXIMUM_WAITQUEUE_OBJECTS + 1];
+    FILE_IO_COMPLETION_INFORMATION info[MAXIMUM_WAITQUEUE_PACKETS];
     struct waitqueue_bucket *bucket = param;
     struct threadpool_object *wait, *next;
     LARGE_INTEGER now, timeout;
-    DWORD num_handles;
+    ULONG i, count;
     NTSTATUS status;
 
     TRACE( "starting wait queue thread\n" );
@@ -1261,7 +1317,6 @@ static void CALLBACK waitqueue_thread_proc( void *param )
     {
         NtQuerySystemTime( &now );
         timeout.QuadPart = MAXLONGLONG;
-        num_handles = 0;
 
         LIST_FOR_EACH_ENTRY_SAFE( wait, next, &bucket->waiting, struct threadpool_object,
                                   u.wait.wait_entry )
@@ -1271,6 +1326,7 @@ static void CALLBACK waitqueue_thread_proc( void *param )
             if (wait->u.wait.timeout <= now.QuadPart)
             {
                 /* Wait object timed out. */
+                tp_waitqueue_cancel( wait );
                 if ((wait->u.wait.flags & WT_EXECUTEONLYONCE))
                 {
                     list_remove( &wait->u.wait.wait_entry );
@@ -1281,9 +1337,9 @@ static void CALLBACK waitqueue_thread_proc( void *param )
                 {
                     InterlockedIncrement( &wait->refcount );
                     wait->num_pending_callbacks++;
-                    RtlEnterCriticalSection( &wait->pool->cs );
+                    RtlEnterCriticalSection( &wait->queue->cs );
                     tp_object_execute( wait, TRUE );
-                    RtlLeaveCriticalSection( &wait->pool->cs );
+                    RtlLeaveCriticalSection( &wait->queue->cs );
                     tp_object_release( wait );
                 }
                 else tp_object_submit( wait, FALSE );
@@ -1293,12 +1349,8 @@ static void CALLBACK waitqueue_thread_proc( void *param )
                 if (wait->u.wait.timeout < timeout.QuadPart)
                     timeout.QuadPart = wait->u.wait.timeout;
 
-                assert( num_handles < MAXIMUM_WAITQUEUE_OBJECTS );
-                InterlockedIncrement( &wait->refcount );
-                objects[num_handles] = wait;
-                handles[num_handles] = wait->u.wait.handle;
-                update_serials[num_handles] = wait->update_serial;
-                num_handles++;
+                if (!wait->u.wait.associated)
+                    tp_waitqueue_associate( bucket, wait );
             }
         }
 
@@ -1306,100 +1358,56 @@ static void CALLBACK waitqueue_thread_proc( void *param )
         {
             /* All wait objects have been destroyed, if no new wait objects are created
              * within some amount of time, then we can shutdown this thread. */
-            assert( num_handles == 0 );
-            RtlLeaveCriticalSection( &waitqueue.cs );
+            assert( list_empty( &bucket->waiting ) );
             timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
-            status = NtWaitForMultipleObjects( 1, &bucket->update_event, TRUE, bucket->alertable, &timeout );
-            RtlEnterCriticalSection( &waitqueue.cs );
-
-            if (status == STATUS_TIMEOUT && !bucket->objcount)
-                break;
         }
-        else
+
+        RtlLeaveCriticalSection( &waitqueue.cs );
+        status = NtRemoveIoCompletionEx( bucket->port, info, ARRAY_SIZE(info), &count,
+                                         &timeout, bucket->alertable );
+        RtlEnterCriticalSection( &waitqueue.cs );
+
+        if (status == STATUS_TIMEOUT && !bucket->objcount)
+            break;
+        if (status != STATUS_SUCCESS)
+            continue;
+
+        for (i = 0; i < count; i++)
         {
-            handles[num_handles] = bucket->update_event;
-            RtlLeaveCriticalSection( &waitqueue.cs );
-            status = NtWaitForMultipleObjects( num_handles + 1, handles, TRUE, bucket->alertable, &timeout );
-            RtlEnterCriticalSection( &waitqueue.cs );
+            /* Packets without a key only wake up the thread. */
+            if (!(wait = (struct threadpool_object *)info[i].CompletionKey))
+                continue;
 
-            if (status >= STATUS_WAIT_0 && status < STATUS_WAIT_0 + num_handles)
+            assert( wait->type == TP_OBJECT_TYPE_WAIT );
+            if (wait->u.wait.associated)
             {
-                wait = objects[status - STATUS_WAIT_0];
-                assert( wait->type == TP_OBJECT_TYPE_WAIT );
-                if (wait->u.wait.bucket && wait->update_serial == update_serials[status - STATUS_WAIT_0])
+                /* Wait object signaled. */
+                assert( wait->u.wait.bucket == bucket );
+                wait->u.wait.associated = FALSE;
+                if ((wait->u.wait.flags & WT_EXECUTEONLYONCE))
                 {
-                    /* Wait object signaled. */
-                    assert( wait->u.wait.bucket == bucket );
-                    if ((wait->u.wait.flags & WT_EXECUTEONLYONCE))
-                    {
-                        list_remove( &wait->u.wait.wait_entry );
-                        list_add_tail( &bucket->reserved, &wait->u.wait.wait_entry );
-                        wait->u.wait.wait_pending = FALSE;
-                    }
-                    if ((wait->u.wait.flags & (WT_EXECUTEINWAITTHREAD | WT_EXECUTEINIOTHREAD)))
-                    {
-                        wait->u.wait.signaled++;
-                        wait->num_pending_callbacks++;
-                        RtlEnterCriticalSection( &wait->pool->cs );
-                        tp_object_execute( wait, TRUE );
-                        RtlLeaveCriticalSection( &wait->pool->cs );
-                    }
-                    else tp_object_submit( wait, TRUE );
+                    list_remove( &wait->u.wait.wait_entry );
+                    list_add_tail( &bucket->reserved, &wait->u.wait.wait_entry );
+                    wait->u.wait.wait_pending = FALSE;
                 }
-                else
+                if ((wait->u.wait.flags & (WT_EXECUTEINWAITTHREAD | WT_EXECUTEINIOTHREAD)))
                 {
-                    WARN("wait object %p triggered while object was %s.\n",
-                            wait, wait->u.wait.bucket ? "updated" : "destroyed");
+                    wait->u.wait.signaled++;
+                    wait->num_pending_callbacks++;
+                    RtlEnterCriticalSection( &wait->queue->cs );
+                    tp_object_execute( wait, TRUE );
+                    RtlLeaveCriticalSection( &wait->queue->cs );
                 }
+                else tp_object_submit( wait, TRUE );
             }
-
-            /* Release temporary references to wait objects. */
-            while (num_handles)
+            else
             {
-                wait = objects[--num_handles];
-                assert( wait->type == TP_OBJECT_TYPE_WAIT );
-                tp_object_release( wait );
+                WARN("wait object %p triggered while object was %s.\n",
+                        wait, wait->u.wait.bucket ? "updated" : "destroyed");
             }
-        }
 
-        /* Try to merge bucket with other threads. */
-        if (waitqueue.num_buckets > 1 && bucket->objcount &&
-            bucket->objcount <= MAXIMUM_WAITQUEUE_OBJECTS * 1 / 3)
-        {
-            struct waitqueue_bucket *other_bucket;
-            LIST_FOR_EACH_ENTRY( other_bucket, &waitqueue.buckets, struct waitqueue_bucket, bucket_entry )
-            {
-                if (other_bucket != bucket && other_bucket->objcount && other_bucket->alertable == bucket->alertable &&
-                    other_bucket->objcount + bucket->objcount <= MAXIMUM_WAITQUEUE_OBJECTS * 2 / 3)
-                {
-                    other_bucket->objcount += bucket->objcount;
-                    bucket->objcount = 0;
-
-                    /* Update reserved list. */
-                    LIST_FOR_EACH_ENTRY( wait, &bucket->reserved, struct threadpool_object, u.wait.wait_entry )
-                    {
-                        assert( wait->type == TP_OBJECT_TYPE_WAIT );
-                        wait->u.wait.bucket = other_bucket;
-                    }
-                    list_move_tail( &other_bucket->reserved, &bucket->reserved );
-
-                    /* Update waiting list. */
-                    LIST_FOR_EACH_ENTRY( wait, &bucket->waiting, struct threadpool_object, u.wait.wait_entry )
-                    {
-                        assert( wait->type == TP_OBJECT_TYPE_WAIT );
-                        wait->u.wait.bucket = other_bucket;
-                    }
-                    list_move_tail( &other_bucket->waiting, &bucket->waiting );
-
-                    /* Move bucket to the end, to keep the probability of
-                     * newly added wait objects as small as possible. */
-                    list_remove( &bucket->bucket_entry );
-                    list_add_tail( &waitqueue.buckets, &bucket->bucket_entry );
-
-                    NtSetEvent( other_bucket->update_event, NULL );
-                    break;
-                }
-            }
+            /* Release the reference held by the packet. */
+            tp_object_release( wait );
         }
     }
 
@@ -1415,7 +1423,7 @@ static void CALLBACK waitqueue_thread_proc( void *param )
     assert( bucket->objcount == 0 );
     assert( list_empty( &bucket->reserved ) );
     assert( list_empty( &bucket->waiting ) );
-    NtClose( bucket->update_event );
+    NtClose( bucket->port );
 
     RtlFreeHeap( GetProcessHeap(), 0, bucket );
     RtlExitUserThread( 0 );
@@ -1435,15 +1443,20 @@ static NTSTATUS tp_waitqueue_lock( struct threadpool_object *wait )
     wait->u.wait.signaled       = 0;
     wait->u.wait.bucket         = NULL;
     wait->u.wait.wait_pending   = FALSE;
+    wait->u.wait.associated     = FALSE;
     wait->u.wait.timeout        = 0;
     wait->u.wait.handle         = INVALID_HANDLE_VALUE;
 
+    status = NtCreateWaitCompletionPacket( &wait->u.wait.packet, GENERIC_ALL, NULL );
+    if (status)
+        return status;
+
     RtlEnterCriticalSection( &waitqueue.cs );
 
     /* Try to assign to existing bucket if possible. */
     LIST_FOR_EACH_ENTRY( bucket, &waitqueue.buckets, struct waitqueue_bucket, bucket_entry )
     {
-        if (bucket->objcount < MAXIMUM_WAITQUEUE_OBJECTS && bucket->alertable == alertable)
+        if (bucket->alertable == alertable)
         {
             list_add_tail( &bucket->reserved, &wait->u.wait.wait_entry );
             wait->u.wait.bucket = bucket;
@@ -1467,8 +1480,7 @@ static NTSTATUS tp_waitqueue_lock( struct threadpool_object *wait )
     list_init( &bucket->reserved );
     list_init( &bucket->waiting );
 
-    status = NtCreateEvent( &bucket->update_event, EVENT_ALL_ACCESS,
-                            NULL, SynchronizationEvent, FALSE );
+    status = NtCreateIoCompletion( &bucket->port, IO_COMPLETION_ALL_ACCESS, NULL, 1 );
     if (status)
     {
         RtlFreeHeap( GetProcessHeap(), 0, bucket );
@@ -1490,12 +1502,13 @@ static NTSTATUS tp_waitqueue_lock( struct threadpool_object *wait )
     }
     else
     {
-        NtClose( bucket->update_event );
+        NtClose( bucket->port );
         RtlFreeHeap( GetProcessHeap(), 0, bucket );
     }
 
 out:
     RtlLeaveCriticalSection( &waitqueue.cs );
+    if (status) NtClose( wait->u.wait.packet );
     return status;
 }
 
@@ -1512,11 +1525,14 @@ static void tp_waitqueue_unlock( struct threadpool_object *wait )
         struct waitqueue_bucket *bucket = wait->u.wait.bucket;
         assert( bucket->objcount > 0 );
 
+        tp_waitqueue_cancel( wait );
+        NtClose( wait->u.wait.packet );
+
         list_remove( &wait->u.wait.wait_entry );
         wait->u.wait.bucket = NULL;
         bucket->objcount--;
 
-        NtSetEvent( bucket->update_event, NULL );
+        NtSetIoCompletion( bucket->port, 0, 0, STATUS_SUCCESS, 0 );
     }
     RtlLeaveCriticalSection( &waitqueue.cs );
 }
@@ -1549,7 +1565,7 @@ static void CALLBACK ioqueue_thread_proc( void *param )
 
         if (io && (io->shutdown || io->u.io.shutting_down))
         {
-            RtlEnterCriticalSection( &io->pool->cs );
+            RtlEnterCriticalSection( &io->queue->cs );
             if (!io->u.io.pending_count)
             {
                 if (io->u.io.skipped_count)
@@ -1560,7 +1576,7 @@ static void CALLBACK ioqueue_thread_proc( void *param )
                 else
                     destroy = TRUE;
             }
-            RtlLeaveCriticalSection( &io->pool->cs );
+            RtlLeaveCriticalSection( &io->queue->cs );
             if (skip) continue;
         }
 
@@ -1573,7 +1589,7 @@ static void CALLBACK ioqueue_thread_proc( void *param )
         }
         else if (io)
         {
-            RtlEnterCriticalSection( &io->pool->cs );
+            RtlEnterCriticalSection( &io->queue->cs );
 
             TRACE( "pending_count %u.\n", io->u.io.pending_count );
 
@@ -1584,7 +1600,7 @@ static void CALLBACK ioqueue_thread_proc( void *param )
                         io->u.io.completion_count + 1, sizeof(*io->u.io.completions)))
                 {
                     ERR( "Failed to allocate memory.\n" );
-                    RtlLeaveCriticalSection( &io->pool->cs );
+                    RtlLeaveCriticalSection( &io->queue->cs );
                     continue;
                 }
 
@@ -1594,7 +1610,7 @@ static void CALLBACK ioqueue_thread_proc( void *param )
 
                 tp_object_submit( io, FALSE );
             }
-            RtlLeaveCriticalSection( &io->pool->cs );
+            RtlLeaveCriticalSection( &io->queue->cs );
         }
 
         if (!ioqueue.objcount)
@@ -1673,10 +1689,11 @@ static NTSTATUS tp_ioqueue_lock( struct threadpool_object *io, HANDLE file )
 static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
 {
     IMAGE_NT_HEADERS *nt = RtlImageNtHeader( NtCurrentTeb()->Peb->ImageBaseAddress );
+    unsigned int i, j, num_queues;
     struct threadpool *pool;
-    unsigned int i;
 
-    pool = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*pool) );
+    num_queues = min( max( NtCurrentTeb()->Peb->NumberOfProcessors, 1 ), THREADPOOL_MAX_QUEUES );
+    pool = RtlAllocateHeap( GetProcessHeap(), 0, offsetof( struct threadpool, queues[num_queues] ) );
     if (!pool)
         return STATUS_NO_MEMORY;
 
@@ -1687,14 +1704,26 @@ static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
     RtlInitializeCriticalSectionEx( &pool->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
     pool->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": threadpool.cs");
 
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
-        list_init( &pool->pools[i] );
     RtlInitializeConditionVariable( &pool->update_event );
 
     pool->max_workers             = 500;
     pool->min_workers             = 0;
     pool->num_workers             = 0;
     pool->num_busy_workers        = 0;
+    pool->num_idle_workers        = 0;
+    pool->next_queue              = 0;
+    pool->num_queues              = num_queues;
+    for (i = 0; i < num_queues; ++i)
+    {
+        struct threadpool_queue *queue = &pool->queues[i];
+
+        RtlInitializeCriticalSectionEx( &queue->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
+        queue->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": threadpool_queue.cs");
+        for (j = 0; j < ARRAY_SIZE(queue->pools); ++j)
+            list_init( &queue->pools[j] );
+    }
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
+        pool->num_queued[i] = 0;
     pool->stack_info.StackReserve = nt->OptionalHeader.SizeOfStackReserve;
     pool->stack_info.StackCommit  = nt->OptionalHeader.SizeOfStackCommit;
 
@@ -1735,8 +1764,16 @@ static BOOL tp_threadpool_release( struct threadpool *pool )
 
     assert( pool->shutdown );
     assert( !pool->objcount );
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
-        assert( list_empty( &pool->pools[i] ) );
+    for (i = 0; i < pool->num_queues; ++i)
+    {
+        struct threadpool_queue *queue = &pool->queues[i];
+        unsigned int j;
+
+        for (j = 0; j < ARRAY_SIZE(queue->pools); ++j)
+            assert( list_empty( &queue->pools[j] ) );
+        queue->cs.DebugInfo->Spare[0] = 0;
+        RtlDeleteCriticalSection( &queue->cs );
+    }
 
     pool->cs.DebugInfo->Spare[0] = 0;
     RtlDeleteCriticalSection( &pool->cs );
@@ -1905,6 +1942,7 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
     object->shutdown                = FALSE;
 
     object->pool                    = pool;
+    object->queue                   = &pool->queues[(ULONG)InterlockedIncrement( &pool->next_queue ) % pool->num_queues];
     object->group                   = NULL;
     object->userdata                = userdata;
     object->group_cancel_callback   = NULL;
@@ -1923,7 +1961,6 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
     object->num_pending_callbacks   = 0;
     object->num_running_callbacks   = 0;
     object->num_associated_callbacks = 0;
-    object->update_serial           = 0;
 
     if (environment)
     {
@@ -1940,7 +1977,7 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
             TP_CALLBACK_ENVIRON_V3 *environment_v3 = (TP_CALLBACK_ENVIRON_V3 *)environment;
 
             object->priority = environment_v3->CallbackPriority;
-            assert( object->priority < ARRAY_SIZE(pool->pools) );
+            assert( object->priority < ARRAY_SIZE(pool->num_queued) );
         }
 
         if (environment->ActivationContext)
@@ -1977,10 +2014,58 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
         tp_object_release( object );
 }
 
+/* object->queue->cs has to be held */
 static void tp_object_prio_queue( struct threadpool_object *object )
 {
-    ++object->pool->num_busy_workers;
-    list_add_tail( &object->pool->pools[object->priority], &object->pool_entry );
+    InterlockedIncrement( &object->pool->num_busy_workers );
+    list_add_tail( &object->queue->pools[object->priority], &object->pool_entry );
+    InterlockedIncrement( &object->pool->num_queued[object->priority] );
+}
+
+/* object->queue->cs has to be held */
+static void tp_object_prio_dequeue( struct threadpool_object *object )
+{
+    list_remove( &object->pool_entry );
+    InterlockedDecrement( &object->pool->num_queued[object->priority] );
+}
+
+static BOOL threadpool_has_queued_items( struct threadpool *pool )
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
+        if (ReadNoFence( &pool->num_queued[i] )) return TRUE;
+    return FALSE;
+}
+
+/***********************************************************************
+ *           tp_threadpool_wake    (internal)
+ *
+ * Starts a new worker thread if all of them are busy, or wakes up an idle
+ * one to process a newly queued item.
+ */
+static void tp_threadpool_wake( struct threadpool *pool )
+{
+    NTSTATUS status = STATUS_UNSUCCESSFUL;
+
+    if (ReadNoFence( &pool->num_busy_workers ) >= pool->num_workers)
+    {
+        RtlEnterCriticalSection( &pool->cs );
+        if (pool->num_busy_workers >= pool->num_workers &&
+            pool->num_workers < pool->max_workers)
+            status = tp_new_worker_thread( pool );
+        RtlLeaveCriticalSection( &pool->cs );
+    }
+
+    /* Workers increment num_idle_workers before checking the queues for the
+     * last time, and the item has been queued with an interlocked operation,
+     * so either they see the item or we see them. */
+    if (status != STATUS_SUCCESS && ReadAcquire( &pool->num_idle_workers ))
+    {
+        RtlEnterCriticalSection( &pool->cs );
+        RtlWakeConditionVariable( &pool->update_event );
+        RtlLeaveCriticalSection( &pool->cs );
+    }
 }
 
 /***********************************************************************
@@ -1992,17 +2077,12 @@ static void tp_object_prio_queue( struct threadpool_object *object )
 static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
 {
     struct threadpool *pool = object->pool;
-    NTSTATUS status = STATUS_UNSUCCESSFUL;
+    struct threadpool_queue *queue = object->queue;
 
     assert( !object->shutdown );
     assert( !pool->shutdown );
 
-    RtlEnterCriticalSection( &pool->cs );
-
-    /* Start new worker threads if required. */
-    if (pool->num_busy_workers >= pool->num_workers &&
-        pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    RtlEnterCriticalSection( &queue->cs );
 
     /* Queue work item and increment refcount. */
     InterlockedIncrement( &object->refcount );
@@ -2013,14 +2093,9 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
-    {
-        assert( pool->num_workers > 0 );
-        RtlWakeConditionVariable( &pool->update_event );
-    }
+    RtlLeaveCriticalSection( &queue->cs );
 
-    RtlLeaveCriticalSection( &pool->cs );
+    tp_threadpool_wake( pool );
 }
 
 /***********************************************************************
@@ -2030,15 +2105,15 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
  */
 static void tp_object_cancel( struct threadpool_object *object )
 {
-    struct threadpool *pool = object->pool;
+    struct threadpool_queue *queue = object->queue;
     LONG pending_callbacks = 0;
 
-    RtlEnterCriticalSection( &pool->cs );
+    RtlEnterCriticalSection( &queue->cs );
     if (object->num_pending_callbacks)
     {
         pending_callbacks = object->num_pending_callbacks;
         object->num_pending_callbacks = 0;
-        list_remove( &object->pool_entry );
+        tp_object_prio_dequeue( object );
 
         if (object->type == TP_OBJECT_TYPE_WAIT)
             object->u.wait.signaled = 0;
@@ -2048,7 +2123,7 @@ static void tp_object_cancel( struct threadpool_object *object )
         object->u.io.skipped_count += object->u.io.pending_count;
         object->u.io.pending_count = 0;
     }
-    RtlLeaveCriticalSection( &pool->cs );
+    RtlLeaveCriticalSection( &queue->cs );
 
     while (pending_callbacks--)
         tp_object_release( object );
@@ -2075,17 +2150,17 @@ static BOOL object_is_finished( struct threadpool_object *object, BOOL group )
  */
 static void tp_object_wait( struct threadpool_object *object, BOOL group_wait )
 {
-    struct threadpool *pool = object->pool;
+    struct threadpool_queue *queue = object->queue;
 
-    RtlEnterCriticalSection( &pool->cs );
+    RtlEnterCriticalSection( &queue->cs );
     while (!object_is_finished( object, group_wait ))
     {
         if (group_wait)
-            RtlSleepConditionVariableCS( &object->group_finished_event, &pool->cs, NULL );
+            RtlSleepConditionVariableCS( &object->group_finished_event, &queue->cs, NULL );
         else
-            RtlSleepConditionVariableCS( &object->finished_event, &pool->cs, NULL );
+            RtlSleepConditionVariableCS( &object->finished_event, &queue->cs, NULL );
     }
-    RtlLeaveCriticalSection( &pool->cs );
+    RtlLeaveCriticalSection( &queue->cs );
 }
 
 static void tp_ioqueue_unlock( struct threadpool_object *io )
@@ -2162,24 +2237,45 @@ static BOOL tp_object_release( struct threadpool_object *object )
     return TRUE;
 }
 
-static struct list *threadpool_get_next_item( const struct threadpool *pool )
+/***********************************************************************
+ *           threadpool_get_next_item    (internal)
+ *
+ * Returns the next object to execute, with the critical section of its
+ * queue held. Queues are scanned starting from *index, which is updated to
+ * the queue where the object was found, so that a worker picks up items
+ * from its last queue first and steals from the other ones when it is empty.
+ */
+static struct threadpool_object *threadpool_get_next_item( struct threadpool *pool, unsigned int *index )
 {
+    struct threadpool_queue *queue;
+    unsigned int i, j, k;
     struct list *ptr;
-    unsigned int i;
 
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
     {
-        if ((ptr = list_head( &pool->pools[i] )))
-            break;
+        if (!ReadNoFence( &pool->num_queued[i] )) continue;
+
+        for (j = 0; j < pool->num_queues; ++j)
+        {
+            k = (*index + j) % pool->num_queues;
+            queue = &pool->queues[k];
+            RtlEnterCriticalSection( &queue->cs );
+            if ((ptr = list_head( &queue->pools[i] )))
+            {
+                *index = k;
+                return LIST_ENTRY( ptr, struct threadpool_object, pool_entry );
+            }
+            RtlLeaveCriticalSection( &queue->cs );
+        }
     }
 
-    return ptr;
+    return NULL;
 }
 
 /***********************************************************************
  *           tp_object_execute    (internal)
  *
- * Executes a threadpool object callback, object->pool->cs has to be
+ * Executes a threadpool object callback, object->queue->cs has to be
  * held.
  */
 static void tp_object_execute( struct threadpool_object *object, BOOL wait_thread )
@@ -2187,7 +2283,7 @@ static void tp_object_execute( struct threadpool_object *object, BOOL wait_threa
     TP_CALLBACK_INSTANCE *callback_instance;
     struct threadpool_instance instance;
     struct io_completion completion;
-    struct threadpool *pool = object->pool;
+    struct threadpool_queue *queue = object->queue;
     TP_WAIT_RESULT wait_result = 0;
     NTSTATUS status;
 
@@ -2208,7 +2304,7 @@ static void tp_object_execute( struct threadpool_object *object, BOOL wait_threa
     /* Leave critical section and do the actual callback. */
     object->num_associated_callbacks++;
     object->num_running_callbacks++;
-    RtlLeaveCriticalSection( &pool->cs );
+    RtlLeaveCriticalSection( &queue->cs );
     if (wait_thread) RtlLeaveCriticalSection( &waitqueue.cs );
 
     /* Initialize threadpool instance struct. */
@@ -2314,7 +2410,7 @@ static void tp_object_execute( struct threadpool_object *object, BOOL wait_threa
 
 skip_cleanup:
     if (wait_thread) RtlEnterCriticalSection( &waitqueue.cs );
-    RtlEnterCriticalSection( &pool->cs );
+    RtlEnterCriticalSection( &queue->cs );
 
     /* Simple callbacks are automatically shutdown after execution. */
     if (object->type == TP_OBJECT_TYPE_SIMPLE)
@@ -2341,50 +2437,70 @@ skip_cleanup:
 static void CALLBACK threadpool_worker_proc( void *param )
 {
     struct threadpool *pool = param;
+    struct threadpool_object *object;
+    unsigned int index = InterlockedIncrement( &pool->next_queue );
     LARGE_INTEGER timeout;
-    struct list *ptr;
+    NTSTATUS status;
 
     TRACE( "starting worker thread for pool %p\n", pool );
     set_thread_name(L"wine_threadpool_worker");
 
-    RtlEnterCriticalSection( &pool->cs );
     for (;;)
     {
-        while ((ptr = threadpool_get_next_item( pool )))
+        while ((object = threadpool_get_next_item( pool, &index )))
         {
-            struct threadpool_object *object = LIST_ENTRY( ptr, struct threadpool_object, pool_entry );
+            struct threadpool_queue *queue = object->queue;
             assert( object->num_pending_callbacks > 0 );
 
             /* If further pending callbacks are queued, move the work item to
              * the end of the pool list. Otherwise remove it from the pool. */
-            list_remove( &object->pool_entry );
+            tp_object_prio_dequeue( object );
             if (object->num_pending_callbacks > 1)
                 tp_object_prio_queue( object );
 
             tp_object_execute( object, FALSE );
+            RtlLeaveCriticalSection( &queue->cs );
+
+            /* Continue with the next queue, so that objects on different
+             * queues are executed in turn. */
+            index++;
 
             assert(pool->num_busy_workers);
-            pool->num_busy_workers--;
+            InterlockedDecrement( &pool->num_busy_workers );
 
             tp_object_release( object );
         }
 
+        RtlEnterCriticalSection( &pool->cs );
+
         /* Shutdown worker thread if requested. */
         if (pool->shutdown)
             break;
 
+        /* Check the queues again after announcing that we are idle, items
+         * submitted after that will wake us up. */
+        InterlockedIncrement( &pool->num_idle_workers );
+        if (threadpool_has_queued_items( pool ))
+        {
+            InterlockedDecrement( &pool->num_idle_workers );
+            RtlLeaveCriticalSection( &pool->cs );
+            continue;
+        }
+
         /* Wait for new tasks or until the timeout expires. A thread only terminates
          * when no new tasks are available, and the number of threads can be
          * decreased without violating the min_workers limit. An exception is when
          * min_workers == 0, then objcount is used to detect if the last thread
          * can be terminated. */
         timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
-        if (RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout ) == STATUS_TIMEOUT &&
-            !threadpool_get_next_item( pool ) && (pool->num_workers > max( pool->min_workers, 1 ) ||
-            (!pool->min_workers && !pool->objcount)))
+        status = RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout );
+        InterlockedDecrement( &pool->num_idle_workers );
+        if (status == STATUS_TIMEOUT && !threadpool_has_queued_items( pool ) &&
+            (pool->num_workers > max( pool->min_workers, 1 ) || (!pool->min_workers && !pool->objcount)))
         {
             break;
         }
+        RtlLeaveCriticalSection( &pool->cs );
     }
     pool->num_workers--;
     RtlLeaveCriticalSection( &pool->cs );
@@ -2587,7 +2703,7 @@ void WINAPI TpCancelAsyncIoOperation( TP_IO *io )
 
     TRACE( "%p\n", io );
 
-    RtlEnterCriticalSection( &this->pool->cs );
+    RtlEnterCriticalSection( &this->queue->cs );
 
     TRACE("pending_count %u.\n", this->u.io.pending_count);
 
@@ -2597,7 +2713,7 @@ void WINAPI TpCancelAsyncIoOperation( TP_IO *io )
     if (object_is_finished( this, FALSE ))
         RtlWakeAllConditionVariable( &this->finished_event );
 
-    RtlLeaveCriticalSection( &this->pool->cs );
+    RtlLeaveCriticalSection( &this->queue->cs );
 }
 
 /***********************************************************************
@@ -2717,7 +2833,6 @@ VOID WINAPI TpDisassociateCallback( TP_CALLBACK_INSTANCE *instance )
 {
     struct threadpool_instance *this = impl_from_TP_CALLBACK_INSTANCE( instance );
     struct threadpool_object *object = this->object;
-    struct threadpool *pool;
 
     TRACE( "%p\n", instance );
 
@@ -2730,14 +2845,13 @@ VOID WINAPI TpDisassociateCallback( TP_CALLBACK_INSTANCE *instance )
     if (!this->associated)
         return;
 
-    pool = object->pool;
-    RtlEnterCriticalSection( &pool->cs );
+    RtlEnterCriticalSection( &object->queue->cs );
 
     object->num_associated_callbacks--;
     if (object_is_finished( object, FALSE ))
         RtlWakeAllConditionVariable( &object->finished_event );
 
-    RtlLeaveCriticalSection( &pool->cs );
+    RtlLeaveCriticalSection( &object->queue->cs );
     this->associated = FALSE;
 }
 
@@ -2861,10 +2975,10 @@ void WINAPI TpReleaseIoCompletion( TP_IO *io )
 
     TRACE( "%p\n", io );
 
-    RtlEnterCriticalSection( &this->pool->cs );
+    RtlEnterCriticalSection( &this->queue->cs );
     this->u.io.shutting_down = TRUE;
     can_destroy = !this->u.io.pending_count && !this->u.io.skipped_count;
-    RtlLeaveCriticalSection( &this->pool->cs );
+    RtlLeaveCriticalSection( &this->queue->cs );
 
     if (can_destroy)
     {
@@ -3074,6 +3188,10 @@ VOID WINAPI TpSetWait( TP_WAIT *wait, HANDLE handle, LARGE_INTEGER *timeout )
         struct waitqueue_bucket *bucket = this->u.wait.bucket;
         list_remove( &this->u.wait.wait_entry );
 
+        /* Keep waiting for the same handle, so that a signal isn't lost. */
+        if (!handle || !same_handle)
+            tp_waitqueue_cancel( this );
+
         /* Convert relative timeout to absolute timestamp. */
         if (handle && timeout)
         {
@@ -3100,9 +3218,7 @@ VOID WINAPI TpSetWait( TP_WAIT *wait, HANDLE handle, LARGE_INTEGER *timeout )
         }
 
         /* Wake up the wait queue thread. */
-        if (!same_handle)
-            ++this->update_serial;
-        NtSetEvent( bucket->update_event, NULL );
+        NtSetIoCompletion( bucket->port, 0, 0, STATUS_SUCCESS, 0 );
     }
 
     RtlLeaveCriticalSection( &waitqueue.cs );
@@ -3147,11 +3263,11 @@ void WINAPI TpStartAsyncIoOperation( TP_IO *io )
 
     TRACE( "%p\n", io );
 
-    RtlEnterCriticalSection( &this->pool->cs );
+    RtlEnterCriticalSection( &this->queue->cs );
 
     this->u.io.pending_count++;
 
-    RtlLeaveCriticalSection( &this->pool->cs );
+    RtlLeaveCriticalSection( &this->queue->cs );
 }
 
 /***********************************************************************
@@ -3343,11 +3459,11 @@ NTSTATUS WINAPI RtlDeregisterWaitEx( HANDLE handle, HANDLE event )
         object->completed_event = event;
     }
 
-    RtlEnterCriticalSection( &object->pool->cs );
+    RtlEnterCriticalSection( &object->queue->cs );
     if (object->num_pending_callbacks + object->num_running_callbacks
         + object->num_associated_callbacks) status = STATUS_PENDING;
     else status = STATUS_SUCCESS;
-    RtlLeaveCriticalSection( &object->pool->cs );
+    RtlLeaveCriticalSection( &object->queue->cs );
 
     TpReleaseWait( (TP_WAIT *)object );
     return status;
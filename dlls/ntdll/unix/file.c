@@ -52,6 +52,9 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/ioctl.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef HAVE_SYS_ATTR_H
 #include <sys/attr.h>
 #endif
@@ -81,6 +84,10 @@
 #ifdef HAVE_LINUX_IOCTL_H
 #include <linux/ioctl.h>
 #endif
+#ifdef HAVE_LINUX_IO_URING_H
+# include <sys/mman.h>
+# include <linux/io_uring.h>
+#endif
 #ifdef HAVE_LINUX_MAJOR_H
 # include <linux/major.h>
 #endif
@@ -160,6 +167,18 @@ typedef struct
 #define AT_NO_AUTOMOUNT 0x800
 #endif
 
+/* Define the reflink ioctl */
+#ifndef FICLONERANGE
+struct file_clone_range
+{
+    int64_t  src_fd;
+    uint64_t src_offset;
+    uint64_t src_length;
+    uint64_t dest_offset;
+};
+#define FICLONERANGE _IOW(0x94, 13, struct file_clone_range)
+#endif
+
 #endif  /* linux */
 
 #define IS_SEPARATOR(ch)   ((ch) == '\\' || (ch) == '/')
@@ -235,6 +254,19 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* process-wide cache of the full sorted contents of recently listed directories */
+struct dir_snapshot
+{
+    struct list             entry;   /* entry in the LRU list */
+    ULONGLONG               mtime;   /* directory modification time at the time of the scan */
+    struct dir_data        *data;    /* unfiltered directory contents */
+};
+
+#define DIR_SNAPSHOT_CACHE_SIZE 16
+
+static struct list dir_snapshot_cache = LIST_INIT( dir_snapshot_cache );
+static unsigned int dir_snapshot_count;
+
 static BOOL show_dot_files;
 static mode_t start_umask;
 
@@ -280,6 +312,17 @@ static inline BOOL is_same_file( const struct file_identity *file, const struct
     return st->st_dev == file->dev && st->st_ino == file->ino;
 }
 
+static ULONGLONG get_stat_mtime( const struct stat *st )
+{
+    ULONGLONG ret = (ULONGLONG)st->st_mtime * 1000000000;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    ret += st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    ret += st->st_mtimespec.tv_nsec;
+#endif
+    return ret;
+}
+
 static inline BOOL is_ignored_file( const struct stat *st )
 {
     unsigned int i;
@@ -2592,15 +2635,126 @@ done:
 }
 
 
+/* compare file names for directory sorting */
+static int name_compare( const void *a, const void *b )
+{
+    const struct dir_data_names *file_a = (const struct dir_data_names *)a;
+    const struct dir_data_names *file_b = (const struct dir_data_names *)b;
+    int ret = wcsicmp( file_a->long_name, file_b->long_name );
+    if (!ret) ret = wcscmp( file_a->long_name, file_b->long_name );
+    return ret;
+}
+
+
+/* sort filenames, but not "." and ".." */
+static void sort_dir_data( struct dir_data *data )
+{
+    unsigned int i = 0;
+
+    if (i < data->count && !strcmp( data->names[i].unix_name, "." )) i++;
+    if (i < data->count && !strcmp( data->names[i].unix_name, ".." )) i++;
+    if (i < data->count) qsort( data->names + i, data->count - i, sizeof(*data->names), name_compare );
+}
+
+
+/* copy the entries of a directory snapshot that match the mask, keeping them sorted */
+static NTSTATUS filter_dir_data( struct dir_data *data, const struct dir_data *all, const UNICODE_STRING *mask )
+{
+    unsigned int i;
+
+    for (i = 0; i < all->count; i++)
+    {
+        const struct dir_data_names *names = &all->names[i];
+
+        if (mask && !match_filename( names->long_name, wcslen( names->long_name ), mask ) &&
+            (!names->short_name[0] || !match_filename( names->short_name, wcslen( names->short_name ), mask )))
+            continue;
+        if (!add_dir_data_names( data, names->long_name, names->short_name, names->unix_name ))
+            return STATUS_NO_MEMORY;
+    }
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *           read_directory_data_snapshot
+ *
+ * Read a directory through the snapshot cache; helper for NtQueryDirectoryFile.
+ * The directory must be the current directory.
+ */
+static NTSTATUS read_directory_data_snapshot( struct dir_data *data, int fd, const UNICODE_STRING *mask )
+{
+    struct dir_snapshot *snapshot;
+    struct dir_data *all;
+    struct stat st;
+    time_t now = time( NULL );
+    NTSTATUS status;
+
+    if (fstat( fd, &st ) == -1) return STATUS_NOT_SUPPORTED;
+
+    LIST_FOR_EACH_ENTRY( snapshot, &dir_snapshot_cache, struct dir_snapshot, entry )
+    {
+        if (!is_same_file( &snapshot->data->id, &st )) continue;
+        if (snapshot->mtime == get_stat_mtime( &st ))
+        {
+            TRACE( "reusing snapshot of %u files\n", snapshot->data->count );
+            list_remove( &snapshot->entry );
+            list_add_head( &dir_snapshot_cache, &snapshot->entry );
+            return filter_dir_data( data, snapshot->data, mask );
+        }
+        list_remove( &snapshot->entry );
+        free_dir_data( snapshot->data );
+        free( snapshot );
+        dir_snapshot_count--;
+        break;
+    }
+
+    if (!(all = calloc( 1, sizeof(*all) ))) return STATUS_NO_MEMORY;
+    if ((status = read_directory_data_readdir( all, NULL )))
+    {
+        free_dir_data( all );
+        return status;
+    }
+    sort_dir_data( all );
+    all->id.dev = st.st_dev;
+    all->id.ino = st.st_ino;
+    status = filter_dir_data( data, all, mask );
+
+    /* changes within the timestamp granularity can't be detected, don't keep a recently modified directory */
+    if (status || now - st.st_mtime < 2 || !(snapshot = malloc( sizeof(*snapshot) )))
+    {
+        free_dir_data( all );
+        return status;
+    }
+    snapshot->data = all;
+    snapshot->mtime = get_stat_mtime( &st );
+
+    if (dir_snapshot_count == DIR_SNAPSHOT_CACHE_SIZE)
+    {
+        struct dir_snapshot *old = LIST_ENTRY( list_tail( &dir_snapshot_cache ), struct dir_snapshot, entry );
+        list_remove( &old->entry );
+        free_dir_data( old->data );
+        free( old );
+        dir_snapshot_count--;
+    }
+    list_add_head( &dir_snapshot_cache, &snapshot->entry );
+    dir_snapshot_count++;
+    return STATUS_SUCCESS;
+}
+
+
 /***********************************************************************
  *           read_directory_data
  *
  * Read the full contents of a directory, using one of the above helper functions.
+ * The names are returned already sorted if sorted is set.
  */
-static NTSTATUS read_directory_data( struct dir_data *data, int fd, const UNICODE_STRING *mask )
+static NTSTATUS read_directory_data( struct dir_data *data, int fd, const UNICODE_STRING *mask, BOOL *sorted )
 {
     NTSTATUS status;
 
+    *sorted = FALSE;
+
 #ifdef VFAT_IOCTL_READDIR_BOTH
     if (!(status = read_directory_data_vfat( data, fd, mask ))) return status;
 #endif
@@ -2621,21 +2775,15 @@ static NTSTATUS read_directory_data( struct dir_data *data, int fd, const UNICOD
         }
     }
 
+    if ((status = read_directory_data_snapshot( data, fd, mask )) != STATUS_NOT_SUPPORTED)
+    {
+        *sorted = !status;
+        return status;
+    }
     return read_directory_data_readdir( data, mask );
 }
 
 
-/* compare file names for directory sorting */
-static int name_compare( const void *a, const void *b )
-{
-    const struct dir_data_names *file_a = (const struct dir_data_names *)a;
-    const struct dir_data_names *file_b = (const struct dir_data_names *)b;
-    int ret = wcsicmp( file_a->long_name, file_b->long_name );
-    if (!ret) ret = wcscmp( file_a->long_name, file_b->long_name );
-    return ret;
-}
-
-
 /***********************************************************************
  *           init_cached_dir_data
  *
@@ -2647,10 +2795,11 @@ static NTSTATUS init_cached_dir_data( struct dir_data **data_ret, int fd, const
     struct stat st;
     NTSTATUS status;
     unsigned int i;
+    BOOL sorted;
 
     if (!(data = calloc( 1, sizeof(*data) ))) return STATUS_NO_MEMORY;
 
-    if ((status = read_directory_data( data, fd, mask )))
+    if ((status = read_directory_data( data, fd, mask, &sorted )))
     {
         free_dir_data( data );
         return status;
@@ -2667,11 +2816,7 @@ static NTSTATUS init_cached_dir_data( struct dir_data **data_ret, int fd, const
         memcpy(data->mask.Buffer, mask->Buffer, mask->Length);
     }
 
-    /* sort filenames, but not "." and ".." */
-    i = 0;
-    if (i < data->count && !strcmp( data->names[i].unix_name, "." )) i++;
-    if (i < data->count && !strcmp( data->names[i].unix_name, ".." )) i++;
-    if (i < data->count) qsort( data->names + i, data->count - i, sizeof(*data->names), name_compare );
+    if (!sorted) sort_dir_data( data );
 
     if (data->count)
     {
@@ -2870,6 +3015,251 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* case-insensitive index of the names of a directory, to avoid scanning it for every lookup */
+struct name_index_entry
+{
+    struct name_index_entry *next;            /* next entry in the long name hash bucket */
+    struct name_index_entry *short_next;      /* next entry in the short name hash bucket */
+    unsigned short           len;             /* length of the long name */
+    unsigned short           short_len;       /* length of the short name, 0 if the name is 8.3 */
+    WCHAR                    short_name[12];  /* short name for names that aren't 8.3 */
+    char                    *unix_name;       /* Unix file name in host encoding */
+    WCHAR                    name[1];         /* long file name in Unicode */
+};
+
+struct name_index
+{
+    struct list               entry;          /* entry in the LRU list */
+    dev_t                     dev;            /* directory device */
+    ino_t                     ino;            /* directory inode */
+    ULONGLONG                 mtime;          /* directory modification time at the time of the scan */
+    size_t                    size;           /* memory used by the index */
+    unsigned int              hash_size;      /* size of the hash tables, a power of 2 */
+    struct name_index_entry **buckets;        /* hash table of the long names */
+    struct name_index_entry **short_buckets;  /* hash table of the short names */
+};
+
+/* maximum memory used by all the cached indexes */
+#define NAME_INDEX_CACHE_SIZE (16 * 1024 * 1024)
+
+static struct list name_index_cache = LIST_INIT( name_index_cache );
+static size_t name_index_cache_size;
+static LONG name_index_hits, name_index_misses;
+static pthread_mutex_t name_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int hash_name_nocase( const WCHAR *name, int len )
+{
+    unsigned int hash = 0;
+    while (len--) hash = hash * 31 + towupper( *name++ );
+    return hash;
+}
+
+static void free_name_index( struct name_index *index )
+{
+    struct name_index_entry *entry, *next;
+    unsigned int i;
+
+    for (i = 0; i < index->hash_size; i++)
+    {
+        for (entry = index->buckets[i]; entry; entry = next)
+        {
+            next = entry->next;
+            free( entry );
+        }
+    }
+    free( index->buckets );
+    free( index );
+}
+
+/* read a whole directory into a new name index */
+static struct name_index *create_name_index( int root_fd, const char *dir_name, const struct stat *st )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    struct name_index_entry *entry, *list = NULL;
+    struct name_index *index;
+    unsigned int count = 0, hash;
+    size_t size = 0, entry_size;
+    struct dirent *de;
+    DIR *dir;
+    int fd, len;
+
+    if ((fd = openat( root_fd, dir_name, O_RDONLY | O_DIRECTORY )) == -1) return NULL;
+    if (!(dir = fdopendir( fd )))
+    {
+        close( fd );
+        return NULL;
+    }
+
+    while ((de = readdir( dir )))
+    {
+        size_t unix_len = strlen( de->d_name );
+
+        len = ntdll_umbstowcs( de->d_name, unix_len, buffer, MAX_DIR_ENTRY_LEN );
+        entry_size = offsetof( struct name_index_entry, name[len] ) + unix_len + 1;
+        /* the index of a huge directory would evict all the others */
+        if ((size += entry_size) > NAME_INDEX_CACHE_SIZE / 4) goto failed;
+        if (!(entry = malloc( entry_size ))) goto failed;
+        count++;
+        memcpy( entry->name, buffer, len * sizeof(WCHAR) );
+        entry->len = len;
+        entry->unix_name = (char *)&entry->name[len];
+        memcpy( entry->unix_name, de->d_name, unix_len + 1 );
+        if (!is_legal_8dot3_name( buffer, len ))
+            entry->short_len = hash_short_file_name( buffer, len, entry->short_name );
+        else
+            entry->short_len = 0;
+        entry->next = list;
+        list = entry;
+    }
+    closedir( dir );
+
+    if (!(index = malloc( sizeof(*index) ))) goto failed_list;
+    for (index->hash_size = 16; index->hash_size < count; index->hash_size *= 2) ;
+    if (!(index->buckets = calloc( 2 * index->hash_size, sizeof(*index->buckets) )))
+    {
+        free( index );
+        goto failed_list;
+    }
+    index->short_buckets = index->buckets + index->hash_size;
+    index->dev = st->st_dev;
+    index->ino = st->st_ino;
+    index->mtime = get_stat_mtime( st );
+    index->size = sizeof(*index) + size + 2 * index->hash_size * sizeof(*index->buckets);
+
+    while ((entry = list))
+    {
+        list = entry->next;
+        hash = hash_name_nocase( entry->name, entry->len ) & (index->hash_size - 1);
+        entry->next = index->buckets[hash];
+        index->buckets[hash] = entry;
+        if (!entry->short_len) continue;
+        hash = hash_name_nocase( entry->short_name, entry->short_len ) & (index->hash_size - 1);
+        entry->short_next = index->short_buckets[hash];
+        index->short_buckets[hash] = entry;
+    }
+    return index;
+
+failed:
+    closedir( dir );
+failed_list:
+    while ((entry = list))
+    {
+        list = entry->next;
+        free( entry );
+    }
+    return NULL;
+}
+
+static const struct name_index_entry *lookup_name_index( const struct name_index *index, const WCHAR *name,
+                                                         int length, BOOLEAN is_name_8_dot_3 )
+{
+    unsigned int hash = hash_name_nocase( name, length ) & (index->hash_size - 1);
+    const struct name_index_entry *entry;
+
+    for (entry = index->buckets[hash]; entry; entry = entry->next)
+        if (entry->len == length && !wcsnicmp( entry->name, name, length )) return entry;
+
+    if (!is_name_8_dot_3) return NULL;
+
+    for (entry = index->short_buckets[hash]; entry; entry = entry->short_next)
+        if (entry->short_len == length && !wcsnicmp( entry->short_name, name, length )) return entry;
+
+    return NULL;
+}
+
+/***********************************************************************
+ *           find_file_in_name_index
+ *
+ * Look for a file in the cached name index of a directory, building it if necessary.
+ * unix_name contains the directory name; the file found is appended to it at pos.
+ * Returns STATUS_NOT_SUPPORTED if the directory needs to be scanned the hard way.
+ */
+static NTSTATUS find_file_in_name_index( int root_fd, char *unix_name, int pos, const WCHAR *name, int length,
+                                         BOOLEAN is_name_8_dot_3 )
+{
+    const struct name_index_entry *entry;
+    struct name_index *index;
+    struct stat st;
+    ULONGLONG mtime;
+    BOOL cached = FALSE;
+    NTSTATUS status = STATUS_NOT_SUPPORTED;
+
+    if (fstatat( root_fd, unix_name, &st, 0 ) == -1) return STATUS_NOT_SUPPORTED;
+    mtime = get_stat_mtime( &st );
+
+    mutex_lock( &name_index_mutex );
+    LIST_FOR_EACH_ENTRY( index, &name_index_cache, struct name_index, entry )
+    {
+        if (index->dev != st.st_dev || index->ino != st.st_ino) continue;
+        if (index->mtime != mtime) break;
+
+        list_remove( &index->entry );
+        list_add_head( &name_index_cache, &index->entry );
+        cached = TRUE;
+        if ((entry = lookup_name_index( index, name, length, is_name_8_dot_3 )))
+        {
+            unix_name[pos - 1] = '/';
+            strcpy( unix_name + pos, entry->unix_name );
+            status = STATUS_SUCCESS;
+        }
+        break;
+    }
+    mutex_unlock( &name_index_mutex );
+
+    if (status == STATUS_SUCCESS)
+    {
+        /* the file may have been renamed within the same timestamp */
+        if (!fstatat( root_fd, unix_name, &st, AT_SYMLINK_NOFOLLOW ))
+        {
+            InterlockedIncrement( &name_index_hits );
+            return STATUS_SUCCESS;
+        }
+        unix_name[pos - 1] = 0;
+    }
+    /* changes within the timestamp granularity can't be detected, and some file systems
+     * don't update it at all, so a cached index can only be trusted for the names it contains */
+    if (cached) return STATUS_NOT_SUPPORTED;
+
+    InterlockedIncrement( &name_index_misses );
+    if (!(index = create_name_index( root_fd, unix_name, &st ))) return STATUS_NOT_SUPPORTED;
+
+    if ((entry = lookup_name_index( index, name, length, is_name_8_dot_3 )))
+    {
+        unix_name[pos - 1] = '/';
+        strcpy( unix_name + pos, entry->unix_name );
+        status = STATUS_SUCCESS;
+    }
+    else status = STATUS_OBJECT_NAME_NOT_FOUND;
+
+    TRACE( "indexed %s, %d hits %d misses\n", debugstr_a(unix_name),
+           (int)ReadNoFence( &name_index_hits ), (int)ReadNoFence( &name_index_misses ) );
+
+    mutex_lock( &name_index_mutex );
+    {
+        struct name_index *old, *next;
+
+        LIST_FOR_EACH_ENTRY_SAFE( old, next, &name_index_cache, struct name_index, entry )
+        {
+            if (old->dev != index->dev || old->ino != index->ino) continue;
+            list_remove( &old->entry );
+            name_index_cache_size -= old->size;
+            free_name_index( old );
+        }
+        while (name_index_cache_size + index->size > NAME_INDEX_CACHE_SIZE)
+        {
+            old = LIST_ENTRY( list_tail( &name_index_cache ), struct name_index, entry );
+            list_remove( &old->entry );
+            name_index_cache_size -= old->size;
+            free_name_index( old );
+        }
+        list_add_head( &name_index_cache, &index->entry );
+        name_index_cache_size += index->size;
+    }
+    mutex_unlock( &name_index_mutex );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2882,6 +3272,7 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
 {
     WCHAR buffer[MAX_DIR_ENTRY_LEN];
     BOOLEAN is_name_8_dot_3;
+    NTSTATUS status;
     DIR *dir;
     struct dirent *de;
     struct stat st;
@@ -2960,6 +3351,9 @@ static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const W
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    status = find_file_in_name_index( root_fd, unix_name, pos, name, length, is_name_8_dot_3 );
+    if (status != STATUS_NOT_SUPPORTED) return status;
+
     if ((fd = openat( root_fd, unix_name, O_RDONLY )) == -1) return errno_to_status( errno );
     if (!(dir = fdopendir( fd )))
     {
@@ -5084,6 +5478,16 @@ struct async_irp
     ULONG               size;     /* size of buffer */
 };
 
+struct async_fileio_uring
+{
+    struct async_fileio io;
+    off_t               offset;
+    ULONG               length;   /* total size of the buffers */
+    int                 type;     /* ASYNC_TYPE_READ or ASYNC_TYPE_WRITE */
+    unsigned int        count;    /* number of buffers */
+    struct iovec        iov[1];
+};
+
 static struct async_fileio *fileio_freelist;
 
 void release_fileio( struct async_fileio *io )
@@ -5314,11 +5718,11 @@ static unsigned int server_write_file( HANDLE handle, HANDLE event, PIO_APC_ROUT
 }
 
 /* do an ioctl call through the server */
-static NTSTATUS server_ioctl_file( HANDLE handle, HANDLE event,
-                                   PIO_APC_ROUTINE apc, PVOID apc_context,
-                                   IO_STATUS_BLOCK *io, UINT code,
-                                   const void *in_buffer, UINT in_size,
-                                   PVOID out_buffer, UINT out_size )
+NTSTATUS server_ioctl_file( HANDLE handle, HANDLE event,
+                            PIO_APC_ROUTINE apc, PVOID apc_context,
+                            IO_STATUS_BLOCK *io, UINT code,
+                            const void *in_buffer, UINT in_size,
+                            PVOID out_buffer, UINT out_size )
 {
     struct async_irp *async;
     unsigned int status;
@@ -5495,6 +5899,352 @@ static unsigned int register_async_file_read( HANDLE handle, HANDLE event,
     return status;
 }
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#ifndef HAVE_PREADV
+/* only the first buffer is transferred, callers handle short transfers */
+static ssize_t preadv( int fd, const struct iovec *iov, int count, off_t offset )
+{
+    return pread( fd, iov->iov_base, iov->iov_len, offset );
+}
+#endif
+
+#ifndef HAVE_PWRITEV
+static ssize_t pwritev( int fd, const struct iovec *iov, int count, off_t offset )
+{
+    return pwrite( fd, iov->iov_base, iov->iov_len, offset );
+}
+#endif
+
+/* build the buffer list of a scatter/gather request, merging contiguous segments */
+static struct iovec *get_segments_iovec( FILE_SEGMENT_ELEMENT *segments, ULONG length, unsigned int *count )
+{
+    struct iovec *iov;
+    unsigned int i, n = 0;
+    ULONG size;
+
+    if (!(iov = malloc( max( 1, (length + page_size - 1) / page_size ) * sizeof(*iov) ))) return NULL;
+
+    for (i = 0; length; i++, length -= size)
+    {
+        char *buffer = segments[i].Buffer;
+
+        size = min( length, page_size );
+        if (n && (char *)iov[n - 1].iov_base + iov[n - 1].iov_len == buffer)
+            iov[n - 1].iov_len += size;
+        else
+        {
+            iov[n].iov_base = buffer;
+            iov[n].iov_len = size;
+            n++;
+        }
+    }
+    *count = n;
+    return iov;
+}
+
+/* transfer a list of buffers, until the end of file for reads; the list is modified */
+static unsigned int do_vectored_io( int fd, BOOL write, struct iovec *iov, unsigned int count,
+                                    const LARGE_INTEGER *offset, UINT *total )
+{
+    ssize_t result;
+    int n;
+
+    while (count)
+    {
+        n = min( count, IOV_MAX );
+        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            result = write ? pwritev( fd, iov, n, offset->QuadPart + *total )
+                           : preadv( fd, iov, n, offset->QuadPart + *total );
+        else
+            result = write ? writev( fd, iov, n ) : readv( fd, iov, n );
+
+        if (result == -1)
+        {
+            if (errno == EINTR) continue;
+            if (write && errno == EFAULT) return STATUS_INVALID_USER_BUFFER;
+            return errno_to_status( errno );
+        }
+        if (!result) return write ? STATUS_DISK_FULL : STATUS_SUCCESS;
+
+        *total += result;
+        while (count && result >= iov->iov_len)
+        {
+            result -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count)
+        {
+            iov->iov_base = (char *)iov->iov_base + result;
+            iov->iov_len -= result;
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#define IO_URING_ENTRIES 256
+
+/* io_uring instance used for overlapped I/O on regular files; we submit the
+ * reads and writes, and the server reaps the completions to complete the asyncs */
+static struct
+{
+    int                  fd;       /* io_uring file descriptor, -1 if not available */
+    unsigned int        *head;     /* submission ring head, updated by the kernel */
+    unsigned int        *tail;     /* submission ring tail */
+    unsigned int        *array;    /* submission ring indices */
+    unsigned int         mask;     /* submission ring index mask */
+    unsigned int         entries;  /* number of submission ring entries */
+    struct io_uring_sqe *sqes;     /* submission queue entries */
+} uring = { -1 };
+
+static pthread_mutex_t uring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static LONG uring_init_done;
+
+/* create the io_uring instance and let the server reap its completions */
+static void init_io_uring(void)
+{
+    struct io_uring_params params;
+    void *sq_ring, *sqes;
+    size_t sq_size, sqes_size;
+    unsigned int status;
+    const char *env;
+    int fd;
+
+    if (!(env = getenv( "WINEIOURING" )) || !atoi( env )) return;
+
+    memset( &params, 0, sizeof(params) );
+    if ((fd = syscall( __NR_io_uring_setup, IO_URING_ENTRIES, &params )) == -1)
+    {
+        WARN( "io_uring not available: %s\n", strerror( errno ));
+        return;
+    }
+    /* the kernel must support IORING_OP_READ and IORING_OP_WRITE, and it must
+     * not drop completions while the server is busy */
+    if (!(params.features & IORING_FEAT_RW_CUR_POS) || !(params.features & IORING_FEAT_NODROP))
+    {
+        close( fd );
+        return;
+    }
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    if ((sq_ring = mmap( NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd, IORING_OFF_SQ_RING )) == MAP_FAILED)
+    {
+        close( fd );
+        return;
+    }
+    if ((sqes = mmap( NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQES )) == MAP_FAILED)
+    {
+        munmap( sq_ring, sq_size );
+        close( fd );
+        return;
+    }
+
+    wine_server_send_fd( fd );
+    SERVER_START_REQ( set_io_uring )
+    {
+        req->fd      = fd;
+        req->size    = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        req->entries = params.cq_entries;
+        req->head    = params.cq_off.head;
+        req->tail    = params.cq_off.tail;
+        req->mask    = params.cq_off.ring_mask;
+        req->cqes    = params.cq_off.cqes;
+        status = wine_server_call( req );
+    }
+    SERVER_END_REQ;
+
+    if (status)
+    {
+        TRACE( "server doesn't reap io_uring completions: %#x\n", status );
+        munmap( sqes, sqes_size );
+        munmap( sq_ring, sq_size );
+        close( fd );
+        return;
+    }
+
+    uring.head    = (unsigned int *)((char *)sq_ring + params.sq_off.head);
+    uring.tail    = (unsigned int *)((char *)sq_ring + params.sq_off.tail);
+    uring.array   = (unsigned int *)((char *)sq_ring + params.sq_off.array);
+    uring.mask    = *(unsigned int *)((char *)sq_ring + params.sq_off.ring_mask);
+    uring.entries = params.sq_entries;
+    uring.sqes    = sqes;
+    uring.fd      = fd;
+    TRACE( "using io_uring with %u entries\n", uring.entries );
+}
+
+/* perform the I/O of an io_uring async synchronously */
+static unsigned int io_uring_sync_io( struct async_fileio_uring *fileio, int fd, ULONG_PTR *info )
+{
+    LARGE_INTEGER offset;
+    unsigned int status;
+    UINT total = 0;
+    ssize_t ret;
+
+    if (fileio->count > 1)
+    {
+        offset.QuadPart = fileio->offset;
+        status = do_vectored_io( fd, fileio->type == ASYNC_TYPE_WRITE, fileio->iov, fileio->count, &offset, &total );
+        *info = total;
+        if (!status && !total && fileio->length && fileio->type == ASYNC_TYPE_READ) return STATUS_END_OF_FILE;
+        return status;
+    }
+
+    do
+    {
+        if (fileio->type == ASYNC_TYPE_READ)
+            ret = virtual_locked_pread( fd, fileio->iov[0].iov_base, fileio->length, fileio->offset );
+        else
+            ret = pwrite( fd, fileio->iov[0].iov_base, fileio->length, fileio->offset );
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret == -1)
+    {
+        if (errno == EFAULT && fileio->type == ASYNC_TYPE_WRITE) return STATUS_INVALID_USER_BUFFER;
+        return errno_to_status( errno );
+    }
+    *info = ret;
+    if (!ret && fileio->length && fileio->type == ASYNC_TYPE_READ) return STATUS_END_OF_FILE;
+    return STATUS_SUCCESS;
+}
+
+static BOOL async_uring_proc( void *user, ULONG_PTR *info, unsigned int *status )
+{
+    struct async_fileio_uring *fileio = user;
+    ACCESS_MASK access = fileio->type == ASYNC_TYPE_READ ? FILE_READ_DATA : FILE_WRITE_DATA;
+    int fd, needs_close;
+
+    /* the kernel can't write to pages protected for write watches, retry the I/O ourselves */
+    if (*status == STATUS_ACCESS_VIOLATION &&
+        !(*status = server_get_unix_fd( fileio->io.handle, access, &fd, &needs_close, NULL, NULL )))
+    {
+        *status = io_uring_sync_io( fileio, fd, info );
+        if (needs_close) close( fd );
+    }
+    release_fileio( &fileio->io );
+    return TRUE;
+}
+
+/* submit an overlapped read or write on a regular file to the io_uring instance;
+ * helper for NtReadFile and NtWriteFile, STATUS_NOT_SUPPORTED means that the
+ * caller has to perform the I/O itself */
+static unsigned int register_io_uring_file_io( HANDLE handle, int unix_fd, int type, HANDLE event,
+                                               PIO_APC_ROUTINE apc, void *apc_user, client_ptr_t iosb,
+                                               const struct iovec *iov, unsigned int count,
+                                               ULONG length, off_t offset )
+{
+    struct async_fileio_uring *fileio;
+    unsigned int status, slot = 0, tail;
+    BOOL submitted = FALSE;
+    ULONG_PTR info = 0;
+
+    if (!ReadAcquire( &uring_init_done ))
+    {
+        mutex_lock( &uring_mutex );
+        if (!uring_init_done) init_io_uring();
+        WriteRelease( &uring_init_done, TRUE );
+        mutex_unlock( &uring_mutex );
+    }
+    if (uring.fd == -1 || !length || count > IOV_MAX) return STATUS_NOT_SUPPORTED;
+
+    if (!(fileio = (struct async_fileio_uring *)alloc_fileio( offsetof( struct async_fileio_uring, iov[count] ),
+                                                              async_uring_proc, handle )))
+        return STATUS_NO_MEMORY;
+
+    fileio->offset = offset;
+    fileio->length = length;
+    fileio->type   = type;
+    fileio->count  = count;
+    memcpy( fileio->iov, iov, count * sizeof(*iov) );
+
+    SERVER_START_REQ( register_io_uring_async )
+    {
+        req->type  = type;
+        req->count = length;
+        req->async = server_async( handle, &fileio->io, event, apc, apc_user, iosb );
+        status = wine_server_call( req );
+        slot = reply->slot;
+    }
+    SERVER_END_REQ;
+
+    if (status != STATUS_PENDING)
+    {
+        /* e.g. all the slots are in use, fall back to synchronous I/O */
+        free( fileio );
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    mutex_lock( &uring_mutex );
+    tail = *uring.tail;
+    if (tail - ReadAcquire( (LONG *)uring.head ) < uring.entries)
+    {
+        unsigned int index = tail & uring.mask;
+        struct io_uring_sqe *sqe = &uring.sqes[index];
+        int ret;
+
+        memset( sqe, 0, sizeof(*sqe) );
+        if (count == 1)
+        {
+            sqe->opcode = type == ASYNC_TYPE_READ ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe->addr   = (ULONG_PTR)iov[0].iov_base;
+            sqe->len    = length;
+        }
+        else
+        {
+            /* the buffer list is kept in the async until the completion */
+            sqe->opcode = type == ASYNC_TYPE_READ ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->addr   = (ULONG_PTR)fileio->iov;
+            sqe->len    = count;
+        }
+        sqe->fd        = unix_fd;
+        sqe->off       = offset;
+        sqe->user_data = slot;
+        uring.array[index] = index;
+        WriteRelease( (LONG *)uring.tail, tail + 1 );
+
+        do ret = syscall( __NR_io_uring_enter, uring.fd, 1, 0, 0, NULL, 0 );
+        while (ret == -1 && errno == EINTR);
+
+        /* take the entry back if the kernel didn't consume it */
+        if (!(submitted = (ReadAcquire( (LONG *)uring.head ) != tail)))
+            WriteRelease( (LONG *)uring.tail, tail );
+    }
+    mutex_unlock( &uring_mutex );
+
+    if (!submitted)
+    {
+        status = io_uring_sync_io( fileio, unix_fd, &info );
+        SERVER_START_REQ( set_io_uring_result )
+        {
+            req->slot   = slot;
+            req->status = status;
+            req->total  = info;
+            wine_server_call( req );
+        }
+        SERVER_END_REQ;
+    }
+    return STATUS_PENDING;
+}
+
+#else  /* HAVE_LINUX_IO_URING_H */
+
+static unsigned int register_io_uring_file_io( HANDLE handle, int unix_fd, int type, HANDLE event,
+                                               PIO_APC_ROUTINE apc, void *apc_user, client_ptr_t iosb,
+                                               const struct iovec *iov, unsigned int count,
+                                               ULONG length, off_t offset )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+#endif  /* HAVE_LINUX_IO_URING_H */
+
 static void add_completion( HANDLE handle, ULONG_PTR value, NTSTATUS status, ULONG info, BOOL async )
 {
     SERVER_START_REQ( add_fd_completion )
@@ -5609,7 +6359,14 @@ NTSTATUS WINAPI NtReadFile( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, vo
 
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
         {
-            /* async I/O doesn't make sense on regular files */
+            struct iovec iov = { buffer, length };
+
+            if (async_read &&
+                (status = register_io_uring_file_io( handle, unix_handle, ASYNC_TYPE_READ, event, apc, apc_user,
+                                                     iosb_ptr, &iov, 1, length, offset->QuadPart )) != STATUS_NOT_SUPPORTED)
+                goto err;
+
+            /* otherwise async I/O doesn't make sense on regular files */
             while ((result = virtual_locked_pread( unix_handle, buffer, length, offset->QuadPart )) == -1)
             {
                 if (errno != EINTR)
@@ -5777,13 +6534,14 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    IO_STATUS_BLOCK *io, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, LARGE_INTEGER *offset, ULONG *key )
 {
-    int result, unix_handle, needs_close;
-    unsigned int options, status;
-    UINT pos = 0, total = 0;
+    int unix_handle, needs_close;
+    unsigned int options, status, count;
+    UINT total = 0;
     client_ptr_t iosb_ptr = iosb_client_ptr(io);
     enum server_fd_type type;
     ULONG_PTR cvalue = apc ? 0 : (ULONG_PTR)apc_user;
     BOOL send_completion = FALSE;
+    struct iovec *iov;
 
     TRACE( "(%p,%p,%p,%p,%p,%p,0x%08x,%p,%p),partial stub!\n",
            file, event, apc, apc_user, io, segments, length, offset, key );
@@ -5801,30 +6559,25 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto error;
     }
 
-    while (length)
+    if (!(iov = get_segments_iovec( segments, length, &count )))
     {
-        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pread( unix_handle, (char *)segments->Buffer + pos,
-                            min( length - pos, page_size - pos ), offset->QuadPart + total );
-        else
-            result = read( unix_handle, (char *)segments->Buffer + pos, min( length - pos, page_size - pos ) );
+        status = STATUS_NO_MEMORY;
+        goto error;
+    }
 
-        if (result == -1)
-        {
-            if (errno == EINTR) continue;
-            status = errno_to_status( errno );
-            break;
-        }
-        if (!result) break;
-        total += result;
-        length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+    if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION &&
+        (status = register_io_uring_file_io( file, unix_handle, ASYNC_TYPE_READ, event, apc, apc_user, iosb_ptr,
+                                             iov, count, length, offset->QuadPart )) != STATUS_NOT_SUPPORTED)
+    {
+        free( iov );
+        if (needs_close) close( unix_handle );
+        TRACE("= 0x%08x\n", status);
+        return status;
     }
 
+    status = do_vectored_io( unix_handle, FALSE, iov, count, offset, &total );
+    free( iov );
+
     if (total == 0) status = STATUS_END_OF_FILE;
 
     send_completion = cvalue != 0;
@@ -5906,6 +6659,7 @@ NTSTATUS WINAPI NtWriteFile( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, v
 
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
         {
+            struct iovec iov = { (void *)buffer, length };
             off_t off = offset->QuadPart;
 
             if (offset->QuadPart == FILE_WRITE_TO_END_OF_FILE)
@@ -5925,7 +6679,12 @@ NTSTATUS WINAPI NtWriteFile( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, v
                 goto done;
             }
 
-            /* async I/O doesn't make sense on regular files */
+            if (async_write &&
+                (status = register_io_uring_file_io( handle, unix_handle, ASYNC_TYPE_WRITE, event, apc, apc_user,
+                                                     iosb_ptr, &iov, 1, length, off )) != STATUS_NOT_SUPPORTED)
+                goto err;
+
+            /* otherwise async I/O doesn't make sense on regular files */
             while ((result = pwrite( unix_handle, buffer, length, off )) == -1)
             {
                 if (errno != EINTR)
@@ -6079,10 +6838,11 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
                                    IO_STATUS_BLOCK *io, FILE_SEGMENT_ELEMENT *segments,
                                    ULONG length, LARGE_INTEGER *offset, ULONG *key )
 {
-    int result, unix_handle, needs_close;
-    unsigned int options, status;
-    UINT pos = 0, total = 0;
+    int unix_handle, needs_close;
+    unsigned int options, status, count;
+    UINT total = 0;
     enum server_fd_type type;
+    struct iovec *iov;
 
     TRACE( "(%p,%p,%p,%p,%p,%p,0x%08x,%p,%p),partial stub!\n",
            file, event, apc, apc_user, io, segments, length, offset, key );
@@ -6101,39 +6861,26 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         goto done;
     }
 
-    while (length)
+    if (!(iov = get_segments_iovec( segments, length, &count )))
     {
-        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
-            result = pwrite( unix_handle, (char *)segments->Buffer + pos,
-                             page_size - pos, offset->QuadPart + total );
-        else
-            result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+        status = STATUS_NO_MEMORY;
+        goto done;
+    }
 
-        if (result == -1)
-        {
-            if (errno == EINTR) continue;
-            if (errno == EFAULT)
-            {
-                status = STATUS_INVALID_USER_BUFFER;
-                goto done;
-            }
-            status = errno_to_status( errno );
-            break;
-        }
-        if (!result)
-        {
-            status = STATUS_DISK_FULL;
-            break;
-        }
-        total += result;
-        length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+    if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION &&
+        (status = register_io_uring_file_io( file, unix_handle, ASYNC_TYPE_WRITE, event, apc, apc_user,
+                                             iosb_client_ptr(io), iov, count, length,
+                                             offset->QuadPart )) != STATUS_NOT_SUPPORTED)
+    {
+        free( iov );
+        if (needs_close) close( unix_handle );
+        TRACE("= 0x%08x\n", status);
+        return status;
     }
 
+    status = do_vectored_io( unix_handle, TRUE, iov, count, offset, &total );
+    free( iov );
+
  done:
     if (needs_close) close( unix_handle );
     if (status == STATUS_SUCCESS)
@@ -6236,6 +6983,90 @@ static void ignore_server_ioctl_struct_holes( ULONG code, const void *in_buffer,
 }
 
 
+/* copy a range of a file into another one, sharing the data blocks if possible */
+static NTSTATUS duplicate_extents( int dest_fd, const DUPLICATE_EXTENTS_DATA *data )
+{
+#ifdef linux
+    off_t src_offset = data->SourceFileOffset.QuadPart, dest_offset = data->TargetFileOffset.QuadPart;
+    ULONGLONG count = data->ByteCount.QuadPart;
+    struct file_clone_range range;
+    enum server_fd_type type;
+    int src_fd, needs_close;
+    struct stat src_st, dest_st;
+    NTSTATUS status;
+
+    if (data->SourceFileOffset.QuadPart < 0 || data->TargetFileOffset.QuadPart < 0 ||
+        data->ByteCount.QuadPart < 0)
+        return STATUS_INVALID_PARAMETER;
+
+    if ((status = server_get_unix_fd( data->FileHandle, FILE_READ_DATA, &src_fd, &needs_close, &type, NULL )))
+        return status;
+    if (type != FD_TYPE_FILE)
+    {
+        status = STATUS_INVALID_DEVICE_REQUEST;
+        goto done;
+    }
+
+    if (fstat( src_fd, &src_st ) == -1 || fstat( dest_fd, &dest_st ) == -1)
+    {
+        status = errno_to_status( errno );
+        goto done;
+    }
+    /* like on Windows, both ranges must be within the files, the target file is never extended */
+    if (count > src_st.st_size || src_offset > src_st.st_size - count ||
+        count > dest_st.st_size || dest_offset > dest_st.st_size - count)
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto done;
+    }
+
+    /* try a reflink first, the file systems that support it require aligned offsets */
+    range.src_fd      = src_fd;
+    range.src_offset  = src_offset;
+    range.src_length  = count;
+    range.dest_offset = dest_offset;
+    if (count && !ioctl( dest_fd, FICLONERANGE, &range ))
+    {
+        TRACE( "cloned %s bytes\n", wine_dbgstr_longlong( count ));
+        goto done;
+    }
+
+#ifdef __NR_copy_file_range
+    while (count)
+    {
+        ssize_t ret = syscall( __NR_copy_file_range, src_fd, &src_offset, dest_fd, &dest_offset,
+                               (size_t)min( count, 0x40000000 ), 0 );
+        if (ret < 0)
+        {
+            if (errno == EINTR) continue;
+            /* nothing has been copied yet, let the caller fall back to reading and writing */
+            if (count == data->ByteCount.QuadPart &&
+                (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+                status = STATUS_INVALID_DEVICE_REQUEST;
+            else
+                status = errno_to_status( errno );
+            break;
+        }
+        if (!ret)  /* the source file has been truncated meanwhile */
+        {
+            status = STATUS_END_OF_FILE;
+            break;
+        }
+        count -= ret;
+    }
+#else
+    if (count) status = STATUS_INVALID_DEVICE_REQUEST;
+#endif
+
+done:
+    if (needs_close) close( src_fd );
+    return status;
+#else
+    return STATUS_INVALID_DEVICE_REQUEST;
+#endif
+}
+
+
 /******************************************************************************
  *              NtFsControlFile   (NTDLL.@)
  */
@@ -6338,6 +7169,21 @@ NTSTATUS WINAPI NtFsControlFile( HANDLE handle, HANDLE event, PIO_APC_ROUTINE ap
         TRACE("FSCTL_SET_SPARSE: Ignoring request\n");
         status = STATUS_SUCCESS;
         break;
+
+    case FSCTL_DUPLICATE_EXTENTS_TO_FILE:
+    {
+        int fd, needs_close;
+
+        if (in_size < sizeof(DUPLICATE_EXTENTS_DATA))
+        {
+            status = STATUS_INVALID_PARAMETER;
+            break;
+        }
+        if ((status = server_get_unix_fd( handle, FILE_WRITE_DATA, &fd, &needs_close, NULL, NULL ))) break;
+        status = duplicate_extents( fd, in_buffer );
+        if (needs_close) close( fd );
+        break;
+    }
     default:
         return server_ioctl_file( handle, event, apc, apc_context, io, code,
                                   in_buffer, in_size, out_buffer, out_size );
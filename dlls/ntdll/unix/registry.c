@@ -484,6 +484,142 @@ NTSTATUS WINAPI NtEnumerateValueKey( HANDLE handle, ULONG index, KEY_VALUE_INFOR
 }
 
 
+/* Small values are cached on the client side. The server exposes a generation
+ * counter for each key in the session shared memory, which is incremented every
+ * time the key values change, so cached values can be validated without a round-trip. */
+
+#define VALUE_CACHE_SIZE     64   /* number of cached values */
+#define VALUE_CACHE_MAX_NAME 64   /* max length of a cached value name in WCHARs */
+#define VALUE_CACHE_MAX_DATA 128  /* max size of cached value data */
+
+struct value_cache_entry
+{
+    HANDLE             handle;                          /* key handle, 0 if entry is free */
+    struct obj_locator locator;                         /* key shared object locator */
+    UINT64             generation;                      /* key generation when the value was cached */
+    unsigned int       lru;                             /* last access stamp */
+    int                type;                            /* value type, -1 if the value doesn't exist */
+    data_size_t        name_len;                        /* length of the value name in bytes */
+    data_size_t        data_len;                        /* length of the value data */
+    WCHAR              name[VALUE_CACHE_MAX_NAME];      /* value name */
+    BYTE               data[VALUE_CACHE_MAX_DATA];      /* value data */
+};
+
+static struct value_cache_entry value_cache[VALUE_CACHE_SIZE];
+static unsigned int value_cache_stamp;
+static LONG value_cache_close_seq;  /* incremented every time a key handle is closed */
+static pthread_mutex_t value_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* check that a cached value is still up to date */
+static BOOL is_value_cache_valid( const struct value_cache_entry *entry )
+{
+    const shared_object_t *object;
+    object_id_t id;
+    UINT64 generation;
+    LONG64 seq;
+
+    if (!(object = get_session_object( entry->locator ))) return FALSE;
+    do
+    {
+        while ((seq = ReadNoFence64( &object->seq )) & 1) YieldProcessor();
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        id = object->id;
+        generation = object->shm.key.generation;
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    } while (ReadNoFence64( &object->seq ) != seq);
+
+    return id == entry->locator.id && generation == entry->generation;
+}
+
+static struct value_cache_entry *find_value_cache_entry( HANDLE handle, const UNICODE_STRING *name )
+{
+    unsigned int i;
+
+    for (i = 0; i < VALUE_CACHE_SIZE; i++)
+    {
+        struct value_cache_entry *entry = &value_cache[i];
+        if (entry->handle != handle || entry->name_len != name->Length) continue;
+        if (!memcmp( entry->name, name->Buffer, name->Length )) return entry;
+    }
+    return NULL;
+}
+
+/* look up a value in the cache, copying the entry to avoid holding the lock while validating it */
+static BOOL get_cached_value( HANDLE handle, const UNICODE_STRING *name, struct value_cache_entry *ret )
+{
+    struct value_cache_entry *entry;
+    sigset_t sigset;
+    BOOL found = FALSE;
+
+    if (!handle || name->Length > VALUE_CACHE_MAX_NAME * sizeof(WCHAR)) return FALSE;
+
+    server_enter_uninterrupted_section( &value_cache_mutex, &sigset );
+    if ((entry = find_value_cache_entry( handle, name )))
+    {
+        entry->lru = ++value_cache_stamp;
+        *ret = *entry;
+        found = TRUE;
+    }
+    server_leave_uninterrupted_section( &value_cache_mutex, &sigset );
+
+    return found && is_value_cache_valid( ret );
+}
+
+/* add a value to the cache, evicting the least recently used entry; close_seq is the value of
+ * value_cache_close_seq before the value was retrieved, the handle may have been closed and
+ * reused for another key if it changed meanwhile */
+static void cache_value( HANDLE handle, const UNICODE_STRING *name, LONG close_seq, struct obj_locator locator,
+                         UINT64 generation, int type, const void *data, data_size_t len )
+{
+    struct value_cache_entry *entry;
+    unsigned int i;
+    sigset_t sigset;
+
+    if (!handle || !locator.id || len > VALUE_CACHE_MAX_DATA) return;
+    if (name->Length > VALUE_CACHE_MAX_NAME * sizeof(WCHAR)) return;
+
+    server_enter_uninterrupted_section( &value_cache_mutex, &sigset );
+    if (value_cache_close_seq != close_seq)
+    {
+        server_leave_uninterrupted_section( &value_cache_mutex, &sigset );
+        return;
+    }
+    if (!(entry = find_value_cache_entry( handle, name )))
+    {
+        entry = &value_cache[0];
+        for (i = 1; i < VALUE_CACHE_SIZE && entry->handle; i++)
+            if (!value_cache[i].handle || value_cache[i].lru < entry->lru) entry = &value_cache[i];
+    }
+    entry->handle     = handle;
+    entry->locator    = locator;
+    entry->generation = generation;
+    entry->lru        = ++value_cache_stamp;
+    entry->type       = type;
+    entry->name_len   = name->Length;
+    entry->data_len   = len;
+    memcpy( entry->name, name->Buffer, name->Length );
+    if (len) memcpy( entry->data, data, len );
+    server_leave_uninterrupted_section( &value_cache_mutex, &sigset );
+}
+
+/***********************************************************************
+ *           invalidate_key_value_cache
+ *
+ * Remove the cached values of a key handle, called when the handle is closed.
+ */
+void invalidate_key_value_cache( HANDLE handle )
+{
+    unsigned int i;
+    sigset_t sigset;
+
+    server_enter_uninterrupted_section( &value_cache_mutex, &sigset );
+    value_cache_close_seq++;
+    for (i = 0; i < VALUE_CACHE_SIZE; i++)
+        if (value_cache[i].handle == handle) value_cache[i].handle = 0;
+    server_leave_uninterrupted_section( &value_cache_mutex, &sigset );
+}
+
+
 /******************************************************************************
  *              NtQueryValueKey  (NTDLL.@)
  */
@@ -491,9 +627,13 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
                                  KEY_VALUE_INFORMATION_CLASS info_class,
                                  void *info, DWORD length, DWORD *result_len )
 {
+    struct value_cache_entry cached;
     unsigned int ret;
     UCHAR *data_ptr;
     unsigned int fixed_size, min_size;
+    data_size_t total;
+    LONG close_seq;
+    int type;
 
     TRACE( "(%p,%s,%d,%p,%d)\n", handle, debugstr_us(name), info_class, info, length );
 
@@ -539,21 +679,42 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
         return STATUS_INVALID_PARAMETER;
     }
 
-    SERVER_START_REQ( get_key_value )
+    if (get_cached_value( handle, name, &cached ))
     {
-        req->hkey = wine_server_obj_handle( handle );
-        wine_server_add_data( req, name->Buffer, name->Length );
-        if (length > fixed_size && data_ptr) wine_server_set_reply( req, data_ptr, length - fixed_size );
-        if (!(ret = wine_server_call( req )))
+        if (cached.type == -1) return STATUS_OBJECT_NAME_NOT_FOUND;
+        if (length > fixed_size && data_ptr)
+            memcpy( data_ptr, cached.data, min( length - fixed_size, cached.data_len ));
+        type = cached.type;
+        total = cached.data_len;
+        ret = STATUS_SUCCESS;
+    }
+    else
+    {
+        close_seq = ReadAcquire( &value_cache_close_seq );
+        SERVER_START_REQ( get_key_value )
         {
-            copy_key_value_info( info_class, info, length, reply->type,
-                                 name->Length, reply->total );
-            *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : reply->total);
-            if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
-            else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
+            req->hkey = wine_server_obj_handle( handle );
+            wine_server_add_data( req, name->Buffer, name->Length );
+            if (length > fixed_size && data_ptr) wine_server_set_reply( req, data_ptr, length - fixed_size );
+            ret = wine_server_call( req );
+            type = reply->type;
+            total = reply->total;
+            /* only cache values that have been fully retrieved */
+            if (ret == STATUS_OBJECT_NAME_NOT_FOUND)
+                cache_value( handle, name, close_seq, reply->locator, reply->generation, -1, NULL, 0 );
+            else if (!ret && data_ptr && wine_server_reply_size( reply ) == total)
+                cache_value( handle, name, close_seq, reply->locator, reply->generation, type, data_ptr, total );
         }
+        SERVER_END_REQ;
+    }
+
+    if (!ret)
+    {
+        copy_key_value_info( info_class, info, length, type, name->Length, total );
+        *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : total);
+        if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
+        else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
     }
-    SERVER_END_REQ;
     return ret;
 }
 
@@ -564,8 +725,68 @@ NTSTATUS WINAPI NtQueryValueKey( HANDLE handle, const UNICODE_STRING *name,
 NTSTATUS WINAPI NtQueryMultipleValueKey( HANDLE key, KEY_MULTIPLE_VALUE_INFORMATION *info,
                                          ULONG count, void *buffer, ULONG length, ULONG *retlen )
 {
-    FIXME( "(%p,%p,0x%08x,%p,0x%08x,%p) stub!\n", key, info, count, buffer, length, retlen );
-    return STATUS_SUCCESS;
+    struct __server_request_info *reqs, **ptrs;
+    struct get_key_value_request *req;
+    ULONG i, pos = 0;
+    unsigned int ret;
+
+    TRACE( "(%p,%p,0x%08x,%p,0x%08x,%p)\n", key, info, count, buffer, length, retlen );
+
+    for (i = 0; i < count; i++)
+        if (info[i].ValueName->Length > MAX_VALUE_LENGTH) return STATUS_OBJECT_NAME_NOT_FOUND;
+
+    if (!(reqs = malloc( count * (sizeof(*reqs) + sizeof(*ptrs)) ))) return STATUS_NO_MEMORY;
+    ptrs = (struct __server_request_info **)(reqs + count);
+
+    /* first retrieve the type and size of all the values in one round-trip */
+    for (i = 0; i < count; i++)
+    {
+        req = SERVER_BATCH_REQ( &reqs[i], get_key_value );
+        req->hkey = wine_server_obj_handle( key );
+        wine_server_add_data( &reqs[i], info[i].ValueName->Buffer, info[i].ValueName->Length );
+        ptrs[i] = &reqs[i];
+    }
+    if (!count) ret = STATUS_SUCCESS;
+    else if (!(ret = server_call_batch( ptrs, count )))
+    {
+        for (i = 0; i < count; i++)
+        {
+            if ((ret = reqs[i].u.reply.reply_header.error)) break;
+            pos = (pos + sizeof(ULONG) - 1) & ~(sizeof(ULONG) - 1);
+            info[i].Type       = SERVER_BATCH_REPLY( &reqs[i], get_key_value )->type;
+            info[i].DataLength = SERVER_BATCH_REPLY( &reqs[i], get_key_value )->total;
+            info[i].DataOffset = pos;
+            pos += info[i].DataLength;
+        }
+    }
+
+    /* then retrieve the data directly into the buffer in a second one */
+    if (!ret && pos > length) ret = STATUS_BUFFER_TOO_SMALL;
+    else if (!ret && pos)
+    {
+        for (i = 0; i < count; i++)
+        {
+            req = SERVER_BATCH_REQ( &reqs[i], get_key_value );
+            req->hkey = wine_server_obj_handle( key );
+            wine_server_add_data( &reqs[i], info[i].ValueName->Buffer, info[i].ValueName->Length );
+            wine_server_set_reply( &reqs[i], (char *)buffer + info[i].DataOffset, info[i].DataLength );
+        }
+        if (!(ret = server_call_batch( ptrs, count )))
+        {
+            for (i = 0; i < count && !ret; i++)
+            {
+                if ((ret = reqs[i].u.reply.reply_header.error)) break;
+                info[i].Type = SERVER_BATCH_REPLY( &reqs[i], get_key_value )->type;
+                /* the value may have grown in the meantime */
+                if (SERVER_BATCH_REPLY( &reqs[i], get_key_value )->total > info[i].DataLength)
+                    ret = STATUS_BUFFER_TOO_SMALL;
+            }
+        }
+    }
+
+    if (retlen && (!ret || ret == STATUS_BUFFER_TOO_SMALL)) *retlen = pos;
+    free( reqs );
+    return ret;
 }
 
 
@@ -312,6 +312,73 @@ unsigned int CDECL wine_server_call( void *req_ptr )
 }
 
 
+/***********************************************************************
+ *           server_call_batch
+ *
+ * Perform several independent server calls in a single round-trip. The
+ * replies are stored in the individual requests; the return value is the
+ * status of the batch itself, requests that haven't been executed get it
+ * as their error code.
+ */
+unsigned int server_call_batch( struct __server_request_info **reqs, unsigned int count )
+{
+    data_size_t size = 0, reply_size = 0, pos;
+    unsigned int i, j, ret;
+    char *data, *reply_data;
+
+    for (i = 0; i < count; i++)
+    {
+        size += sizeof(reqs[i]->u.req) + ((reqs[i]->u.req.request_header.request_size + 7) & ~7);
+        reply_size += sizeof(reqs[i]->u.reply) + reqs[i]->u.req.request_header.reply_size;
+    }
+    if (!(data = malloc( size + reply_size ))) return STATUS_NO_MEMORY;
+    reply_data = data + size;
+
+    for (i = pos = 0; i < count; i++)
+    {
+        memcpy( data + pos, &reqs[i]->u.req, sizeof(reqs[i]->u.req) );
+        pos += sizeof(reqs[i]->u.req);
+        for (j = 0; j < reqs[i]->data_count; j++)
+        {
+            memcpy( data + pos, reqs[i]->data[j].ptr, reqs[i]->data[j].size );
+            pos += reqs[i]->data[j].size;
+        }
+        memset( data + pos, 0, -pos & 7 );
+        pos = (pos + 7) & ~7;
+    }
+
+    SERVER_START_REQ( batch )
+    {
+        wine_server_add_data( req, data, size );
+        wine_server_set_reply( req, reply_data, reply_size );
+        ret = wine_server_call( req );
+        reply_size = wine_server_reply_size( reply );
+    }
+    SERVER_END_REQ;
+
+    for (i = pos = 0; i < count; i++)
+    {
+        struct __server_request_info *info = reqs[i];
+
+        if (reply_size - pos < sizeof(info->u.reply))
+        {
+            memset( &info->u.reply, 0, sizeof(info->u.reply) );
+            info->u.reply.reply_header.error = ret ? ret : STATUS_INTERNAL_ERROR;
+            pos = reply_size;
+            continue;
+        }
+        memcpy( &info->u.reply, reply_data + pos, sizeof(info->u.reply) );
+        pos += sizeof(info->u.reply);
+        if (info->u.reply.reply_header.reply_size)
+            memcpy( info->reply_data, reply_data + pos, info->u.reply.reply_header.reply_size );
+        pos += info->u.reply.reply_header.reply_size;
+    }
+
+    free( data );
+    return ret;
+}
+
+
 /***********************************************************************
  *           unixcall_wine_server_call
  *
@@ -1012,6 +1079,12 @@ static int receive_fd( obj_handle_t *handle )
 /***********************************************************************/
 /* fd cache support */
 
+/* The cache is read without locking. A thread that retrieves an fd from the server
+ * first reserves the cache entry with a unique pending value, and only stores the fd
+ * if the entry still holds that value. Closing a handle marks the entry as closing
+ * for the duration of the server call, so that an fd retrieved concurrently for the
+ * old object can never be stored for a new object reusing the same handle value. */
+
 union fd_cache_entry
 {
     LONG64 data;
@@ -1029,8 +1102,13 @@ C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 #define FD_CACHE_BLOCK_SIZE  (65536 / sizeof(union fd_cache_entry))
 #define FD_CACHE_ENTRIES     128
 
+/* access values of FD_TYPE_INVALID entries that don't store an error */
+#define FD_CACHE_PENDING     1
+#define FD_CACHE_CLOSING     2
+
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
+static LONG fd_cache_ticket;
 
 static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 {
@@ -1041,42 +1119,72 @@ static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 
 
 /***********************************************************************
- *           add_fd_to_cache
+ *           get_fd_cache_entry
  *
- * Caller must hold fd_cache_mutex.
+ * Return the cache entry of a handle, allocating its block if needed.
  */
-static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
-                            unsigned int access, unsigned int options )
+static union fd_cache_entry *get_fd_cache_entry( HANDLE handle )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
-    union fd_cache_entry cache;
 
-    if (entry >= FD_CACHE_ENTRIES)
-    {
-        FIXME( "too many allocated handles, not caching %p\n", handle );
-        return FALSE;
-    }
+    if (entry >= FD_CACHE_ENTRIES) return NULL;
 
     if (!fd_cache[entry])  /* do we need to allocate a new block of entries? */
     {
-        if (!entry) fd_cache[0] = fd_cache_initial_block;
+        if (!entry) InterlockedCompareExchangePointer( (void **)&fd_cache[0], fd_cache_initial_block, NULL );
         else
         {
-            void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry),
-                                         PROT_READ | PROT_WRITE );
-            if (ptr == MAP_FAILED) return FALSE;
-            fd_cache[entry] = ptr;
+            static const size_t size = FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry);
+            void *ptr = anon_mmap_alloc( size, PROT_READ | PROT_WRITE );
+            if (ptr == MAP_FAILED) return NULL;
+            if (InterlockedCompareExchangePointer( (void **)&fd_cache[entry], ptr, NULL ))
+                munmap( ptr, size ); /* someone beat us to it */
         }
     }
+    return &fd_cache[entry][idx];
+}
+
+
+/***********************************************************************
+ *           reserve_fd_cache_entry
+ *
+ * Reserve the cache entry of a handle before retrieving its fd from the server.
+ */
+static union fd_cache_entry *reserve_fd_cache_entry( HANDLE handle, union fd_cache_entry *pending )
+{
+    union fd_cache_entry *entry;
+
+    if (!(entry = get_fd_cache_entry( handle )))
+    {
+        FIXME( "too many allocated handles, not caching %p\n", handle );
+        return NULL;
+    }
+    pending->data = 0;
+    pending->s.fd = InterlockedIncrement( &fd_cache_ticket );
+    pending->s.type = FD_TYPE_INVALID;
+    pending->s.access = FD_CACHE_PENDING;
+    if (InterlockedCompareExchange64( &entry->data, pending->data, 0 )) return NULL;
+    return entry;
+}
+
+
+/***********************************************************************
+ *           add_fd_to_cache
+ *
+ * Store an fd in a reserved cache entry; fails if the handle was closed in the meantime.
+ */
+static BOOL add_fd_to_cache( union fd_cache_entry *entry, union fd_cache_entry pending, int fd,
+                             enum server_fd_type type, unsigned int access, unsigned int options )
+{
+    union fd_cache_entry cache;
 
     /* store fd+1 so that 0 can be used as the unset value */
+    cache.data = 0;
     cache.s.fd = fd + 1;
     cache.s.type = type;
     cache.s.access = access;
     cache.s.options = options;
-    cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, cache.data );
-    assert( !cache.s.fd );
-    return TRUE;
+    return InterlockedCompareExchange64( &entry->data, cache.data, pending.data ) == pending.data;
 }
 
 
@@ -1095,7 +1203,8 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
     if (!cache.data) return STATUS_INVALID_HANDLE;
 
     /* if fd type is invalid, fd stores an error value */
-    if (cache.s.type == FD_TYPE_INVALID) return cache.s.fd - 1;
+    if (cache.s.type == FD_TYPE_INVALID)
+        return cache.s.access ? STATUS_INVALID_HANDLE : cache.s.fd - 1;
 
     *fd = cache.s.fd - 1;
     if (type) *type = cache.s.type;
@@ -1105,22 +1214,44 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
 }
 
 
+static inline union fd_cache_entry closing_fd_cache_entry(void)
+{
+    union fd_cache_entry cache;
+
+    cache.data = 0;
+    cache.s.type = FD_TYPE_INVALID;
+    cache.s.access = FD_CACHE_CLOSING;
+    return cache;
+}
+
+
 /***********************************************************************
  *           remove_fd_from_cache
+ *
+ * Mark the cache entry of a handle that is being closed, and return the cached fd.
+ * The entry must be released with release_fd_cache_entry once the handle is closed.
  */
-static int remove_fd_from_cache( HANDLE handle )
+static union fd_cache_entry *remove_fd_from_cache( HANDLE handle, int *fd )
 {
-    unsigned int entry, idx = handle_to_index( handle, &entry );
-    int fd = -1;
+    union fd_cache_entry *entry, cache;
 
-    if (entry < FD_CACHE_ENTRIES && fd_cache[entry])
-    {
-        union fd_cache_entry cache;
-        cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, 0 );
-        if (cache.s.type != FD_TYPE_INVALID) fd = cache.s.fd - 1;
-    }
+    *fd = -1;
+    if (!(entry = get_fd_cache_entry( handle ))) return NULL;
+
+    cache.data = interlocked_xchg64( &entry->data, closing_fd_cache_entry().data );
+    if (cache.s.type != FD_TYPE_INVALID) *fd = cache.s.fd - 1;
+    return entry;
+}
 
-    return fd;
+
+/***********************************************************************
+ *           release_fd_cache_entry
+ *
+ * Release a cache entry that was reserved or marked as closing.
+ */
+static void release_fd_cache_entry( union fd_cache_entry *entry, union fd_cache_entry marker )
+{
+    if (entry) InterlockedCompareExchange64( &entry->data, 0, marker.data );
 }
 
 
@@ -1132,6 +1263,7 @@ static int remove_fd_from_cache( HANDLE handle )
 int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                         int *needs_close, enum server_fd_type *type, unsigned int *options )
 {
+    union fd_cache_entry *entry, pending;
     sigset_t sigset;
     obj_handle_t fd_handle;
     int ret, fd = -1;
@@ -1144,34 +1276,34 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     ret = get_cached_fd( handle, &fd, type, &access, options );
     if (ret != STATUS_INVALID_HANDLE) goto done;
 
+    /* the mutex ensures that we receive the fd matching our request */
     server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
-    ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret == STATUS_INVALID_HANDLE)
+    /* if the entry is busy, retrieve the fd without caching it */
+    entry = reserve_fd_cache_entry( handle, &pending );
+    SERVER_START_REQ( get_handle_fd )
     {
-        SERVER_START_REQ( get_handle_fd )
+        req->handle = wine_server_obj_handle( handle );
+        if (!(ret = wine_server_call( req )))
         {
-            req->handle = wine_server_obj_handle( handle );
-            if (!(ret = wine_server_call( req )))
+            if (type) *type = reply->type;
+            if (options) *options = reply->options;
+            access = reply->access;
+            if ((fd = receive_fd( &fd_handle )) != -1)
             {
-                if (type) *type = reply->type;
-                if (options) *options = reply->options;
-                access = reply->access;
-                if ((fd = receive_fd( &fd_handle )) != -1)
-                {
-                    assert( wine_server_ptr_handle(fd_handle) == handle );
-                    *needs_close = (!reply->cacheable ||
-                                    !add_fd_to_cache( handle, fd, reply->type,
-                                                      reply->access, reply->options ));
-                }
-                else ret = STATUS_TOO_MANY_OPENED_FILES;
-            }
-            else if (reply->cacheable)
-            {
-                add_fd_to_cache( handle, ret, FD_TYPE_INVALID, 0, 0 );
+                assert( wine_server_ptr_handle(fd_handle) == handle );
+                *needs_close = (!reply->cacheable || !entry ||
+                                !add_fd_to_cache( entry, pending, fd, reply->type,
+                                                  reply->access, reply->options ));
             }
+            else ret = STATUS_TOO_MANY_OPENED_FILES;
+        }
+        else if (reply->cacheable && entry)
+        {
+            add_fd_to_cache( entry, pending, ret, FD_TYPE_INVALID, 0, 0 );
         }
-        SERVER_END_REQ;
     }
+    SERVER_END_REQ;
+    release_fd_cache_entry( entry, pending );
     server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
 
 done:
@@ -1185,6 +1317,517 @@ done:
 }
 
 
+/***********************************************************************/
+/* in-process synchronization support */
+
+union inproc_sync_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        unsigned int index : 22;
+        unsigned int type : 3;
+        unsigned int valid : 1;
+        unsigned int access : 21;      /* specific and standard access rights */
+        unsigned int generation : 11;  /* low bits of the slot generation */
+    } s;
+};
+
+C_ASSERT( sizeof(union inproc_sync_cache_entry) == sizeof(LONG64) );
+
+#define INPROC_SYNC_PER_BLOCK  (INPROC_SYNC_BLOCK_SIZE / sizeof(inproc_sync_shm_t))
+#define INPROC_SYNC_MAX_BLOCKS 4096
+#define INPROC_SYNC_GENERATION_MASK ((1 << 11) - 1)
+
+C_ASSERT( INPROC_SYNC_MAX_BLOCKS * INPROC_SYNC_PER_BLOCK <= (1 << 22) );
+
+static union inproc_sync_cache_entry *inproc_sync_cache[FD_CACHE_ENTRIES];
+static inproc_sync_shm_t *inproc_sync_blocks[INPROC_SYNC_MAX_BLOCKS];
+static int inproc_sync_fd = -1;
+static BOOL inproc_sync_disabled;
+
+
+/***********************************************************************
+ *           map_inproc_sync_block
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static inproc_sync_shm_t *map_inproc_sync_block( unsigned int block )
+{
+    obj_handle_t fd_handle;
+    void *ptr;
+
+    if (inproc_sync_blocks[block]) return inproc_sync_blocks[block];
+
+    if (inproc_sync_fd == -1)
+    {
+        NTSTATUS ret;
+
+        SERVER_START_REQ( get_inproc_sync_fd )
+        {
+            if (!(ret = wine_server_call( req )))
+            {
+                inproc_sync_fd = receive_fd( &fd_handle );
+                assert( !fd_handle );
+            }
+        }
+        SERVER_END_REQ;
+        if (ret == STATUS_NOT_IMPLEMENTED) inproc_sync_disabled = TRUE;
+        if (inproc_sync_fd == -1) return NULL;
+    }
+
+    ptr = mmap( NULL, INPROC_SYNC_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                inproc_sync_fd, (off_t)block * INPROC_SYNC_BLOCK_SIZE );
+    if (ptr == MAP_FAILED) return NULL;
+    return inproc_sync_blocks[block] = ptr;
+}
+
+
+/***********************************************************************
+ *           add_inproc_sync_to_cache
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static void add_inproc_sync_to_cache( HANDLE handle, union inproc_sync_cache_entry cache )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry >= FD_CACHE_ENTRIES) return;
+
+    if (!inproc_sync_cache[entry])
+    {
+        void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(union inproc_sync_cache_entry),
+                                     PROT_READ | PROT_WRITE );
+        if (ptr == MAP_FAILED) return;
+        inproc_sync_cache[entry] = ptr;
+    }
+    interlocked_xchg64( &inproc_sync_cache[entry][idx].data, cache.data );
+}
+
+
+/***********************************************************************
+ *           get_cached_inproc_sync
+ */
+static inline BOOL get_cached_inproc_sync( HANDLE handle, union inproc_sync_cache_entry *cache )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry >= FD_CACHE_ENTRIES || !inproc_sync_cache[entry]) return FALSE;
+    cache->data = InterlockedCompareExchange64( &inproc_sync_cache[entry][idx].data, 0, 0 );
+    return cache->s.valid;
+}
+
+
+/***********************************************************************
+ *           remove_inproc_sync_from_cache
+ */
+static void remove_inproc_sync_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry < FD_CACHE_ENTRIES && inproc_sync_cache[entry])
+        interlocked_xchg64( &inproc_sync_cache[entry][idx].data, 0 );
+}
+
+
+/***********************************************************************
+ *           lock_inproc_sync_cache
+ *
+ * Lock the cache while closing a handle, unless in-process synchronization is disabled.
+ */
+static BOOL lock_inproc_sync_cache( sigset_t *sigset )
+{
+    if (inproc_sync_disabled) return FALSE;
+    server_enter_uninterrupted_section( &fd_cache_mutex, sigset );
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           get_inproc_sync
+ *
+ * Retrieve the shared state of an event, mutex or semaphore handle; INPROC_SYNC_UNKNOWN
+ * matches any type. Returns STATUS_NOT_IMPLEMENTED if the caller needs to go through the server.
+ */
+NTSTATUS get_inproc_sync( HANDLE handle, enum inproc_sync_type type, ACCESS_MASK access,
+                          inproc_sync_shm_t **sync )
+{
+    unsigned int entry;
+    union inproc_sync_cache_entry cache;
+    inproc_sync_shm_t *block;
+    sigset_t sigset;
+
+    if (inproc_sync_disabled) return STATUS_NOT_IMPLEMENTED;
+    /* pseudo-handles and handles that can't be cached always go through the server */
+    handle_to_index( handle, &entry );
+    if (entry >= FD_CACHE_ENTRIES) return STATUS_NOT_IMPLEMENTED;
+
+    if (!get_cached_inproc_sync( handle, &cache ))
+    {
+        NTSTATUS ret;
+
+        server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+        if (!get_cached_inproc_sync( handle, &cache ))
+        {
+            SERVER_START_REQ( get_inproc_sync )
+            {
+                req->handle = wine_server_obj_handle( handle );
+                if (!(ret = wine_server_call( req )))
+                {
+                    cache.data = 0;
+                    cache.s.valid = 1;
+                    cache.s.type = reply->type;
+                    cache.s.index = reply->index;
+                    cache.s.access = reply->access & ((1 << 21) - 1);
+                    cache.s.generation = reply->generation & INPROC_SYNC_GENERATION_MASK;
+                }
+            }
+            SERVER_END_REQ;
+
+            if (ret == STATUS_NOT_IMPLEMENTED) inproc_sync_disabled = TRUE;
+            else if (!ret && cache.s.type != INPROC_SYNC_UNKNOWN &&
+                     !map_inproc_sync_block( cache.s.index / INPROC_SYNC_PER_BLOCK ))
+                cache.s.type = INPROC_SYNC_UNKNOWN;
+            if (!ret) add_inproc_sync_to_cache( handle, cache );
+        }
+        server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+        if (!cache.s.valid) return STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (cache.s.type == INPROC_SYNC_UNKNOWN) return STATUS_NOT_IMPLEMENTED;
+    if (type != INPROC_SYNC_UNKNOWN && cache.s.type != type) return STATUS_NOT_IMPLEMENTED;
+    if ((access & cache.s.access) != access) return STATUS_NOT_IMPLEMENTED;
+    if (!(block = inproc_sync_blocks[cache.s.index / INPROC_SYNC_PER_BLOCK])) return STATUS_NOT_IMPLEMENTED;
+    *sync = &block[cache.s.index % INPROC_SYNC_PER_BLOCK];
+    /* the slot may have been reused if the handle was closed by another thread or process */
+    if (ReadAcquire( (LONG *)&(*sync)->type ) != cache.s.type) return STATUS_NOT_IMPLEMENTED;
+    if (((*sync)->generation & INPROC_SYNC_GENERATION_MASK) != cache.s.generation) return STATUS_NOT_IMPLEMENTED;
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************/
+/* completion ring support */
+
+#define COMPLETION_RINGS_PER_BLOCK  (COMPLETION_RING_BLOCK_SIZE / sizeof(completion_ring_t))
+#define COMPLETION_RING_MAX_BLOCKS  1024
+
+union completion_ring_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        unsigned int index;  /* index of the ring in the shared memory */
+        unsigned int id;     /* unique id of the port, 0 if it doesn't have a ring */
+    } s;
+};
+
+C_ASSERT( sizeof(union completion_ring_cache_entry) == sizeof(LONG64) );
+
+static union completion_ring_cache_entry *completion_ring_cache[FD_CACHE_ENTRIES];
+static completion_ring_t *completion_ring_blocks[COMPLETION_RING_MAX_BLOCKS];
+static int completion_ring_fd = -1;
+
+
+/***********************************************************************
+ *           map_completion_ring_block
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static completion_ring_t *map_completion_ring_block( unsigned int block )
+{
+    obj_handle_t fd_handle;
+    void *ptr;
+
+    if (block >= COMPLETION_RING_MAX_BLOCKS) return NULL;
+    if (completion_ring_blocks[block]) return completion_ring_blocks[block];
+
+    if (completion_ring_fd == -1)
+    {
+        SERVER_START_REQ( get_completion_ring_fd )
+        {
+            if (!wine_server_call( req ))
+            {
+                completion_ring_fd = receive_fd( &fd_handle );
+                assert( !fd_handle );
+            }
+        }
+        SERVER_END_REQ;
+        if (completion_ring_fd == -1) return NULL;
+    }
+
+    ptr = mmap( NULL, COMPLETION_RING_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                completion_ring_fd, (off_t)block * COMPLETION_RING_BLOCK_SIZE );
+    if (ptr == MAP_FAILED) return NULL;
+    return completion_ring_blocks[block] = ptr;
+}
+
+
+/***********************************************************************
+ *           add_completion_ring_to_cache
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static void add_completion_ring_to_cache( HANDLE handle, union completion_ring_cache_entry cache )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (!completion_ring_cache[entry])
+    {
+        void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(union completion_ring_cache_entry),
+                                     PROT_READ | PROT_WRITE );
+        if (ptr == MAP_FAILED) return;
+        completion_ring_cache[entry] = ptr;
+    }
+    interlocked_xchg64( &completion_ring_cache[entry][idx].data, cache.data );
+}
+
+
+/***********************************************************************
+ *           remove_completion_ring_from_cache
+ */
+static void remove_completion_ring_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry < FD_CACHE_ENTRIES && completion_ring_cache[entry])
+        interlocked_xchg64( &completion_ring_cache[entry][idx].data, 0 );
+}
+
+
+/***********************************************************************
+ *           get_completion_ring
+ *
+ * Retrieve the shared memory ring of a completion port handle, or NULL if the
+ * caller needs to go through the server.
+ */
+completion_ring_t *get_completion_ring( HANDLE handle, unsigned int *id )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union completion_ring_cache_entry cache;
+    completion_ring_t *block;
+    sigset_t sigset;
+
+    if (entry >= FD_CACHE_ENTRIES) return NULL;
+
+    cache.data = 0;
+    if (completion_ring_cache[entry])
+        cache.data = InterlockedCompareExchange64( &completion_ring_cache[entry][idx].data, 0, 0 );
+    if (!cache.data)
+    {
+        NTSTATUS ret;
+
+        server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+        SERVER_START_REQ( get_completion_ring )
+        {
+            req->handle = wine_server_obj_handle( handle );
+            if (!(ret = wine_server_call( req )))
+            {
+                cache.s.id = reply->id;
+                cache.s.index = reply->index;
+            }
+        }
+        SERVER_END_REQ;
+        if (!ret && cache.s.id && !map_completion_ring_block( cache.s.index / COMPLETION_RINGS_PER_BLOCK ))
+            cache.s.id = 0;
+        /* remember that the port doesn't have a usable ring */
+        if (!cache.s.id) cache.s.index = ~0u;
+        if (!ret || ret == STATUS_ACCESS_DENIED) add_completion_ring_to_cache( handle, cache );
+        server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+        if (ret) return NULL;
+    }
+
+    if (!cache.s.id) return NULL;
+    if (!(block = completion_ring_blocks[cache.s.index / COMPLETION_RINGS_PER_BLOCK])) return NULL;
+    *id = cache.s.id;
+    return &block[cache.s.index % COMPLETION_RINGS_PER_BLOCK];
+}
+
+
+/* a view of the session shared memory */
+struct session_view
+{
+    const char *data;
+    SIZE_T      size;
+};
+
+static pthread_mutex_t session_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct session_view * volatile session_view;
+
+
+/***********************************************************************
+ *           get_session_object
+ *
+ * Return a shared object of the session shared memory, mapping it again if
+ * it has grown. Old views are kept around as other threads may still be
+ * reading from them.
+ */
+const shared_object_t *get_session_object( struct obj_locator locator )
+{
+    static const WCHAR nameW[] = {'\\','K','e','r','n','e','l','O','b','j','e','c','t','s','\\',
+                                  '_','_','w','i','n','e','_','s','e','s','s','i','o','n',0};
+    UNICODE_STRING name = RTL_CONSTANT_STRING( nameW );
+    struct session_view *view = session_view;
+    const shared_object_t *object = NULL;
+    OBJECT_ATTRIBUTES attr;
+    HANDLE section = 0;
+    void *data = NULL;
+    SIZE_T size = 0;
+    sigset_t sigset;
+
+    if (!locator.id) return NULL;
+    if (view && locator.offset + sizeof(*object) <= view->size)
+        return (const shared_object_t *)(view->data + locator.offset);
+
+    server_enter_uninterrupted_section( &session_mutex, &sigset );
+    if (!(view = session_view) || locator.offset + sizeof(*object) > view->size)
+    {
+        InitializeObjectAttributes( &attr, &name, 0, NULL, NULL );
+        if (!NtOpenSection( &section, SECTION_MAP_READ, &attr ) &&
+            !NtMapViewOfSection( section, NtCurrentProcess(), &data, 0, 0, NULL, &size,
+                                 ViewUnmap, 0, PAGE_READONLY ) &&
+            (view = malloc( sizeof(*view) )))
+        {
+            view->data = data;
+            view->size = size;
+            InterlockedExchangePointer( (void **)&session_view, view );
+        }
+    }
+    if (view && locator.offset + sizeof(*object) <= view->size)
+        object = (const shared_object_t *)(view->data + locator.offset);
+    server_leave_uninterrupted_section( &session_mutex, &sigset );
+
+    if (section) NtClose( section );
+    return object;
+}
+
+
+struct socket_fast_cache_entry
+{
+    LONG64       id;       /* id of the shared object that revokes the entry, 0 if unused */
+    mem_size_t   offset;   /* offset of the shared object in the session memory */
+    unsigned int flags;    /* SOCKET_FAST_* flags */
+    unsigned int options;  /* device open options */
+};
+
+static struct socket_fast_cache_entry *socket_fast_cache[FD_CACHE_ENTRIES];
+
+static int socket_fast_path_enabled = -1;
+
+
+/***********************************************************************
+ *           add_socket_fast_path_to_cache
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static void add_socket_fast_path_to_cache( HANDLE handle, struct obj_locator locator,
+                                           unsigned int flags, unsigned int options )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    struct socket_fast_cache_entry *cache;
+
+    if (entry >= FD_CACHE_ENTRIES) return;
+    if (!socket_fast_cache[entry])
+    {
+        void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(struct socket_fast_cache_entry),
+                                     PROT_READ | PROT_WRITE );
+        if (ptr == MAP_FAILED) return;
+        socket_fast_cache[entry] = ptr;
+    }
+    cache = &socket_fast_cache[entry][idx];
+    /* readers check that the id didn't change while they read the other fields */
+    interlocked_xchg64( &cache->id, 0 );
+    cache->offset  = locator.offset;
+    cache->flags   = flags;
+    cache->options = options;
+    interlocked_xchg64( &cache->id, locator.id );
+}
+
+
+/***********************************************************************
+ *           remove_socket_fast_path_from_cache
+ *
+ * Forget the cached state of a socket, it will be queried again from the server.
+ */
+void remove_socket_fast_path_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry < FD_CACHE_ENTRIES && socket_fast_cache[entry])
+        interlocked_xchg64( &socket_fast_cache[entry][idx].id, 0 );
+}
+
+
+/***********************************************************************
+ *           get_cached_socket_fast_path
+ *
+ * Retrieve the cached state of a socket, if the server didn't revoke it.
+ */
+static BOOL get_cached_socket_fast_path( unsigned int entry, unsigned int idx,
+                                         unsigned int *flags, unsigned int *options )
+{
+    struct socket_fast_cache_entry *cache;
+    const shared_object_t *object;
+    struct obj_locator locator;
+
+    if (!socket_fast_cache[entry]) return FALSE;
+    cache = &socket_fast_cache[entry][idx];
+    if (!(locator.id = ReadAcquire64( &cache->id ))) return FALSE;
+    locator.offset = cache->offset;
+    *flags   = cache->flags;
+    *options = cache->options;
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    if (ReadNoFence64( &cache->id ) != locator.id) return FALSE;
+
+    /* the server gives the object a new id when the socket gets another handle */
+    if (!(object = get_session_object( locator ))) return FALSE;
+    return ReadNoFence64( (const LONG64 *)&object->id ) == locator.id;
+}
+
+
+/***********************************************************************
+ *           get_socket_fast_path
+ *
+ * Retrieve the SOCKET_FAST_* flags of a socket handle, telling whether
+ * nonblocking I/O can be done without going through the server.
+ */
+unsigned int get_socket_fast_path( HANDLE handle, unsigned int *options )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    unsigned int flags;
+    sigset_t sigset;
+
+    if (socket_fast_path_enabled == -1)
+    {
+        const char *env = getenv( "WINESOCKETFASTPATH" );
+        socket_fast_path_enabled = env && atoi( env );
+    }
+    if (!socket_fast_path_enabled || entry >= FD_CACHE_ENTRIES) return 0;
+
+    if (!get_cached_socket_fast_path( entry, idx, &flags, options ))
+    {
+        NTSTATUS ret;
+
+        server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+        SERVER_START_REQ( get_socket_fast_path )
+        {
+            req->handle = wine_server_obj_handle( handle );
+            if (!(ret = wine_server_call( req )))
+            {
+                flags = reply->flags;
+                *options = reply->options;
+                if (reply->locator.id)
+                    add_socket_fast_path_to_cache( handle, reply->locator, flags, *options );
+            }
+        }
+        SERVER_END_REQ;
+        server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+        if (ret) return 0;
+    }
+    return flags;
+}
+
+
 /***********************************************************************
  *           wine_server_fd_to_handle
  */
@@ -1570,6 +2213,7 @@ size_t server_init_process(void)
 {
     const char *arch = getenv( "WINEARCH" );
     const char *env_socket = getenv( "WINESERVERSOCKET" );
+    const char *env;
     obj_handle_t version;
     unsigned int i;
     int ret, reply_pipe;
@@ -1578,6 +2222,8 @@ size_t server_init_process(void)
     DWORD pid, tid;
 
     server_pid = -1;
+    /* in-process synchronization is enabled per process */
+    if (!(env = getenv( "WINEINPROCSYNC" )) || !atoi( env )) inproc_sync_disabled = TRUE;
     if (env_socket)
     {
         fd_socket = atoi( env_socket );
@@ -1798,8 +2444,10 @@ NTSTATUS WINAPI NtAllocateReserveObject( HANDLE *handle, const OBJECT_ATTRIBUTES
 NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE dest_process, HANDLE *dest,
                                    ACCESS_MASK access, ULONG attributes, ULONG options )
 {
+    union fd_cache_entry *entry = NULL;
     sigset_t sigset;
     unsigned int ret;
+    BOOL locked = FALSE;
     int fd = -1;
 
     if (dest) *dest = 0;
@@ -1825,12 +2473,18 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
         return result.dup_handle.status;
     }
 
-    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
-
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
     if (options & DUPLICATE_CLOSE_SOURCE)
-        fd = remove_fd_from_cache( source );
+    {
+        locked = lock_inproc_sync_cache( &sigset );
+        entry = remove_fd_from_cache( source, &fd );
+        remove_inproc_sync_from_cache( source );
+        remove_completion_ring_from_cache( source );
+        invalidate_key_value_cache( source );
+    }
+    /* the socket is no longer owned by a single handle */
+    if (source_process == NtCurrentProcess()) remove_socket_fast_path_from_cache( source );
 
     SERVER_START_REQ( dup_handle )
     {
@@ -1847,7 +2501,8 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
     }
     SERVER_END_REQ;
 
-    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    release_fd_cache_entry( entry, closing_fd_cache_entry() );
+    if (locked) server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
 
     if (fd != -1) close( fd );
     return ret;
@@ -1888,19 +2543,25 @@ NTSTATUS WINAPI NtCompareTokens( HANDLE first, HANDLE second, BOOLEAN *equal )
  */
 NTSTATUS WINAPI NtClose( HANDLE handle )
 {
+    union fd_cache_entry *entry;
     sigset_t sigset;
     HANDLE port;
     unsigned int ret;
+    BOOL locked;
     int fd;
 
     if (HandleToLong( handle ) >= ~5 && HandleToLong( handle ) <= ~0)
         return STATUS_SUCCESS;
 
-    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+    locked = lock_inproc_sync_cache( &sigset );
 
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
-    fd = remove_fd_from_cache( handle );
+    entry = remove_fd_from_cache( handle, &fd );
+    remove_inproc_sync_from_cache( handle );
+    remove_completion_ring_from_cache( handle );
+    remove_socket_fast_path_from_cache( handle );
+    invalidate_key_value_cache( handle );
 
     SERVER_START_REQ( close_handle )
     {
@@ -1909,7 +2570,8 @@ NTSTATUS WINAPI NtClose( HANDLE handle )
     }
     SERVER_END_REQ;
 
-    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    release_fd_cache_entry( entry, closing_fd_cache_entry() );
+    if (locked) server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
 
     if (fd != -1) close( fd );
 
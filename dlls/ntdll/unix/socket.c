@@ -25,10 +25,14 @@
 #include "config.h"
 #include <assert.h>
 #include <errno.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#ifdef __linux__
+# include <sys/sendfile.h>
+#endif
 #ifdef HAVE_IFADDRS_H
 # include <ifaddrs.h>
 #endif
@@ -147,6 +151,7 @@ struct async_transmit_ioctl
     unsigned int tail_cursor;   /* amount of tail data already sent */
     unsigned int file_len;      /* total file length to send */
     unsigned int flags;
+    BOOL zero_copy;             /* send the file data directly from the page cache */
     const char *head;
     const char *tail;
     unsigned int head_len;
@@ -709,41 +714,30 @@ static ssize_t fixup_icmp_over_dgram( struct msghdr *hdr, union unix_sockaddr *u
     return recv_len;
 }
 
-static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *size )
+static void init_recv_hdr( struct async_recv_ioctl *async, struct msghdr *hdr, union unix_sockaddr *unix_addr,
+                           char *control_buffer, size_t control_size )
 {
-    char control_buffer[512];
-    union unix_sockaddr unix_addr;
-    struct msghdr hdr;
-    NTSTATUS status;
-    ssize_t ret;
-
-    memset( &hdr, 0, sizeof(hdr) );
+    memset( hdr, 0, sizeof(*hdr) );
     if (async->addr || async->icmp_over_dgram)
     {
-        hdr.msg_name = &unix_addr.addr;
-        hdr.msg_namelen = sizeof(unix_addr);
+        hdr->msg_name = &unix_addr->addr;
+        hdr->msg_namelen = sizeof(*unix_addr);
     }
-    hdr.msg_iov = async->iov;
-    hdr.msg_iovlen = async->count;
-    hdr.msg_control = control_buffer;
-    hdr.msg_controllen = sizeof(control_buffer);
-
-    while ((ret = virtual_locked_recvmsg( fd, &hdr, async->unix_flags )) < 0 && errno == EINTR);
-
-    if (ret < 0)
-    {
-        /* Unix-like systems return EINVAL when attempting to read OOB data from
-         * an empty socket buffer; Windows returns WSAEWOULDBLOCK. */
-        if ((async->unix_flags & MSG_OOB) && errno == EINVAL)
-            errno = EWOULDBLOCK;
+    hdr->msg_iov = async->iov;
+    hdr->msg_iovlen = async->count;
+    hdr->msg_control = control_buffer;
+    hdr->msg_controllen = control_size;
+}
 
-        if (errno != EWOULDBLOCK) WARN( "recvmsg: %s\n", strerror( errno ) );
-        return sock_errno_to_status( errno );
-    }
+/* convert the message received by recvmsg() for the async */
+static NTSTATUS finish_recv( struct async_recv_ioctl *async, struct msghdr *hdr, union unix_sockaddr *unix_addr,
+                             ssize_t ret, ULONG_PTR *size )
+{
+    NTSTATUS status;
 
-    status = (hdr.msg_flags & MSG_TRUNC) ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
+    status = (hdr->msg_flags & MSG_TRUNC) ? STATUS_BUFFER_OVERFLOW : STATUS_SUCCESS;
     if (async->icmp_over_dgram)
-        ret = fixup_icmp_over_dgram( &hdr, &unix_addr, async->io.handle, ret, &status );
+        ret = fixup_icmp_over_dgram( hdr, unix_addr, async->io.handle, ret, &status );
 
     if (async->control)
     {
@@ -757,7 +751,7 @@ static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *siz
 
             wsabuf.len = sizeof(control_buffer64);
             wsabuf.buf = control_buffer64;
-            if (convert_control_headers( &hdr, &wsabuf ))
+            if (convert_control_headers( hdr, &wsabuf ))
             {
                 if (!wow64_translate_control( &wsabuf, async->control ))
                 {
@@ -775,7 +769,7 @@ static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *siz
         }
         else
         {
-            if (!convert_control_headers( &hdr, async->control ))
+            if (!convert_control_headers( hdr, async->control ))
             {
                 WARN( "Application passed insufficient room for control headers.\n" );
                 *async->ret_flags |= WS_MSG_CTRUNC;
@@ -790,13 +784,155 @@ static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *siz
      * MSDN says that the address is ignored for connection-oriented sockets, so
      * don't try to translate it.
      */
-    if (async->addr && hdr.msg_namelen)
-        *async->addr_len = sockaddr_from_unix( &unix_addr, async->addr, *async->addr_len );
+    if (async->addr && hdr->msg_namelen)
+        *async->addr_len = sockaddr_from_unix( unix_addr, async->addr, *async->addr_len );
 
     *size = ret;
     return status;
 }
 
+static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *size )
+{
+    char control_buffer[512];
+    union unix_sockaddr unix_addr;
+    struct msghdr hdr;
+    ssize_t ret;
+
+    init_recv_hdr( async, &hdr, &unix_addr, control_buffer, sizeof(control_buffer) );
+
+    while ((ret = virtual_locked_recvmsg( fd, &hdr, async->unix_flags )) < 0 && errno == EINTR);
+
+    if (ret < 0)
+    {
+        /* Unix-like systems return EINVAL when attempting to read OOB data from
+         * an empty socket buffer; Windows returns WSAEWOULDBLOCK. */
+        if ((async->unix_flags & MSG_OOB) && errno == EINVAL)
+            errno = EWOULDBLOCK;
+
+        if (errno != EWOULDBLOCK) WARN( "recvmsg: %s\n", strerror( errno ) );
+        return sock_errno_to_status( errno );
+    }
+
+    return finish_recv( async, &hdr, &unix_addr, ret, size );
+}
+
+static BOOL async_recv_proc( void *user, ULONG_PTR *info, unsigned int *status );
+
+/* retrieve the asyncs that the server claimed for a batch along with the current one */
+static unsigned int get_socket_batch( HANDLE handle, BOOL write, struct async_batch_entry *entries )
+{
+    unsigned int count = 0;
+
+    SERVER_START_REQ( socket_get_batch )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        req->write  = write;
+        wine_server_set_reply( req, entries, (SOCKET_IO_BATCH_MAX - 1) * sizeof(*entries) );
+        if (!wine_server_call( req )) count = wine_server_reply_size( reply ) / sizeof(*entries);
+    }
+    SERVER_END_REQ;
+    return count;
+}
+
+/* report the results of the claimed asyncs, STATUS_PENDING puts them back in the queue */
+static void set_socket_batch( HANDLE handle, BOOL write, const struct async_batch_entry *entries,
+                              unsigned int count )
+{
+    SERVER_START_REQ( socket_set_batch )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        req->write  = write;
+        wine_server_add_data( req, entries, count * sizeof(*entries) );
+        wine_server_call( req );
+    }
+    SERVER_END_REQ;
+}
+
+/* put the claimed asyncs back in the queue without processing them */
+static void restart_socket_batch( HANDLE handle, BOOL write )
+{
+    struct async_batch_entry entries[SOCKET_IO_BATCH_MAX - 1];
+    unsigned int i, count = get_socket_batch( handle, write, entries );
+
+    for (i = 0; i < count; i++) entries[i].status = STATUS_PENDING;
+    if (count) set_socket_batch( handle, write, entries, count );
+}
+
+/* receive the datagrams of the current async and of the claimed ones with a single recvmmsg() */
+static NTSTATUS try_recv_batch( int fd, struct async_recv_ioctl *async, ULONG_PTR *size )
+{
+    struct async_batch_entry entries[SOCKET_IO_BATCH_MAX - 1];
+    struct async_recv_ioctl *asyncs[SOCKET_IO_BATCH_MAX];
+    unsigned int i, count, batch = 1;
+    NTSTATUS status = STATUS_SUCCESS;
+    int received = 0;
+
+    count = get_socket_batch( async->io.handle, FALSE, entries );
+    asyncs[0] = async;
+    if (!async->icmp_over_dgram)
+    {
+        /* stop at the first async that needs to be handled separately, to keep the order */
+        for (i = 0; i < count; i++)
+        {
+            struct async_recv_ioctl *next = wine_server_get_ptr( entries[i].user );
+
+            if (next->io.callback != async_recv_proc || next->unix_flags != async->unix_flags ||
+                next->icmp_over_dgram)
+                break;
+            asyncs[batch++] = next;
+        }
+    }
+
+#ifdef __linux__
+    if (batch > 1)
+    {
+        static const size_t control_size = 512;
+        union unix_sockaddr unix_addrs[SOCKET_IO_BATCH_MAX];
+        struct mmsghdr msgs[SOCKET_IO_BATCH_MAX];
+        char *control;
+
+        if ((control = malloc( batch * control_size )))
+        {
+            for (i = 0; i < batch; i++)
+            {
+                init_recv_hdr( asyncs[i], &msgs[i].msg_hdr, &unix_addrs[i], control + i * control_size, control_size );
+                msgs[i].msg_len = 0;
+            }
+            while ((received = recvmmsg( fd, msgs, batch, async->unix_flags, NULL )) < 0 && errno == EINTR);
+            TRACE( "recvmmsg returned %d for %u asyncs\n", received, batch );
+
+            if (received > 0)
+                status = finish_recv( async, &msgs[0].msg_hdr, &unix_addrs[0], msgs[0].msg_len, size );
+            for (i = 1; i < received; i++)
+            {
+                ULONG_PTR information;
+
+                entries[i - 1].status = finish_recv( asyncs[i], &msgs[i].msg_hdr, &unix_addrs[i],
+                                                     msgs[i].msg_len, &information );
+                entries[i - 1].total = information;
+                set_async_iosb( entries[i - 1].sb, entries[i - 1].status, information );
+            }
+            free( control );
+        }
+    }
+#endif
+
+    /* fall back to a plain recvmsg() for the current async only */
+    if (received <= 0)
+    {
+        received = 1;
+        status = try_recv( fd, async, size );
+    }
+
+    if (count)
+    {
+        for (i = received - 1; i < count; i++) entries[i].status = STATUS_PENDING;
+        set_socket_batch( async->io.handle, FALSE, entries, count );
+        for (i = 1; i < received; i++) release_fileio( &asyncs[i]->io );
+    }
+    return status;
+}
+
 static BOOL async_recv_proc( void *user, ULONG_PTR *info, unsigned int *status )
 {
     struct async_recv_ioctl *async = user;
@@ -806,10 +942,16 @@ static BOOL async_recv_proc( void *user, ULONG_PTR *info, unsigned int *status )
 
     if (*status == STATUS_ALERTED)
     {
+        /* the server passes the number of following asyncs claimed for a batch */
+        unsigned int batch = *info;
+
         if ((*status = server_get_unix_fd( async->io.handle, 0, &fd, &needs_close, NULL, NULL )))
+        {
+            if (batch) restart_socket_batch( async->io.handle, FALSE );
             return TRUE;
+        }
 
-        *status = try_recv( fd, async, info );
+        *status = batch ? try_recv_batch( fd, async, info ) : try_recv( fd, async, info );
         TRACE( "got status %#x, %#lx bytes read\n", *status, *info );
         if (needs_close) close( fd );
 
@@ -842,7 +984,7 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
 {
     HANDLE wait_handle;
     BOOL nonblocking;
-    unsigned int i, status;
+    unsigned int i, status, fast_options;
     ULONG options;
 
     for (i = 0; i < async->count; ++i)
@@ -854,6 +996,19 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
         }
     }
 
+    if (!force_async && !apc && !apc_user &&
+        (get_socket_fast_path( handle, &fast_options ) & SOCKET_FAST_IO))
+    {
+        ULONG_PTR information;
+
+        /* nonblocking socket only used by this process, the server doesn't need to know */
+        status = try_recv( fd, async, &information );
+        if (!NT_ERROR(status))
+            file_complete_async( handle, fast_options, event, NULL, NULL, io, status, information );
+        release_fileio( &async->io );
+        return status;
+    }
+
     SERVER_START_REQ( recv_socket )
     {
         req->force_async = force_async;
@@ -879,8 +1034,9 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
         set_async_direct_result( &wait_handle, options, io, status, information, FALSE );
     }
 
-    if (status != STATUS_PENDING)
-        release_fileio( &async->io );
+    /* the server has to be involved as long as the async is queued */
+    if (status == STATUS_PENDING) remove_socket_fast_path_from_cache( handle );
+    else release_fileio( &async->io );
 
     if (wait_handle) status = wait_async( wait_handle, options & FILE_SYNCHRONOUS_IO_ALERT );
     return status;
@@ -963,34 +1119,26 @@ NTSTATUS sock_read( HANDLE handle, int fd, HANDLE event, PIO_APC_ROUTINE apc,
 }
 
 
-static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
+static NTSTATUS init_send_hdr( int fd, struct async_send_ioctl *async, int sock_type, struct msghdr *hdr,
+                               union unix_sockaddr *unix_addr )
 {
-    union unix_sockaddr unix_addr;
-    struct msghdr hdr;
-    int attempt = 0;
-    int sock_type;
-    socklen_t len = sizeof(sock_type);
-    ssize_t ret;
-
-    getsockopt(fd, SOL_SOCKET, SO_TYPE, &sock_type, &len);
-
-    memset( &hdr, 0, sizeof(hdr) );
+    memset( hdr, 0, sizeof(*hdr) );
     if (async->addr && sock_type != SOCK_STREAM)
     {
-        hdr.msg_name = &unix_addr;
-        hdr.msg_namelen = sockaddr_to_unix( async->addr, async->addr_len, &unix_addr );
-        if (!hdr.msg_namelen)
+        hdr->msg_name = unix_addr;
+        hdr->msg_namelen = sockaddr_to_unix( async->addr, async->addr_len, unix_addr );
+        if (!hdr->msg_namelen)
         {
             ERR( "failed to convert address\n" );
             return STATUS_ACCESS_VIOLATION;
         }
-        if (sock_type == SOCK_DGRAM && ((unix_addr.addr.sa_family == AF_INET && !unix_addr.in.sin_port)
-            || (unix_addr.addr.sa_family == AF_INET6 && !unix_addr.in6.sin6_port)))
+        if (sock_type == SOCK_DGRAM && ((unix_addr->addr.sa_family == AF_INET && !unix_addr->in.sin_port)
+            || (unix_addr->addr.sa_family == AF_INET6 && !unix_addr->in6.sin6_port)))
         {
             /* Sending to port 0 succeeds on Windows. Use 'discard' service instead so sendmsg() works on Unix
              * while still goes through other parameters validation. */
             WARN( "Trying to use destination port 0, substituing 9.\n" );
-            unix_addr.in.sin_port = htons( 9 );
+            unix_addr->in.sin_port = htons( 9 );
         }
 
 #if defined(HAS_IPX) && defined(SOL_IPX)
@@ -1006,13 +1154,29 @@ static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
              * the IPX type in the sockaddr_ipx structure with the stored value.
              */
             if (getsockopt(fd, SOL_IPX, IPX_TYPE, &type, &len) >= 0)
-                unix_addr.ipx.sipx_type = type;
+                unix_addr->ipx.sipx_type = type;
         }
 #endif
     }
 
-    hdr.msg_iov = async->iov + async->iov_cursor;
-    hdr.msg_iovlen = async->count - async->iov_cursor;
+    hdr->msg_iov = async->iov + async->iov_cursor;
+    hdr->msg_iovlen = async->count - async->iov_cursor;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
+{
+    union unix_sockaddr unix_addr;
+    struct msghdr hdr;
+    int attempt = 0;
+    int sock_type;
+    socklen_t len = sizeof(sock_type);
+    NTSTATUS status;
+    ssize_t ret;
+
+    getsockopt(fd, SOL_SOCKET, SO_TYPE, &sock_type, &len);
+
+    if ((status = init_send_hdr( fd, async, sock_type, &hdr, &unix_addr ))) return status;
 
     while ((ret = sendmsg( fd, &hdr, async->unix_flags )) == -1)
     {
@@ -1052,6 +1216,80 @@ static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
     return STATUS_SUCCESS;
 }
 
+static BOOL async_send_proc( void *user, ULONG_PTR *info, unsigned int *status );
+
+static NTSTATUS try_send_batch( int fd, struct async_send_ioctl *async )
+{
+    struct async_batch_entry entries[SOCKET_IO_BATCH_MAX - 1];
+    struct async_send_ioctl *asyncs[SOCKET_IO_BATCH_MAX];
+    unsigned int i, count, batch = 1;
+    NTSTATUS status = STATUS_SUCCESS;
+    int sent = 0;
+
+    count = get_socket_batch( async->io.handle, TRUE, entries );
+    asyncs[0] = async;
+    if (async->fd == -1 && !async->iov_cursor)
+    {
+        /* stop at the first async that needs to be handled separately, to keep the order */
+        for (i = 0; i < count; i++)
+        {
+            struct async_send_ioctl *next = wine_server_get_ptr( entries[i].user );
+
+            if (next->io.callback != async_send_proc || next->unix_flags != async->unix_flags ||
+                next->fd != -1 || next->iov_cursor)
+                break;
+            asyncs[batch++] = next;
+        }
+    }
+
+#ifdef __linux__
+    if (batch > 1)
+    {
+        union unix_sockaddr unix_addrs[SOCKET_IO_BATCH_MAX];
+        struct mmsghdr msgs[SOCKET_IO_BATCH_MAX];
+        socklen_t len = sizeof(int);
+        int sock_type;
+
+        getsockopt( fd, SOL_SOCKET, SO_TYPE, &sock_type, &len );
+        for (i = 0; i < batch; i++)
+        {
+            if (init_send_hdr( fd, asyncs[i], sock_type, &msgs[i].msg_hdr, &unix_addrs[i] )) break;
+            msgs[i].msg_len = 0;
+        }
+        /* leave the asyncs with an invalid address to sendmsg() for proper error reporting */
+        if ((batch = i) > 1)
+        {
+            while ((sent = sendmmsg( fd, msgs, batch, async->unix_flags )) < 0 && errno == EINTR);
+            TRACE( "sendmmsg returned %d for %u asyncs\n", sent, batch );
+        }
+
+        /* datagrams are sent whole, or not at all */
+        for (i = 0; i < sent; i++) asyncs[i]->sent_len += msgs[i].msg_len;
+        for (i = 1; i < sent; i++)
+        {
+            entries[i - 1].status = STATUS_SUCCESS;
+            entries[i - 1].total = asyncs[i]->sent_len;
+            set_async_iosb( entries[i - 1].sb, STATUS_SUCCESS, asyncs[i]->sent_len );
+        }
+    }
+#endif
+
+    /* fall back to a plain sendmsg() for the current async only */
+    if (sent <= 0)
+    {
+        sent = 1;
+        status = try_send( fd, async );
+    }
+
+    if (count)
+    {
+        for (i = sent - 1; i < count; i++) entries[i].status = STATUS_PENDING;
+        set_socket_batch( async->io.handle, TRUE, entries, count );
+        for (i = 1; i < sent; i++) release_fileio( &asyncs[i]->io );
+    }
+    return status;
+}
+
 static BOOL async_send_proc( void *user, ULONG_PTR *info, unsigned int *status )
 {
     struct async_send_ioctl *async = user;
@@ -1061,11 +1299,17 @@ static BOOL async_send_proc( void *user, ULONG_PTR *info, unsigned int *status )
 
     if (*status == STATUS_ALERTED)
     {
+        /* the server passes the number of following asyncs claimed for a batch */
+        unsigned int batch = *info;
+
         needs_close = FALSE;
         if ((fd = async->fd) == -1 && (*status = server_get_unix_fd( async->io.handle, 0, &fd, &needs_close, NULL, NULL )))
+        {
+            if (batch) restart_socket_batch( async->io.handle, TRUE );
             return TRUE;
+        }
 
-        *status = try_send( fd, async );
+        *status = batch ? try_send_batch( fd, async ) : try_send( fd, async );
         TRACE( "got status %#x\n", *status );
 
         if (needs_close) close( fd );
@@ -1109,9 +1353,24 @@ static NTSTATUS sock_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
 {
     HANDLE wait_handle;
     BOOL nonblocking;
-    unsigned int status;
+    unsigned int status, fast_options;
     ULONG options;
 
+    if (!server_flags && !apc && !apc_user &&
+        (get_socket_fast_path( handle, &fast_options ) & SOCKET_FAST_IO))
+    {
+        /* nonblocking socket only used by this process, the server doesn't need to know
+         * unless the remaining data has to be queued */
+        status = try_send( fd, async );
+        if (status != STATUS_DEVICE_NOT_READY)
+        {
+            if (!NT_ERROR(status))
+                file_complete_async( handle, fast_options, event, NULL, NULL, io, status, async->sent_len );
+            release_fileio( &async->io );
+            return status;
+        }
+    }
+
     SERVER_START_REQ( send_socket )
     {
         req->flags = server_flags;
@@ -1201,7 +1460,9 @@ static NTSTATUS sock_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
         set_async_direct_result( &wait_handle, options, io, status, async->sent_len, FALSE );
     }
 
-    if (status != STATUS_PENDING)
+    /* the server has to be involved as long as the async is queued */
+    if (status == STATUS_PENDING) remove_socket_fast_path_from_cache( handle );
+    else
     {
         if (async->fd != -1) close( async->fd );
         release_fileio( &async->io );
@@ -1287,8 +1548,55 @@ static ssize_t do_send( int fd, const void *buffer, size_t len, int flags )
     return ret;
 }
 
+/* send the file data with sendfile(), without copying it to the user space buffer */
+static NTSTATUS try_transmit_zero_copy( int sock_fd, int file_fd, struct async_transmit_ioctl *async )
+{
+#ifdef __linux__
+    while (async->file)
+    {
+        unsigned int count = async->file_len ? async->file_len - async->file_cursor : 0x7ffff000;
+        ssize_t ret;
+
+        TRACE( "sending %u bytes of file data\n", count );
+        do
+        {
+            if (async->offset.QuadPart == FILE_USE_FILE_POINTER_POSITION)
+                ret = sendfile( sock_fd, file_fd, NULL, count );
+            else
+            {
+                off_t offset = async->offset.QuadPart;
+                ret = sendfile( sock_fd, file_fd, &offset, count );
+            }
+        } while (ret < 0 && errno == EINTR);
+
+        if (ret < 0)
+        {
+            /* fall back to read() and send() if the file doesn't support it */
+            if ((errno == EINVAL || errno == ENOSYS) && !async->file_cursor)
+            {
+                TRACE( "sendfile not supported, falling back to copying\n" );
+                async->zero_copy = FALSE;
+                return STATUS_SUCCESS;
+            }
+            return sock_errno_to_status( errno );
+        }
+        TRACE( "sendfile returned %zd\n", ret );
+
+        async->file_cursor += ret;
+        if (async->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            async->offset.QuadPart += ret;
+        if (!ret || (async->file_len && async->file_cursor == async->file_len))
+            async->file = NULL;
+    }
+#else
+    async->zero_copy = FALSE;
+#endif
+    return STATUS_SUCCESS;
+}
+
 static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_ioctl *async )
 {
+    NTSTATUS status;
     ssize_t ret;
 
     while (async->head_cursor < async->head_len)
@@ -1312,6 +1620,11 @@ static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_io
         async->file_cursor += ret;
     }
 
+    if (async->file && async->zero_copy)
+    {
+        if ((status = try_transmit_zero_copy( sock_fd, file_fd, async ))) return status;
+    }
+
     if (async->file && async->buffer_cursor == async->read_len)
     {
         unsigned int read_size = async->buffer_size;
@@ -1405,23 +1718,27 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
     {
         if ((status = server_get_unix_fd( ULongToHandle( params->file ), 0, &file_fd, &file_needs_close, &file_type, NULL )))
             return status;
-        if (file_needs_close) close( file_fd );
 
         if (file_type != FD_TYPE_FILE)
         {
             FIXME( "unsupported file type %#x\n", file_type );
+            if (file_needs_close) close( file_fd );
             return STATUS_NOT_IMPLEMENTED;
         }
     }
 
     if (!(async = (struct async_transmit_ioctl *)alloc_fileio( sizeof(*async), async_transmit_proc, handle )))
+    {
+        if (file_needs_close) close( file_fd );
         return STATUS_NO_MEMORY;
+    }
 
     async->file = ULongToHandle( params->file );
     async->buffer_size = params->buffer_size ? params->buffer_size : 65536;
     if (!(async->buffer = malloc( async->buffer_size )))
     {
         release_fileio( &async->io );
+        if (file_needs_close) close( file_fd );
         return STATUS_NO_MEMORY;
     }
     async->read_len = 0;
@@ -1431,6 +1748,7 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
     async->tail_cursor = 0;
     async->file_len = params->file_len;
     async->flags = params->flags;
+    async->zero_copy = TRUE;
     async->head = u64_to_user_ptr(params->head_ptr);
     async->head_len = params->head_len;
     async->tail = u64_to_user_ptr(params->tail_ptr);
@@ -1461,6 +1779,7 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
         information = async->head_cursor + async->file_cursor + async->tail_cursor;
         set_async_direct_result( &wait_handle, options, io, status, information, TRUE );
     }
+    if (file_needs_close) close( file_fd );
 
     if (status != STATUS_PENDING)
         release_fileio( &async->io );
@@ -1528,10 +1847,115 @@ static int get_sock_type( HANDLE handle )
 }
 
 
+/* complete a poll without the server if all the sockets can bypass it, and it can
+ * be satisfied immediately; return STATUS_BAD_DEVICE_TYPE to go through the server */
+static NTSTATUS try_fast_poll( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user,
+                               IO_STATUS_BLOCK *io, const void *in_buffer, UINT in_size,
+                               void *out_buffer, UINT out_size )
+{
+    const struct afd_poll_params *params = in_buffer;
+    struct afd_poll_params *output = out_buffer;
+    unsigned int i, count, signaled = 0, options, sock_options;
+    NTSTATUS status = STATUS_BAD_DEVICE_TYPE;
+    struct pollfd *pollfds;
+    int fd, needs_close;
+    int *flags, *close_fds;
+    LONGLONG timeout;
+
+    /* let the server validate the parameters and handle the asynchronous case */
+    if (in_wow64_call() || apc || apc_user) return STATUS_BAD_DEVICE_TYPE;
+    if (in_size < sizeof(*params) || !params->count || params->exclusive) return STATUS_BAD_DEVICE_TYPE;
+    if (in_size < offsetof( struct afd_poll_params, sockets[params->count] ) || out_size < in_size)
+        return STATUS_BAD_DEVICE_TYPE;
+    if (server_get_unix_fd( handle, 0, &fd, &needs_close, NULL, &options )) return STATUS_BAD_DEVICE_TYPE;
+    if (needs_close) close( fd );
+
+    count = params->count;
+    timeout = params->timeout;
+    if (!(pollfds = malloc( count * (sizeof(*pollfds) + 2 * sizeof(int)) ))) return STATUS_BAD_DEVICE_TYPE;
+    flags = (int *)(pollfds + count);
+    close_fds = flags + count;
+    for (i = 0; i < count; i++) close_fds[i] = -1;
+
+    for (i = 0; i < count; i++)
+    {
+        HANDLE sock = (HANDLE)params->sockets[i].socket;
+
+        if (!((flags[i] = get_socket_fast_path( sock, &sock_options )) & SOCKET_FAST_IO)) break;
+        if (server_get_unix_fd( sock, 0, &fd, &needs_close, NULL, NULL )) break;
+        if (needs_close) close_fds[i] = fd;
+        pollfds[i].fd = fd;
+        pollfds[i].events = POLLIN | POLLPRI | POLLOUT;
+#ifdef POLLRDHUP
+        /* a graceful close by the peer is otherwise only reported as POLLIN */
+        pollfds[i].events |= POLLRDHUP;
+#endif
+        pollfds[i].revents = 0;
+    }
+
+    if (i == count && poll( pollfds, count, 0 ) >= 0)
+    {
+        for (i = 0; i < count; i++)
+        {
+            BOOL connected = flags[i] & SOCKET_FAST_CONNECTED;
+
+            /* the server keeps track of errors, hangups and out-of-band data */
+            if (pollfds[i].revents & ~(POLLIN | POLLOUT)) break;
+#ifndef POLLRDHUP
+            if (connected && (pollfds[i].revents & POLLIN))
+            {
+                char c;
+                /* tell a graceful close by the peer from incoming data */
+                if (!recv( pollfds[i].fd, &c, 1, MSG_PEEK | MSG_DONTWAIT )) break;
+            }
+#endif
+
+            flags[i] = 0;
+            if (pollfds[i].revents & POLLIN) flags[i] |= AFD_POLL_READ;
+            if (pollfds[i].revents & POLLOUT) flags[i] |= AFD_POLL_WRITE;
+            if (connected) flags[i] |= AFD_POLL_CONNECT;
+            if ((flags[i] &= params->sockets[i].flags)) signaled++;
+        }
+
+        /* a poll that has to wait is left to the server */
+        if (i == count && (signaled || !timeout))
+        {
+            unsigned int pos = 0;
+
+            /* input and output may be the same buffer, sockets only move backwards */
+            for (i = 0; i < count; i++)
+            {
+                if (!flags[i]) continue;
+                output->sockets[pos].socket = params->sockets[i].socket;
+                output->sockets[pos].flags = flags[i];
+                output->sockets[pos].status = 0;
+                pos++;
+            }
+            output->timeout = timeout;
+            output->count = signaled;
+            output->exclusive = FALSE;
+            status = STATUS_SUCCESS;
+        }
+    }
+
+    for (i = 0; i < count; i++) if (close_fds[i] != -1) close( close_fds[i] );
+    free( pollfds );
+
+    if (!status)
+    {
+        TRACE( "%u sockets signaled without the server\n", signaled );
+        file_complete_async( handle, options, event, NULL, NULL, io, status,
+                             offsetof( struct afd_poll_params, sockets[signaled] ) );
+    }
+    return status;
+}
+
+
 NTSTATUS sock_ioctl( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user, IO_STATUS_BLOCK *io,
                      UINT code, void *in_buffer, UINT in_size, void *out_buffer, UINT out_size )
 {
     int fd, needs_close = FALSE;
+    BOOL fast_path_change = FALSE;
     unsigned int options;
     NTSTATUS status;
 
@@ -1542,6 +1966,20 @@ NTSTATUS sock_ioctl( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc
      * fill the iosb or signal completion; such sockopts are only called
      * synchronously by ws2_32 */
 
+    switch (code)
+    {
+        /* these may change whether I/O on the socket can bypass the server */
+        case IOCTL_AFD_BIND:
+        case IOCTL_AFD_LISTEN:
+        case IOCTL_AFD_EVENT_SELECT:
+        case IOCTL_AFD_WINE_MESSAGE_SELECT:
+        case IOCTL_AFD_WINE_FIONBIO:
+        case IOCTL_AFD_WINE_SHUTDOWN:
+        case IOCTL_AFD_WINE_CONNECT:
+            fast_path_change = TRUE;
+            break;
+    }
+
     switch (code)
     {
         case IOCTL_AFD_BIND:
@@ -1617,8 +2055,7 @@ NTSTATUS sock_ioctl( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc
         }
 
         case IOCTL_AFD_POLL:
-            status = STATUS_BAD_DEVICE_TYPE;
-            break;
+            return try_fast_poll( handle, event, apc, apc_user, io, in_buffer, in_size, out_buffer, out_size );
 
         case IOCTL_AFD_RECV:
         {
@@ -2601,5 +3038,13 @@ NTSTATUS sock_ioctl( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc
 
     if (needs_close) close( fd );
 
+    /* forget the cached state only once the server has processed the request,
+     * so that the old state can't be cached again in the meantime */
+    if (fast_path_change && status == STATUS_BAD_DEVICE_TYPE)
+    {
+        status = server_ioctl_file( handle, event, apc, apc_user, io, code, in_buffer, in_size, out_buffer, out_size );
+        remove_socket_fast_path_from_cache( handle );
+    }
+
     return status;
 }
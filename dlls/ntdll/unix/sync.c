@@ -192,6 +192,196 @@ static inline int futex_wake_one( const LONG *addr )
 
 #endif /* __APPLE__ */
 
+#if defined(USE_FUTEX) || defined(HAVE_KQUEUE)
+static LONGLONG get_absolute_timeout( const LARGE_INTEGER *timeout )
+{
+    LARGE_INTEGER now;
+
+    if (timeout->QuadPart >= 0) return timeout->QuadPart;
+    NtQuerySystemTime( &now );
+    return now.QuadPart - timeout->QuadPart;
+}
+
+static LONGLONG update_timeout( ULONGLONG end )
+{
+    LARGE_INTEGER now;
+    LONGLONG timeleft;
+
+    NtQuerySystemTime( &now );
+    timeleft = end - now.QuadPart;
+    if (timeleft < 0) timeleft = 0;
+    return timeleft;
+}
+#endif
+
+#ifdef __linux__
+
+/* in-process synchronization objects; see server/inproc_sync.c */
+
+static inline int futex_wait_shared( volatile LONG *addr, int val, struct timespec *timeout )
+{
+#if (defined(__i386__) || defined(__arm__)) && _TIME_BITS==64
+    if (timeout && sizeof(*timeout) != 8)
+    {
+        struct {
+            long tv_sec;
+            long tv_nsec;
+        } timeout32 = { timeout->tv_sec, timeout->tv_nsec };
+
+        return syscall( __NR_futex, addr, FUTEX_WAIT, val, &timeout32, 0, 0 );
+    }
+#endif
+    return syscall( __NR_futex, addr, FUTEX_WAIT, val, timeout, 0, 0 );
+}
+
+static inline void inproc_sync_wake( inproc_sync_shm_t *sync )
+{
+    InterlockedIncrement( &sync->seq );
+    if (sync->waiters) syscall( __NR_futex, &sync->seq, FUTEX_WAKE, INT_MAX, NULL, 0, 0 );
+}
+
+static inline LONG64 inproc_sync_state( inproc_sync_shm_t *sync )
+{
+    return InterlockedCompareExchange64( &sync->state, 0, 0 );
+}
+
+/* try to acquire an object; returns STATUS_PENDING if it isn't signaled, and
+ * STATUS_NOT_IMPLEMENTED if it has waiters in the server */
+static NTSTATUS inproc_sync_try_acquire( inproc_sync_shm_t *sync, unsigned int tid )
+{
+    LONG64 state, value;
+
+    for (;;)
+    {
+        state = inproc_sync_state( sync );
+        if (state >= INPROC_SYNC_SERVER_WAITER) return STATUS_NOT_IMPLEMENTED;
+        value = state & INPROC_SYNC_VALUE_MASK;
+
+        switch (sync->type)
+        {
+        case INPROC_SYNC_EVENT:
+            if (!value) return STATUS_PENDING;
+            if (sync->max) return STATUS_SUCCESS;  /* manual-reset */
+            if (InterlockedCompareExchange64( &sync->state, 0, state ) == state) return STATUS_SUCCESS;
+            break;
+        case INPROC_SYNC_SEMAPHORE:
+            if (!value) return STATUS_PENDING;
+            if (InterlockedCompareExchange64( &sync->state, state - 1, state ) == state) return STATUS_SUCCESS;
+            break;
+        case INPROC_SYNC_MUTEX:
+            if (value == tid)
+            {
+                /* only the owner thread modifies the recursion count */
+                if (sync->count == ~0u) return STATUS_NOT_IMPLEMENTED;
+                sync->count++;
+                return STATUS_SUCCESS;
+            }
+            if (value) return STATUS_PENDING;
+            if (InterlockedCompareExchange64( &sync->state, tid, state ) == state)
+            {
+                sync->count = 1;
+                return (state & INPROC_SYNC_ABANDONED) ? STATUS_ABANDONED_WAIT_0 : STATUS_SUCCESS;
+            }
+            break;
+        default:
+            return STATUS_NOT_IMPLEMENTED;
+        }
+    }
+}
+
+/* check whether a futex waiter has been woken by a pulse of the event */
+static BOOL inproc_sync_pulsed( inproc_sync_shm_t *sync, LONG pulse_seq )
+{
+    if (sync->type != INPROC_SYNC_EVENT || ReadAcquire( &sync->pulse_seq ) == pulse_seq) return FALSE;
+    if (sync->max) return TRUE;
+    return InterlockedCompareExchange( &sync->pulse_token, 0, 1 ) == 1;
+}
+
+/* wait on objects without going through the server; returns STATUS_NOT_IMPLEMENTED
+ * if the wait needs to be done in the server, in which case the timeout may be
+ * updated to the absolute end time */
+static NTSTATUS inproc_wait( DWORD count, const HANDLE *handles, BOOLEAN wait_any, BOOLEAN alertable,
+                             const LARGE_INTEGER **timeout, LARGE_INTEGER *end_time )
+{
+    inproc_sync_shm_t *syncs[MAXIMUM_WAIT_OBJECTS], *sync;
+    unsigned int tid = HandleToULong( NtCurrentTeb()->ClientId.UniqueThread );
+    struct timespec timespec;
+    LONG seq, pulse_seq;
+    NTSTATUS ret;
+    ULONGLONG end;
+    DWORD i;
+    int err;
+
+    if (alertable || (count > 1 && !wait_any)) return STATUS_NOT_IMPLEMENTED;
+
+    for (i = 0; i < count; i++)
+        if (get_inproc_sync( handles[i], INPROC_SYNC_UNKNOWN, SYNCHRONIZE, &syncs[i] ))
+            return STATUS_NOT_IMPLEMENTED;
+
+    if (count > 1)
+    {
+        for (i = 0; i < count; i++)
+        {
+            ret = inproc_sync_try_acquire( syncs[i], tid );
+            if (ret == STATUS_PENDING) continue;
+            if (ret != STATUS_NOT_IMPLEMENTED) ret += i;
+            return ret;
+        }
+        if (*timeout && !(*timeout)->QuadPart) return STATUS_TIMEOUT;
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    sync = syncs[0];
+    if ((ret = inproc_sync_try_acquire( sync, tid )) != STATUS_PENDING) return ret;
+    if (*timeout && !(*timeout)->QuadPart) return STATUS_TIMEOUT;
+
+    if (*timeout && (*timeout)->QuadPart == TIMEOUT_INFINITE) *timeout = NULL;
+    if (*timeout) end = get_absolute_timeout( *timeout );
+
+    InterlockedIncrement( &sync->waiters );
+    pulse_seq = ReadAcquire( &sync->pulse_seq );
+    for (;;)
+    {
+        seq = ReadAcquire( &sync->seq );
+        if ((ret = inproc_sync_try_acquire( sync, tid )) != STATUS_PENDING) break;
+        if (inproc_sync_pulsed( sync, pulse_seq ))
+        {
+            ret = STATUS_SUCCESS;
+            break;
+        }
+        if (*timeout)
+        {
+            LONGLONG timeleft = update_timeout( end );
+
+            if (!timeleft)
+            {
+                ret = STATUS_TIMEOUT;
+                break;
+            }
+            timespec.tv_sec = timeleft / (ULONGLONG)TICKSPERSEC;
+            timespec.tv_nsec = (timeleft % TICKSPERSEC) * 100;
+            err = futex_wait_shared( &sync->seq, seq, &timespec );
+        }
+        else err = futex_wait_shared( &sync->seq, seq, NULL );
+
+        if (err == -1 && errno == ENOSYS)
+        {
+            ret = STATUS_NOT_IMPLEMENTED;
+            break;
+        }
+    }
+    InterlockedDecrement( &sync->waiters );
+
+    if (ret == STATUS_NOT_IMPLEMENTED && *timeout)
+    {
+        end_time->QuadPart = end;
+        *timeout = end_time;
+    }
+    return ret;
+}
+
+#endif /* __linux__ */
+
 /* create a struct security_descriptor and contained information in one contiguous piece of memory */
 unsigned int alloc_object_attributes( const OBJECT_ATTRIBUTES *attr, struct object_attributes **ret,
                                       data_size_t *ret_len )
@@ -396,6 +586,24 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 NTSTATUS WINAPI NtReleaseSemaphore( HANDLE handle, ULONG count, ULONG *previous )
 {
     unsigned int ret;
+#ifdef __linux__
+    inproc_sync_shm_t *sync;
+    LONG64 state;
+    ULONG cur;
+
+    if (!get_inproc_sync( handle, INPROC_SYNC_SEMAPHORE, SEMAPHORE_MODIFY_STATE, &sync ))
+    {
+        while ((state = inproc_sync_state( sync )) < INPROC_SYNC_SERVER_WAITER)
+        {
+            cur = state;
+            if (cur + count < cur || cur + count > sync->max) return STATUS_SEMAPHORE_LIMIT_EXCEEDED;
+            if (InterlockedCompareExchange64( &sync->state, state + count, state ) != state) continue;
+            if (!cur) inproc_sync_wake( sync );
+            if (previous) *previous = cur;
+            return STATUS_SUCCESS;
+        }
+    }
+#endif
 
     SERVER_START_REQ( release_semaphore )
     {
@@ -472,6 +680,19 @@ NTSTATUS WINAPI NtOpenEvent( HANDLE *handle, ACCESS_MASK access, const OBJECT_AT
 NTSTATUS WINAPI NtSetEvent( HANDLE handle, LONG *prev_state )
 {
     unsigned int ret;
+#ifdef __linux__
+    inproc_sync_shm_t *sync;
+    LONG64 state;
+
+    if (!get_inproc_sync( handle, INPROC_SYNC_EVENT, EVENT_MODIFY_STATE, &sync ) &&
+        (state = inproc_sync_state( sync )) < INPROC_SYNC_SERVER_WAITER &&
+        InterlockedCompareExchange64( &sync->state, 1, state ) == state)
+    {
+        if (!state) inproc_sync_wake( sync );
+        if (prev_state) *prev_state = state;
+        return STATUS_SUCCESS;
+    }
+#endif
 
     SERVER_START_REQ( event_op )
     {
@@ -491,6 +712,18 @@ NTSTATUS WINAPI NtSetEvent( HANDLE handle, LONG *prev_state )
 NTSTATUS WINAPI NtResetEvent( HANDLE handle, LONG *prev_state )
 {
     unsigned int ret;
+#ifdef __linux__
+    inproc_sync_shm_t *sync;
+    LONG64 state;
+
+    if (!get_inproc_sync( handle, INPROC_SYNC_EVENT, EVENT_MODIFY_STATE, &sync ) &&
+        (state = inproc_sync_state( sync )) < INPROC_SYNC_SERVER_WAITER &&
+        InterlockedCompareExchange64( &sync->state, 0, state ) == state)
+    {
+        if (prev_state) *prev_state = state;
+        return STATUS_SUCCESS;
+    }
+#endif
 
     SERVER_START_REQ( event_op )
     {
@@ -626,6 +859,31 @@ NTSTATUS WINAPI NtOpenMutant( HANDLE *handle, ACCESS_MASK access, const OBJECT_A
 NTSTATUS WINAPI NtReleaseMutant( HANDLE handle, LONG *prev_count )
 {
     unsigned int ret;
+#ifdef __linux__
+    unsigned int tid = HandleToULong( NtCurrentTeb()->ClientId.UniqueThread );
+    inproc_sync_shm_t *sync;
+    unsigned int count;
+
+    if (!get_inproc_sync( handle, INPROC_SYNC_MUTEX, 0, &sync ) &&
+        inproc_sync_state( sync ) == tid && (count = sync->count))
+    {
+        if (count > 1) sync->count = count - 1;
+        else
+        {
+            sync->count = 0;
+            if (InterlockedCompareExchange64( &sync->state, 0, tid ) != tid)
+            {
+                /* a server waiter showed up, let the server hand the mutex over */
+                sync->count = 1;
+                goto server;
+            }
+            inproc_sync_wake( sync );
+        }
+        if (prev_count) *prev_count = 1 - count;
+        return STATUS_SUCCESS;
+    }
+server:
+#endif
 
     SERVER_START_REQ( release_mutex )
     {
@@ -1574,9 +1832,19 @@ NTSTATUS WINAPI NtWaitForMultipleObjects( DWORD count, const HANDLE *handles, BO
 {
     union select_op select_op;
     UINT i, flags = SELECT_INTERRUPTIBLE;
+#ifdef __linux__
+    LARGE_INTEGER end_time;
+    NTSTATUS ret;
+#endif
 
     if (!count || count > MAXIMUM_WAIT_OBJECTS) return STATUS_INVALID_PARAMETER_1;
 
+#ifdef __linux__
+    if ((ret = inproc_wait( count, handles, wait_any || count == 1, alertable,
+                            &timeout, &end_time )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+#endif
+
     if (alertable) flags |= SELECT_ALERTABLE;
     select_op.wait.op = wait_any ? SELECT_WAIT : SELECT_WAIT_ALL;
     for (i = 0; i < count; i++) select_op.wait.handles[i] = wine_server_obj_handle( handles[i] );
@@ -1931,6 +2199,7 @@ NTSTATUS WINAPI NtReleaseKeyedEvent( HANDLE handle, const void *key,
 NTSTATUS WINAPI NtCreateIoCompletion( HANDLE *handle, ACCESS_MASK access, OBJECT_ATTRIBUTES *attr,
                                       ULONG threads )
 {
+    static int use_ring = -1;
     unsigned int status;
     data_size_t len;
     struct object_attributes *objattr;
@@ -1940,10 +2209,17 @@ NTSTATUS WINAPI NtCreateIoCompletion( HANDLE *handle, ACCESS_MASK access, OBJECT
     *handle = 0;
     if ((status = alloc_object_attributes( attr, &objattr, &len ))) return status;
 
+    if (use_ring == -1)
+    {
+        const char *env = getenv( "WINECOMPLETIONRING" );
+        use_ring = env && atoi( env );
+    }
+
     SERVER_START_REQ( create_completion )
     {
         req->access     = access;
         req->concurrent = threads;
+        req->ring       = use_ring;
         wine_server_add_data( req, objattr, len );
         status = wine_server_call( req );
         *handle = wine_server_ptr_handle( reply->handle );
@@ -2033,6 +2309,38 @@ NTSTATUS WINAPI NtSetIoCompletionEx( HANDLE completion_handle, HANDLE completion
     return ret;
 }
 
+/* remove the oldest packet from the shared memory ring of a completion port */
+static BOOL remove_ring_completion( completion_ring_t *ring, unsigned int id, ULONG_PTR *key,
+                                    ULONG_PTR *value, IO_STATUS_BLOCK *io )
+{
+    completion_ring_entry_t *entry;
+    unsigned int pos, prev;
+
+    pos = ReadAcquire( (LONG *)&ring->head );
+    for (;;)
+    {
+        /* the ring may have been released and reused by another port */
+        if (ReadAcquire( (LONG *)&ring->id ) != id) return FALSE;
+        prev = pos;
+        entry = &ring->entries[pos % COMPLETION_RING_SIZE];
+        if (ReadAcquire( (LONG *)&entry->seq ) != pos + 1)
+        {
+            /* empty, unless another consumer removed the packet in the meantime */
+            if ((pos = ReadAcquire( (LONG *)&ring->head )) == prev) return FALSE;
+            continue;
+        }
+        if ((pos = InterlockedCompareExchange( (LONG *)&ring->head, pos + 1, pos )) == prev) break;
+    }
+
+    *key            = entry->ckey;
+    *value          = entry->cvalue;
+    io->Information = entry->information;
+    io->Status      = entry->status;
+    WriteRelease( (LONG *)&entry->seq, pos + COMPLETION_RING_SIZE );
+    return TRUE;
+}
+
+
 /***********************************************************************
  *             NtRemoveIoCompletion (NTDLL.@)
  */
@@ -2040,10 +2348,14 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE handle, ULONG_PTR *key, ULONG_PTR *
                                       IO_STATUS_BLOCK *io, LARGE_INTEGER *timeout )
 {
     HANDLE wait_handle = NULL;
-    unsigned int status;
+    completion_ring_t *ring;
+    unsigned int status, id;
 
     TRACE( "(%p, %p, %p, %p, %p)\n", handle, key, value, io, timeout );
 
+    if ((ring = get_completion_ring( handle, &id )) && remove_ring_completion( ring, id, key, value, io ))
+        return STATUS_SUCCESS;
+
     SERVER_START_REQ( remove_completion )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -2086,13 +2398,27 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE handle, FILE_IO_COMPLETION_INFORM
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
     HANDLE wait_handle = NULL;
-    unsigned int status;
+    completion_ring_t *ring;
+    unsigned int status, id;
     ULONG i = 0;
 
     TRACE( "%p %p %u %p %p %u\n", handle, info, count, written, timeout, alertable );
 
     if (!count) return STATUS_INVALID_PARAMETER;
 
+    /* alertable waits need the server to check for user APCs */
+    if (!alertable && (ring = get_completion_ring( handle, &id )))
+    {
+        while (i < count && remove_ring_completion( ring, id, &info[i].CompletionKey,
+                                                    &info[i].CompletionValue, &info[i].IoStatusBlock ))
+            i++;
+        if (i)
+        {
+            status = STATUS_SUCCESS;
+            goto done;
+        }
+    }
+
     while (i < count)
     {
         SERVER_START_REQ( remove_completion )
@@ -2183,6 +2509,84 @@ NTSTATUS WINAPI NtQueryIoCompletion( HANDLE handle, IO_COMPLETION_INFORMATION_CL
 }
 
 
+/***********************************************************************
+ *             NtCreateWaitCompletionPacket (NTDLL.@)
+ */
+NTSTATUS WINAPI NtCreateWaitCompletionPacket( HANDLE *handle, ACCESS_MASK access, OBJECT_ATTRIBUTES *attr )
+{
+    unsigned int status;
+    data_size_t len;
+    struct object_attributes *objattr;
+
+    TRACE( "(%p, %x, %p)\n", handle, access, attr );
+
+    *handle = 0;
+    if ((status = alloc_object_attributes( attr, &objattr, &len ))) return status;
+
+    SERVER_START_REQ( create_wait_completion_packet )
+    {
+        req->access = access;
+        wine_server_add_data( req, objattr, len );
+        status = wine_server_call( req );
+        *handle = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+
+    free( objattr );
+    return status;
+}
+
+
+/***********************************************************************
+ *             NtAssociateWaitCompletionPacket (NTDLL.@)
+ */
+NTSTATUS WINAPI NtAssociateWaitCompletionPacket( HANDLE packet, HANDLE completion, HANDLE target,
+                                                 void *key, void *value, NTSTATUS io_status,
+                                                 ULONG_PTR information, BOOLEAN *signaled )
+{
+    unsigned int status;
+
+    TRACE( "(%p, %p, %p, %p, %p, %#x, %#lx, %p)\n", packet, completion, target, key, value,
+           (int)io_status, information, signaled );
+
+    SERVER_START_REQ( associate_wait_completion_packet )
+    {
+        req->packet      = wine_server_obj_handle( packet );
+        req->completion  = wine_server_obj_handle( completion );
+        req->target      = wine_server_obj_handle( target );
+        req->ckey        = wine_server_client_ptr( key );
+        req->cvalue      = wine_server_client_ptr( value );
+        req->information = information;
+        req->status      = io_status;
+        if (!(status = wine_server_call( req )) && signaled) *signaled = reply->signaled;
+    }
+    SERVER_END_REQ;
+
+    return status;
+}
+
+
+/***********************************************************************
+ *             NtCancelWaitCompletionPacket (NTDLL.@)
+ */
+NTSTATUS WINAPI NtCancelWaitCompletionPacket( HANDLE packet, BOOLEAN remove_signaled )
+{
+    unsigned int status;
+
+    TRACE( "(%p, %u)\n", packet, remove_signaled );
+
+    SERVER_START_REQ( cancel_wait_completion_packet )
+    {
+        req->packet          = wine_server_obj_handle( packet );
+        req->remove_signaled = remove_signaled;
+        status = wine_server_call( req );
+    }
+    SERVER_END_REQ;
+
+    return status;
+}
+
+
 /***********************************************************************
  *             NtCreateSection (NTDLL.@)
  */
@@ -2688,28 +3092,6 @@ NTSTATUS WINAPI NtAlertThreadByThreadId( HANDLE tid )
 }
 
 
-#if defined(USE_FUTEX) || defined(HAVE_KQUEUE)
-static LONGLONG get_absolute_timeout( const LARGE_INTEGER *timeout )
-{
-    LARGE_INTEGER now;
-
-    if (timeout->QuadPart >= 0) return timeout->QuadPart;
-    NtQuerySystemTime( &now );
-    return now.QuadPart - timeout->QuadPart;
-}
-
-static LONGLONG update_timeout( ULONGLONG end )
-{
-    LARGE_INTEGER now;
-    LONGLONG timeleft;
-
-    NtQuerySystemTime( &now );
-    timeleft = end - now.QuadPart;
-    if (timeleft < 0) timeleft = 0;
-    return timeleft;
-}
-#endif
-
 
 /***********************************************************************
  *             NtWaitForAlertByThreadId (NTDLL.@)
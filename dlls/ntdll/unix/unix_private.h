@@ -223,6 +223,7 @@ extern ULONG_PTR redirect_arm64ec_rva( void *module, ULONG_PTR rva, const IMAGE_
 extern void start_server( BOOL debug );
 
 extern unsigned int server_call_unlocked( void *req_ptr );
+extern unsigned int server_call_batch( struct __server_request_info **reqs, unsigned int count );
 extern void server_enter_uninterrupted_section( pthread_mutex_t *mutex, sigset_t *sigset );
 extern void server_leave_uninterrupted_section( pthread_mutex_t *mutex, sigset_t *sigset );
 extern unsigned int server_select( const union select_op *select_op, data_size_t size, UINT flags,
@@ -233,6 +234,13 @@ extern unsigned int server_queue_process_apc( HANDLE process, const union apc_ca
                                               union apc_result *result );
 extern int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                                int *needs_close, enum server_fd_type *type, unsigned int *options );
+extern NTSTATUS get_inproc_sync( HANDLE handle, enum inproc_sync_type type, ACCESS_MASK access,
+                                 inproc_sync_shm_t **sync );
+extern void invalidate_key_value_cache( HANDLE handle );
+extern const shared_object_t *get_session_object( struct obj_locator locator );
+extern completion_ring_t *get_completion_ring( HANDLE handle, unsigned int *id );
+extern unsigned int get_socket_fast_path( HANDLE handle, unsigned int *options );
+extern void remove_socket_fast_path_from_cache( HANDLE handle );
 extern void wine_server_send_fd( int fd );
 extern void process_exit_wrapper( int status ) DECLSPEC_NORETURN;
 extern size_t server_init_process(void);
@@ -240,6 +248,16 @@ extern void server_init_process_done(void);
 extern void server_init_thread( void *entry_point, BOOL *suspend );
 extern int server_pipe( int fd[2] );
 
+/* initialize a request to be sent with server_call_batch() and return its request structure */
+#define SERVER_BATCH_REQ(info,type) \
+    (memset( &(info)->u.req, 0, sizeof((info)->u.req) ), \
+     (info)->u.req.request_header.req = REQ_##type, \
+     (info)->data_count = 0, \
+     &(info)->u.req.type##_request)
+
+/* retrieve the reply structure of a request sent with server_call_batch() */
+#define SERVER_BATCH_REPLY(info,type) (&(info)->u.reply.type##_reply)
+
 extern void fpux_to_fpu( I386_FLOATING_SAVE_AREA *fpu, const XSAVE_FORMAT *fpux );
 extern void fpu_to_fpux( XSAVE_FORMAT *fpux, const I386_FLOATING_SAVE_AREA *fpu );
 
@@ -337,6 +355,9 @@ extern NTSTATUS open_hkcu_key( const char *path, HANDLE *key );
 
 extern NTSTATUS sync_ioctl( HANDLE file, ULONG code, void *in_buffer, ULONG in_size,
                             void *out_buffer, ULONG out_size );
+extern NTSTATUS server_ioctl_file( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_context,
+                                   IO_STATUS_BLOCK *io, UINT code, const void *in_buffer, UINT in_size,
+                                   void *out_buffer, UINT out_size );
 extern NTSTATUS cdrom_DeviceIoControl( HANDLE device, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user,
                                        IO_STATUS_BLOCK *io, UINT code, void *in_buffer,
                                        UINT in_size, void *out_buffer, UINT out_size );
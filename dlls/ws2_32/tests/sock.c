@@ -10132,6 +10132,65 @@ static void test_TransmitFile(void)
     closesocket(server);
 }
 
+static void test_TransmitFile_repeated(void)
+{
+    GUID transmitFileGuid = WSAID_TRANSMITFILE;
+    LPFN_TRANSMITFILE pTransmitFile;
+    char path[MAX_PATH], name[MAX_PATH];
+    unsigned char buf[4096];
+    DWORD size, file_size, written, received;
+    unsigned int i;
+    SOCKET client, dest;
+    HANDLE file;
+    BOOL bret;
+    int ret;
+
+    /* a few pages, with a partial one at the end */
+    file_size = 3 * 4096 + 123;
+
+    tcp_socketpair_flags(&client, &dest, 0);
+    ret = WSAIoctl(client, SIO_GET_EXTENSION_FUNCTION_POINTER, &transmitFileGuid, sizeof(transmitFileGuid),
+                   &pTransmitFile, sizeof(pTransmitFile), &size, NULL, NULL);
+    ok(!ret, "failed to get TransmitFile, error %u\n", WSAGetLastError());
+
+    GetTempPathA(sizeof(path), path);
+    GetTempFileNameA(path, "wst", 0, name);
+    file = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "failed to create file, error %lu\n", GetLastError());
+
+    for (size = 0; size < file_size; size += written)
+    {
+        for (i = 0; i < sizeof(buf); i++) buf[i] = (size + i) % 251;
+        bret = WriteFile(file, buf, min(sizeof(buf), file_size - size), &written, NULL);
+        ok(bret, "failed to write file, error %lu\n", GetLastError());
+    }
+
+    /* the whole file is sent every time */
+    for (i = 0; i < 2; i++)
+    {
+        SetFilePointer(file, 0, NULL, FILE_BEGIN);
+        bret = pTransmitFile(client, file, 0, 0, NULL, NULL, 0);
+        ok(bret, "TransmitFile failed, error %u\n", WSAGetLastError());
+    }
+    shutdown(client, SD_SEND);
+
+    received = 0;
+    while ((ret = recv(dest, (char *)buf, sizeof(buf), 0)) > 0)
+    {
+        for (i = 0; i < ret; i++)
+            if (buf[i] != ((received + i) % file_size) % 251) break;
+        ok(i == ret, "data mismatch at offset %lu\n", received + i);
+        received += ret;
+    }
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    ok(received == 2 * file_size, "received %lu bytes, expected %lu\n", received, 2 * file_size);
+
+    CloseHandle(file);
+    closesocket(client);
+    closesocket(dest);
+}
+
 static void test_getpeername(void)
 {
     SOCKET sock;
@@ -13384,6 +13443,342 @@ static void test_simultaneous_async_recv(void)
     for (i = 0; i < num_io; i++) CloseHandle(events[i]);
 }
 
+static void test_simultaneous_async_recvfrom(void)
+{
+    const struct sockaddr_in bind_addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    struct sockaddr_in addr, from_addrs[16];
+    OVERLAPPED overlappeds[16] = {{0}};
+    int from_lens[16];
+    HANDLE events[16];
+    WSABUF wsabufs[16];
+    DWORD flags[16] = {0};
+    char buffers[16][32];
+    SOCKET client, server;
+    char msg[32];
+    unsigned int i;
+    int ret, len;
+
+    client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    server = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ret = bind(server, (const struct sockaddr *)&bind_addr, sizeof(bind_addr));
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(server, (struct sockaddr *)&addr, &len);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        events[i] = CreateEventW(NULL, TRUE, FALSE, NULL);
+        wsabufs[i].buf = buffers[i];
+        wsabufs[i].len = sizeof(buffers[i]);
+        overlappeds[i].hEvent = events[i];
+        from_lens[i] = sizeof(from_addrs[i]);
+        ret = WSARecvFrom(server, &wsabufs[i], 1, NULL, &flags[i], (struct sockaddr *)&from_addrs[i],
+                          &from_lens[i], &overlappeds[i], NULL);
+        ok(ret == -1, "got %d\n", ret);
+        ok(WSAGetLastError() == ERROR_IO_PENDING, "got error %u\n", WSAGetLastError());
+    }
+
+    /* the pending receives should complete in order, one datagram each */
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        memset(msg, 'a' + i, sizeof(msg));
+        ret = sendto(client, msg, i + 1, 0, (struct sockaddr *)&addr, sizeof(addr));
+        ok(ret == i + 1, "got %d\n", ret);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        DWORD size = 0;
+
+        ret = WaitForSingleObject(events[i], 1000);
+        ok(!ret, "wait timed out\n");
+        ret = GetOverlappedResult((HANDLE)server, &overlappeds[i], &size, FALSE);
+        ok(ret, "got error %lu\n", GetLastError());
+        ok(size == i + 1, "%u: got size %lu\n", i, size);
+        memset(msg, 'a' + i, sizeof(msg));
+        ok(!memcmp(buffers[i], msg, i + 1), "%u: got %s\n", i, debugstr_an(buffers[i], size));
+        ok(from_lens[i] == sizeof(struct sockaddr_in), "%u: got address length %d\n", i, from_lens[i]);
+        ok(from_addrs[i].sin_addr.s_addr == htonl(INADDR_LOOPBACK), "%u: got address %08lx\n",
+           i, from_addrs[i].sin_addr.s_addr);
+        CloseHandle(events[i]);
+    }
+
+    closesocket(client);
+    closesocket(server);
+}
+
+static void test_nonblocking_recv_event_select(void)
+{
+    WSANETWORKEVENTS events;
+    SOCKET client, server;
+    struct timeval tv = {0};
+    char buffer[16];
+    fd_set set, write_set;
+    HANDLE event;
+    int ret;
+
+    tcp_socketpair(&client, &server);
+    set_blocking(client, FALSE);
+    event = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    FD_ZERO(&set);
+    FD_SET(client, &set);
+    ret = select(0, &set, NULL, NULL, &tv);
+    ok(!ret, "got %d\n", ret);
+
+    ret = send(server, "data", 4, 0);
+    ok(ret == 4, "got %d\n", ret);
+    check_poll(client, POLLRDNORM | POLLWRNORM);
+
+    FD_ZERO(&set);
+    FD_SET(client, &set);
+    FD_ZERO(&write_set);
+    FD_SET(client, &write_set);
+    tv.tv_sec = 1;
+    ret = select(0, &set, &write_set, NULL, &tv);
+    ok(ret == 2, "got %d\n", ret);
+    ok(FD_ISSET(client, &set), "socket should be readable\n");
+    ok(FD_ISSET(client, &write_set), "socket should be writable\n");
+
+    ret = recv(client, buffer, sizeof(buffer), 0);
+    ok(ret == 4, "got %d\n", ret);
+    ok(!memcmp(buffer, "data", 4), "got %s\n", debugstr_an(buffer, ret));
+    ret = recv(client, buffer, sizeof(buffer), 0);
+    ok(ret == -1, "got %d\n", ret);
+    ok(WSAGetLastError() == WSAEWOULDBLOCK, "got error %u\n", WSAGetLastError());
+    check_poll(client, POLLWRNORM);
+
+    /* data consumed before the event select must not prevent FD_READ from being signaled */
+    ret = WSAEventSelect(client, event, FD_READ);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    ret = WaitForSingleObject(event, 100);
+    ok(ret == WAIT_TIMEOUT, "got %d\n", ret);
+
+    ret = send(server, "more", 4, 0);
+    ok(ret == 4, "got %d\n", ret);
+    ret = WaitForSingleObject(event, 1000);
+    ok(!ret, "got %d\n", ret);
+    ret = WSAEnumNetworkEvents(client, event, &events);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    ok(events.lNetworkEvents == FD_READ, "got events %#lx\n", events.lNetworkEvents);
+
+    ret = recv(client, buffer, sizeof(buffer), 0);
+    ok(ret == 4, "got %d\n", ret);
+    ok(!memcmp(buffer, "more", 4), "got %s\n", debugstr_an(buffer, ret));
+
+    closesocket(client);
+    closesocket(server);
+    CloseHandle(event);
+}
+
+struct batch_owner_params
+{
+    SOCKET sock;
+    OVERLAPPED overlapped;
+    WSABUF wsabuf;
+    DWORD flags;
+    char buffer[32];
+};
+
+static DWORD WINAPI batch_owner_thread(void *arg)
+{
+    struct batch_owner_params *params = arg;
+    int ret;
+
+    params->wsabuf.buf = params->buffer;
+    params->wsabuf.len = sizeof(params->buffer);
+    ret = WSARecv(params->sock, &params->wsabuf, 1, NULL, &params->flags, &params->overlapped, NULL);
+    ok(ret == -1, "got %d\n", ret);
+    ok(WSAGetLastError() == ERROR_IO_PENDING, "got error %u\n", WSAGetLastError());
+    return 0;
+}
+
+static void test_async_recv_owner_exit(void)
+{
+    const struct sockaddr_in bind_addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    struct batch_owner_params params = {0};
+    OVERLAPPED overlappeds[8] = {{0}};
+    HANDLE events[8], thread, port;
+    WSABUF wsabufs[8];
+    DWORD flags[8] = {0};
+    char buffers[8][32];
+    struct sockaddr_in addr;
+    SOCKET client, server;
+    char msg[32], first;
+    unsigned int i;
+    int ret, len;
+
+    client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    server = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ret = bind(server, (const struct sockaddr *)&bind_addr, sizeof(bind_addr));
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(server, (struct sockaddr *)&addr, &len);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+
+    /* I/O associated with a completion port isn't canceled when the thread exits,
+     * so the first receive stays queued after its thread is gone */
+    port = CreateIoCompletionPort((HANDLE)server, NULL, 123, 0);
+    ok(!!port, "failed to create port, error %lu\n", GetLastError());
+
+    params.sock = server;
+    thread = CreateThread(NULL, 0, batch_owner_thread, &params, 0, NULL);
+    ret = WaitForSingleObject(thread, 1000);
+    ok(!ret, "wait timed out\n");
+    CloseHandle(thread);
+
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        events[i] = CreateEventW(NULL, TRUE, FALSE, NULL);
+        wsabufs[i].buf = buffers[i];
+        wsabufs[i].len = sizeof(buffers[i]);
+        /* set the low bit to not queue a completion packet */
+        overlappeds[i].hEvent = (HANDLE)((ULONG_PTR)events[i] | 1);
+        ret = WSARecv(server, &wsabufs[i], 1, NULL, &flags[i], &overlappeds[i], NULL);
+        ok(ret == -1, "got %d\n", ret);
+        ok(WSAGetLastError() == ERROR_IO_PENDING, "got error %u\n", WSAGetLastError());
+    }
+
+    for (i = 0; i <= ARRAY_SIZE(events); i++)
+    {
+        memset(msg, 'a' + i, sizeof(msg));
+        ret = sendto(client, msg, sizeof(msg), 0, (struct sockaddr *)&addr, sizeof(addr));
+        ok(ret == sizeof(msg), "got %d\n", ret);
+    }
+
+    /* whether or not the receive of the exited thread consumed a datagram,
+     * the following ones must not be left waiting for it */
+    first = 0;
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        DWORD size = 0;
+
+        ret = WaitForSingleObject(events[i], 1000);
+        ok(!ret, "%u: wait timed out\n", i);
+        if (ret) continue;
+        ret = GetOverlappedResult((HANDLE)server, &overlappeds[i], &size, FALSE);
+        ok(ret, "got error %lu\n", GetLastError());
+        ok(size == sizeof(msg), "%u: got size %lu\n", i, size);
+        if (!i) first = buffers[0][0];
+        ok(first == 'a' || first == 'b', "got %s\n", debugstr_an(buffers[0], size));
+        ok(buffers[i][0] == first + i, "%u: got %s\n", i, debugstr_an(buffers[i], size));
+    }
+
+    closesocket(client);
+    closesocket(server);
+    for (i = 0; i < ARRAY_SIZE(events); i++) CloseHandle(events[i]);
+    CloseHandle(port);
+}
+
+static void test_simultaneous_async_sendto(void)
+{
+    const struct sockaddr_in bind_addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    OVERLAPPED overlappeds[16] = {{0}};
+    HANDLE events[16];
+    WSABUF wsabufs[16];
+    char buffers[16][256];
+    struct sockaddr_in addr;
+    SOCKET client, server;
+    char buffer[256];
+    unsigned int i;
+    int ret, len;
+
+    client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    server = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ret = bind(server, (const struct sockaddr *)&bind_addr, sizeof(bind_addr));
+    ok(!ret, "got error %u\n", WSAGetLastError());
+    len = sizeof(addr);
+    ret = getsockname(server, (struct sockaddr *)&addr, &len);
+    ok(!ret, "got error %u\n", WSAGetLastError());
+
+    /* a small send buffer makes the sends more likely to be queued, and sent together */
+    len = 1;
+    ret = setsockopt(client, SOL_SOCKET, SO_SNDBUF, (char *)&len, sizeof(len));
+    ok(!ret, "got error %u\n", WSAGetLastError());
+
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        events[i] = CreateEventW(NULL, TRUE, FALSE, NULL);
+        memset(buffers[i], 'a' + i, sizeof(buffers[i]));
+        wsabufs[i].buf = buffers[i];
+        wsabufs[i].len = 16 * (i + 1);
+        overlappeds[i].hEvent = events[i];
+        ret = WSASendTo(client, &wsabufs[i], 1, NULL, 0, (struct sockaddr *)&addr, sizeof(addr),
+                        &overlappeds[i], NULL);
+        ok(!ret || WSAGetLastError() == ERROR_IO_PENDING, "got error %u\n", WSAGetLastError());
+    }
+
+    /* the sends should complete in order, one datagram each */
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        DWORD size = 0;
+
+        ret = WaitForSingleObject(events[i], 1000);
+        ok(!ret, "%u: wait timed out\n", i);
+        ret = GetOverlappedResult((HANDLE)client, &overlappeds[i], &size, FALSE);
+        ok(ret, "got error %lu\n", GetLastError());
+        ok(size == 16 * (i + 1), "%u: got size %lu\n", i, size);
+        CloseHandle(events[i]);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(events); i++)
+    {
+        ret = recv(server, buffer, sizeof(buffer), 0);
+        ok(ret == 16 * (i + 1), "%u: got %d\n", i, ret);
+        ok(!memcmp(buffer, buffers[i], 16 * (i + 1)), "%u: got %s\n", i, debugstr_an(buffer, ret));
+    }
+
+    closesocket(client);
+    closesocket(server);
+}
+
+static void test_nonblocking_hangup(void)
+{
+    SOCKET client, server;
+    char buffer[16];
+    int ret;
+
+    tcp_socketpair(&client, &server);
+    set_blocking(client, FALSE);
+
+    ret = send(server, "data", 4, 0);
+    ok(ret == 4, "got %d\n", ret);
+    check_poll(client, POLLRDNORM | POLLWRNORM);
+    ret = recv(client, buffer, sizeof(buffer), 0);
+    ok(ret == 4, "got %d\n", ret);
+    check_poll(client, POLLWRNORM);
+
+    /* a graceful close is reported as a hangup, not as incoming data */
+    closesocket(server);
+    check_poll(client, POLLWRNORM | POLLHUP);
+    ret = recv(client, buffer, sizeof(buffer), 0);
+    ok(!ret, "got %d\n", ret);
+
+    closesocket(client);
+}
+
+/* run the nonblocking tests again in a process that does socket I/O without the server */
+static void test_socket_fast_path(void)
+{
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    char cmdline[MAX_PATH];
+    char **argv;
+    BOOL ret;
+
+    si.cb = sizeof(si);
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "%s %s fast_path", argv[0], argv[1]);
+    SetEnvironmentVariableA("WINESOCKETFASTPATH", "1");
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "got error %lu\n", GetLastError());
+    SetEnvironmentVariableA("WINESOCKETFASTPATH", NULL);
+    wait_child_process(pi.hProcess);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+}
+
 static void test_empty_recv(void)
 {
     OVERLAPPED overlapped = {0};
@@ -14522,7 +14917,18 @@ static void test_valid_handle(void)
 
 START_TEST( sock )
 {
-    int i;
+    char **argv;
+    int i, argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "fast_path"))
+    {
+        Init();
+        test_nonblocking_recv_event_select();
+        test_nonblocking_hangup();
+        Exit();
+        return;
+    }
 
 /* Leave these tests at the beginning. They depend on WSAStartup not having been
  * called, which is done by Init() below. */
@@ -14583,6 +14989,7 @@ START_TEST( sock )
 
     test_ipv6only();
     test_TransmitFile();
+    test_TransmitFile_repeated();
     test_AcceptEx();
     test_connect();
     test_shutdown();
@@ -14597,6 +15004,12 @@ START_TEST( sock )
     test_WSAGetOverlappedResult();
     test_nonblocking_async_recv();
     test_simultaneous_async_recv();
+    test_simultaneous_async_recvfrom();
+    test_async_recv_owner_exit();
+    test_simultaneous_async_sendto();
+    test_nonblocking_recv_event_select();
+    test_nonblocking_hangup();
+    test_socket_fast_path();
     test_empty_recv();
     test_timeout();
     test_tcp_reset();
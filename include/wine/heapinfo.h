@@ -0,0 +1,80 @@
+/*
+ * Wine-specific heap information classes
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __WINE_WINE_HEAPINFO_H
+#define __WINE_WINE_HEAPINFO_H
+
+#include <winternl.h>
+
+/* Wine extensions to HEAP_INFORMATION_CLASS */
+#define HeapWineStatistics  ((HEAP_INFORMATION_CLASS)0x80001000)  /* HEAP_WINE_STATISTICS */
+#define HeapWineProfiling   ((HEAP_INFORMATION_CLASS)0x80001001)  /* HEAP_WINE_PROFILE, set with a ULONG sample rate */
+
+#define HEAP_WINE_STATISTICS_VERSION  1
+#define HEAP_WINE_PROFILE_VERSION     1
+#define HEAP_WINE_PROFILE_STACK_DEPTH 8
+
+#define HEAP_WINE_FLAG_LFH        0x00000001  /* the LFH frontend is enabled */
+#define HEAP_WINE_FLAG_PROFILING  0x00000002  /* allocation profiling is enabled */
+
+typedef struct _HEAP_WINE_BIN_STATISTICS
+{
+    SIZE_T BlockSize;          /* size of the blocks of this size class, ~0 for large blocks */
+    ULONG  LfhEnabled;         /* size class is served by the LFH frontend */
+    ULONG  BackendAllocCount;  /* allocations from the backend, used for LFH activation */
+    ULONG  BackendFreeCount;
+    ULONG  AllocCount;         /* allocations and frees since profiling was enabled */
+    ULONG  FreeCount;
+    SIZE_T AllocSize;          /* total requested size since profiling was enabled */
+} HEAP_WINE_BIN_STATISTICS, *PHEAP_WINE_BIN_STATISTICS;
+
+typedef struct _HEAP_WINE_STATISTICS
+{
+    ULONG  Version;
+    ULONG  Flags;
+    SIZE_T ReservedSize;
+    SIZE_T CommittedSize;
+    SIZE_T UsedSize;           /* size of busy blocks, including LFH block groups */
+    SIZE_T FreeSize;           /* committed size of free blocks */
+    SIZE_T OverheadSize;
+    SIZE_T LargeSize;          /* virtual size of large blocks */
+    ULONG  SubheapCount;
+    ULONG  LargeCount;
+    ULONG  BinCount;           /* number of entries returned in Bins */
+    HEAP_WINE_BIN_STATISTICS Bins[ANYSIZE_ARRAY];
+} HEAP_WINE_STATISTICS, *PHEAP_WINE_STATISTICS;
+
+typedef struct _HEAP_WINE_PROFILE_SITE
+{
+    ULONG  Hash;
+    ULONG  Count;              /* number of sampled allocations from this call site */
+    SIZE_T Size;               /* total requested size of the sampled allocations */
+    PVOID  Frames[HEAP_WINE_PROFILE_STACK_DEPTH];
+} HEAP_WINE_PROFILE_SITE, *PHEAP_WINE_PROFILE_SITE;
+
+typedef struct _HEAP_WINE_PROFILE
+{
+    ULONG  Version;
+    ULONG  SampleRate;         /* one allocation out of SampleRate has its call stack recorded */
+    ULONG  SampleCount;
+    ULONG  DroppedCount;       /* samples lost because the call site table was full */
+    ULONG  SiteCount;
+    HEAP_WINE_PROFILE_SITE Sites[ANYSIZE_ARRAY];
+} HEAP_WINE_PROFILE, *PHEAP_WINE_PROFILE;
+
+#endif  /* __WINE_WINE_HEAPINFO_H */
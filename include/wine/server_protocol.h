@@ -993,11 +993,17 @@ typedef volatile struct
     int                  keystate_lock;
 } input_shm_t;
 
+typedef volatile struct
+{
+    unsigned __int64     generation;
+} key_shm_t;
+
 typedef volatile union
 {
     desktop_shm_t        desktop;
     queue_shm_t          queue;
     input_shm_t          input;
+    key_shm_t            key;
 } object_shm_t;
 
 typedef volatile struct
@@ -1021,6 +1027,59 @@ struct obj_locator
 
 
 
+enum inproc_sync_type
+{
+    INPROC_SYNC_UNKNOWN,
+    INPROC_SYNC_EVENT,
+    INPROC_SYNC_MUTEX,
+    INPROC_SYNC_SEMAPHORE,
+};
+
+typedef volatile struct
+{
+    LONG64               state;
+    unsigned int         type;
+    LONG                 seq;
+    LONG                 waiters;
+    unsigned int         max;
+    unsigned int         count;
+    LONG                 pulse_seq;
+    LONG                 pulse_token;
+    unsigned int         generation;
+    unsigned int         __pad[6];
+} inproc_sync_shm_t;
+
+#define INPROC_SYNC_VALUE_MASK     0xffffffff
+#define INPROC_SYNC_ABANDONED      ((LONG64)1 << 32)
+#define INPROC_SYNC_SERVER_WAITER  ((LONG64)1 << 40)
+#define INPROC_SYNC_BLOCK_SIZE     0x10000
+
+typedef volatile struct
+{
+    unsigned int         seq;
+    unsigned int         status;
+    apc_param_t          ckey;
+    apc_param_t          cvalue;
+    apc_param_t          information;
+} completion_ring_entry_t;
+
+#define COMPLETION_RING_SIZE       128
+
+
+typedef volatile struct
+{
+    unsigned int         id;
+    unsigned int         head;
+    unsigned int         tail;
+    unsigned int         __pad[13];
+    completion_ring_entry_t entries[COMPLETION_RING_SIZE];
+} completion_ring_t;
+
+#define COMPLETION_RING_BLOCK_SIZE 0x10000
+
+
+
+
 
 struct new_process_request
 {
@@ -1563,6 +1622,34 @@ struct select_reply
 
 
 
+struct get_inproc_sync_fd_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_inproc_sync_fd_reply
+{
+    struct reply_header __header;
+};
+
+
+
+struct get_inproc_sync_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct get_inproc_sync_reply
+{
+    struct reply_header __header;
+    int          type;
+    unsigned int access;
+    unsigned int index;
+    unsigned int generation;
+};
+
+
+
 struct create_event_request
 {
     struct request_header __header;
@@ -2007,6 +2094,64 @@ struct send_socket_reply
 #define SERVER_SOCKET_IO_SYSTEM      0x02
 
 
+struct async_batch_entry
+{
+    client_ptr_t   user;
+    client_ptr_t   sb;
+    unsigned int   status;
+    unsigned int   total;
+};
+
+#define SOCKET_IO_BATCH_MAX 16
+
+
+struct socket_get_batch_request
+{
+    struct request_header __header;
+    obj_handle_t   handle;
+    int            write;
+    char __pad_20[4];
+};
+struct socket_get_batch_reply
+{
+    struct reply_header __header;
+    /* VARARG(asyncs,async_batch); */
+};
+
+
+
+struct socket_set_batch_request
+{
+    struct request_header __header;
+    obj_handle_t   handle;
+    int            write;
+    /* VARARG(asyncs,async_batch); */
+    char __pad_20[4];
+};
+struct socket_set_batch_reply
+{
+    struct reply_header __header;
+};
+
+
+
+struct get_socket_fast_path_request
+{
+    struct request_header __header;
+    obj_handle_t   handle;
+};
+struct get_socket_fast_path_reply
+{
+    struct reply_header __header;
+    unsigned int   flags;
+    unsigned int   options;
+    struct obj_locator locator;
+};
+
+#define SOCKET_FAST_IO        0x01
+#define SOCKET_FAST_CONNECTED 0x02
+
+
 struct socket_get_events_request
 {
     struct request_header __header;
@@ -2603,6 +2748,8 @@ struct get_key_value_reply
     struct reply_header __header;
     int          type;
     data_size_t  total;
+    struct obj_locator locator;
+    unsigned __int64 generation;
     /* VARARG(data,bytes); */
 };
 
@@ -3315,6 +3462,55 @@ struct write_reply
 
 
 
+struct set_io_uring_request
+{
+    struct request_header __header;
+    int            fd;
+    data_size_t    size;
+    unsigned int   entries;
+    unsigned int   head;
+    unsigned int   tail;
+    unsigned int   mask;
+    unsigned int   cqes;
+};
+struct set_io_uring_reply
+{
+    struct reply_header __header;
+};
+
+
+
+struct register_io_uring_async_request
+{
+    struct request_header __header;
+    int            type;
+    data_size_t    count;
+    char __pad_20[4];
+    struct async_data async;
+};
+struct register_io_uring_async_reply
+{
+    struct reply_header __header;
+    unsigned int   slot;
+    char __pad_12[4];
+};
+
+
+
+struct set_io_uring_result_request
+{
+    struct request_header __header;
+    unsigned int   slot;
+    unsigned int   status;
+    data_size_t    total;
+};
+struct set_io_uring_result_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct ioctl_request
 {
     struct request_header __header;
@@ -5398,8 +5594,8 @@ struct create_completion_request
     struct request_header __header;
     unsigned int access;
     unsigned int concurrent;
+    int          ring;
     /* VARARG(objattr,object_attributes); */
-    char __pad_20[4];
 };
 struct create_completion_reply
 {
@@ -5494,6 +5690,82 @@ struct query_completion_reply
 
 
 
+struct get_completion_ring_fd_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_completion_ring_fd_reply
+{
+    struct reply_header __header;
+};
+
+
+
+struct get_completion_ring_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct get_completion_ring_reply
+{
+    struct reply_header __header;
+    unsigned int  id;
+    unsigned int  index;
+};
+
+
+
+struct create_wait_completion_packet_request
+{
+    struct request_header __header;
+    unsigned int  access;
+    /* VARARG(objattr,object_attributes); */
+};
+struct create_wait_completion_packet_reply
+{
+    struct reply_header __header;
+    obj_handle_t  handle;
+    char __pad_12[4];
+};
+
+
+
+struct associate_wait_completion_packet_request
+{
+    struct request_header __header;
+    obj_handle_t  packet;
+    obj_handle_t  completion;
+    obj_handle_t  target;
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    char __pad_52[4];
+};
+struct associate_wait_completion_packet_reply
+{
+    struct reply_header __header;
+    int           signaled;
+    char __pad_12[4];
+};
+
+
+
+struct cancel_wait_completion_packet_request
+{
+    struct request_header __header;
+    obj_handle_t  packet;
+    int           remove_signaled;
+    char __pad_20[4];
+};
+struct cancel_wait_completion_packet_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct set_completion_info_request
 {
     struct request_header __header;
@@ -5911,6 +6183,20 @@ struct set_keyboard_repeat_reply
 };
 
 
+
+struct batch_request
+{
+    struct request_header __header;
+    /* VARARG(data,bytes); */
+    char __pad_12[4];
+};
+struct batch_reply
+{
+    struct reply_header __header;
+    /* VARARG(data,bytes); */
+};
+
+
 enum request
 {
     REQ_new_process,
@@ -5943,6 +6229,8 @@ enum request
     REQ_open_process,
     REQ_open_thread,
     REQ_select,
+    REQ_get_inproc_sync_fd,
+    REQ_get_inproc_sync,
     REQ_create_event,
     REQ_event_op,
     REQ_query_event,
@@ -5970,6 +6258,9 @@ enum request
     REQ_unlock_file,
     REQ_recv_socket,
     REQ_send_socket,
+    REQ_socket_get_batch,
+    REQ_socket_set_batch,
+    REQ_get_socket_fast_path,
     REQ_socket_get_events,
     REQ_socket_send_icmp_id,
     REQ_socket_get_icmp_id,
@@ -6050,6 +6341,9 @@ enum request
     REQ_set_async_direct_result,
     REQ_read,
     REQ_write,
+    REQ_set_io_uring,
+    REQ_register_io_uring_async,
+    REQ_set_io_uring_result,
     REQ_ioctl,
     REQ_set_irp_result,
     REQ_create_named_pipe,
@@ -6179,6 +6473,11 @@ enum request
     REQ_remove_completion,
     REQ_get_thread_completion,
     REQ_query_completion,
+    REQ_get_completion_ring_fd,
+    REQ_get_completion_ring,
+    REQ_create_wait_completion_packet,
+    REQ_associate_wait_completion_packet,
+    REQ_cancel_wait_completion_packet,
     REQ_set_completion_info,
     REQ_add_fd_completion,
     REQ_set_fd_completion_mode,
@@ -6206,6 +6505,7 @@ enum request
     REQ_get_next_process,
     REQ_get_next_thread,
     REQ_set_keyboard_repeat,
+    REQ_batch,
     REQ_NB_REQUESTS
 };
 
@@ -6243,6 +6543,8 @@ union generic_request
     struct open_process_request open_process_request;
     struct open_thread_request open_thread_request;
     struct select_request select_request;
+    struct get_inproc_sync_fd_request get_inproc_sync_fd_request;
+    struct get_inproc_sync_request get_inproc_sync_request;
     struct create_event_request create_event_request;
     struct event_op_request event_op_request;
     struct query_event_request query_event_request;
@@ -6270,6 +6572,9 @@ union generic_request
     struct unlock_file_request unlock_file_request;
     struct recv_socket_request recv_socket_request;
     struct send_socket_request send_socket_request;
+    struct socket_get_batch_request socket_get_batch_request;
+    struct socket_set_batch_request socket_set_batch_request;
+    struct get_socket_fast_path_request get_socket_fast_path_request;
     struct socket_get_events_request socket_get_events_request;
     struct socket_send_icmp_id_request socket_send_icmp_id_request;
     struct socket_get_icmp_id_request socket_get_icmp_id_request;
@@ -6350,6 +6655,9 @@ union generic_request
     struct set_async_direct_result_request set_async_direct_result_request;
     struct read_request read_request;
     struct write_request write_request;
+    struct set_io_uring_request set_io_uring_request;
+    struct register_io_uring_async_request register_io_uring_async_request;
+    struct set_io_uring_result_request set_io_uring_result_request;
     struct ioctl_request ioctl_request;
     struct set_irp_result_request set_irp_result_request;
     struct create_named_pipe_request create_named_pipe_request;
@@ -6479,6 +6787,11 @@ union generic_request
     struct remove_completion_request remove_completion_request;
     struct get_thread_completion_request get_thread_completion_request;
     struct query_completion_request query_completion_request;
+    struct get_completion_ring_fd_request get_completion_ring_fd_request;
+    struct get_completion_ring_request get_completion_ring_request;
+    struct create_wait_completion_packet_request create_wait_completion_packet_request;
+    struct associate_wait_completion_packet_request associate_wait_completion_packet_request;
+    struct cancel_wait_completion_packet_request cancel_wait_completion_packet_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
     struct set_fd_completion_mode_request set_fd_completion_mode_request;
@@ -6506,6 +6819,7 @@ union generic_request
     struct get_next_process_request get_next_process_request;
     struct get_next_thread_request get_next_thread_request;
     struct set_keyboard_repeat_request set_keyboard_repeat_request;
+    struct batch_request batch_request;
 };
 union generic_reply
 {
@@ -6541,6 +6855,8 @@ union generic_reply
     struct open_process_reply open_process_reply;
     struct open_thread_reply open_thread_reply;
     struct select_reply select_reply;
+    struct get_inproc_sync_fd_reply get_inproc_sync_fd_reply;
+    struct get_inproc_sync_reply get_inproc_sync_reply;
     struct create_event_reply create_event_reply;
     struct event_op_reply event_op_reply;
     struct query_event_reply query_event_reply;
@@ -6568,6 +6884,9 @@ union generic_reply
     struct unlock_file_reply unlock_file_reply;
     struct recv_socket_reply recv_socket_reply;
     struct send_socket_reply send_socket_reply;
+    struct socket_get_batch_reply socket_get_batch_reply;
+    struct socket_set_batch_reply socket_set_batch_reply;
+    struct get_socket_fast_path_reply get_socket_fast_path_reply;
     struct socket_get_events_reply socket_get_events_reply;
     struct socket_send_icmp_id_reply socket_send_icmp_id_reply;
     struct socket_get_icmp_id_reply socket_get_icmp_id_reply;
@@ -6648,6 +6967,9 @@ union generic_reply
     struct set_async_direct_result_reply set_async_direct_result_reply;
     struct read_reply read_reply;
     struct write_reply write_reply;
+    struct set_io_uring_reply set_io_uring_reply;
+    struct register_io_uring_async_reply register_io_uring_async_reply;
+    struct set_io_uring_result_reply set_io_uring_result_reply;
     struct ioctl_reply ioctl_reply;
     struct set_irp_result_reply set_irp_result_reply;
     struct create_named_pipe_reply create_named_pipe_reply;
@@ -6777,6 +7099,11 @@ union generic_reply
     struct remove_completion_reply remove_completion_reply;
     struct get_thread_completion_reply get_thread_completion_reply;
     struct query_completion_reply query_completion_reply;
+    struct get_completion_ring_fd_reply get_completion_ring_fd_reply;
+    struct get_completion_ring_reply get_completion_ring_reply;
+    struct create_wait_completion_packet_reply create_wait_completion_packet_reply;
+    struct associate_wait_completion_packet_reply associate_wait_completion_packet_reply;
+    struct cancel_wait_completion_packet_reply cancel_wait_completion_packet_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
     struct set_fd_completion_mode_reply set_fd_completion_mode_reply;
@@ -6804,8 +7131,9 @@ union generic_reply
     struct get_next_process_reply get_next_process_reply;
     struct get_next_thread_reply get_next_thread_reply;
     struct set_keyboard_repeat_reply set_keyboard_repeat_reply;
+    struct batch_reply batch_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 871
+#define SERVER_PROTOCOL_VERSION 883
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
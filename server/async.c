@@ -58,6 +58,13 @@ struct async
     unsigned int         unknown_status :1; /* initial status is not known yet */
     unsigned int         blocking :1;     /* async is blocking */
     unsigned int         is_system :1;    /* background system operation not affecting userspace visible state. */
+    unsigned int         uncancelable :1; /* I/O is in progress in the Unix kernel and can't be canceled */
+    unsigned int         batched :1;      /* claimed by the previous async for batched client-side I/O */
+    unsigned int         batch_owner :1;  /* async has claimed the following ones */
+    unsigned int         batch_done :1;   /* client has reported the result of the claimed async */
+    unsigned int         batch_count;     /* number of asyncs claimed by this one */
+    unsigned int         batch_status;    /* result reported by the client for a claimed async */
+    apc_param_t          batch_total;
     struct completion   *completion;      /* completion associated with fd */
     apc_param_t          comp_key;        /* completion key associated with fd */
     unsigned int         comp_flags;      /* completion flags */
@@ -99,6 +106,8 @@ static inline void async_reselect( struct async *async )
     if (async->queue && async->fd) fd_reselect_async( async->fd, async->queue );
 }
 
+static void async_complete_batch( struct async_queue *queue );
+
 static void async_dump( struct object *obj, int verbose )
 {
     struct async *async = (struct async *)obj;
@@ -150,6 +159,7 @@ static void async_destroy( struct object *obj )
     if (async->queue)
     {
         list_remove( &async->queue_entry );
+        if (async->batch_owner) async_complete_batch( async->queue );
         async_reselect( async );
     }
     else if (async->fd) release_object( async->fd );
@@ -186,6 +196,9 @@ void async_terminate( struct async *async, unsigned int status )
         data.type            = APC_ASYNC_IO;
         data.async_io.user   = async->data.user;
         data.async_io.result = iosb ? iosb->result : 0;
+        /* tell the client how many of the following asyncs it has to process */
+        if (async->batch_count) data.async_io.result = async->batch_count;
+        async->batch_count = 0;
 
         /* this can happen if the initial status was unknown (i.e. for device
          * files). the client should not fill the IOSB in this case; pass it as
@@ -229,6 +242,22 @@ void free_async_queue( struct async_queue *queue )
     {
         if (!async->completion) async->completion = fd_get_completion( async->fd, &async->comp_key );
         async->fd = NULL;
+        if (async->batched)
+        {
+            async->batched = 0;
+            if (async->batch_done)
+            {
+                async->batch_done = 0;
+                /* the client is already done with it */
+                async->queue = NULL;
+                async_set_result( &async->obj, async->batch_status, async->batch_total );
+                release_object( &async->obj );
+                continue;
+            }
+            /* the client will never report a result for it */
+            async->terminated = 0;
+            async->alerted = 0;
+        }
         async_terminate( async, STATUS_HANDLES_CLOSED );
         async->queue = NULL;
         release_object( &async->obj );
@@ -279,6 +308,7 @@ struct async *create_async( struct fd *fd, struct thread *thread, const struct a
     async->unknown_status = 0;
     async->blocking      = !is_fd_overlapped( fd );
     async->is_system     = 0;
+    async->uncancelable  = 0;
     async->completion    = fd_get_completion( fd, &async->comp_key );
     async->comp_flags    = 0;
     async->completion_callback = NULL;
@@ -461,6 +491,12 @@ void async_set_unknown_status( struct async *async )
     async->direct_result = 0;
 }
 
+/* mark an async as being processed by the Unix kernel, only process termination cancels it */
+void async_set_uncancelable( struct async *async )
+{
+    async->uncancelable = 1;
+}
+
 /* set the timeout of an async operation */
 void async_set_timeout( struct async *async, timeout_t timeout, unsigned int status )
 {
@@ -484,6 +520,29 @@ static void add_async_completion( struct async *async, apc_param_t cvalue, unsig
     if (async->completion) add_completion( async->completion, async->comp_key, cvalue, status, information );
 }
 
+/* complete the claimed asyncs the client has reported a result for, and put the other ones back
+ * in the queue, since the client won't process them once the async that claimed them is done */
+static void async_complete_batch( struct async_queue *queue )
+{
+    struct async *async, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE( async, next, &queue->queue, struct async, queue_entry )
+    {
+        if (!async->batched) continue;
+        async->batched = 0;
+        if (async->batch_done)
+        {
+            async->batch_done = 0;
+            async_set_result( &async->obj, async->batch_status, async->batch_total );
+            continue;
+        }
+        async->terminated = 0;
+        async->alerted = 0;
+        if (async->iosb && async->iosb->status == STATUS_ALERTED) async->iosb->status = STATUS_PENDING;
+        async_reselect( async );
+    }
+}
+
 /* store the result of the client-side async callback */
 void async_set_result( struct object *obj, unsigned int status, apc_param_t total )
 {
@@ -499,6 +558,8 @@ void async_set_result( struct object *obj, unsigned int status, apc_param_t tota
     {
         async->terminated = 0;
         async->alerted = 0;
+        if (async->batch_owner && async->queue) async_complete_batch( async->queue );
+        async->batch_owner = 0;
         async_reselect( async );
     }
     else
@@ -542,6 +603,9 @@ void async_set_result( struct object *obj, unsigned int status, apc_param_t tota
 
         async_call_completion_callback( async );
 
+        if (async->batch_owner && async->queue) async_complete_batch( async->queue );
+        async->batch_owner = 0;
+
         if (async->queue)
         {
             list_remove( &async->queue_entry );
@@ -586,7 +650,7 @@ static int cancel_async( struct process *process, struct object *obj, struct thr
 restart:
     LIST_FOR_EACH_ENTRY( async, &process->asyncs, struct async, process_entry )
     {
-        if (async->terminated || async->canceled || async->is_system) continue;
+        if (async->terminated || async->canceled || async->is_system || async->uncancelable) continue;
         if ((!obj || (get_fd_user( async->fd ) == obj)) &&
             (!thread || async->thread == thread) &&
             (!iosb || async->data.iosb == iosb))
@@ -608,7 +672,7 @@ static int cancel_blocking( struct process *process, struct thread *thread, clie
 restart:
     LIST_FOR_EACH_ENTRY( async, &process->asyncs, struct async, process_entry )
     {
-        if (async->terminated || async->canceled) continue;
+        if (async->terminated || async->canceled || async->uncancelable) continue;
         if (async->blocking && async->thread == thread &&
             (!iosb || async->data.iosb == iosb))
         {
@@ -647,7 +711,8 @@ int async_close_obj_handle( struct object *obj, struct process *process, obj_han
 restart:
     LIST_FOR_EACH_ENTRY( async, &process->asyncs, struct async, process_entry )
     {
-        if (async->terminated || async->canceled || get_fd_user( async->fd ) != obj) continue;
+        if (async->terminated || async->canceled || async->uncancelable) continue;
+        if (get_fd_user( async->fd ) != obj) continue;
         if (!async->completion || !async->data.apc_context || async->event) continue;
 
         async->canceled = 1;
@@ -666,7 +731,7 @@ restart:
     {
         if (async->thread != thread || async->terminated || async->canceled) continue;
         if (async->completion && async->data.apc_context && !async->event) continue;
-        if (async->is_system) continue;
+        if (async->is_system || async->uncancelable) continue;
 
         async->canceled = 1;
         fd_cancel_async( async->fd, async );
@@ -687,6 +752,77 @@ void async_wake_up( struct async_queue *queue, unsigned int status )
     }
 }
 
+/* wake up the first async of the queue, and let the client process the following ones at the same time */
+void async_wake_up_batch( struct async_queue *queue, unsigned int max )
+{
+    struct async *first, *async;
+    struct list *ptr;
+
+    if (!(ptr = list_head( &queue->queue ))) return;
+    first = LIST_ENTRY( ptr, struct async, queue_entry );
+    if (first->terminated) return;
+
+    /* stop at the first async that can't be claimed, to complete them in order */
+    while (first->batch_count < max && (ptr = list_next( &queue->queue, ptr )))
+    {
+        async = LIST_ENTRY( ptr, struct async, queue_entry );
+        if (async->terminated || async->is_system || async->direct_result) break;
+        if (async->thread->process != first->thread->process) break;
+
+        async->batched = 1;
+        async->terminated = 1;
+        async->alerted = 1;
+        if (async->iosb && async->iosb->status == STATUS_PENDING) async->iosb->status = STATUS_ALERTED;
+        first->batch_count++;
+    }
+    first->batch_owner = !!first->batch_count;
+    async_terminate( first, STATUS_ALERTED );
+}
+
+/* retrieve the asyncs claimed for a batch by a client process */
+unsigned int async_get_batch( struct async_queue *queue, struct process *process,
+                              struct async_batch_entry *entries, unsigned int max )
+{
+    struct async *async;
+    unsigned int count = 0;
+
+    LIST_FOR_EACH_ENTRY( async, &queue->queue, struct async, queue_entry )
+    {
+        if (count == max) break;
+        if (!async->batched || async->thread->process != process) continue;
+        entries[count].user   = async->data.user;
+        entries[count].sb     = async->data.iosb;
+        entries[count].status = STATUS_ALERTED;
+        entries[count].total  = 0;
+        count++;
+    }
+    return count;
+}
+
+/* store the result of a claimed async, STATUS_PENDING puts it back in the queue */
+void async_set_batch_result( struct async_queue *queue, struct process *process,
+                             const struct async_batch_entry *entry )
+{
+    struct async *async;
+
+    LIST_FOR_EACH_ENTRY( async, &queue->queue, struct async, queue_entry )
+    {
+        if (!async->batched || async->batch_done || async->thread->process != process) continue;
+        if (async->data.user != entry->user) continue;
+        if (entry->status == STATUS_PENDING)
+        {
+            async->batched = 0;
+            async_set_result( &async->obj, STATUS_PENDING, 0 );
+            return;
+        }
+        /* complete it after the async that claimed it, to keep the completion order */
+        async->batch_done = 1;
+        async->batch_status = entry->status;
+        async->batch_total = entry->total;
+        return;
+    }
+}
+
 static void iosb_dump( struct object *obj, int verbose );
 static void iosb_destroy( struct object *obj );
 
@@ -90,6 +90,9 @@ struct dir
     int            want_data; /* return change data */
     int            subtree;  /* do we want to watch subdirectories? */
     struct list    change_records;   /* data for the change */
+    data_size_t    records_size;     /* total size of the queued change records */
+    int            overflow;         /* change records were dropped */
+    struct list    wake_entry;       /* entry in the list of directories to wake up */
     struct list    in_entry; /* entry in the inode dirs list */
     struct inode  *inode;    /* inode of the associated directory */
     struct process *client_process;  /* client process that has a cache for this directory */
@@ -424,9 +427,17 @@ static int dir_close_handle( struct object *obj, struct process *process, obj_ha
     return 1;  /* ok to close */
 }
 
-static void dir_destroy( struct object *obj )
+/* free all the queued change records */
+static void free_change_records( struct dir *dir )
 {
     struct change_record *record;
+
+    while ((record = get_first_change_record( dir ))) free( record );
+    dir->records_size = 0;
+}
+
+static void dir_destroy( struct object *obj )
+{
     struct dir *dir = (struct dir *)obj;
     assert (obj->ops == &dir_ops);
 
@@ -439,7 +450,7 @@ static void dir_destroy( struct object *obj )
         free_inode( dir->inode );
     }
 
-    while ((record = get_first_change_record( dir ))) free( record );
+    free_change_records( dir );
 
     release_dir_cache_entry( dir );
     release_object( dir->fd );
@@ -468,7 +479,20 @@ static enum server_fd_type dir_get_fd_type( struct fd *fd )
 
 #ifdef HAVE_SYS_INOTIFY_H
 
-#define HASH_SIZE 31
+#define HASH_SIZE 1021
+
+/* maximum size of the change records queued for a directory before reporting an overflow */
+#define MAX_CHANGE_RECORDS_SIZE 0x100000
+
+/* maximum number of directories scanned on each main loop iteration */
+#define SCAN_DIRS_PER_POLL 16
+
+enum inode_scan
+{
+    SCAN_NONE,      /* not queued for a scan */
+    SCAN_WATCH,     /* watch the existing subdirectories */
+    SCAN_NOTIFY,    /* also report the existing contents as added */
+};
 
 struct inode {
     struct list ch_entry;    /* entry in the children list */
@@ -481,10 +505,17 @@ struct inode {
     ino_t ino;               /* device's inode number */
     int wd;                  /* inotify's watch descriptor */
     char *name;              /* basename name of the inode */
+    struct list scan_entry;  /* entry in the scan list */
+    struct list dedup_entry; /* entry in the dedup list */
+    enum inode_scan scan;    /* pending scan of the directory contents */
 };
 
 static struct list inode_hash[ HASH_SIZE ];
 static struct list wd_hash[ HASH_SIZE ];
+static struct list wake_list = LIST_INIT(wake_list);  /* directories to wake up after an inotify read */
+static struct list scan_list = LIST_INIT(scan_list);  /* directories waiting to be scanned */
+static struct list dedup_list = LIST_INIT(dedup_list);  /* directories whose new files may be duplicated */
+static struct timeout_user *scan_timeout;
 
 static int inotify_add_dir( char *path, unsigned int filter );
 
@@ -531,6 +562,9 @@ static struct inode *create_inode( dev_t dev, ino_t ino )
         inode->wd = -1;
         inode->parent = NULL;
         inode->name = NULL;
+        inode->scan = SCAN_NONE;
+        list_init( &inode->scan_entry );
+        list_init( &inode->dedup_entry );
         list_add_tail( get_hash_list( dev, ino ), &inode->ino_entry );
     }
     return inode;
@@ -602,6 +636,8 @@ static void free_inode( struct inode *inode )
         list_remove( &inode->wd_entry );
     }
     list_remove( &inode->ino_entry );
+    list_remove( &inode->scan_entry );
+    list_remove( &inode->dedup_entry );
 
     free( inode->name );
     free( inode );
@@ -616,8 +652,10 @@ static struct inode *inode_add( struct inode *parent,
     if (!inode)
         return NULL;
  
-    if (!inode->parent)
+    if (inode->parent != parent)
     {
+        /* the directory may have been moved inside the tree */
+        if (inode->parent) list_remove( &inode->ch_entry );
         list_add_tail( &parent->children, &inode->ch_entry );
         inode->parent = parent;
         assert( inode != parent );
@@ -656,16 +694,77 @@ static int inotify_get_poll_events( struct fd *fd )
     return POLLIN;
 }
 
-static void inotify_do_change_notify( struct dir *dir, unsigned int action,
-                                      unsigned int cookie, const char *relpath )
+/* queue a directory to be woken up once the whole inotify buffer has been processed */
+static void queue_dir_wake_up( struct dir *dir )
+{
+    if (list_empty( &dir->wake_entry ))
+    {
+        grab_object( dir );
+        list_add_tail( &wake_list, &dir->wake_entry );
+    }
+}
+
+static void wake_up_dirs(void)
+{
+    struct list *ptr;
+
+    while ((ptr = list_head( &wake_list )))
+    {
+        struct dir *dir = LIST_ENTRY( ptr, struct dir, wake_entry );
+
+        list_remove( &dir->wake_entry );
+        list_init( &dir->wake_entry );
+        fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
+        release_object( dir );
+    }
+}
+
+/* check whether the last queued change of a file is its addition */
+static int is_added_file_queued( struct dir *dir, const char *relpath, size_t len )
+{
+    struct change_record *record;
+
+    LIST_FOR_EACH_ENTRY_REV( record, &dir->change_records, struct change_record, entry )
+    {
+        if (record->event.len != len || memcmp( record->event.name, relpath, len )) continue;
+        return record->event.action == FILE_ACTION_ADDED;
+    }
+    return 0;
+}
+
+static void inotify_do_change_notify( struct dir *dir, unsigned int action, unsigned int cookie,
+                                      const char *relpath, int dedup )
 {
     struct change_record *record;
 
     assert( dir->obj.ops == &dir_ops );
 
-    if (dir->want_data)
+    if (dir->want_data && !dir->overflow)
     {
         size_t len = strlen(relpath);
+        struct list *ptr = list_tail( &dir->change_records );
+
+        /* coalesce repeated modifications of the same file */
+        if (ptr && action == FILE_ACTION_MODIFIED)
+        {
+            record = LIST_ENTRY( ptr, struct change_record, entry );
+            if (record->event.action == action && record->event.len == len &&
+                !memcmp( record->event.name, relpath, len ))
+                goto done;
+        }
+
+        /* files created in a new directory may be seen both by inotify and by the directory scan */
+        if (dedup && action == FILE_ACTION_ADDED && is_added_file_queued( dir, relpath, len ))
+            goto done;
+
+        if (dir->records_size + offsetof( struct filesystem_event, name[len] ) > MAX_CHANGE_RECORDS_SIZE)
+        {
+            /* nobody is reading the changes, the client will have to enumerate the directory */
+            free_change_records( dir );
+            dir->overflow = 1;
+            goto done;
+        }
+
         record = malloc( offsetof(struct change_record, event.name[len]) );
         if (!record)
             return;
@@ -676,9 +775,11 @@ static void inotify_do_change_notify( struct dir *dir, unsigned int action,
         record->event.len = len;
 
         list_add_tail( &dir->change_records, &record->entry );
+        dir->records_size += offsetof( struct filesystem_event, name[len] );
     }
 
-    fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
+done:
+    queue_dir_wake_up( dir );
 }
 
 static unsigned int filter_from_event( struct inotify_event *ie )
@@ -772,21 +873,45 @@ static char *inode_get_path( struct inode *inode, int sz )
     return path;
 }
 
-static void inode_check_dir( struct inode *parent, const char *name )
+/* some subdirectories of an inode can't be watched, the directories watching it will
+ * have to be enumerated again by the client */
+static void inode_notify_overflow( struct inode *inode )
+{
+    struct inode *i;
+    struct dir *dir;
+
+    for (i = inode; i; i = i->parent)
+    {
+        LIST_FOR_EACH_ENTRY( dir, &i->dirs, struct dir, in_entry )
+        {
+            if (i != inode && !dir->subtree) continue;
+            free_change_records( dir );
+            dir->overflow = 1;
+            queue_dir_wake_up( dir );
+        }
+    }
+}
+
+/* start watching a subdirectory of a recursively watched directory, return it if it wasn't watched yet */
+static struct inode *inode_check_dir( struct inode *parent, const char *name )
 {
     char *path;
     unsigned int filter;
-    struct inode *inode;
+    struct inode *inode, *ret = NULL;
     struct stat st;
     int wd = -1;
 
     path = inode_get_path( parent, strlen(name) );
     if (!path)
-        return;
+        return NULL;
 
     strcat( path, name );
 
-    if (stat( path, &st ) < 0)
+    if (lstat( path, &st ) < 0 || !S_ISDIR( st.st_mode ))
+        goto end;
+
+    /* don't cross mount points */
+    if (st.st_dev != parent->dev)
         goto end;
 
     filter = filter_from_inode( parent, 1 );
@@ -799,12 +924,101 @@ static void inode_check_dir( struct inode *parent, const char *name )
 
     wd = inotify_add_dir( path, filter );
     if (wd != -1)
+    {
         inode_set_wd( inode, wd );
+        ret = inode;
+    }
     else
+    {
+        /* out of watches, changes in that directory would be missed */
+        if (errno == ENOSPC) inode_notify_overflow( parent );
         free_inode( inode );
+    }
 
 end:
     free( path );
+    return ret;
+}
+
+static void inotify_notify_all( struct inotify_event *ie, int dedup );
+static void scan_dirs( void *private );
+
+/* queue a newly watched directory to be scanned, a large tree is scanned a few directories at a time */
+static void queue_inode_scan( struct inode *inode, enum inode_scan scan )
+{
+    if (inode->scan == SCAN_NONE) list_add_tail( &scan_list, &inode->scan_entry );
+    inode->scan = max( inode->scan, scan );
+    if (!scan_timeout) scan_timeout = add_timeout_user( 0, scan_dirs, NULL );
+}
+
+/* watch the existing subdirectories of a newly watched directory; if notify is set, its contents
+ * are reported as added instead, since they may have been created before the watch */
+static void inode_scan_dir( struct inode *inode, int notify )
+{
+    struct inotify_event *ie;
+    struct dirent *de;
+    struct inode *child;
+    char *path;
+    DIR *dirp;
+
+    if (!(path = inode_get_path( inode, 0 ))) return;
+    dirp = opendir( path );
+    free( path );
+    if (!dirp) return;
+
+    while ((de = readdir( dirp )))
+    {
+        size_t len = strlen( de->d_name );
+
+        if (!strcmp( de->d_name, "." ) || !strcmp( de->d_name, ".." )) continue;
+        if (notify)
+        {
+            if (!(ie = malloc( offsetof( struct inotify_event, name[len + 1] )))) break;
+            ie->wd = inode->wd;
+            ie->mask = IN_CREATE;
+            if (de->d_type == DT_DIR) ie->mask |= IN_ISDIR;
+            else if (de->d_type == DT_UNKNOWN)
+            {
+                struct stat st;
+                if (!fstatat( dirfd( dirp ), de->d_name, &st, AT_SYMLINK_NOFOLLOW ) && S_ISDIR( st.st_mode ))
+                    ie->mask |= IN_ISDIR;
+            }
+            ie->cookie = 0;
+            ie->len = len + 1;
+            memcpy( ie->name, de->d_name, len + 1 );
+            inotify_notify_all( ie, 1 );
+            free( ie );
+        }
+        else if (de->d_type == DT_DIR || de->d_type == DT_UNKNOWN)
+        {
+            if ((child = inode_check_dir( inode, de->d_name ))) queue_inode_scan( child, SCAN_WATCH );
+        }
+    }
+    closedir( dirp );
+}
+
+static void scan_dirs( void *private )
+{
+    unsigned int count = 0;
+    enum inode_scan scan;
+    struct inode *inode;
+    struct list *ptr;
+
+    scan_timeout = NULL;
+    while (count++ < SCAN_DIRS_PER_POLL && (ptr = list_head( &scan_list )))
+    {
+        inode = LIST_ENTRY( ptr, struct inode, scan_entry );
+        list_remove( &inode->scan_entry );
+        list_init( &inode->scan_entry );
+        scan = inode->scan;
+        inode->scan = SCAN_NONE;
+        /* inotify may still report files that the scan has seen, until its queue has been read */
+        if (scan == SCAN_NOTIFY && list_empty( &inode->dedup_entry ))
+            list_add_tail( &dedup_list, &inode->dedup_entry );
+        inode_scan_dir( inode, scan == SCAN_NOTIFY );
+    }
+    if (!list_empty( &scan_list )) scan_timeout = add_timeout_user( 0, scan_dirs, NULL );
+    wake_up_dirs();
 }
 
 static int prepend( char **path, const char *segment )
@@ -834,10 +1048,10 @@ static int prepend( char **path, const char *segment )
     return 1;
 }
 
-static void inotify_notify_all( struct inotify_event *ie )
+static void inotify_notify_all( struct inotify_event *ie, int dedup )
 {
     unsigned int filter, action;
-    struct inode *inode, *i;
+    struct inode *inode, *i, *new_dir = NULL;
     char *path = NULL;
     struct dir *dir;
 
@@ -853,8 +1067,9 @@ static void inotify_notify_all( struct inotify_event *ie )
     if (ie->mask & IN_CREATE)
     {
         if (ie->mask & IN_ISDIR)
-            inode_check_dir( inode, ie->name );
+            new_dir = inode_check_dir( inode, ie->name );
 
+        dedup |= !list_empty( &inode->dedup_entry ) || inode->scan == SCAN_NOTIFY;
         action = FILE_ACTION_ADDED;
     }
     else if (ie->mask & IN_DELETE)
@@ -862,7 +1077,13 @@ static void inotify_notify_all( struct inotify_event *ie )
     else if (ie->mask & IN_MOVED_FROM)
         action = FILE_ACTION_RENAMED_OLD_NAME;
     else if (ie->mask & IN_MOVED_TO)
+    {
+        /* a directory moved into the tree needs to be watched too */
+        if ((ie->mask & IN_ISDIR) && (i = inode_check_dir( inode, ie->name )))
+            queue_inode_scan( i, SCAN_WATCH );
+
         action = FILE_ACTION_RENAMED_NEW_NAME;
+    }
     else
         action = FILE_ACTION_MODIFIED;
 
@@ -878,7 +1099,7 @@ static void inotify_notify_all( struct inotify_event *ie )
     {
         LIST_FOR_EACH_ENTRY( dir, &i->dirs, struct dir, in_entry )
             if ((filter & dir->filter) && (i==inode || dir->subtree))
-                inotify_do_change_notify( dir, action, ie->cookie, path );
+                inotify_do_change_notify( dir, action, ie->cookie, path, dedup );
 
         if (!i->name || !prepend( &path, i->name ))
             break;
@@ -886,6 +1107,9 @@ static void inotify_notify_all( struct inotify_event *ie )
 
     free( path );
 
+    /* report the contents of the new directory after the directory itself */
+    if (new_dir) queue_inode_scan( new_dir, SCAN_NOTIFY );
+
     if (ie->mask & IN_DELETE)
     {
         i = inode_from_name( inode, ie->name );
@@ -894,14 +1118,33 @@ static void inotify_notify_all( struct inotify_event *ie )
     }
 }
 
+/* the kernel dropped events, all the watching directories need to be enumerated again */
+static void inotify_notify_overflow(void)
+{
+    struct dir *dir;
+
+    LIST_FOR_EACH_ENTRY( dir, &change_list, struct dir, entry )
+    {
+        if (!dir->inode) continue;
+        free_change_records( dir );
+        dir->overflow = 1;
+        queue_dir_wake_up( dir );
+    }
+}
+
 static void inotify_poll_event( struct fd *fd, int event )
 {
     int r, ofs, unix_fd;
-    char buffer[0x1000];
+    static union
+    {
+        struct inotify_event ie;
+        char data[0x10000];
+    } buffer;
     struct inotify_event *ie;
 
+    /* read as many events as possible, and wake up each directory only once for the batch */
     unix_fd = get_unix_fd( fd );
-    r = read( unix_fd, buffer, sizeof buffer );
+    r = read( unix_fd, buffer.data, sizeof(buffer.data) );
     if (r < 0)
     {
         fprintf(stderr,"inotify_poll_event(): inotify read failed!\n");
@@ -910,11 +1153,27 @@ static void inotify_poll_event( struct fd *fd, int event )
 
     for( ofs = 0; ofs < r - offsetof(struct inotify_event, name); )
     {
-        ie = (struct inotify_event*) &buffer[ofs];
+        ie = (struct inotify_event*) &buffer.data[ofs];
         ofs += offsetof( struct inotify_event, name[ie->len] );
         if (ofs > r) break;
-        if (ie->len) inotify_notify_all( ie );
+        if (ie->mask & IN_Q_OVERFLOW) inotify_notify_overflow();
+        else if (ie->len) inotify_notify_all( ie, 0 );
+    }
+
+    /* the queue has been emptied, the files seen by the previous scans can't be reported again */
+    if (r < sizeof(buffer.data) - offsetof( struct inotify_event, name[NAME_MAX + 1] ))
+    {
+        struct list *ptr;
+
+        while ((ptr = list_head( &dedup_list )))
+        {
+            struct inode *inode = LIST_ENTRY( ptr, struct inode, dedup_entry );
+            list_remove( &inode->dedup_entry );
+            list_init( &inode->dedup_entry );
+        }
     }
+
+    wake_up_dirs();
 }
 
 static inline struct fd *create_inotify_fd( void )
@@ -983,13 +1242,16 @@ static int inotify_adjust_changes( struct dir *dir )
     struct inode *inode;
     struct stat st;
     char *path;
-    int wd, unix_fd;
+    int wd, unix_fd, scan;
 
     if (!inotify_fd)
         return 0;
 
     unix_fd = get_unix_fd( dir->fd );
 
+    /* the existing subdirectories only need to be scanned the first time */
+    scan = dir->subtree && !dir->inode;
+
     inode = dir->inode;
     if (!inode)
     {
@@ -1015,6 +1277,9 @@ static int inotify_adjust_changes( struct dir *dir )
 
     inode_set_wd( inode, wd );
 
+    /* watch the existing subdirectories, new ones are added as they get created */
+    if (scan) queue_inode_scan( inode, SCAN_WATCH );
+
     return 1;
 }
 
@@ -1142,6 +1407,9 @@ struct object *create_dir_obj( struct fd *fd, unsigned int access, mode_t mode )
         return NULL;
 
     list_init( &dir->change_records );
+    list_init( &dir->wake_entry );
+    dir->records_size = 0;
+    dir->overflow = 0;
     dir->filter = 0;
     dir->notified = 0;
     dir->want_data = 0;
@@ -1215,7 +1483,7 @@ DECL_HANDLER(read_directory_changes)
     }
 
     /* if there's already a change in the queue, send it */
-    if (!list_empty( &dir->change_records ))
+    if (!list_empty( &dir->change_records ) || dir->overflow)
         fd_async_wake_up( dir->fd, ASYNC_TYPE_WAIT, STATUS_ALERTED );
 
     /* setup the real notification */
@@ -1241,8 +1509,17 @@ DECL_HANDLER(read_change)
     if (!dir)
         return;
 
+    if (dir->overflow)
+    {
+        dir->overflow = 0;
+        release_object( dir );
+        set_error( STATUS_NOTIFY_ENUM_DIR );
+        return;
+    }
+
     list_init( &events );
     list_move_tail( &events, &dir->change_records );
+    dir->records_size = 0;
     release_object( dir );
 
     if (list_empty( &events ))
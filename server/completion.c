@@ -23,8 +23,12 @@
 
 #include "config.h"
 
+#include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/mman.h>
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -51,6 +55,21 @@ struct type_descr completion_type =
     },
 };
 
+static const WCHAR wait_completion_packet_name[] =
+    {'W','a','i','t','C','o','m','p','l','e','t','i','o','n','P','a','c','k','e','t'};
+
+struct type_descr wait_completion_packet_type =
+{
+    { wait_completion_packet_name, sizeof(wait_completion_packet_name) },   /* name */
+    STANDARD_RIGHTS_REQUIRED | 0x3,                                         /* valid_access */
+    {                                                                       /* mapping */
+        STANDARD_RIGHTS_READ | 0x1,
+        STANDARD_RIGHTS_WRITE | 0x2,
+        STANDARD_RIGHTS_EXECUTE,
+        STANDARD_RIGHTS_REQUIRED | 0x3
+    },
+};
+
 struct comp_msg
 {
     struct   list queue_entry;
@@ -58,6 +77,23 @@ struct comp_msg
     apc_param_t   cvalue;
     apc_param_t   information;
     unsigned int  status;
+    struct wait_completion_packet *packet;  /* wait completion packet that queued the message */
+};
+
+/* A wait completion packet waits on an object on behalf of a completion port, and
+ * queues a message to the port once the object is signaled. This lets a single
+ * thread wait for any number of objects. */
+struct wait_completion_packet
+{
+    struct object       obj;
+    struct thread_wait *wait;           /* wait on the target object, if any */
+    struct completion  *completion;     /* port to queue the message to, while waiting */
+    struct completion  *msg_completion; /* port where the message is queued */
+    struct comp_msg    *msg;            /* queued message, if any */
+    apc_param_t         ckey;           /* completion key */
+    apc_param_t         cvalue;         /* completion value */
+    apc_param_t         information;    /* IO_STATUS_BLOCK Information */
+    unsigned int        status;         /* completion result */
 };
 
 struct completion_wait
@@ -68,29 +104,51 @@ struct completion_wait
     struct thread     *thread;
     struct comp_msg   *msg;
     struct list        wait_queue_entry;
+    int                waiting;       /* is the thread blocked waiting for a message? */
 };
 
 struct completion
 {
-    struct object  obj;
-    struct list    queue;
-    struct list    wait_queue;
-    unsigned int   depth;
-    int            closed;
+    struct object      obj;
+    struct list        queue;
+    struct list        wait_queue;
+    unsigned int       depth;
+    int                closed;
+    completion_ring_t *ring;          /* shared memory ring, if any */
+    unsigned int       waiters;       /* number of threads blocked in the server */
 };
 
+/* Completion rings let clients remove packets without a server round-trip. The server only
+ * adds packets to the ring when no thread is blocked waiting on the port and the queue is
+ * empty, so that packets are still returned in order. As soon as a thread blocks, the ring
+ * contents are moved back to the queue and packets go through the server again. */
+
+#define COMPLETION_RINGS_PER_BLOCK  (COMPLETION_RING_BLOCK_SIZE / sizeof(completion_ring_t))
+#define COMPLETION_RING_MAX_BLOCKS  1024
+
+static int completion_ring_fd = -1;            /* fd of the shared memory file */
+static completion_ring_t *ring_blocks[COMPLETION_RING_MAX_BLOCKS];  /* mapped blocks of rings */
+static unsigned int nb_ring_blocks;            /* number of allocated blocks */
+static unsigned int *free_rings;               /* indices of free rings */
+static unsigned int free_ring_count;           /* number of entries in the free list */
+static unsigned int last_ring_id;              /* last allocated port id */
+
 static void completion_wait_dump( struct object*, int );
+static int completion_wait_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void completion_wait_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int completion_wait_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void completion_wait_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static void completion_wait_destroy( struct object * );
+static void wait_completion_packet_dump( struct object *, int );
+static void wait_completion_packet_destroy( struct object * );
 
 static const struct object_ops completion_wait_ops =
 {
     sizeof(struct completion_wait), /* size */
     &no_type,                       /* type */
     completion_wait_dump,           /* dump */
-    add_queue,                      /* add_queue */
-    remove_queue,                   /* remove_queue */
+    completion_wait_add_queue,      /* add_queue */
+    completion_wait_remove_queue,   /* remove_queue */
     completion_wait_signaled,       /* signaled */
     completion_wait_satisfied,      /* satisfied */
     no_signal,                      /* signal */
@@ -108,6 +166,195 @@ static const struct object_ops completion_wait_ops =
     completion_wait_destroy         /* destroy */
 };
 
+static const struct object_ops wait_completion_packet_ops =
+{
+    sizeof(struct wait_completion_packet), /* size */
+    &wait_completion_packet_type,   /* type */
+    wait_completion_packet_dump,    /* dump */
+    no_add_queue,                   /* add_queue */
+    NULL,                           /* remove_queue */
+    NULL,                           /* signaled */
+    NULL,                           /* satisfied */
+    no_signal,                      /* signal */
+    no_get_fd,                      /* get_fd */
+    default_map_access,             /* map_access */
+    default_get_sd,                 /* get_sd */
+    default_set_sd,                 /* set_sd */
+    default_get_full_name,          /* get_full_name */
+    no_lookup_name,                 /* lookup_name */
+    directory_link_name,            /* link_name */
+    default_unlink_name,            /* unlink_name */
+    no_open_file,                   /* open_file */
+    no_kernel_obj_list,             /* get_kernel_obj_list */
+    no_close_handle,                /* close_handle */
+    wait_completion_packet_destroy  /* destroy */
+};
+
+/* add a block of rings to the shared memory file */
+static int grow_completion_rings(void)
+{
+    unsigned int i, *new_list;
+    void *ptr;
+
+    if (nb_ring_blocks == COMPLETION_RING_MAX_BLOCKS) return 0;
+    if (completion_ring_fd == -1 &&
+        (completion_ring_fd = create_temp_file( COMPLETION_RING_BLOCK_SIZE )) == -1)
+        return 0;
+    if (!grow_file( completion_ring_fd, (file_pos_t)(nb_ring_blocks + 1) * COMPLETION_RING_BLOCK_SIZE ))
+        return 0;
+    if (!(new_list = realloc( free_rings, (nb_ring_blocks + 1) * COMPLETION_RINGS_PER_BLOCK * sizeof(*free_rings) )))
+    {
+        set_error( STATUS_NO_MEMORY );
+        return 0;
+    }
+    free_rings = new_list;
+
+    if ((ptr = mmap( NULL, COMPLETION_RING_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     completion_ring_fd, (off_t)nb_ring_blocks * COMPLETION_RING_BLOCK_SIZE )) == MAP_FAILED)
+    {
+        file_set_error();
+        return 0;
+    }
+    ring_blocks[nb_ring_blocks] = ptr;
+
+    /* push the indices in reverse order so that the lowest ones get allocated first */
+    for (i = COMPLETION_RINGS_PER_BLOCK; i > 0; i--)
+        free_rings[free_ring_count++] = nb_ring_blocks * COMPLETION_RINGS_PER_BLOCK + i - 1;
+    nb_ring_blocks++;
+    return 1;
+}
+
+static inline completion_ring_t *get_ring_ptr( unsigned int index )
+{
+    return &ring_blocks[index / COMPLETION_RINGS_PER_BLOCK][index % COMPLETION_RINGS_PER_BLOCK];
+}
+
+/* retrieve the index of a ring */
+static unsigned int get_ring_index( completion_ring_t *ring )
+{
+    unsigned int i;
+
+    for (i = 0; i < nb_ring_blocks; i++)
+    {
+        if (ring < ring_blocks[i] || ring >= ring_blocks[i] + COMPLETION_RINGS_PER_BLOCK) continue;
+        return i * COMPLETION_RINGS_PER_BLOCK + (ring - ring_blocks[i]);
+    }
+    assert( 0 );
+    return 0;
+}
+
+/* allocate a ring for a new port; failure is not an error, the port just doesn't use a ring */
+static completion_ring_t *alloc_completion_ring(void)
+{
+    completion_ring_t *ring;
+    unsigned int i;
+
+    if (!free_ring_count && !grow_completion_rings())
+    {
+        clear_error();
+        return NULL;
+    }
+    ring = get_ring_ptr( free_rings[--free_ring_count] );
+    ring->head = ring->tail = 0;
+    for (i = 0; i < COMPLETION_RING_SIZE; i++) ring->entries[i].seq = i;
+    if (!++last_ring_id) last_ring_id++;
+    /* the id is set last, clients check it to know if the ring is valid */
+    WriteRelease( (LONG *)&ring->id, last_ring_id );
+    return ring;
+}
+
+static void free_completion_ring( completion_ring_t *ring )
+{
+    WriteRelease( (LONG *)&ring->id, 0 );
+    free_rings[free_ring_count++] = get_ring_index( ring );
+}
+
+/* number of packets currently in the ring */
+static unsigned int get_ring_count( struct completion *completion )
+{
+    if (!completion->ring) return 0;
+    return min( completion->ring->tail - ReadAcquire( (LONG *)&completion->ring->head ), COMPLETION_RING_SIZE );
+}
+
+/* add a packet to the ring; fails if it is full */
+static int add_ring_packet( completion_ring_t *ring, apc_param_t ckey, apc_param_t cvalue,
+                            unsigned int status, apc_param_t information )
+{
+    unsigned int pos = ring->tail;
+    completion_ring_entry_t *entry = &ring->entries[pos % COMPLETION_RING_SIZE];
+
+    /* the entry is free once the consumer of the previous round has released it */
+    if (ReadAcquire( (LONG *)&entry->seq ) != pos) return 0;
+    entry->ckey        = ckey;
+    entry->cvalue      = cvalue;
+    entry->status      = status;
+    entry->information = information;
+    WriteRelease( (LONG *)&entry->seq, pos + 1 );
+    WriteRelease( (LONG *)&ring->tail, pos + 1 );
+    return 1;
+}
+
+/* remove the oldest packet from the ring, competing with the clients */
+static struct comp_msg *remove_ring_packet( completion_ring_t *ring )
+{
+    completion_ring_entry_t *entry;
+    struct comp_msg *msg;
+    unsigned int pos;
+
+    pos = ReadAcquire( (LONG *)&ring->head );
+    for (;;)
+    {
+        unsigned int prev = pos;
+
+        if ((int)(ring->tail - pos) <= 0) return NULL;
+        entry = &ring->entries[pos % COMPLETION_RING_SIZE];
+        if (ReadAcquire( (LONG *)&entry->seq ) == pos + 1 &&
+            (pos = InterlockedCompareExchange( (LONG *)&ring->head, pos + 1, pos )) == prev)
+            break;
+        /* retry only if a client removed a packet in the meantime */
+        if (pos == prev && (pos = ReadAcquire( (LONG *)&ring->head )) == prev) return NULL;
+    }
+
+    if ((msg = mem_alloc( sizeof(*msg) )))
+    {
+        msg->ckey        = entry->ckey;
+        msg->cvalue      = entry->cvalue;
+        msg->status      = entry->status;
+        msg->information = entry->information;
+        msg->packet      = NULL;
+    }
+    WriteRelease( (LONG *)&entry->seq, pos + COMPLETION_RING_SIZE );
+    return msg;
+}
+
+/* move the ring contents back to the queue, before the packets that are already queued */
+static void flush_completion_ring( struct completion *completion )
+{
+    struct list *pos = list_head( &completion->queue );
+    struct comp_msg *msg;
+
+    if (!completion->ring) return;
+    while ((msg = remove_ring_packet( completion->ring )))
+    {
+        if (pos) list_add_before( pos, &msg->queue_entry );
+        else list_add_tail( &completion->queue, &msg->queue_entry );
+        completion->depth++;
+    }
+}
+
+/* remove a message from the port queue */
+static void remove_comp_msg( struct completion *completion, struct comp_msg *msg )
+{
+    list_remove( &msg->queue_entry );
+    completion->depth--;
+    if (msg->packet)
+    {
+        msg->packet->msg = NULL;
+        msg->packet->msg_completion = NULL;
+        msg->packet = NULL;
+    }
+}
+
 static void completion_wait_destroy( struct object *obj )
 {
     struct completion_wait *wait = (struct completion_wait *)obj;
@@ -123,6 +370,34 @@ static void completion_wait_dump( struct object *obj, int verbose )
     fprintf( stderr, "Completion wait completion=%p\n", wait->completion );
 }
 
+static int completion_wait_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct completion_wait *wait = (struct completion_wait *)obj;
+
+    assert( obj->ops == &completion_wait_ops );
+    if (wait->completion && !wait->waiting)
+    {
+        /* make sure that no packet can be left in the ring while we are waiting */
+        wait->waiting = 1;
+        wait->completion->waiters++;
+        flush_completion_ring( wait->completion );
+    }
+    return add_queue( obj, entry );
+}
+
+static void completion_wait_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct completion_wait *wait = (struct completion_wait *)obj;
+
+    assert( obj->ops == &completion_wait_ops );
+    if (wait->waiting)
+    {
+        if (wait->completion) wait->completion->waiters--;
+        wait->waiting = 0;
+    }
+    remove_queue( obj, entry );
+}
+
 static int completion_wait_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct completion_wait *wait = (struct completion_wait *)obj;
@@ -147,8 +422,7 @@ static void completion_wait_satisfied( struct object *obj, struct wait_queue_ent
     msg_entry = list_head( &wait->completion->queue );
     assert( msg_entry );
     msg = LIST_ENTRY( msg_entry, struct comp_msg, queue_entry );
-    --wait->completion->depth;
-    list_remove( &msg->queue_entry );
+    remove_comp_msg( wait->completion, msg );
     if (wait->msg) free( wait->msg );
     wait->msg = msg;
 }
@@ -189,8 +463,10 @@ static void completion_destroy( struct object *obj)
 
     LIST_FOR_EACH_ENTRY_SAFE( tmp, next, &completion->queue, struct comp_msg, queue_entry )
     {
+        remove_comp_msg( completion, tmp );
         free( tmp );
     }
+    if (completion->ring) free_completion_ring( completion->ring );
 }
 
 static void completion_dump( struct object *obj, int verbose )
@@ -198,14 +474,14 @@ static void completion_dump( struct object *obj, int verbose )
     struct completion *completion = (struct completion *) obj;
 
     assert( obj->ops == &completion_ops );
-    fprintf( stderr, "Completion depth=%u\n", completion->depth );
+    fprintf( stderr, "Completion depth=%u ring=%u\n", completion->depth, get_ring_count( completion ) );
 }
 
 static int completion_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct completion *completion = (struct completion *)obj;
 
-    return !list_empty( &completion->queue ) || completion->closed;
+    return !list_empty( &completion->queue ) || get_ring_count( completion ) || completion->closed;
 }
 
 static int completion_close_handle( struct object *obj, struct process *process, obj_handle_t handle )
@@ -218,6 +494,7 @@ static int completion_close_handle( struct object *obj, struct process *process,
     LIST_FOR_EACH_ENTRY_SAFE( wait, wait_next, &completion->wait_queue, struct completion_wait, wait_queue_entry )
     {
         assert( wait->completion );
+        if (wait->waiting) completion->waiters--;
         wait->completion = NULL;
         list_remove( &wait->wait_queue_entry );
         if (!wait->msg)
@@ -253,6 +530,7 @@ static struct completion_wait *create_completion_wait( struct thread *thread )
     wait->completion = NULL;
     wait->thread = thread;
     wait->msg = NULL;
+    wait->waiting = 0;
     if (!(wait->handle = alloc_handle( current->process, wait, SYNCHRONIZE, 0 )))
     {
         release_object( &wait->obj );
@@ -262,7 +540,7 @@ static struct completion_wait *create_completion_wait( struct thread *thread )
 }
 
 static struct completion *create_completion( struct object *root, const struct unicode_str *name,
-                                             unsigned int attr, unsigned int concurrent,
+                                             unsigned int attr, unsigned int concurrent, int ring,
                                              const struct security_descriptor *sd )
 {
     struct completion *completion;
@@ -275,6 +553,8 @@ static struct completion *create_completion( struct object *root, const struct u
             list_init( &completion->wait_queue );
             completion->depth = 0;
             completion->closed = 0;
+            completion->waiters = 0;
+            completion->ring = ring ? alloc_completion_ring() : NULL;
         }
     }
 
@@ -286,28 +566,93 @@ struct completion *get_completion_obj( struct process *process, obj_handle_t han
     return (struct completion *) get_handle_obj( process, handle, access, &completion_ops );
 }
 
+/* add a message to the port queue and wake up the waiting threads */
+static void queue_comp_msg( struct completion *completion, struct comp_msg *msg )
+{
+    struct completion_wait *wait;
+
+    list_add_tail( &completion->queue, &msg->queue_entry );
+    completion->depth++;
+    LIST_FOR_EACH_ENTRY( wait, &completion->wait_queue, struct completion_wait, wait_queue_entry )
+    {
+        wake_up( &wait->obj, 1 );
+        if (list_empty( &completion->queue )) return;
+    }
+    if (!list_empty( &completion->queue )) wake_up( &completion->obj, 0 );
+}
+
 void add_completion( struct completion *completion, apc_param_t ckey, apc_param_t cvalue,
                      unsigned int status, apc_param_t information )
 {
     struct comp_msg *msg = mem_alloc( sizeof( *msg ) );
-    struct completion_wait *wait;
 
     if (!msg)
         return;
 
+    /* no thread can be waiting for the packet in the server, let the clients fetch it */
+    if (completion->ring && !completion->waiters && list_empty( &completion->queue ) &&
+        add_ring_packet( completion->ring, ckey, cvalue, status, information ))
+    {
+        free( msg );
+        wake_up( &completion->obj, 0 );
+        return;
+    }
+
     msg->ckey = ckey;
     msg->cvalue = cvalue;
     msg->status = status;
     msg->information = information;
+    msg->packet = NULL;
+    queue_comp_msg( completion, msg );
+}
 
-    list_add_tail( &completion->queue, &msg->queue_entry );
-    completion->depth++;
-    LIST_FOR_EACH_ENTRY( wait, &completion->wait_queue, struct completion_wait, wait_queue_entry )
+static void wait_completion_packet_dump( struct object *obj, int verbose )
+{
+    struct wait_completion_packet *packet = (struct wait_completion_packet *)obj;
+
+    assert( obj->ops == &wait_completion_packet_ops );
+    fprintf( stderr, "WaitCompletionPacket waiting=%d queued=%d\n", packet->wait != NULL, packet->msg != NULL );
+}
+
+static void wait_completion_packet_destroy( struct object *obj )
+{
+    struct wait_completion_packet *packet = (struct wait_completion_packet *)obj;
+
+    assert( obj->ops == &wait_completion_packet_ops );
+    if (packet->wait) remove_detached_wait( packet->wait );
+    if (packet->completion) release_object( packet->completion );
+    /* a message that is already queued stays in the port */
+    if (packet->msg) packet->msg->packet = NULL;
+}
+
+/* the packet target object has been signaled, queue the message to the port */
+static void wait_completion_packet_satisfied( void *private, unsigned int status )
+{
+    struct wait_completion_packet *packet = private;
+    struct completion *completion = packet->completion;
+    struct comp_msg *msg;
+
+    packet->wait = NULL;
+    packet->completion = NULL;
+
+    if ((msg = mem_alloc( sizeof(*msg) )))
     {
-        wake_up( &wait->obj, 1 );
-        if (list_empty( &completion->queue )) return;
+        msg->ckey        = packet->ckey;
+        msg->cvalue      = packet->cvalue;
+        msg->status      = packet->status;
+        msg->information = packet->information;
+        msg->packet      = packet;
+        packet->msg      = msg;
+        packet->msg_completion = completion;
+        queue_comp_msg( completion, msg );
     }
-    if (!list_empty( &completion->queue )) wake_up( &completion->obj, 0 );
+    release_object( completion );
+}
+
+static struct wait_completion_packet *get_wait_completion_packet_obj( struct process *process, obj_handle_t handle,
+                                                                      unsigned int access )
+{
+    return (struct wait_completion_packet *)get_handle_obj( process, handle, access, &wait_completion_packet_ops );
 }
 
 /* create a completion */
@@ -321,7 +666,7 @@ DECL_HANDLER(create_completion)
 
     if (!objattr) return;
 
-    if ((completion = create_completion( root, &name, objattr->attributes, req->concurrent, sd )))
+    if ((completion = create_completion( root, &name, objattr->attributes, req->concurrent, req->ring, sd )))
     {
         if (get_error() == STATUS_OBJECT_NAME_EXISTS)
             reply->handle = alloc_handle( current->process, completion, req->access, objattr->attributes );
@@ -375,7 +720,8 @@ DECL_HANDLER(remove_completion)
 
     entry = list_head( &completion->queue );
     if (req->alertable && !list_empty( &current->user_apc )
-        && !(entry && current->completion_wait && current->completion_wait->completion == completion))
+        && !((entry || get_ring_count( completion )) &&
+             current->completion_wait && current->completion_wait->completion == completion))
     {
         set_error( STATUS_USER_APC );
         release_object( completion );
@@ -392,16 +738,25 @@ DECL_HANDLER(remove_completion)
     }
     current->completion_wait->completion = completion;
     list_add_head( &completion->wait_queue, &current->completion_wait->wait_queue_entry );
-    if (!entry)
+    /* packets in the ring are older than the queued ones */
+    if (completion->ring && (msg = remove_ring_packet( completion->ring )))
+    {
+        reply->ckey = msg->ckey;
+        reply->cvalue = msg->cvalue;
+        reply->status = msg->status;
+        reply->information = msg->information;
+        free( msg );
+        reply->wait_handle = 0;
+    }
+    else if (!entry)
     {
         reply->wait_handle = current->completion_wait->handle;
         set_error( STATUS_PENDING );
     }
     else
     {
-        list_remove( entry );
-        completion->depth--;
         msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
+        remove_comp_msg( completion, msg );
         reply->ckey = msg->ckey;
         reply->cvalue = msg->cvalue;
         reply->status = msg->status;
@@ -440,7 +795,127 @@ DECL_HANDLER(query_completion)
 
     if (!completion) return;
 
-    reply->depth = completion->depth;
+    reply->depth = completion->depth + get_ring_count( completion );
+
+    release_object( completion );
+}
+
+/* retrieve the file descriptor of the completion rings shared memory */
+DECL_HANDLER(get_completion_ring_fd)
+{
+    if (completion_ring_fd == -1 && !grow_completion_rings()) return;
+    send_client_fd( current->process, completion_ring_fd, 0 );
+}
+
+/* retrieve the shared memory ring of a completion port */
+DECL_HANDLER(get_completion_ring)
+{
+    struct completion *completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
+
+    if (!completion) return;
 
+    if (completion->ring)
+    {
+        reply->id    = completion->ring->id;
+        reply->index = get_ring_index( completion->ring );
+    }
     release_object( completion );
 }
+
+/* create a wait completion packet */
+DECL_HANDLER(create_wait_completion_packet)
+{
+    struct wait_completion_packet *packet;
+    struct unicode_str name;
+    struct object *root;
+    const struct security_descriptor *sd;
+    const struct object_attributes *objattr = get_req_object_attributes( &sd, &name, &root );
+
+    if (!objattr) return;
+
+    if ((packet = create_named_object( root, &wait_completion_packet_ops, &name, objattr->attributes, sd )))
+    {
+        if (get_error() != STATUS_OBJECT_NAME_EXISTS)
+        {
+            packet->wait           = NULL;
+            packet->completion     = NULL;
+            packet->msg_completion = NULL;
+            packet->msg            = NULL;
+        }
+        reply->handle = alloc_handle( current->process, packet, req->access, objattr->attributes );
+        release_object( packet );
+    }
+
+    if (root) release_object( root );
+}
+
+/* queue a wait completion packet to a port once an object is signaled */
+DECL_HANDLER(associate_wait_completion_packet)
+{
+    struct wait_completion_packet *packet;
+    struct completion *completion;
+    struct object *target;
+
+    if (!(packet = get_wait_completion_packet_obj( current->process, req->packet, 0 ))) return;
+
+    if (packet->wait || packet->msg)
+    {
+        set_error( STATUS_INVALID_PARAMETER_1 );
+        release_object( packet );
+        return;
+    }
+    if (!(completion = get_completion_obj( current->process, req->completion, IO_COMPLETION_MODIFY_STATE )))
+    {
+        release_object( packet );
+        return;
+    }
+    if (!(target = get_handle_obj( current->process, req->target, SYNCHRONIZE, NULL )))
+    {
+        release_object( completion );
+        release_object( packet );
+        return;
+    }
+
+    packet->ckey        = req->ckey;
+    packet->cvalue      = req->cvalue;
+    packet->information = req->information;
+    packet->status      = req->status;
+    packet->completion  = completion;
+    if ((packet->wait = add_detached_wait( target, wait_completion_packet_satisfied, packet )))
+        reply->signaled = wake_detached_wait( packet->wait );
+    else
+    {
+        packet->completion = NULL;
+        release_object( completion );
+    }
+
+    release_object( target );
+    release_object( packet );
+}
+
+/* cancel the wait of a wait completion packet */
+DECL_HANDLER(cancel_wait_completion_packet)
+{
+    struct wait_completion_packet *packet;
+
+    if (!(packet = get_wait_completion_packet_obj( current->process, req->packet, 0 ))) return;
+
+    if (packet->wait)
+    {
+        remove_detached_wait( packet->wait );
+        packet->wait = NULL;
+        release_object( packet->completion );
+        packet->completion = NULL;
+    }
+    else if (packet->msg && req->remove_signaled)
+    {
+        struct comp_msg *msg = packet->msg;
+
+        remove_comp_msg( packet->msg_completion, msg );
+        free( msg );
+    }
+    else if (packet->msg) set_error( STATUS_PENDING );
+    else set_error( STATUS_CANCELLED );
+
+    release_object( packet );
+}
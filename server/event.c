@@ -52,25 +52,29 @@ struct type_descr event_type =
 
 struct event
 {
-    struct object  obj;             /* object header */
-    struct list    kernel_object;   /* list of kernel object pointers */
-    int            manual_reset;    /* is it a manual reset event? */
-    int            signaled;        /* event has been signaled */
+    struct object      obj;             /* object header */
+    struct list        kernel_object;   /* list of kernel object pointers */
+    int                manual_reset;    /* is it a manual reset event? */
+    inproc_sync_shm_t *sync;            /* event state, the signaled flag is the state value */
+    inproc_sync_shm_t  local_sync;      /* event state storage when not in shared memory */
 };
 
 static void event_dump( struct object *obj, int verbose );
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void event_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static int event_signal( struct object *obj, unsigned int access);
 static struct list *event_get_kernel_obj_list( struct object *obj );
+static void event_destroy( struct object *obj );
 
 static const struct object_ops event_ops =
 {
     sizeof(struct event),      /* size */
     &event_type,               /* type */
     event_dump,                /* dump */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    event_add_queue,           /* add_queue */
+    event_remove_queue,        /* remove_queue */
     event_signaled,            /* signaled */
     event_satisfied,           /* satisfied */
     event_signal,              /* signal */
@@ -85,7 +89,7 @@ static const struct object_ops event_ops =
     no_open_file,              /* open_file */
     event_get_kernel_obj_list, /* get_kernel_obj_list */
     no_close_handle,           /* close_handle */
-    no_destroy                 /* destroy */
+    event_destroy              /* destroy */
 };
 
 
@@ -149,7 +153,8 @@ struct event *create_event( struct object *root, const struct unicode_str *name,
             /* initialize it if it didn't already exist */
             list_init( &event->kernel_object );
             event->manual_reset = manual_reset;
-            event->signaled     = initial_state;
+            event->sync = create_inproc_sync( &event->local_sync, INPROC_SYNC_EVENT,
+                                              !!initial_state, manual_reset );
         }
     }
     return event;
@@ -160,24 +165,35 @@ struct event *get_event_obj( struct process *process, obj_handle_t handle, unsig
     return (struct event *)get_handle_obj( process, handle, access, &event_ops );
 }
 
+static inline int is_event_signaled( struct event *event )
+{
+    return (get_inproc_sync_state( event->sync ) & INPROC_SYNC_VALUE_MASK) != 0;
+}
+
 static void pulse_event( struct event *event )
 {
-    event->signaled = 1;
+    set_inproc_sync_value( event->sync, 1 );
     /* wake up all waiters if manual reset, a single one otherwise */
     wake_up( &event->obj, !event->manual_reset );
-    event->signaled = 0;
+    /* let a client-side waiter claim the pulse if no server waiter did */
+    if (!event->manual_reset && is_event_signaled( event ) && event->sync->waiters)
+        WriteRelease( &event->sync->pulse_token, 1 );
+    InterlockedIncrement( &event->sync->pulse_seq );
+    set_inproc_sync_value( event->sync, 0 );
+    wake_inproc_sync( event->sync );
 }
 
 void set_event( struct event *event )
 {
-    event->signaled = 1;
+    set_inproc_sync_value( event->sync, 1 );
     /* wake up all waiters if manual reset, a single one otherwise */
     wake_up( &event->obj, !event->manual_reset );
+    wake_inproc_sync( event->sync );
 }
 
 void reset_event( struct event *event )
 {
-    event->signaled = 0;
+    set_inproc_sync_value( event->sync, 0 );
 }
 
 static void event_dump( struct object *obj, int verbose )
@@ -185,14 +201,30 @@ static void event_dump( struct object *obj, int verbose )
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
     fprintf( stderr, "Event manual=%d signaled=%d\n",
-             event->manual_reset, event->signaled );
+             event->manual_reset, is_event_signaled( event ) );
+}
+
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    add_inproc_sync_waiter( event->sync );
+    return add_queue( obj, entry );
+}
+
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    remove_inproc_sync_waiter( event->sync );
+    remove_queue( obj, entry );
 }
 
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
-    return event->signaled;
+    return is_event_signaled( event );
 }
 
 static void event_satisfied( struct object *obj, struct wait_queue_entry *entry )
@@ -200,7 +232,7 @@ static void event_satisfied( struct object *obj, struct wait_queue_entry *entry
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
     /* Reset if it's an auto-reset event */
-    if (!event->manual_reset) event->signaled = 0;
+    if (!event->manual_reset) set_inproc_sync_value( event->sync, 0 );
 }
 
 static int event_signal( struct object *obj, unsigned int access )
@@ -223,6 +255,19 @@ static struct list *event_get_kernel_obj_list( struct object *obj )
     return &event->kernel_object;
 }
 
+static void event_destroy( struct object *obj )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    free_inproc_sync( event->sync );
+}
+
+inproc_sync_shm_t *get_event_inproc_sync( struct object *obj )
+{
+    if (obj->ops != &event_ops) return NULL;
+    return ((struct event *)obj)->sync;
+}
+
 struct keyed_event *create_keyed_event( struct object *root, const struct unicode_str *name,
                                         unsigned int attr, const struct security_descriptor *sd )
 {
@@ -316,7 +361,7 @@ DECL_HANDLER(event_op)
     struct event *event;
 
     if (!(event = get_event_obj( current->process, req->handle, EVENT_MODIFY_STATE ))) return;
-    reply->state = event->signaled;
+    reply->state = is_event_signaled( event );
     switch(req->op)
     {
     case PULSE_EVENT:
@@ -343,7 +388,7 @@ DECL_HANDLER(query_event)
     if (!(event = get_event_obj( current->process, req->handle, EVENT_QUERY_STATE ))) return;
 
     reply->manual_reset = event->manual_reset;
-    reply->state = event->signaled;
+    reply->state = is_event_signaled( event );
 
     release_object( event );
 }
@@ -74,6 +74,7 @@
 #undef LIST_INIT
 #undef LIST_ENTRY
 #endif
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #ifdef MAJOR_IN_MKDEV
@@ -86,6 +87,9 @@
 #ifdef HAVE_SYS_SYSCALL_H
 #include <sys/syscall.h>
 #endif
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -326,14 +330,25 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct list           entry;      /* entry in expired timeouts list */
+    int                   index;      /* index in the timeout heap, or -1 once expired */
     abstime_t             when;       /* timeout expiry */
+    unsigned __int64      seq;        /* insertion sequence number, to order equal expiries */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list abs_timeout_list = LIST_INIT(abs_timeout_list); /* sorted absolute timeouts list */
-static struct list rel_timeout_list = LIST_INIT(rel_timeout_list); /* sorted relative timeouts list */
+/* binary min-heap of timeouts, ordered by expiry, then by insertion order */
+struct timeout_heap
+{
+    struct timeout_user **users;      /* array of timeouts */
+    int                   count;      /* number of timeouts in the heap */
+    int                   size;       /* allocated size of the array */
+};
+
+static struct timeout_heap abs_timeouts;  /* absolute timeouts, based on current_time */
+static struct timeout_heap rel_timeouts;  /* relative timeouts, based on monotonic_time */
+static unsigned __int64 timeout_seq;      /* sequence number of the last added timeout */
 timeout_t current_time;
 timeout_t monotonic_time;
 
@@ -410,43 +425,126 @@ void set_current_time(void)
     if (user_shared_data) set_user_shared_data_time();
 }
 
+/* expiry time of a timeout; relative timeouts are stored as negative values */
+static inline timeout_t get_timeout_expiry( const struct timeout_user *user )
+{
+    return user->when > 0 ? user->when : -user->when;
+}
+
+/* check whether a timeout expires before another one of the same heap */
+static inline int timeout_before( const struct timeout_user *a, const struct timeout_user *b )
+{
+    timeout_t expiry_a = get_timeout_expiry( a ), expiry_b = get_timeout_expiry( b );
+
+    if (expiry_a != expiry_b) return expiry_a < expiry_b;
+    return a->seq < b->seq;
+}
+
+static inline struct timeout_heap *get_timeout_heap( const struct timeout_user *user )
+{
+    return user->when > 0 ? &abs_timeouts : &rel_timeouts;
+}
+
+/* store a timeout at a given position in the heap */
+static inline void set_heap_timeout( struct timeout_heap *heap, int index, struct timeout_user *user )
+{
+    heap->users[index] = user;
+    user->index = index;
+}
+
+/* move a timeout up the heap until its parent expires before it */
+static void sift_timeout_up( struct timeout_heap *heap, int index )
+{
+    struct timeout_user *user = heap->users[index];
+
+    while (index)
+    {
+        int parent = (index - 1) / 2;
+        if (!timeout_before( user, heap->users[parent] )) break;
+        set_heap_timeout( heap, index, heap->users[parent] );
+        index = parent;
+    }
+    set_heap_timeout( heap, index, user );
+}
+
+/* move a timeout down the heap until its children expire after it */
+static void sift_timeout_down( struct timeout_heap *heap, int index )
+{
+    struct timeout_user *user = heap->users[index];
+
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && timeout_before( heap->users[child + 1], heap->users[child] ))
+            child++;
+        if (!timeout_before( heap->users[child], user )) break;
+        set_heap_timeout( heap, index, heap->users[child] );
+        index = child;
+    }
+    set_heap_timeout( heap, index, user );
+}
+
+/* remove a timeout from its heap */
+static void remove_heap_timeout( struct timeout_heap *heap, struct timeout_user *user )
+{
+    int index = user->index;
+    struct timeout_user *last = heap->users[--heap->count];
+
+    user->index = -1;
+    if (last == user) return;
+    set_heap_timeout( heap, index, last );
+    if (index && timeout_before( last, heap->users[(index - 1) / 2] ))
+        sift_timeout_up( heap, index );
+    else
+        sift_timeout_down( heap, index );
+}
+
+/* return the first timeout to expire in a heap */
+static inline struct timeout_user *get_first_timeout( const struct timeout_heap *heap )
+{
+    return heap->count ? heap->users[0] : NULL;
+}
+
 /* add a timeout user */
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
+    struct timeout_heap *heap;
     struct timeout_user *user;
-    struct list *ptr;
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = timeout_to_abstime( when );
+    user->seq      = ++timeout_seq;
     user->callback = func;
     user->private  = private;
 
-    /* Now insert it in the linked list */
+    /* Now insert it in the heap */
 
-    if (user->when > 0)
+    heap = get_timeout_heap( user );
+    if (heap->count == heap->size)
     {
-        LIST_FOR_EACH( ptr, &abs_timeout_list )
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            if (timeout->when >= user->when) break;
-        }
-    }
-    else
-    {
-        LIST_FOR_EACH( ptr, &rel_timeout_list )
+        int size = max( 64, heap->size * 2 );
+        struct timeout_user **new_users = realloc( heap->users, size * sizeof(*new_users) );
+
+        if (!new_users)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            if (timeout->when <= user->when) break;
+            free( user );
+            set_error( STATUS_NO_MEMORY );
+            return NULL;
         }
+        heap->users = new_users;
+        heap->size  = size;
     }
-    list_add_before( ptr, &user->entry );
+    heap->users[heap->count] = user;
+    sift_timeout_up( heap, heap->count++ );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (user->index != -1) remove_heap_timeout( get_timeout_heap( user ), user );
+    else list_remove( &user->entry );  /* expired but its callback hasn't been called yet */
     free( user );
 }
 
@@ -882,57 +980,44 @@ static int get_next_timeout( struct timespec *ts )
 {
     timeout_t ret = user_shared_data ? user_shared_data_timeout : -1;
 
-    if (!list_empty( &abs_timeout_list ) || !list_empty( &rel_timeout_list ))
+    if (abs_timeouts.count || rel_timeouts.count)
     {
+        struct timeout_user *timeout;
         struct list expired_list, *ptr;
 
-        /* first remove all expired timers from the list */
+        /* first remove all expired timers from the heaps */
 
         list_init( &expired_list );
-        while ((ptr = list_head( &abs_timeout_list )) != NULL)
+        while ((timeout = get_first_timeout( &abs_timeouts )) && timeout->when <= current_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            remove_heap_timeout( &abs_timeouts, timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
-        while ((ptr = list_head( &rel_timeout_list )) != NULL)
+        while ((timeout = get_first_timeout( &rel_timeouts )) && -timeout->when <= monotonic_time)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-
-            if (-timeout->when <= monotonic_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
+            remove_heap_timeout( &rel_timeouts, timeout );
+            list_add_tail( &expired_list, &timeout->entry );
         }
 
         /* now call the callback for all the removed timers */
 
         while ((ptr = list_head( &expired_list )) != NULL)
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+            timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
             list_remove( &timeout->entry );
             timeout->callback( timeout->private );
             free( timeout );
         }
 
-        if ((ptr = list_head( &abs_timeout_list )) != NULL)
+        if ((timeout = get_first_timeout( &abs_timeouts )))
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
             timeout_t diff = timeout->when - current_time;
             if (diff < 0) diff = 0;
             if (ret == -1 || diff < ret) ret = diff;
         }
 
-        if ((ptr = list_head( &rel_timeout_list )) != NULL)
+        if ((timeout = get_first_timeout( &rel_timeouts )))
         {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
             timeout_t diff = -timeout->when - monotonic_time;
             if (diff < 0) diff = 0;
             if (ret == -1 || diff < ret) ret = diff;
@@ -2922,6 +3007,319 @@ DECL_HANDLER(register_async)
     }
 }
 
+#ifdef HAVE_LINUX_IO_URING_H
+
+/* io_uring support: the client submits overlapped reads and writes on regular files
+ * to its io_uring instance, and the server reaps the completions to complete the asyncs */
+
+struct io_uring_slot
+{
+    struct async               *async;      /* async waiting for the completion */
+    unsigned int                next_free;  /* next free slot */
+    int                         type;       /* ASYNC_TYPE_READ or ASYNC_TYPE_WRITE */
+    data_size_t                 count;      /* number of bytes requested */
+};
+
+struct io_uring_ring
+{
+    struct object               obj;        /* object header */
+    struct fd                  *fd;         /* fd of the io_uring instance */
+    void                       *ptr;        /* mapping of the completion ring */
+    data_size_t                 size;       /* size of the mapping */
+    unsigned int               *head;       /* completion ring head, updated by the server */
+    const unsigned int         *tail;       /* completion ring tail, updated by the kernel */
+    const struct io_uring_cqe  *cqes;       /* completion ring entries */
+    unsigned int                mask;       /* completion ring index mask */
+    unsigned int                count;      /* number of slots */
+    unsigned int                free_slot;  /* first free slot, count if none */
+    struct io_uring_slot       *slots;      /* asyncs submitted to the ring */
+};
+
+static void io_uring_dump( struct object *obj, int verbose );
+static void io_uring_destroy( struct object *obj );
+
+static const struct object_ops io_uring_ops =
+{
+    sizeof(struct io_uring_ring), /* size */
+    &no_type,                 /* type */
+    io_uring_dump,            /* dump */
+    no_add_queue,             /* add_queue */
+    NULL,                     /* remove_queue */
+    NULL,                     /* signaled */
+    NULL,                     /* satisfied */
+    no_signal,                /* signal */
+    no_get_fd,                /* get_fd */
+    default_map_access,       /* map_access */
+    default_get_sd,           /* get_sd */
+    default_set_sd,           /* set_sd */
+    no_get_full_name,         /* get_full_name */
+    no_lookup_name,           /* lookup_name */
+    no_link_name,             /* link_name */
+    NULL,                     /* unlink_name */
+    no_open_file,             /* open_file */
+    no_kernel_obj_list,       /* get_kernel_obj_list */
+    no_close_handle,          /* close_handle */
+    io_uring_destroy          /* destroy */
+};
+
+static void io_uring_poll_event( struct fd *fd, int event );
+
+static const struct fd_ops io_uring_fd_ops =
+{
+    NULL,                     /* get_poll_events */
+    io_uring_poll_event,      /* poll_event */
+    NULL,                     /* flush */
+    NULL,                     /* get_fd_type */
+    NULL,                     /* ioctl */
+    NULL,                     /* queue_async */
+    NULL                      /* reselect_async */
+};
+
+static void io_uring_dump( struct object *obj, int verbose )
+{
+    struct io_uring_ring *ring = (struct io_uring_ring *)obj;
+    assert( obj->ops == &io_uring_ops );
+    fprintf( stderr, "io_uring fd=%p entries=%u\n", ring->fd, ring->count );
+}
+
+static void io_uring_destroy( struct object *obj )
+{
+    struct io_uring_ring *ring = (struct io_uring_ring *)obj;
+    unsigned int i;
+
+    assert( obj->ops == &io_uring_ops );
+
+    if (ring->slots)
+    {
+        for (i = 0; i < ring->count; i++)
+            if (ring->slots[i].async) release_object( ring->slots[i].async );
+        free( ring->slots );
+    }
+    if (ring->ptr) munmap( ring->ptr, ring->size );
+    if (ring->fd) release_object( ring->fd );
+}
+
+/* complete the async of a slot and free the slot */
+static void io_uring_complete( struct io_uring_ring *ring, unsigned int slot,
+                               unsigned int status, data_size_t total )
+{
+    struct async *async = ring->slots[slot].async;
+
+    ring->slots[slot].async = NULL;
+    ring->slots[slot].next_free = ring->free_slot;
+    ring->free_slot = slot;
+    async_request_complete( async, status, total, 0, NULL );
+    release_object( async );
+}
+
+/* reap the completion ring entries */
+static void io_uring_poll_event( struct fd *fd, int event )
+{
+    struct io_uring_ring *ring = get_fd_user( fd );
+    unsigned int head = *ring->head, tail = ReadAcquire( (const LONG *)ring->tail );
+
+    while (head != tail)
+    {
+        const struct io_uring_cqe *cqe = &ring->cqes[head++ & ring->mask];
+        unsigned int slot = cqe->user_data, status = STATUS_SUCCESS;
+
+        if (cqe->user_data >= ring->count || !ring->slots[slot].async) continue;
+
+        /* the client retries the I/O itself, in case the buffer is protected for write watches */
+        if (cqe->res == -EFAULT) status = STATUS_ACCESS_VIOLATION;
+        else if (cqe->res < 0)
+        {
+            errno = -cqe->res;
+            file_set_error();
+            status = get_error();
+            clear_error();
+        }
+        else if (!cqe->res && ring->slots[slot].type == ASYNC_TYPE_READ && ring->slots[slot].count)
+            status = STATUS_END_OF_FILE;
+
+        io_uring_complete( ring, slot, status, max( cqe->res, 0 ));
+        if (head == tail) tail = ReadAcquire( (const LONG *)ring->tail );
+    }
+    WriteRelease( (LONG *)ring->head, head );
+}
+
+/* check that a field of the completion ring is inside the mapping */
+static int is_valid_ring_field( data_size_t size, unsigned int offset, data_size_t len )
+{
+    return !(offset % sizeof(int)) && offset <= size && len <= size - offset;
+}
+
+/* free the io_uring instance of a terminated process */
+void free_process_io_uring( struct process *process )
+{
+    if (!process->io_uring) return;
+    release_object( process->io_uring );
+    process->io_uring = NULL;
+}
+
+/* let the server reap the completions of a client io_uring instance */
+DECL_HANDLER(set_io_uring)
+{
+    struct io_uring_ring *ring;
+    unsigned int i;
+    int unix_fd;
+
+    if ((unix_fd = thread_get_inflight_fd( current, req->fd )) == -1)
+    {
+        set_error( STATUS_INVALID_HANDLE );
+        return;
+    }
+    if (current->process->io_uring || !req->entries || (req->entries & (req->entries - 1)) ||
+        req->entries > 65536 || req->size > 16 * 1024 * 1024 ||
+        !is_valid_ring_field( req->size, req->head, sizeof(int) ) ||
+        !is_valid_ring_field( req->size, req->tail, sizeof(int) ) ||
+        !is_valid_ring_field( req->size, req->mask, sizeof(int) ) ||
+        !is_valid_ring_field( req->size, req->cqes, req->entries * sizeof(struct io_uring_cqe) ))
+    {
+        close( unix_fd );
+        set_error( STATUS_INVALID_PARAMETER );
+        return;
+    }
+
+    if (!(ring = alloc_object( &io_uring_ops )))
+    {
+        close( unix_fd );
+        return;
+    }
+    ring->ptr   = NULL;
+    ring->size  = req->size;
+    ring->count = req->entries;
+    ring->slots = NULL;
+    if (!(ring->fd = create_anonymous_fd( &io_uring_fd_ops, unix_fd, &ring->obj, 0 ))) goto failed;
+
+    if ((ring->ptr = mmap( NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           unix_fd, IORING_OFF_CQ_RING )) == MAP_FAILED)
+    {
+        ring->ptr = NULL;
+        file_set_error();
+        goto failed;
+    }
+    ring->head = (unsigned int *)((char *)ring->ptr + req->head);
+    ring->tail = (const unsigned int *)((char *)ring->ptr + req->tail);
+    ring->cqes = (const struct io_uring_cqe *)((char *)ring->ptr + req->cqes);
+    ring->mask = *(const unsigned int *)((char *)ring->ptr + req->mask);
+    if (ring->mask != ring->count - 1)
+    {
+        set_error( STATUS_INVALID_PARAMETER );
+        goto failed;
+    }
+
+    if (!(ring->slots = mem_alloc( ring->count * sizeof(*ring->slots) ))) goto failed;
+    for (i = 0; i < ring->count; i++)
+    {
+        ring->slots[i].async = NULL;
+        ring->slots[i].next_free = i + 1;
+    }
+    ring->free_slot = 0;
+
+    set_fd_events( ring->fd, POLLIN );
+    current->process->io_uring = ring;
+    return;
+
+failed:
+    release_object( ring );
+}
+
+/* create an async for a read or write submitted to the process io_uring */
+DECL_HANDLER(register_io_uring_async)
+{
+    struct io_uring_ring *ring = current->process->io_uring;
+    struct io_uring_slot *slot;
+    unsigned int access;
+    struct async *async;
+    struct fd *fd;
+
+    switch (req->type)
+    {
+    case ASYNC_TYPE_READ:
+        access = FILE_READ_DATA;
+        break;
+    case ASYNC_TYPE_WRITE:
+        access = FILE_WRITE_DATA;
+        break;
+    default:
+        set_error( STATUS_INVALID_PARAMETER );
+        return;
+    }
+
+    if (!ring)
+    {
+        set_error( STATUS_NOT_SUPPORTED );
+        return;
+    }
+    /* the client falls back to synchronous I/O, which also keeps the completion ring from overflowing */
+    if (ring->free_slot == ring->count)
+    {
+        set_error( STATUS_INSUFFICIENT_RESOURCES );
+        return;
+    }
+
+    if (!(fd = get_handle_fd_obj( current->process, req->async.handle, access ))) return;
+
+    if (!fd->inode || !is_fd_overlapped( fd )) set_error( STATUS_NOT_SUPPORTED );
+    else if ((async = create_request_async( fd, fd->comp_flags, &req->async, 0 )))
+    {
+        reply->slot = ring->free_slot;
+        slot = &ring->slots[reply->slot];
+        ring->free_slot = slot->next_free;
+        slot->async = (struct async *)grab_object( async );
+        slot->type  = req->type;
+        slot->count = req->count;
+
+        /* the kernel may still access the buffer, so the I/O can't be canceled once submitted */
+        async_set_uncancelable( async );
+        set_fd_signaled( fd, 0 );
+        set_error( STATUS_PENDING );
+        async_handoff( async, NULL, 0 );
+        release_object( async );
+    }
+    release_object( fd );
+}
+
+/* complete an io_uring async that could not be submitted */
+DECL_HANDLER(set_io_uring_result)
+{
+    struct io_uring_ring *ring = current->process->io_uring;
+
+    if (!ring || req->slot >= ring->count || !ring->slots[req->slot].async)
+    {
+        set_error( STATUS_INVALID_PARAMETER );
+        return;
+    }
+    io_uring_complete( ring, req->slot, req->status, req->total );
+}
+
+#else  /* HAVE_LINUX_IO_URING_H */
+
+void free_process_io_uring( struct process *process )
+{
+}
+
+DECL_HANDLER(set_io_uring)
+{
+    int unix_fd;
+
+    if ((unix_fd = thread_get_inflight_fd( current, req->fd )) != -1) close( unix_fd );
+    set_error( STATUS_NOT_SUPPORTED );
+}
+
+DECL_HANDLER(register_io_uring_async)
+{
+    set_error( STATUS_NOT_SUPPORTED );
+}
+
+DECL_HANDLER(set_io_uring_result)
+{
+    set_error( STATUS_NOT_SUPPORTED );
+}
+
+#endif  /* HAVE_LINUX_IO_URING_H */
+
 /* attach completion object to a fd */
 DECL_HANDLER(set_completion_info)
 {
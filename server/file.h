@@ -129,6 +129,7 @@ extern void default_fd_queue_async( struct fd *fd, struct async *async, int type
 extern void default_fd_reselect_async( struct fd *fd, struct async_queue *queue );
 extern void main_loop(void);
 extern void remove_process_locks( struct process *process );
+extern void free_process_io_uring( struct process *process );
 
 static inline struct fd *get_obj_fd( struct object *obj ) { return obj->ops->get_fd( obj ); }
 
@@ -177,6 +178,7 @@ struct memory_view;
 
 extern void init_memory(void);
 extern int grow_file( int unix_fd, file_pos_t new_size );
+extern int create_temp_file( file_pos_t size );
 extern void free_map_addr( client_ptr_t base, mem_size_t size );
 extern struct memory_view *find_mapped_view( struct process *process, client_ptr_t base );
 extern struct memory_view *get_exe_view( struct process *process );
@@ -261,6 +263,7 @@ extern void async_set_timeout( struct async *async, timeout_t timeout, unsigned
 extern void async_set_result( struct object *obj, unsigned int status, apc_param_t total );
 extern void async_set_completion_callback( struct async *async, async_completion_callback func, void *private );
 extern void async_set_unknown_status( struct async *async );
+extern void async_set_uncancelable( struct async *async );
 extern void set_async_pending( struct async *async );
 extern void async_set_initial_status( struct async *async, unsigned int status );
 extern void async_wake_obj( struct async *async );
@@ -272,6 +275,11 @@ extern void async_request_complete( struct async *async, unsigned int status, da
 extern void async_request_complete_alloc( struct async *async, unsigned int status, data_size_t result,
                                           data_size_t out_size, const void *out_data );
 extern void async_wake_up( struct async_queue *queue, unsigned int status );
+extern void async_wake_up_batch( struct async_queue *queue, unsigned int max );
+extern unsigned int async_get_batch( struct async_queue *queue, struct process *process,
+                                     struct async_batch_entry *entries, unsigned int max );
+extern void async_set_batch_result( struct async_queue *queue, struct process *process,
+                                    const struct async_batch_entry *entry );
 extern struct completion *fd_get_completion( struct fd *fd, apc_param_t *p_key );
 extern void fd_copy_completion( struct fd *src, struct fd *dst );
 extern struct iosb *async_get_iosb( struct async *async );
@@ -43,6 +43,8 @@ struct handle_entry
 {
     struct object *ptr;       /* object */
     unsigned int   access;    /* access rights */
+    int            next;      /* next entry in the free list (free entries only) */
+    int            prev;      /* previous entry in the free list (free entries only) */
 };
 
 struct handle_table
@@ -51,7 +53,7 @@ struct handle_table
     struct process      *process;     /* process owning this table */
     int                  count;       /* number of allocated entries */
     int                  last;        /* last used entry */
-    int                  free;        /* first entry that may be free */
+    int                  free;        /* head of the list of free entries below last, or -1 */
     struct handle_entry *entries;     /* handle entries */
 };
 
@@ -100,7 +102,7 @@ static inline obj_handle_t handle_global_to_local( obj_handle_t handle )
 /* grab an object and increment its handle count */
 static struct object *grab_object_for_handle( struct object *obj )
 {
-    obj->handle_count++;
+    if (obj->handle_count++) sock_handle_added( obj );
     obj->ops->type->handle_count++;
     obj->ops->type->handle_max = max( obj->ops->type->handle_max, obj->ops->type->handle_count );
     return grab_object( obj );
@@ -208,7 +210,7 @@ struct handle_table *alloc_handle_table( struct process *process, int count )
     table->process = process;
     table->count   = count;
     table->last    = -1;
-    table->free    = 0;
+    table->free    = -1;
     if ((table->entries = mem_alloc( count * sizeof(*table->entries) ))) return table;
     release_object( table );
     return NULL;
@@ -231,21 +233,51 @@ static int grow_handle_table( struct handle_table *table )
     return 1;
 }
 
-/* allocate the first free entry in the handle table */
-static obj_handle_t alloc_entry( struct handle_table *table, void *obj, unsigned int access )
+/* add an entry to the head of the free list */
+static void push_free_entry( struct handle_table *table, int index )
+{
+    struct handle_entry *entry = table->entries + index;
+
+    entry->ptr  = NULL;
+    entry->next = table->free;
+    entry->prev = -1;
+    if (table->free != -1) table->entries[table->free].prev = index;
+    table->free = index;
+}
+
+/* remove an entry from the free list */
+static void unlink_free_entry( struct handle_table *table, int index )
+{
+    struct handle_entry *entry = table->entries + index;
+
+    if (entry->prev != -1) table->entries[entry->prev].next = entry->next;
+    else table->free = entry->next;
+    if (entry->next != -1) table->entries[entry->next].prev = entry->prev;
+}
+
+/* rebuild the free list from scratch, with the lowest entries first */
+static void init_free_list( struct handle_table *table )
 {
-    struct handle_entry *entry = table->entries + table->free;
     int i;
 
-    for (i = table->free; i <= table->last; i++, entry++) if (!entry->ptr) goto found;
-    if (i >= table->count)
+    table->free = -1;
+    for (i = table->last; i >= 0; i--) if (!table->entries[i].ptr) push_free_entry( table, i );
+}
+
+/* allocate a free entry in the handle table */
+static obj_handle_t alloc_entry( struct handle_table *table, void *obj, unsigned int access )
+{
+    struct handle_entry *entry;
+    int i = table->free;
+
+    if (i != -1) unlink_free_entry( table, i );
+    else
     {
-        if (!grow_handle_table( table )) return 0;
-        entry = table->entries + i;  /* the entries may have moved */
+        i = table->last + 1;
+        if (i >= table->count && !grow_handle_table( table )) return 0;
+        table->last = i;
     }
-    table->last = i;
- found:
-    table->free = i + 1;
+    entry = table->entries + i;
     entry->ptr    = grab_object_for_handle( obj );
     entry->access = access;
     return index_to_handle(i);
@@ -346,6 +378,7 @@ static void shrink_handle_table( struct handle_table *table )
     while (table->last >= 0)
     {
         if (entry->ptr) break;
+        unlink_free_entry( table, table->last );
         table->last--;
         entry--;
     }
@@ -417,6 +450,7 @@ struct handle_table *copy_handle_table( struct process *process, struct process
             }
         }
     }
+    init_free_list( table );
     /* attempt to shrink the table */
     shrink_handle_table( table );
     return table;
@@ -433,9 +467,8 @@ unsigned int close_handle( struct process *process, obj_handle_t handle )
     if (entry->access & RESERVED_CLOSE_PROTECT) return STATUS_HANDLE_NOT_CLOSABLE;
     obj = entry->ptr;
     if (!obj->ops->close_handle( obj, process, handle )) return STATUS_HANDLE_NOT_CLOSABLE;
-    entry->ptr = NULL;
     table = handle_is_global(handle) ? global_table : process->handles;
-    if (entry < table->entries + table->free) table->free = entry - table->entries;
+    push_free_entry( table, entry - table->entries );
     if (entry == table->entries + table->last) shrink_handle_table( table );
     release_object_from_handle( obj );
     return STATUS_SUCCESS;
@@ -0,0 +1,267 @@
+/*
+ * In-process synchronization objects support
+ *
+ * Copyright (C) 2026 Wine contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * Events, mutexes and semaphores keep their state in a shared memory block
+ * that is mapped by all the client processes. When no thread is waiting on
+ * the object in the server, clients can signal and acquire the object with
+ * atomic operations, and sleep on a futex while waiting for it to become
+ * signaled. As soon as the server queues a waiter on the object, the server
+ * waiters count stored in the state prevents clients from modifying it, and
+ * all further operations go through the server until the waiters are gone.
+ */
+
+#include "config.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+# include <linux/futex.h>
+# include <sys/syscall.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+
+#include "file.h"
+#include "handle.h"
+#include "thread.h"
+#include "request.h"
+
+#define INPROC_SYNC_PER_BLOCK  (INPROC_SYNC_BLOCK_SIZE / sizeof(inproc_sync_shm_t))
+#define INPROC_SYNC_MAX_BLOCKS 4096
+
+static int inproc_sync_enabled = -1;           /* is in-process synchronization enabled? */
+static int inproc_sync_fd = -1;                /* fd of the shared memory file */
+static inproc_sync_shm_t *blocks[INPROC_SYNC_MAX_BLOCKS];  /* mapped blocks of shared objects */
+static unsigned int nb_blocks;                 /* number of allocated blocks */
+static unsigned int *free_list;                /* indices of free shared objects */
+static unsigned int free_count;                /* number of entries in the free list */
+
+/* check whether in-process synchronization is enabled */
+int do_inproc_sync(void)
+{
+#ifdef __linux__
+    if (inproc_sync_enabled == -1)
+    {
+        const char *env = getenv( "WINEINPROCSYNC" );
+        inproc_sync_enabled = env && atoi( env );
+        if (inproc_sync_enabled && debug_level) fprintf( stderr, "wineserver: using in-process synchronization\n" );
+    }
+    return inproc_sync_enabled;
+#else
+    return 0;
+#endif
+}
+
+/* enable in-process synchronization for the objects created from now on, once a client asks for it */
+static int enable_inproc_sync(void)
+{
+#ifdef __linux__
+    if (!do_inproc_sync())
+    {
+        inproc_sync_enabled = 1;
+        if (debug_level) fprintf( stderr, "wineserver: using in-process synchronization\n" );
+    }
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* add a block of shared objects to the shared memory file */
+static int grow_inproc_sync(void)
+{
+    unsigned int i, *new_list;
+    void *ptr;
+
+    if (nb_blocks == INPROC_SYNC_MAX_BLOCKS) return 0;
+    if (inproc_sync_fd == -1 && (inproc_sync_fd = create_temp_file( INPROC_SYNC_BLOCK_SIZE )) == -1)
+        return 0;
+    if (!grow_file( inproc_sync_fd, (file_pos_t)(nb_blocks + 1) * INPROC_SYNC_BLOCK_SIZE )) return 0;
+    if (!(new_list = realloc( free_list, (nb_blocks + 1) * INPROC_SYNC_PER_BLOCK * sizeof(*free_list) )))
+    {
+        set_error( STATUS_NO_MEMORY );
+        return 0;
+    }
+    free_list = new_list;
+
+    if ((ptr = mmap( NULL, INPROC_SYNC_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     inproc_sync_fd, (off_t)nb_blocks * INPROC_SYNC_BLOCK_SIZE )) == MAP_FAILED)
+    {
+        file_set_error();
+        return 0;
+    }
+    blocks[nb_blocks] = ptr;
+
+    /* push the indices in reverse order so that the lowest ones get allocated first */
+    for (i = INPROC_SYNC_PER_BLOCK; i > 0; i--)
+        free_list[free_count++] = nb_blocks * INPROC_SYNC_PER_BLOCK + i - 1;
+    nb_blocks++;
+    return 1;
+}
+
+static inline inproc_sync_shm_t *get_inproc_sync_ptr( unsigned int index )
+{
+    return &blocks[index / INPROC_SYNC_PER_BLOCK][index % INPROC_SYNC_PER_BLOCK];
+}
+
+/* retrieve the index of a shared object; return 0 if the object isn't in shared memory */
+static int get_inproc_sync_index( inproc_sync_shm_t *sync, unsigned int *index )
+{
+    unsigned int i;
+
+    for (i = 0; i < nb_blocks; i++)
+    {
+        if (sync < blocks[i] || sync >= blocks[i] + INPROC_SYNC_PER_BLOCK) continue;
+        *index = i * INPROC_SYNC_PER_BLOCK + (sync - blocks[i]);
+        return 1;
+    }
+    return 0;
+}
+
+/* allocate the state of a synchronization object, falling back to the private storage */
+inproc_sync_shm_t *create_inproc_sync( inproc_sync_shm_t *local, enum inproc_sync_type type,
+                                       LONG64 state, unsigned int max )
+{
+    inproc_sync_shm_t *sync = local;
+
+    if (do_inproc_sync() && (free_count || grow_inproc_sync()))
+        sync = get_inproc_sync_ptr( free_list[--free_count] );
+
+    sync->state = state;
+    sync->max = max;
+    sync->count = 0;
+    sync->waiters = 0;
+    sync->pulse_token = 0;
+    /* clients check it to detect that a cached slot has been reused */
+    sync->generation++;
+    /* the type is set last, clients check it to know if the object is valid */
+    WriteRelease( (LONG *)&sync->type, type );
+    return sync;
+}
+
+/* free the state of a synchronization object */
+void free_inproc_sync( inproc_sync_shm_t *sync )
+{
+    unsigned int index;
+
+    WriteRelease( (LONG *)&sync->type, INPROC_SYNC_UNKNOWN );
+    if (!get_inproc_sync_index( sync, &index )) return;
+    /* wake up clients still sleeping on a stale handle so that they notice */
+    wake_inproc_sync( sync );
+    free_list[free_count++] = index;
+}
+
+/* read the current state of a synchronization object */
+LONG64 get_inproc_sync_state( inproc_sync_shm_t *sync )
+{
+    return InterlockedCompareExchange64( &sync->state, 0, 0 );
+}
+
+/* atomically replace the object value, keeping the server waiters count */
+LONG64 set_inproc_sync_value( inproc_sync_shm_t *sync, LONG64 value )
+{
+    LONG64 state;
+
+    do state = get_inproc_sync_state( sync );
+    while (InterlockedCompareExchange64( &sync->state, (state & ~(INPROC_SYNC_SERVER_WAITER - 1)) | value,
+                                         state ) != state);
+    return state & (INPROC_SYNC_SERVER_WAITER - 1);
+}
+
+/* add a server-side waiter, preventing clients from modifying the object */
+void add_inproc_sync_waiter( inproc_sync_shm_t *sync )
+{
+    InterlockedExchangeAdd64( &sync->state, INPROC_SYNC_SERVER_WAITER );
+}
+
+/* remove a server-side waiter */
+void remove_inproc_sync_waiter( inproc_sync_shm_t *sync )
+{
+    LONG64 prev = InterlockedExchangeAdd64( &sync->state, -INPROC_SYNC_SERVER_WAITER );
+    assert( prev >= INPROC_SYNC_SERVER_WAITER );
+}
+
+/* wake up the client threads sleeping on the object futex */
+void wake_inproc_sync( inproc_sync_shm_t *sync )
+{
+    InterlockedIncrement( &sync->seq );
+#ifdef __linux__
+    if (sync->waiters) syscall( __NR_futex, &sync->seq, FUTEX_WAKE, INT_MAX, NULL, 0, 0 );
+#endif
+}
+
+/* retrieve the in-process synchronization state of an object, if any */
+static inproc_sync_shm_t *get_obj_inproc_sync( struct object *obj )
+{
+    inproc_sync_shm_t *sync;
+
+    if ((sync = get_event_inproc_sync( obj ))) return sync;
+    if ((sync = get_mutex_inproc_sync( obj ))) return sync;
+    return get_semaphore_inproc_sync( obj );
+}
+
+/* retrieve the file descriptor of the in-process synchronization shared memory */
+DECL_HANDLER(get_inproc_sync_fd)
+{
+    if (!enable_inproc_sync())
+    {
+        set_error( STATUS_NOT_IMPLEMENTED );
+        return;
+    }
+    if (inproc_sync_fd == -1 && !grow_inproc_sync()) return;
+    send_client_fd( current->process, inproc_sync_fd, 0 );
+}
+
+/* retrieve the in-process synchronization shared object of a handle */
+DECL_HANDLER(get_inproc_sync)
+{
+    inproc_sync_shm_t *sync;
+    struct object *obj;
+    unsigned int index;
+
+    if (!enable_inproc_sync())
+    {
+        set_error( STATUS_NOT_IMPLEMENTED );
+        return;
+    }
+    if (!(obj = get_handle_obj( current->process, req->handle, 0, NULL ))) return;
+
+    if ((sync = get_obj_inproc_sync( obj )) && get_inproc_sync_index( sync, &index ))
+    {
+        reply->type   = sync->type;
+        reply->access = get_handle_access( current->process, req->handle );
+        reply->index  = index;
+        reply->generation = sync->generation;
+    }
+    else reply->type = INPROC_SYNC_UNKNOWN;
+
+    release_object( obj );
+}
@@ -214,9 +214,12 @@ static void sigterm_handler( int signum )
 
 int main( int argc, char *argv[] )
 {
+    const char *env;
+
     setvbuf( stderr, NULL, _IOLBF, 0 );
     server_argv0 = argv[0];
     parse_options( argc, argv, "d::fhk::p::vw", long_options, option_callback );
+    if ((env = getenv( "WINEREQUESTSTATS" ))) request_stats_enabled = atoi( env );
 
     /* setup temporary handlers before the real signal initialization is done */
     signal( SIGPIPE, SIG_IGN );
@@ -50,16 +50,23 @@ struct type_descr mutex_type =
     },
 };
 
+/* The mutex state value is the owner thread id, the recursion count is
+ * stored in the count field and the abandoned flag in the state. Mutexes
+ * in shared memory can be acquired by clients without the server knowing,
+ * so they are kept in a global list instead of the owner thread list. */
 struct mutex
 {
-    struct object  obj;             /* object header */
-    struct thread *owner;           /* mutex owner */
-    unsigned int   count;           /* recursion count */
-    int            abandoned;       /* has it been abandoned? */
-    struct list    entry;           /* entry in owner thread mutex list */
+    struct object      obj;             /* object header */
+    inproc_sync_shm_t *sync;            /* mutex state */
+    inproc_sync_shm_t  local_sync;      /* mutex state storage when not in shared memory */
+    struct list        entry;           /* entry in owner thread mutex list or shared mutex list */
 };
 
+static struct list shared_mutex_list = LIST_INIT( shared_mutex_list );
+
 static void mutex_dump( struct object *obj, int verbose );
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static void mutex_destroy( struct object *obj );
@@ -70,8 +77,8 @@ static const struct object_ops mutex_ops =
     sizeof(struct mutex),      /* size */
     &mutex_type,               /* type */
     mutex_dump,                /* dump */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    mutex_add_queue,           /* add_queue */
+    mutex_remove_queue,        /* remove_queue */
     mutex_signaled,            /* signaled */
     mutex_satisfied,           /* satisfied */
     mutex_signal,              /* signal */
@@ -90,27 +97,44 @@ static const struct object_ops mutex_ops =
 };
 
 
+static inline int is_mutex_shared( struct mutex *mutex )
+{
+    return mutex->sync != &mutex->local_sync;
+}
+
+static inline thread_id_t get_mutex_owner( struct mutex *mutex )
+{
+    return get_inproc_sync_state( mutex->sync ) & INPROC_SYNC_VALUE_MASK;
+}
+
+static inline int is_mutex_abandoned( struct mutex *mutex )
+{
+    return (get_inproc_sync_state( mutex->sync ) & INPROC_SYNC_ABANDONED) != 0;
+}
+
 /* grab a mutex for a given thread */
 static void do_grab( struct mutex *mutex, struct thread *thread )
 {
-    assert( !mutex->count || (mutex->owner == thread) );
+    assert( !mutex->sync->count || (get_mutex_owner( mutex ) == thread->id) );
 
-    if (!mutex->count++)  /* FIXME: avoid wrap-around */
+    if (!mutex->sync->count++)  /* FIXME: avoid wrap-around */
     {
-        assert( !mutex->owner );
-        mutex->owner = thread;
-        list_add_head( &thread->mutex_list, &mutex->entry );
+        assert( !get_mutex_owner( mutex ));
+        set_inproc_sync_value( mutex->sync, thread->id |
+                               (get_inproc_sync_state( mutex->sync ) & INPROC_SYNC_ABANDONED) );
+        if (!is_mutex_shared( mutex )) list_add_head( &thread->mutex_list, &mutex->entry );
     }
 }
 
 /* release a mutex once the recursion count is 0 */
-static void do_release( struct mutex *mutex )
+static void do_release( struct mutex *mutex, int abandoned )
 {
-    assert( !mutex->count );
+    assert( !mutex->sync->count );
     /* remove the mutex from the thread list of owned mutexes */
-    list_remove( &mutex->entry );
-    mutex->owner = NULL;
+    if (!is_mutex_shared( mutex )) list_remove( &mutex->entry );
+    set_inproc_sync_value( mutex->sync, abandoned ? INPROC_SYNC_ABANDONED : 0 );
     wake_up( &mutex->obj, 0 );
+    wake_inproc_sync( mutex->sync );
 }
 
 static struct mutex *create_mutex( struct object *root, const struct unicode_str *name,
@@ -123,9 +147,8 @@ static struct mutex *create_mutex( struct object *root, const struct unicode_str
         if (get_error() != STATUS_OBJECT_NAME_EXISTS)
         {
             /* initialize it if it didn't already exist */
-            mutex->count = 0;
-            mutex->owner = NULL;
-            mutex->abandoned = 0;
+            mutex->sync = create_inproc_sync( &mutex->local_sync, INPROC_SYNC_MUTEX, 0, 0 );
+            if (is_mutex_shared( mutex )) list_add_tail( &shared_mutex_list, &mutex->entry );
             if (owned) do_grab( mutex, current );
         }
     }
@@ -134,15 +157,23 @@ static struct mutex *create_mutex( struct object *root, const struct unicode_str
 
 void abandon_mutexes( struct thread *thread )
 {
+    struct mutex *mutex, *next;
     struct list *ptr;
 
     while ((ptr = list_head( &thread->mutex_list )) != NULL)
     {
-        struct mutex *mutex = LIST_ENTRY( ptr, struct mutex, entry );
-        assert( mutex->owner == thread );
-        mutex->count = 0;
-        mutex->abandoned = 1;
-        do_release( mutex );
+        mutex = LIST_ENTRY( ptr, struct mutex, entry );
+        assert( get_mutex_owner( mutex ) == thread->id );
+        mutex->sync->count = 0;
+        do_release( mutex, 1 );
+    }
+
+    /* shared mutexes may have been acquired without the server knowing */
+    LIST_FOR_EACH_ENTRY_SAFE( mutex, next, &shared_mutex_list, struct mutex, entry )
+    {
+        if (get_mutex_owner( mutex ) != thread->id) continue;
+        mutex->sync->count = 0;
+        do_release( mutex, 1 );
     }
 }
 
@@ -150,14 +181,31 @@ static void mutex_dump( struct object *obj, int verbose )
 {
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
-    fprintf( stderr, "Mutex count=%u owner=%p\n", mutex->count, mutex->owner );
+    fprintf( stderr, "Mutex count=%u owner=%04x\n", mutex->sync->count, get_mutex_owner( mutex ) );
+}
+
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    add_inproc_sync_waiter( mutex->sync );
+    return add_queue( obj, entry );
+}
+
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    remove_inproc_sync_waiter( mutex->sync );
+    remove_queue( obj, entry );
 }
 
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct mutex *mutex = (struct mutex *)obj;
+    thread_id_t owner = get_mutex_owner( mutex );
     assert( obj->ops == &mutex_ops );
-    return (!mutex->count || (mutex->owner == get_wait_queue_thread( entry )));
+    return (!owner || (owner == get_wait_queue_thread( entry )->id));
 }
 
 static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry )
@@ -166,8 +214,21 @@ static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry
     assert( obj->ops == &mutex_ops );
 
     do_grab( mutex, get_wait_queue_thread( entry ));
-    if (mutex->abandoned) make_wait_abandoned( entry );
-    mutex->abandoned = 0;
+    if (is_mutex_abandoned( mutex )) make_wait_abandoned( entry );
+    set_inproc_sync_value( mutex->sync, get_mutex_owner( mutex ));
+}
+
+/* release a mutex owned by the current thread */
+static int release_mutex( struct mutex *mutex, unsigned int *prev_count )
+{
+    if (!mutex->sync->count || (get_mutex_owner( mutex ) != current->id))
+    {
+        set_error( STATUS_MUTANT_NOT_OWNED );
+        return 0;
+    }
+    if (prev_count) *prev_count = mutex->sync->count;
+    if (!--mutex->sync->count) do_release( mutex, 0 );
+    return 1;
 }
 
 static int mutex_signal( struct object *obj, unsigned int access )
@@ -180,13 +241,7 @@ static int mutex_signal( struct object *obj, unsigned int access )
         set_error( STATUS_ACCESS_DENIED );
         return 0;
     }
-    if (!mutex->count || (mutex->owner != current))
-    {
-        set_error( STATUS_MUTANT_NOT_OWNED );
-        return 0;
-    }
-    if (!--mutex->count) do_release( mutex );
-    return 1;
+    return release_mutex( mutex, NULL );
 }
 
 static void mutex_destroy( struct object *obj )
@@ -194,9 +249,15 @@ static void mutex_destroy( struct object *obj )
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
 
-    if (!mutex->count) return;
-    mutex->count = 0;
-    do_release( mutex );
+    if (is_mutex_shared( mutex )) list_remove( &mutex->entry );
+    else if (mutex->sync->count) list_remove( &mutex->entry );
+    free_inproc_sync( mutex->sync );
+}
+
+inproc_sync_shm_t *get_mutex_inproc_sync( struct object *obj )
+{
+    if (obj->ops != &mutex_ops) return NULL;
+    return ((struct mutex *)obj)->sync;
 }
 
 /* create a mutex */
@@ -240,12 +301,7 @@ DECL_HANDLER(release_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  0, &mutex_ops )))
     {
-        if (!mutex->count || (mutex->owner != current)) set_error( STATUS_MUTANT_NOT_OWNED );
-        else
-        {
-            reply->prev_count = mutex->count;
-            if (!--mutex->count) do_release( mutex );
-        }
+        release_mutex( mutex, &reply->prev_count );
         release_object( mutex );
     }
 }
@@ -258,9 +314,9 @@ DECL_HANDLER(query_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  MUTANT_QUERY_STATE, &mutex_ops )))
     {
-        reply->count = mutex->count;
-        reply->owned = (mutex->owner == current);
-        reply->abandoned = mutex->abandoned;
+        reply->count = mutex->sync->count;
+        reply->owned = (get_mutex_owner( mutex ) == current->id);
+        reply->abandoned = is_mutex_abandoned( mutex );
 
         release_object( mutex );
     }
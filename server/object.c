@@ -48,9 +48,16 @@
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    unsigned int        min_size;        /* initial size of hash table */
+    unsigned int        count;           /* number of names in the table */
+    unsigned int        resizes;         /* number of times the table has been resized */
+    struct list        *names;           /* array of hash entry lists */
+    struct list         order;           /* names in insertion order, for enumeration */
 };
 
+/* average number of names per hash entry above which the table is grown */
+#define NAMESPACE_MAX_LOAD 2
+
 
 struct type_descr no_type =
 {
@@ -236,11 +243,54 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
+/* rehash all the names of a namespace into a new hash table */
+static void resize_namespace( struct namespace *namespace, unsigned int hash_size )
+{
+    struct object_name *ptr, *next;
+    struct list *names;
+    unsigned int i;
+
+    if (!(names = malloc( hash_size * sizeof(*names) ))) return;  /* keep the current size */
+    for (i = 0; i < hash_size; i++) list_init( &names[i] );
+
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE( ptr, next, &namespace->names[i], struct object_name, entry )
+        {
+            list_remove( &ptr->entry );
+            list_add_head( &names[hash_strW( ptr->name, ptr->len, hash_size )], &ptr->entry );
+        }
+    }
+    free( namespace->names );
+    namespace->names     = names;
+    namespace->hash_size = hash_size;
+    namespace->resizes++;
+}
+
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
-    unsigned int hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
+    unsigned int hash;
+
+    if (++namespace->count > namespace->hash_size * NAMESPACE_MAX_LOAD)
+        resize_namespace( namespace, namespace->hash_size * 2 + 1 );
 
+    hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
     list_add_head( &namespace->names[hash], &ptr->entry );
+    list_add_tail( &namespace->order, &ptr->order_entry );
+    ptr->namespace = namespace;
+}
+
+/* remove a name from its namespace */
+static void namespace_remove( struct namespace *namespace, struct object_name *ptr )
+{
+    list_remove( &ptr->entry );
+    list_remove( &ptr->order_entry );
+    ptr->namespace = NULL;
+    namespace->count--;
+
+    /* shrink only once well below the growth threshold to avoid resizing back and forth */
+    if (namespace->hash_size > namespace->min_size && namespace->count < namespace->hash_size / 4)
+        resize_namespace( namespace, max( namespace->hash_size / 2, namespace->min_size ));
 }
 
 /* allocate a name for an object */
@@ -252,6 +302,7 @@ static struct object_name *alloc_name( const struct unicode_str *name )
     {
         ptr->len = name->len;
         ptr->parent = NULL;
+        ptr->namespace = NULL;
         memcpy( ptr->name, name->str, name->len );
     }
     return ptr;
@@ -584,18 +635,15 @@ struct object *find_object( const struct namespace *namespace, const struct unic
 }
 
 /* find an object by its index; the refcount is incremented */
+/* the index follows insertion order, so it doesn't change when the hash table is resized */
 struct object *find_object_index( const struct namespace *namespace, unsigned int index )
 {
-    unsigned int i;
+    const struct object_name *ptr;
 
     /* FIXME: not efficient at all */
-    for (i = 0; i < namespace->hash_size; i++)
+    LIST_FOR_EACH_ENTRY( ptr, &namespace->order, const struct object_name, order_entry )
     {
-        const struct object_name *ptr;
-        LIST_FOR_EACH_ENTRY( ptr, &namespace->names[i], const struct object_name, entry )
-        {
-            if (!index--) return grab_object( ptr->obj );
-        }
+        if (!index--) return grab_object( ptr->obj );
     }
     return NULL;
 }
@@ -606,15 +654,46 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(*namespace->names) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size = hash_size;
+    namespace->min_size  = hash_size;
+    namespace->count     = 0;
+    namespace->resizes   = 0;
+    list_init( &namespace->order );
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
     return namespace;
 }
 
+/* free a namespace */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    free( namespace->names );
+    free( namespace );
+}
+
+/* dump the hash table statistics of a namespace */
+void dump_namespace( const struct namespace *namespace )
+{
+    unsigned int i, len, used = 0, longest = 0;
+    struct list *p;
+
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        len = 0;
+        LIST_FOR_EACH( p, &namespace->names[i] ) len++;
+        if (len) used++;
+        longest = max( longest, len );
+    }
+    fprintf( stderr, "names=%u buckets=%u used=%u longest=%u resizes=%u",
+             namespace->count, namespace->hash_size, used, longest, namespace->resizes );
+}
+
 /* functions for unimplemented/default object operations */
 
 int no_add_queue( struct object *obj, struct wait_queue_entry *entry )
@@ -797,7 +876,8 @@ int no_link_name( struct object *obj, struct object_name *name, struct object *p
 
 void default_unlink_name( struct object *obj, struct object_name *name )
 {
-    list_remove( &name->entry );
+    if (name->namespace) namespace_remove( name->namespace, name );
+    else list_remove( &name->entry );
 }
 
 struct object *no_open_file( struct object *obj, unsigned int access, unsigned int sharing,
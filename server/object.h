@@ -126,8 +126,10 @@ struct object
 struct object_name
 {
     struct list         entry;           /* entry in the hash list */
+    struct list         order_entry;     /* entry in the namespace insertion order list */
     struct object      *obj;             /* object owning this name */
     struct object      *parent;          /* parent object */
+    struct namespace   *namespace;       /* namespace containing the name, if any */
     data_size_t         len;             /* name length in bytes */
     WCHAR               name[1];
 };
@@ -158,6 +160,8 @@ extern void *open_named_object( struct object *parent, const struct object_ops *
                                 const struct unicode_str *name, unsigned int attributes );
 extern void unlink_named_object( struct object *obj );
 extern struct namespace *create_namespace( unsigned int hash_size );
+extern void free_namespace( struct namespace *namespace );
+extern void dump_namespace( const struct namespace *namespace );
 extern void free_kernel_objects( struct object *obj );
 /* grab/release_object can take any pointer, but you better make sure */
 /* that the thing pointed to starts with a struct object... */
@@ -223,10 +227,28 @@ extern struct event *get_event_obj( struct process *process, obj_handle_t handle
 extern struct keyed_event *get_keyed_event_obj( struct process *process, obj_handle_t handle, unsigned int access );
 extern void set_event( struct event *event );
 extern void reset_event( struct event *event );
+extern inproc_sync_shm_t *get_event_inproc_sync( struct object *obj );
 
 /* mutex functions */
 
 extern void abandon_mutexes( struct thread *thread );
+extern inproc_sync_shm_t *get_mutex_inproc_sync( struct object *obj );
+
+/* semaphore functions */
+
+extern inproc_sync_shm_t *get_semaphore_inproc_sync( struct object *obj );
+
+/* in-process synchronization functions */
+
+extern int do_inproc_sync(void);
+extern inproc_sync_shm_t *create_inproc_sync( inproc_sync_shm_t *local, enum inproc_sync_type type,
+                                              LONG64 state, unsigned int max );
+extern void free_inproc_sync( inproc_sync_shm_t *sync );
+extern LONG64 get_inproc_sync_state( inproc_sync_shm_t *sync );
+extern LONG64 set_inproc_sync_value( inproc_sync_shm_t *sync, LONG64 value );
+extern void add_inproc_sync_waiter( inproc_sync_shm_t *sync );
+extern void remove_inproc_sync_waiter( inproc_sync_shm_t *sync );
+extern void wake_inproc_sync( inproc_sync_shm_t *sync );
 
 /* serial functions */
 
@@ -235,6 +257,7 @@ int get_serial_async_timeout(struct object *obj, int type, int count);
 /* socket functions */
 
 extern void sock_init(void);
+extern void sock_handle_added( struct object *obj );
 
 /* debugger functions */
 
@@ -337,6 +360,7 @@ extern struct type_descr mapping_type;
 extern struct type_descr key_type;
 extern struct type_descr apc_reserve_type;
 extern struct type_descr completion_reserve_type;
+extern struct type_descr wait_completion_packet_type;
 
 #define KEYEDEVENT_WAIT       0x0001
 #define KEYEDEVENT_WAKE       0x0002
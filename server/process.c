@@ -678,6 +678,7 @@ struct process *create_process( int fd, struct process *parent, unsigned int fla
     process->peb             = 0;
     process->ldt_copy        = 0;
     process->dir_cache       = NULL;
+    process->io_uring        = NULL;
     process->winstation      = 0;
     process->desktop         = 0;
     process->token           = NULL;
@@ -969,6 +970,7 @@ static void process_killed( struct process *process )
     process->winstation = 0;
     process->desktop = 0;
     cancel_process_asyncs( process );
+    free_process_io_uring( process );
     close_process_handles( process );
     if (process->idle_event) release_object( process->idle_event );
     process->idle_event = NULL;
@@ -33,6 +33,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -90,6 +91,7 @@ struct key
     unsigned int      flags;       /* flags */
     timeout_t         modif;       /* last modification time */
     struct list       notify_list; /* list of notifications */
+    key_shm_t        *shared;      /* key in session shared memory */
 };
 
 /* key flags */
@@ -99,6 +101,7 @@ struct key
 #define KEY_SYMLINK  0x0008  /* key is a symbolic link */
 #define KEY_WOWSHARE 0x0010  /* key is a Wow64 shared key (used for Software\Classes) */
 #define KEY_PREDEF   0x0020  /* key is marked as predefined */
+#define KEY_CHANGED  0x0040  /* key contents changed since it was last written to the change log */
 
 #define OBJ_KEY_WOW64 0x100000 /* magic flag added to attributes for WoW64 redirection */
 
@@ -125,6 +128,8 @@ static const timeout_t ticks_1601_to_1970 = (timeout_t)86400 * (369 * 365 + 89)
 static const timeout_t save_period = 30 * -TICKS_PER_SEC;  /* delay between periodic saves */
 static struct timeout_user *save_timeout_user;  /* saving timer */
 static enum prefix_type { PREFIX_UNKNOWN, PREFIX_32BIT, PREFIX_64BIT } prefix_type;
+static int binary_registry;  /* save and load binary copies of the registry branches */
+static int registry_log;     /* save registry changes to an append-only log */
 
 static const WCHAR wow6432node[] = {'W','o','w','6','4','3','2','N','o','d','e'};
 static const WCHAR symlink_value[] = {'S','y','m','b','o','l','i','c','L','i','n','k','V','a','l','u','e'};
@@ -132,12 +137,18 @@ static const struct unicode_str symlink_str = { symlink_value, sizeof(symlink_va
 
 static void set_periodic_save_timer(void);
 static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index );
+static void log_key_deletion( struct key *key );
 
 /* information about where to save a registry branch */
 struct save_branch_info
 {
-    struct key  *key;
-    const char  *filename;
+    struct key       *key;
+    const char       *filename;
+    FILE             *log;           /* change log, if enabled */
+    unsigned __int64  log_seq;       /* sequence number of the last change log record */
+    off_t             log_flushed;   /* log size at the last successful flush */
+    off_t             compact_size;  /* log size that triggers a new snapshot */
+    struct reglog_compact *compact;  /* snapshot being written in the background */
 };
 
 #define MAX_SAVE_BRANCH_INFO 3
@@ -158,6 +169,7 @@ struct file_load_info
     int         line;     /* current input line */
     WCHAR      *tmp;      /* temp buffer to use while parsing input */
     size_t      tmplen;   /* length of temp buffer */
+    unsigned __int64 log_seq;  /* last change log record included in the file */
 };
 
 
@@ -336,12 +348,11 @@ static int grow_subkeys( struct key *key )
     return 1;
 }
 
-/* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+/* save a registry key without its subkeys to a text file */
+static void save_key( const struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
-    if (key->flags & KEY_VOLATILE) return;
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
@@ -359,6 +370,15 @@ static void save_subkeys( const struct key *key, const struct key *base, FILE *f
         if (key->flags & KEY_SYMLINK) fputs( "#link\n", f );
         for (i = 0; i <= key->last_value; i++) dump_value( &key->values[i], f );
     }
+}
+
+/* save a registry and all its subkeys to a text file */
+static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+{
+    int i;
+
+    if (key->flags & KEY_VOLATILE) return;
+    save_key( key, base, f );
     for (i = 0; i <= key->last_subkey; i++) save_subkeys( key->subkeys[i], base, f );
 }
 
@@ -681,6 +701,18 @@ static void key_destroy( struct object *obj )
         struct notify *notify = LIST_ENTRY( ptr, struct notify, entry );
         do_notification( key, notify, 1 );
     }
+    if (key->shared) free_shared_object( key->shared );
+}
+
+/* mark a key and all its parents as dirty (modified) */
+static void make_dirty( struct key *key )
+{
+    while (key)
+    {
+        if (key->flags & (KEY_DIRTY|KEY_VOLATILE)) return;  /* nothing to do */
+        key->flags |= KEY_DIRTY;
+        key = get_parent( key );
+    }
 }
 
 /* allocate a key object */
@@ -708,6 +740,7 @@ static struct key *create_key_object( struct object *parent, const struct unicod
             key->last_value  = -1;
             key->values      = NULL;
             key->modif       = modif;
+            key->shared      = NULL;
             list_init( &key->notify_list );
 
             if (options & REG_OPTION_CREATE_LINK) key->flags |= KEY_SYMLINK;
@@ -719,23 +752,16 @@ static struct key *create_key_object( struct object *parent, const struct unicod
                 release_object( key );
                 return NULL;
             }
-            else key->flags |= KEY_DIRTY;
+            else
+            {
+                key->flags |= KEY_DIRTY | KEY_CHANGED;
+                make_dirty( get_parent( key ) );
+            }
         }
     }
     return key;
 }
 
-/* mark a key and all its parents as dirty (modified) */
-static void make_dirty( struct key *key )
-{
-    while (key)
-    {
-        if (key->flags & (KEY_DIRTY|KEY_VOLATILE)) return;  /* nothing to do */
-        key->flags |= KEY_DIRTY;
-        key = get_parent( key );
-    }
-}
-
 /* mark a key and all its subkeys as clean (not modified) */
 static void make_clean( struct key *key )
 {
@@ -743,10 +769,20 @@ static void make_clean( struct key *key )
 
     if (key->flags & KEY_VOLATILE) return;
     if (!(key->flags & KEY_DIRTY)) return;
-    key->flags &= ~KEY_DIRTY;
+    key->flags &= ~(KEY_DIRTY | KEY_CHANGED);
     for (i = 0; i <= key->last_subkey; i++) make_clean( key->subkeys[i] );
 }
 
+/* mark a key and all its subkeys as changed */
+static void make_subtree_changed( struct key *key )
+{
+    int i;
+
+    if (key->flags & KEY_VOLATILE) return;
+    key->flags |= KEY_DIRTY | KEY_CHANGED;
+    for (i = 0; i <= key->last_subkey; i++) make_subtree_changed( key->subkeys[i] );
+}
+
 /* go through all the notifications and send them if necessary */
 static void check_notify( struct key *key, unsigned int change, int not_subtree )
 {
@@ -760,11 +796,24 @@ static void check_notify( struct key *key, unsigned int change, int not_subtree
     }
 }
 
+/* invalidate the values cached by the clients for a key */
+static void update_key_generation( struct key *key )
+{
+    if (!key->shared) return;
+    SHARED_WRITE_BEGIN( key->shared, key_shm_t )
+    {
+        shared->generation++;
+    }
+    SHARED_WRITE_END;
+}
+
 /* update key modification time */
 static void touch_key( struct key *key, unsigned int change )
 {
     key->modif = current_time;
+    key->flags |= KEY_CHANGED;
     make_dirty( key );
+    update_key_generation( key );
 
     /* do notifications */
     check_notify( key, change, 1 );
@@ -1048,11 +1097,14 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
     }
     parent->subkeys[index] = key;
 
+    log_key_deletion( key );
     free( key->obj.name );
     key->obj.name = new_name_ptr;
 
     if (debug_level > 1) dump_operation( key, NULL, "Rename" );
     touch_key( key, REG_NOTIFY_CHANGE_NAME );
+    /* the whole subtree needs to be logged again under its new name */
+    make_subtree_changed( key );
 }
 
 /* delete a key and its values */
@@ -1085,7 +1137,9 @@ static int delete_key( struct key *key, int recurse )
     }
 
     if (debug_level > 1) dump_operation( key, NULL, "Delete" );
+    log_key_deletion( key );
     key->flags |= KEY_DELETED;
+    update_key_generation( key );
     unlink_named_object( &key->obj );
     touch_key( parent, REG_NOTIFY_CHANGE_NAME );
     return 1;
@@ -1522,6 +1576,15 @@ static int load_global_option( const char *buffer, struct file_load_info *info )
             return 0;
         }
     }
+    if (!strncmp( buffer, "#logseq=", 8 ))
+    {
+        for (p = buffer + 8; *p; p++)
+        {
+            if (*p >= '0' && *p <= '9') info->log_seq = (info->log_seq << 4) | (*p - '0');
+            else if (*p >= 'a' && *p <= 'f') info->log_seq = (info->log_seq << 4) | (*p - 'a' + 10);
+            else break;
+        }
+    }
     /* ignore unknown options */
     return 1;
 }
@@ -1556,6 +1619,8 @@ static int load_key_option( struct key *key, const char *buffer, struct file_loa
         key->classlen = len;
     }
     if (!strncmp( buffer, "#link", 5 )) key->flags |= KEY_SYMLINK;
+    key->flags |= KEY_CHANGED;
+    make_dirty( key );
     /* ignore unknown options */
     return 1;
 }
@@ -1674,6 +1739,9 @@ static int load_value( struct key *key, const char *buffer, struct file_load_inf
     value->data = newptr;
     value->len  = len;
     value->type = type;
+    key->flags |= KEY_CHANGED;
+    make_dirty( key );
+    update_key_generation( key );
     return 1;
 
  error:
@@ -1714,7 +1782,8 @@ static int get_prefix_len( struct key *key, const char *name, struct file_load_i
 
 /* load all the keys from the input file */
 /* prefix_len is the number of key name prefixes to skip, or -1 for autodetection */
-static void load_keys( struct key *key, const char *filename, FILE *f, int prefix_len )
+static void load_keys( struct key *key, const char *filename, FILE *f, int prefix_len,
+                       unsigned __int64 *log_seq )
 {
     struct key *subkey = NULL;
     struct file_load_info info;
@@ -1726,6 +1795,7 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
     info.len    = 4;
     info.tmplen = 4;
     info.line   = 0;
+    info.log_seq = 0;
     if (!(info.buffer = mem_alloc( info.len ))) return;
     if (!(info.tmp = mem_alloc( info.tmplen )))
     {
@@ -1780,6 +1850,7 @@ static void load_keys( struct key *key, const char *filename, FILE *f, int prefi
         update_key_time( subkey, modif );
         release_object( subkey );
     }
+    if (log_seq) *log_seq = info.log_seq;
     free( info.buffer );
     free( info.tmp );
 }
@@ -1798,35 +1869,595 @@ static void load_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "r" );
         if (f)
         {
-            load_keys( key, NULL, f, -1 );
+            load_keys( key, NULL, f, -1, NULL );
             fclose( f );
         }
         else file_set_error();
     }
 }
 
+/*
+ * Binary registry hives
+ *
+ * When enabled, a binary copy of each registry branch is written next to the
+ * text file every time the branch is saved. It records the size, modification
+ * time and inode of the text file it was generated from, and it is only used
+ * at startup if the text file hasn't changed since, so the text file remains
+ * the reference and can still be edited by hand. The binary file is mapped in
+ * memory and the keys are created directly from it without any parsing.
+ */
+
+#define HIVE_MAGIC   "WINEHIVE"
+#define HIVE_VERSION 2
+
+struct hive_header
+{
+    char             magic[8];     /* HIVE_MAGIC */
+    unsigned int     version;      /* HIVE_VERSION */
+    unsigned int     prefix_type;  /* prefix architecture */
+    unsigned __int64 text_size;    /* size of the text file */
+    unsigned __int64 text_mtime;   /* modification time of the text file */
+    unsigned __int64 text_ino;     /* inode of the text file */
+    unsigned __int64 log_seq;      /* last change log record included in the hive */
+    unsigned int     key_count;    /* number of key records */
+    unsigned int     reserved;
+};
+
+/* a key record, followed by the key name, the class and the values, each aligned to 8 bytes;
+ * keys are stored in depth-first order so that a parent always comes before its subkeys */
+struct hive_key
+{
+    unsigned int     parent;       /* index of the parent key record, ~0 for the branch root */
+    unsigned int     flags;        /* HIVE_KEY_* flags */
+    timeout_t        modif;        /* last modification time */
+    data_size_t      namelen;      /* length of key name */
+    data_size_t      classlen;     /* length of key class */
+    unsigned int     value_count;  /* number of values */
+    unsigned int     reserved;
+};
+
+#define HIVE_KEY_SYMLINK 0x0001
+
+/* a value record, followed by the value name and data, each aligned to 8 bytes */
+struct hive_value
+{
+    unsigned int     type;         /* value type */
+    data_size_t      namelen;      /* length of value name */
+    data_size_t      len;          /* length of value data */
+    unsigned int     reserved;
+};
+
+static inline size_t hive_align( size_t len )
+{
+    return (len + 7) & ~(size_t)7;
+}
+
+/* build the name of a file stored next to a registry file */
+static char *get_branch_file_name( const char *filename, const char *ext )
+{
+    char *name;
+
+    if ((name = mem_alloc( strlen( filename ) + strlen( ext ) + 1 ))) sprintf( name, "%s%s", filename, ext );
+    return name;
+}
+
+/* write a chunk of data to a binary hive, padded to 8 bytes */
+static int write_hive_data( FILE *f, const void *data, size_t len )
+{
+    static const char padding[8];
+    size_t pad = hive_align( len ) - len;
+
+    if (len && fwrite( data, len, 1, f ) != 1) return 0;
+    return !pad || fwrite( padding, pad, 1, f ) == 1;
+}
+
+/* size of the record of a key in a binary hive, without the key name */
+static size_t get_hive_key_size( const struct key *key )
+{
+    size_t size = sizeof(struct hive_key) + hive_align( key->class ? key->classlen : 0 );
+    int i;
+
+    for (i = 0; i <= key->last_value; i++)
+        size += sizeof(struct hive_value) + hive_align( key->values[i].namelen ) + hive_align( key->values[i].len );
+    return size;
+}
+
+/* write the record of a key and its values to a binary hive */
+static int write_hive_key( const struct key *key, unsigned int parent, data_size_t namelen, FILE *f )
+{
+    struct hive_key rec;
+    struct hive_value val;
+    int i;
+
+    memset( &rec, 0, sizeof(rec) );
+    rec.parent      = parent;
+    rec.flags       = (key->flags & KEY_SYMLINK) ? HIVE_KEY_SYMLINK : 0;
+    rec.modif       = key->modif;
+    rec.namelen     = namelen;
+    rec.classlen    = key->class ? key->classlen : 0;
+    rec.value_count = key->last_value + 1;
+
+    if (!write_hive_data( f, &rec, sizeof(rec) )) return 0;
+    if (!write_hive_data( f, key->obj.name->name, rec.namelen )) return 0;
+    if (!write_hive_data( f, key->class, rec.classlen )) return 0;
+
+    for (i = 0; i <= key->last_value; i++)
+    {
+        memset( &val, 0, sizeof(val) );
+        val.type    = key->values[i].type;
+        val.namelen = key->values[i].namelen;
+        val.len     = key->values[i].len;
+        if (!write_hive_data( f, &val, sizeof(val) )) return 0;
+        if (!write_hive_data( f, key->values[i].name, val.namelen )) return 0;
+        if (!write_hive_data( f, key->values[i].data, val.len )) return 0;
+    }
+    return 1;
+}
+
+/* save a key and its subkeys to a binary hive */
+static int save_hive_key( const struct key *key, unsigned int parent, unsigned int *count, FILE *f )
+{
+    unsigned int index = (*count)++;
+    int i;
+
+    if (!write_hive_key( key, parent, (parent != ~0u) ? key->obj.name->len : 0, f )) return 0;
+
+    for (i = 0; i <= key->last_subkey; i++)
+    {
+        if (key->subkeys[i]->flags & KEY_VOLATILE) continue;
+        if (!save_hive_key( key->subkeys[i], index, count, f )) return 0;
+    }
+    return 1;
+}
+
+/* save the binary hive of a registry branch once its text file has been written */
+static void save_binary_branch( struct key *key, const char *filename, unsigned __int64 log_seq )
+{
+    struct hive_header header;
+    struct stat st;
+    char tmp[32], *name;
+    int fd, ret;
+    FILE *f;
+
+    if (stat( filename, &st ) == -1) return;
+    if (!(name = get_branch_file_name( filename, ".bin" ))) return;
+
+    snprintf( tmp, sizeof(tmp), "hive%lx.tmp", (long) getpid() );
+    if ((fd = open( tmp, O_CREAT | O_TRUNC | O_WRONLY, 0666 )) == -1) goto done;
+    if (!(f = fdopen( fd, "w" )))
+    {
+        close( fd );
+        unlink( tmp );
+        goto done;
+    }
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, HIVE_MAGIC, sizeof(header.magic) );
+    header.version     = HIVE_VERSION;
+    header.prefix_type = prefix_type;
+    header.text_size   = st.st_size;
+    header.text_mtime  = st.st_mtime;
+    header.text_ino    = st.st_ino;
+    header.log_seq     = log_seq;
+
+    /* the header is written again at the end once the number of keys is known */
+    ret = fwrite( &header, sizeof(header), 1, f ) == 1 &&
+          save_hive_key( key, ~0u, &header.key_count, f ) &&
+          !fseek( f, 0, SEEK_SET ) &&
+          fwrite( &header, sizeof(header), 1, f ) == 1;
+    if (fclose( f )) ret = 0;
+
+    if (ret) ret = !rename( tmp, name );
+    if (!ret) unlink( tmp );
+    if (debug_level > 1) fprintf( stderr, "%s: %s binary hive\n", name, ret ? "saved" : "could not save" );
+
+done:
+    free( name );
+}
+
+/* validate a key record and its values, and move past it */
+static int check_hive_key( const char *data, size_t size, size_t *pos )
+{
+    const struct hive_key *rec;
+    const struct hive_value *val;
+    unsigned int i;
+
+    if (size - *pos < sizeof(*rec)) return 0;
+    rec = (const struct hive_key *)(data + *pos);
+    *pos += sizeof(*rec);
+    if (rec->namelen >= 65534 || rec->namelen % sizeof(WCHAR)) return 0;
+    if (size - *pos < hive_align( rec->namelen ) + hive_align( rec->classlen )) return 0;
+    *pos += hive_align( rec->namelen ) + hive_align( rec->classlen );
+
+    for (i = 0; i < rec->value_count; i++)
+    {
+        if (size - *pos < sizeof(*val)) return 0;
+        val = (const struct hive_value *)(data + *pos);
+        *pos += sizeof(*val);
+        if (val->namelen > MAX_VALUE_LEN * sizeof(WCHAR) || val->namelen % sizeof(WCHAR)) return 0;
+        if (size - *pos < hive_align( val->namelen ) + hive_align( val->len )) return 0;
+        *pos += hive_align( val->namelen ) + hive_align( val->len );
+    }
+    return 1;
+}
+
+/* validate the records of a binary hive before loading anything from it */
+static int check_hive( const char *data, size_t size, unsigned int count )
+{
+    const struct hive_key *rec;
+    size_t pos = sizeof(struct hive_header);
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        rec = (const struct hive_key *)(data + pos);
+        if (!check_hive_key( data, size, &pos )) return 0;
+        if (i ? (rec->parent >= i || !rec->namelen) : (rec->parent != ~0u)) return 0;
+    }
+    return pos == size;
+}
+
+/* replace the contents of a key by a validated binary hive record */
+static int load_hive_key( struct key *key, const struct hive_key *rec )
+{
+    const char *pos = (const char *)(rec + 1) + hive_align( rec->namelen );
+    struct key_value *value;
+    struct unicode_str name;
+    unsigned int i;
+    void *ptr;
+    int index;
+
+    for (i = 0; (int)i <= key->last_value; i++)
+    {
+        free( key->values[i].name );
+        free( key->values[i].data );
+    }
+    key->last_value = -1;
+    free( key->class );
+    key->class = NULL;
+    key->classlen = 0;
+
+    if (rec->classlen && (key->class = memdup( pos, rec->classlen ))) key->classlen = rec->classlen;
+    pos += hive_align( rec->classlen );
+    if (rec->flags & HIVE_KEY_SYMLINK) key->flags |= KEY_SYMLINK;
+    key->modif = rec->modif;
+
+    for (i = 0; i < rec->value_count; i++)
+    {
+        const struct hive_value *val = (const struct hive_value *)pos;
+
+        pos = (const char *)(val + 1);
+        name.str = (const WCHAR *)pos;
+        name.len = val->namelen;
+        pos += hive_align( val->namelen );
+
+        ptr = NULL;
+        if (val->len && !(ptr = memdup( pos, val->len ))) return 0;
+        if (!(value = find_value( key, &name, &index )) && !(value = insert_value( key, &name, index )))
+        {
+            free( ptr );
+            return 0;
+        }
+        free( value->data );
+        value->type = val->type;
+        value->len  = val->len;
+        value->data = ptr;
+        pos += hive_align( val->len );
+    }
+    return 1;
+}
+
+/* load a registry branch from its binary hive; return 0 if the hive is missing or out of date */
+static int load_binary_branch( struct key *base, const char *filename, unsigned __int64 *log_seq )
+{
+    const struct hive_header *header;
+    struct stat st, text_st;
+    struct key **keys = NULL;
+    void *ptr = MAP_FAILED;
+    const char *pos;
+    unsigned int i, count = 0;
+    int fd = -1, ret = 0;
+    char *name;
+
+    if (stat( filename, &text_st ) == -1) return 0;
+    if (!(name = get_branch_file_name( filename, ".bin" ))) return 0;
+
+    if ((fd = open( name, O_RDONLY )) == -1) goto done;
+    if (fstat( fd, &st ) == -1 || st.st_size < (off_t)sizeof(*header)) goto done;
+    if ((ptr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) == MAP_FAILED) goto done;
+
+    header = ptr;
+    if (memcmp( header->magic, HIVE_MAGIC, sizeof(header->magic) )) goto done;
+    if (header->version != HIVE_VERSION || !header->key_count) goto done;
+    if (header->text_size != (unsigned __int64)text_st.st_size ||
+        header->text_mtime != (unsigned __int64)text_st.st_mtime ||
+        header->text_ino != (unsigned __int64)text_st.st_ino)
+    {
+        if (debug_level) fprintf( stderr, "%s: ignoring out of date binary hive\n", name );
+        goto done;
+    }
+    if (header->prefix_type != PREFIX_32BIT && header->prefix_type != PREFIX_64BIT) goto done;
+    if (prefix_type != PREFIX_UNKNOWN && header->prefix_type != prefix_type) goto done;
+    if (!check_hive( ptr, st.st_size, header->key_count )) goto done;
+    if (!(keys = mem_alloc( header->key_count * sizeof(*keys) ))) goto done;
+
+    for (i = 0, pos = (const char *)(header + 1); i < header->key_count; i++)
+    {
+        const struct hive_key *rec = (const struct hive_key *)pos;
+        size_t offset = pos - (const char *)ptr;
+        struct unicode_str str;
+        struct key *key;
+
+        str.str = (const WCHAR *)(rec + 1);
+        str.len = rec->namelen;
+        if (!i) key = (struct key *)grab_object( base );
+        else if (!(key = create_key_object( &keys[rec->parent]->obj, &str, OBJ_OPENIF, 0, rec->modif, NULL )))
+            break;
+        keys[count++] = key;
+        if (!load_hive_key( key, rec )) break;
+        check_hive_key( ptr, st.st_size, &offset );
+        pos = (const char *)ptr + offset;
+    }
+
+    if ((ret = (i == header->key_count)))
+    {
+        prefix_type = header->prefix_type;
+        *log_seq = header->log_seq;
+        /* the branch now matches what has been saved on disk */
+        make_clean( base );
+        if (debug_level) fprintf( stderr, "%s: loaded %u keys from binary hive\n", name, i );
+    }
+    while (count) release_object( keys[--count] );
+    free( keys );
+
+done:
+    if (ptr != MAP_FAILED) munmap( ptr, st.st_size );
+    if (fd != -1) close( fd );
+    free( name );
+    return ret;
+}
+
+/*
+ * Registry change log
+ *
+ * When enabled, the periodic saves append the keys that changed since the
+ * previous save to a log file next to the registry file, instead of rewriting
+ * the whole branch. Each record contains the full contents of a changed key, or
+ * the deletion of a key, and has a sequence number. The text file records the
+ * sequence number of the last change it includes, so that only the following
+ * records are replayed on startup.
+ *
+ * A deletion is logged when it happens, because the path of the key is lost
+ * once it is removed from the tree. Changed keys are only logged by the next
+ * periodic save, so that a key that changes often gets a single record per
+ * save period; until then, they are lost on a crash like without a log.
+ *
+ * When the log grows too large, a new snapshot of the branch is written to a
+ * temporary file from the main loop, a few keys at a time, while the clients
+ * keep changing the registry. The changes made meanwhile are logged after the
+ * snapshot sequence number, and they are replayed over the snapshot, so it
+ * doesn't matter whether it includes them. Once the snapshot has replaced the
+ * file, only these records are kept in the log. When the server shuts down,
+ * the whole branch is saved to the file like without a log, and the log is
+ * emptied.
+ */
+
+#define REGLOG_MAGIC   "WINERLOG"
+#define REGLOG_VERSION 1
+#define REGLOG_MIN_COMPACT_SIZE (256 * 1024)  /* min. log size before it gets compacted */
+#define REGLOG_COMPACT_KEYS     1024          /* keys saved per step of a compaction */
+
+struct reglog_header
+{
+    char             magic[8];     /* REGLOG_MAGIC */
+    unsigned int     version;      /* REGLOG_VERSION */
+    unsigned int     reserved;
+};
+
+enum reglog_op
+{
+    REGLOG_SET_KEY = 1,            /* create a key and set its contents */
+    REGLOG_DELETE_KEY              /* delete a key and its subkeys */
+};
+
+/* a log record, followed by the key path relative to the branch root aligned to 8 bytes,
+ * and for REGLOG_SET_KEY by a binary hive key record without name */
+struct reglog_record
+{
+    unsigned __int64 seq;          /* sequence number */
+    unsigned int     op;           /* REGLOG_* operation */
+    data_size_t      pathlen;      /* length of the key path */
+    data_size_t      size;         /* size of the data following the path */
+    unsigned int     reserved;
+};
+
+/* a key on the path to the current key of a compaction */
+struct reglog_compact_level
+{
+    struct key      *key;          /* the key */
+    WCHAR           *name;         /* its name when it was reached */
+    data_size_t      len;          /* length of the name */
+};
+
+/* a snapshot of a registry branch being written in the background */
+struct reglog_compact
+{
+    FILE                        *file;     /* temporary file */
+    char                         tmp[32];  /* temporary file name */
+    off_t                        log_pos;  /* log offset of the first record not included */
+    struct timeout_user         *timeout;  /* timer for the next step */
+    unsigned int                 depth;    /* depth of the current key */
+    unsigned int                 size;     /* size of the stack */
+    struct reglog_compact_level *stack;    /* path to the current key */
+};
+
+/* validate a log record and return its total size, or 0 if it's invalid or truncated */
+static size_t check_log_record( const char *data, size_t size )
+{
+    const struct reglog_record *rec = (const struct reglog_record *)data;
+    size_t pos;
+
+    if (size < sizeof(*rec)) return 0;
+    if (rec->pathlen % sizeof(WCHAR) || rec->size % 8) return 0;
+    if (size - sizeof(*rec) < hive_align( rec->pathlen ) + (size_t)rec->size) return 0;
+    pos = sizeof(*rec) + hive_align( rec->pathlen );
+
+    switch (rec->op)
+    {
+    case REGLOG_SET_KEY:
+        if (!check_hive_key( data, pos + rec->size, &pos )) return 0;
+        if (((const struct hive_key *)(data + sizeof(*rec) + hive_align( rec->pathlen )))->namelen) return 0;
+        return pos == sizeof(*rec) + hive_align( rec->pathlen ) + rec->size ? pos : 0;
+    case REGLOG_DELETE_KEY:
+        if (!rec->pathlen || rec->size) return 0;
+        return pos;
+    }
+    return 0;
+}
+
+/* find a key of the branch from its path in a log record */
+static struct key *find_log_key( struct key *base, const WCHAR *path, data_size_t len )
+{
+    struct key *key = base;
+    struct unicode_str name;
+    int index;
+
+    while (key && len)
+    {
+        name.str = path;
+        name.len = get_path_element( path, len );
+        key = find_subkey( key, &name, &index );
+        if (name.len < len) name.len += sizeof(WCHAR);
+        path += name.len / sizeof(WCHAR);
+        len -= name.len;
+    }
+    return key;
+}
+
+/* apply a validated log record to a registry branch */
+static void replay_log_record( struct key *base, const struct reglog_record *rec )
+{
+    struct unicode_str path = { (const WCHAR *)(rec + 1), rec->pathlen };
+    const struct hive_key *hive;
+    struct key *key;
+
+    switch (rec->op)
+    {
+    case REGLOG_SET_KEY:
+        hive = (const struct hive_key *)((const char *)(rec + 1) + hive_align( rec->pathlen ));
+        if (!path.len) key = (struct key *)grab_object( base );
+        else if (!(key = create_key_recursive( base, &path, hive->modif ))) break;
+        load_hive_key( key, hive );
+        release_object( key );
+        break;
+    case REGLOG_DELETE_KEY:
+        if ((key = find_log_key( base, path.str, path.len ))) delete_key( key, 1 );
+        break;
+    }
+}
+
+/* replay the change log of a registry branch and open it to append new records */
+static void open_branch_log( struct save_branch_info *info )
+{
+    struct reglog_header header;
+    struct stat st;
+    size_t pos = sizeof(header), len;
+    unsigned int count = 0;
+    char *data, *name;
+    int fd;
+
+    if (!(name = get_branch_file_name( info->filename, ".log" ))) return;
+    if ((fd = open( name, O_RDWR | O_CREAT, 0666 )) == -1 || fstat( fd, &st ) == -1) goto error;
+
+    if (st.st_size >= (off_t)sizeof(header) &&
+        (data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) != MAP_FAILED)
+    {
+        if (!memcmp( data, REGLOG_MAGIC, sizeof(header.magic) ) &&
+            ((struct reglog_header *)data)->version == REGLOG_VERSION)
+        {
+            while ((len = check_log_record( data + pos, st.st_size - pos )))
+            {
+                const struct reglog_record *rec = (const struct reglog_record *)(data + pos);
+                if (rec->seq > info->log_seq)
+                {
+                    replay_log_record( info->key, rec );
+                    info->log_seq = rec->seq;
+                    count++;
+                }
+                pos += len;
+            }
+        }
+        else pos = 0;
+        munmap( data, st.st_size );
+    }
+    else pos = 0;
+
+    if (debug_level && count) fprintf( stderr, "%s: replayed %u changes\n", name, count );
+    if (pos < sizeof(header))
+    {
+        /* create a new log */
+        memset( &header, 0, sizeof(header) );
+        memcpy( header.magic, REGLOG_MAGIC, sizeof(header.magic) );
+        header.version = REGLOG_VERSION;
+        if (ftruncate( fd, 0 ) == -1 || write( fd, &header, sizeof(header) ) != sizeof(header)) goto error;
+        pos = sizeof(header);
+    }
+    /* drop any truncated record left by a crash */
+    else if (pos < (size_t)st.st_size && ftruncate( fd, pos ) == -1) goto error;
+
+    if (lseek( fd, pos, SEEK_SET ) == -1 || !(info->log = fdopen( fd, "a" ))) goto error;
+    info->log_flushed = pos;
+    info->compact_size = max( REGLOG_MIN_COMPACT_SIZE, stat( info->filename, &st ) ? 0 : st.st_size / 4 );
+    free( name );
+    return;
+
+error:
+    fprintf( stderr, "wineserver: could not open registry log %s", name );
+    perror( " " );
+    if (fd != -1) close( fd );
+    free( name );
+}
+
 /* load one of the initial registry files */
 static int load_init_registry_from_file( const char *filename, struct key *key )
 {
-    FILE *f;
+    struct save_branch_info *info;
+    FILE *f = NULL;
+    int ret;
+
+    assert( save_branch_count < MAX_SAVE_BRANCH_INFO );
 
-    if ((f = fopen( filename, "r" )))
+    info = &save_branch_info[save_branch_count];
+    info->key = key;
+    info->filename = filename;
+    info->log = NULL;
+    info->log_seq = 0;
+    info->compact = NULL;
+
+    if (!(ret = binary_registry && load_binary_branch( key, filename, &info->log_seq )) &&
+        (f = fopen( filename, "r" )))
     {
-        load_keys( key, filename, f, 0 );
+        load_keys( key, filename, f, 0, &info->log_seq );
         fclose( f );
         if (get_error() == STATUS_NOT_REGISTRY_FILE)
         {
             fprintf( stderr, "%s is not a valid registry file\n", filename );
             return 1;
         }
+        ret = 1;
     }
 
-    assert( save_branch_count < MAX_SAVE_BRANCH_INFO );
+    if (registry_log)
+    {
+        open_branch_log( info );
+        /* the branch now matches the file and its log */
+        make_clean( key );
+    }
 
-    save_branch_info[save_branch_count].filename = filename;
-    save_branch_info[save_branch_count++].key = (struct key *)grab_object( key );
+    save_branch_count++;
+    info->key = (struct key *)grab_object( key );
     make_object_permanent( &key->obj );
-    return (f != NULL);
+    return ret;
 }
 
 static WCHAR *format_user_registry_path( const struct sid *sid, struct unicode_str *path )
@@ -1904,6 +2535,9 @@ void init_registry(void)
     unsigned int i;
     char *p;
 
+    if ((p = getenv( "WINEBINARYREGISTRY" ))) binary_registry = atoi( p );
+    if ((p = getenv( "WINEREGISTRYLOG" ))) registry_log = atoi( p );
+
     /* switch to the config dir */
 
     if (fchdir( config_dir_fd ) == -1) fatal_error( "chdir to config dir: %s\n", strerror( errno ));
@@ -2005,8 +2639,8 @@ void init_registry(void)
     if (fchdir( server_dir_fd ) == -1) fatal_error( "chdir to server dir: %s\n", strerror( errno ));
 }
 
-/* save a registry branch to a file */
-static void save_all_subkeys( struct key *key, FILE *f )
+/* write the header of a registry branch file */
+static void save_branch_header( struct key *key, unsigned __int64 log_seq, FILE *f )
 {
     fprintf( f, "WINE REGISTRY Version 2\n" );
     fprintf( f, ";; All keys relative to " );
@@ -2023,6 +2657,13 @@ static void save_all_subkeys( struct key *key, FILE *f )
     default:
         break;
     }
+    if (log_seq) fprintf( f, "#logseq=%x%08x\n", (unsigned int)(log_seq >> 32), (unsigned int)log_seq );
+}
+
+/* save a registry branch to a file */
+static void save_all_subkeys( struct key *key, unsigned __int64 log_seq, FILE *f )
+{
+    save_branch_header( key, log_seq, f );
     save_subkeys( key, key, f );
 }
 
@@ -2040,7 +2681,7 @@ static void save_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "w" );
         if (f)
         {
-            save_all_subkeys( key, f );
+            save_all_subkeys( key, 0, f );
             if (fclose( f )) file_set_error();
         }
         else
@@ -2052,7 +2693,7 @@ static void save_registry( struct key *key, obj_handle_t handle )
 }
 
 /* save a registry branch to a file */
-static int save_branch( struct key *key, const char *filename )
+static int save_branch( struct key *key, const char *filename, unsigned __int64 log_seq )
 {
     struct stat st;
     char tmp[32];
@@ -2106,7 +2747,7 @@ static int save_branch( struct key *key, const char *filename )
         dump_operation( key, NULL, "saving" );
     }
 
-    save_all_subkeys( key, f );
+    save_all_subkeys( key, log_seq, f );
     ret = !fclose(f);
 
     if (tmp[0])
@@ -2117,10 +2758,388 @@ static int save_branch( struct key *key, const char *filename )
     }
 
 done:
-    if (ret) make_clean( key );
+    if (ret)
+    {
+        make_clean( key );
+        if (binary_registry) save_binary_branch( key, filename, log_seq );
+    }
     return ret;
 }
 
+/* get the branch that a key is saved into */
+static struct save_branch_info *get_key_branch( const struct key *key )
+{
+    int i;
+
+    for ( ; key; key = get_parent( key ))
+        for (i = 0; i < save_branch_count; i++)
+            if (save_branch_info[i].key == key) return &save_branch_info[i];
+    return NULL;
+}
+
+/* write the path of a key relative to the branch root to the change log */
+static int write_log_path( FILE *f, const struct key *key, const struct key *base )
+{
+    static const WCHAR backslash = '\\';
+
+    if (key == base) return 1;
+    if (get_parent( key ) != base)
+    {
+        if (!write_log_path( f, get_parent( key ), base )) return 0;
+        if (fwrite( &backslash, sizeof(backslash), 1, f ) != 1) return 0;
+    }
+    return fwrite( key->obj.name->name, key->obj.name->len, 1, f ) == 1;
+}
+
+/* stop using the change log after a write error, and fall back to saving the whole branch */
+static void abort_branch_log( struct save_branch_info *info )
+{
+    int fd = dup( fileno( info->log ) );
+
+    fprintf( stderr, "wineserver: could not write registry log for %s", info->filename );
+    perror( " " );
+    fclose( info->log );
+    info->log = NULL;
+    info->key->flags |= KEY_DIRTY;
+
+    /* drop the records that may have been partially written, the next save includes them */
+    if (fd == -1) return;
+    if (ftruncate( fd, info->log_flushed ) == -1 && debug_level)
+        fprintf( stderr, "%s: could not truncate change log\n", info->filename );
+    close( fd );
+}
+
+/* append a record for a key to the change log of its branch */
+static void write_log_record( struct save_branch_info *info, const struct key *key, enum reglog_op op )
+{
+    static const char padding[8];
+    struct reglog_record rec;
+    const struct key *parent;
+
+    if (!info->log) return;  /* the log was aborted */
+
+    memset( &rec, 0, sizeof(rec) );
+    rec.seq = ++info->log_seq;
+    rec.op  = op;
+    for (parent = key; parent != info->key; parent = get_parent( parent ))
+        rec.pathlen += parent->obj.name->len + (rec.pathlen ? sizeof(WCHAR) : 0);
+    if (op == REGLOG_SET_KEY) rec.size = get_hive_key_size( key );
+
+    if (fwrite( &rec, sizeof(rec), 1, info->log ) != 1 ||
+        !write_log_path( info->log, key, info->key ) ||
+        (hive_align( rec.pathlen ) > rec.pathlen &&
+         fwrite( padding, hive_align( rec.pathlen ) - rec.pathlen, 1, info->log ) != 1) ||
+        (op == REGLOG_SET_KEY && !write_hive_key( key, ~0u, 0, info->log )))
+        abort_branch_log( info );
+}
+
+/* log the deletion of a key, before it is removed from the tree */
+static void log_key_deletion( struct key *key )
+{
+    struct save_branch_info *info;
+
+    if (!registry_log || (key->flags & KEY_VOLATILE)) return;
+    if (!(info = get_key_branch( key )) || !info->log || info->key == key) return;
+    write_log_record( info, key, REGLOG_DELETE_KEY );
+}
+
+/* write the changed keys of a dirty subtree to the change log */
+static void log_dirty_keys( struct save_branch_info *info, struct key *key )
+{
+    int i;
+
+    if (key->flags & KEY_VOLATILE) return;
+    if (!(key->flags & KEY_DIRTY)) return;
+    if (key->flags & KEY_CHANGED) write_log_record( info, key, REGLOG_SET_KEY );
+    key->flags &= ~(KEY_DIRTY | KEY_CHANGED);
+    for (i = 0; i <= key->last_subkey; i++) log_dirty_keys( info, key->subkeys[i] );
+}
+
+/* save the whole branch to its file, and empty the change log that it now includes */
+static int compact_branch_log( struct save_branch_info *info )
+{
+    struct stat st;
+
+    info->key->flags |= KEY_DIRTY;
+    if (!save_branch( info->key, info->filename, info->log_seq )) return 0;
+
+    if (fflush( info->log ) || ftruncate( fileno( info->log ), sizeof(struct reglog_header) ) == -1 ||
+        fseek( info->log, sizeof(struct reglog_header), SEEK_SET ))
+    {
+        /* the file includes all the records, so they are skipped when replaying */
+        abort_branch_log( info );
+        return 1;
+    }
+    info->log_flushed = sizeof(struct reglog_header);
+
+    if (debug_level) fprintf( stderr, "%s: compacted change log\n", info->filename );
+    info->compact_size = max( REGLOG_MIN_COMPACT_SIZE, stat( info->filename, &st ) ? 0 : st.st_size / 4 );
+    return 1;
+}
+
+/* save the path to a key of the branch being compacted; return 0 on memory error */
+static int push_compact_key( struct reglog_compact *compact, struct key *key )
+{
+    struct reglog_compact_level *level;
+
+    if (compact->depth == compact->size)
+    {
+        unsigned int size = max( 16, compact->size * 2 );
+        struct reglog_compact_level *new_stack = realloc( compact->stack, size * sizeof(*new_stack) );
+
+        if (!new_stack) return 0;
+        compact->stack = new_stack;
+        compact->size  = size;
+    }
+    level = &compact->stack[compact->depth];
+    if (!(level->name = memdup( key->obj.name->name, key->obj.name->len ))) return 0;
+    level->len = key->obj.name->len;
+    level->key = (struct key *)grab_object( key );
+    compact->depth++;
+    return 1;
+}
+
+/* leave the current key of the branch being compacted */
+static void pop_compact_key( struct reglog_compact *compact )
+{
+    struct reglog_compact_level *level = &compact->stack[--compact->depth];
+
+    release_object( level->key );
+    free( level->name );
+}
+
+/* move to the key that follows the current one in the order of save_subkeys();
+ * return 0 once the whole branch has been saved, and -1 on memory error */
+static int next_compact_key( struct reglog_compact *compact )
+{
+    struct reglog_compact_level *level = &compact->stack[compact->depth - 1];
+    struct unicode_str name;
+    struct key *parent;
+    int index;
+
+    if (!(level->key->flags & (KEY_DELETED | KEY_VOLATILE)) && level->key->last_subkey >= 0)
+        return push_compact_key( compact, level->key->subkeys[0] ) ? 1 : -1;
+
+    while (compact->depth > 1)
+    {
+        /* the subkeys may have changed since the previous step, so the next sibling is
+         * looked up by name; keys that have been added before it are logged */
+        name.str = compact->stack[compact->depth - 1].name;
+        name.len = compact->stack[compact->depth - 1].len;
+        pop_compact_key( compact );
+        parent = compact->stack[compact->depth - 1].key;
+        if (parent->flags & KEY_DELETED) continue;
+        if (find_subkey( parent, &name, &index )) index++;
+        if (index <= parent->last_subkey)
+            return push_compact_key( compact, parent->subkeys[index] ) ? 1 : -1;
+    }
+    return 0;
+}
+
+/* stop a background compaction, and remove its snapshot */
+static void cancel_log_compaction( struct save_branch_info *info )
+{
+    struct reglog_compact *compact = info->compact;
+
+    if (!compact) return;
+    if (compact->timeout) remove_timeout_user( compact->timeout );
+    while (compact->depth) pop_compact_key( compact );
+    fclose( compact->file );
+    unlink( compact->tmp );
+    free( compact->stack );
+    free( compact );
+    info->compact = NULL;
+}
+
+/* remove the records included in a new snapshot from the change log */
+static int trim_branch_log( struct save_branch_info *info, off_t pos )
+{
+    struct reglog_header header;
+    char tmp[32], *name, *data = NULL;
+    off_t end = ftell( info->log );
+    int fd, ret = 0;
+    FILE *f;
+
+    if (!(name = get_branch_file_name( info->filename, ".log" ))) return 0;
+    snprintf( tmp, sizeof(tmp), "reglog%lx.tmp", (long) getpid() );
+    if ((fd = open( tmp, O_CREAT | O_TRUNC | O_RDWR, 0666 )) == -1) goto done;
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, REGLOG_MAGIC, sizeof(header.magic) );
+    header.version = REGLOG_VERSION;
+    if (write( fd, &header, sizeof(header) ) != sizeof(header)) goto done;
+    if (end > pos)
+    {
+        if (!(data = malloc( end - pos ))) goto done;
+        if (pread( fileno( info->log ), data, end - pos, pos ) != end - pos) goto done;
+        if (write( fd, data, end - pos ) != end - pos) goto done;
+    }
+    if (!(f = fdopen( fd, "a" ))) goto done;
+    fd = -1;
+    if (rename( tmp, name ) == -1)
+    {
+        fclose( f );
+        unlink( tmp );
+        goto done;
+    }
+
+    fclose( info->log );
+    info->log = f;
+    info->log_flushed = sizeof(header) + end - pos;
+    ret = 1;
+
+done:
+    if (fd != -1)
+    {
+        close( fd );
+        unlink( tmp );
+    }
+    free( data );
+    free( name );
+    return ret;
+}
+
+/* write the snapshot of a background compaction, a few keys at a time */
+static void compact_log_step( void *arg )
+{
+    struct save_branch_info *info = arg;
+    struct reglog_compact *compact = info->compact;
+    unsigned int count = 0;
+    struct stat st;
+    int ret = 1;
+
+    if (fchdir( config_dir_fd ) == -1)
+    {
+        compact->timeout = add_timeout_user( save_period, compact_log_step, info );
+        return;
+    }
+    compact->timeout = NULL;
+
+    /* a full save has been done after a log error, the snapshot is out of date */
+    if (!info->log) goto cancel;
+
+    while (count++ < REGLOG_COMPACT_KEYS && (ret = next_compact_key( compact )) > 0)
+        if (!(compact->stack[compact->depth - 1].key->flags & KEY_VOLATILE))
+            save_key( compact->stack[compact->depth - 1].key, info->key, compact->file );
+
+    if (ret > 0 && (compact->timeout = add_timeout_user( 0, compact_log_step, info ))) goto done;
+    if (ret) goto cancel;
+
+    ret = !fclose( compact->file );
+    compact->file = NULL;
+    if (ret) ret = !rename( compact->tmp, info->filename );
+    if (!ret)
+    {
+        unlink( compact->tmp );
+        goto cancel;
+    }
+
+    if (fflush( info->log ) || !trim_branch_log( info, compact->log_pos ))
+    {
+        /* the file includes the records, so they are skipped when replaying */
+        abort_branch_log( info );
+    }
+    else
+    {
+        if (debug_level) fprintf( stderr, "%s: compacted change log\n", info->filename );
+        info->compact_size = max( REGLOG_MIN_COMPACT_SIZE, stat( info->filename, &st ) ? 0 : st.st_size / 4 );
+    }
+
+cancel:
+    if (compact->file)
+    {
+        fclose( compact->file );
+        unlink( compact->tmp );
+    }
+    while (compact->depth) pop_compact_key( compact );
+    free( compact->stack );
+    free( compact );
+    info->compact = NULL;
+done:
+    if (fchdir( server_dir_fd ) == -1) fatal_error( "chdir to server dir: %s\n", strerror( errno ));
+}
+
+/* start writing a snapshot of the branch in the background; the records logged from now on
+ * are kept in the log, and the others are removed once the snapshot replaces the file */
+static void start_log_compaction( struct save_branch_info *info )
+{
+    struct reglog_compact *compact;
+    struct stat st;
+    int fd, count = 0;
+
+    /* files that are saved in place can't be replaced at once */
+    if (!lstat( info->filename, &st ) && (!S_ISREG(st.st_mode) || st.st_nlink > 1))
+    {
+        compact_branch_log( info );
+        return;
+    }
+
+    if (!(compact = mem_alloc( sizeof(*compact) ))) return;
+    memset( compact, 0, sizeof(*compact) );
+    for (;;)
+    {
+        snprintf( compact->tmp, sizeof(compact->tmp), "reg%lx%04x.tmp", (long) getpid(), count++ );
+        if ((fd = open( compact->tmp, O_CREAT | O_EXCL | O_WRONLY, 0666 )) != -1) break;
+        if (errno != EEXIST) goto error;
+    }
+    if (!(compact->file = fdopen( fd, "w" )))
+    {
+        close( fd );
+        unlink( compact->tmp );
+        goto error;
+    }
+    if (!push_compact_key( compact, info->key ) ||
+        !(compact->timeout = add_timeout_user( 0, compact_log_step, info )))
+    {
+        while (compact->depth) pop_compact_key( compact );
+        fclose( compact->file );
+        unlink( compact->tmp );
+        goto error;
+    }
+
+    compact->log_pos = ftell( info->log );
+    save_branch_header( info->key, info->log_seq, compact->file );
+    save_key( info->key, info->key, compact->file );
+    info->compact = compact;
+    if (debug_level) fprintf( stderr, "%s: compacting change log\n", info->filename );
+    return;
+
+error:
+    free( compact->stack );
+    free( compact );
+}
+
+/* append the changes of a registry branch to its change log */
+static int save_branch_log( struct save_branch_info *info, int force_compact )
+{
+    log_dirty_keys( info, info->key );
+    if (info->log && fflush( info->log )) abort_branch_log( info );
+    if (!info->log)
+    {
+        /* the dirty flags may have been cleared after the log was aborted */
+        info->key->flags |= KEY_DIRTY;
+        return save_branch( info->key, info->filename, info->log_seq );
+    }
+    info->log_flushed = ftell( info->log );
+    /* always fold the log into the file when shutting down, so that it
+     * doesn't get lost if the next server runs without the log */
+    if (force_compact)
+    {
+        cancel_log_compaction( info );
+        return compact_branch_log( info );
+    }
+    if (!info->compact && info->log_flushed > info->compact_size) start_log_compaction( info );
+    return 1;
+}
+
+/* save a registry branch, either to its change log or to its file */
+static int flush_branch( struct save_branch_info *info, int force_compact )
+{
+    if (info->log) return save_branch_log( info, force_compact );
+    cancel_log_compaction( info );
+    return save_branch( info->key, info->filename, info->log_seq );
+}
+
 /* periodic saving of the registry */
 static void periodic_save( void *arg )
 {
@@ -2129,7 +3148,7 @@ static void periodic_save( void *arg )
     if (fchdir( config_dir_fd ) == -1) return;
     save_timeout_user = NULL;
     for (i = 0; i < save_branch_count; i++)
-        save_branch( save_branch_info[i].key, save_branch_info[i].filename );
+        flush_branch( &save_branch_info[i], 0 );
     if (fchdir( server_dir_fd ) == -1) fatal_error( "chdir to server dir: %s\n", strerror( errno ));
     set_periodic_save_timer();
 }
@@ -2149,7 +3168,7 @@ void flush_registry(void)
     if (fchdir( config_dir_fd ) == -1) return;
     for (i = 0; i < save_branch_count; i++)
     {
-        if (!save_branch( save_branch_info[i].key, save_branch_info[i].filename ))
+        if (!flush_branch( &save_branch_info[i], 1 ))
         {
             fprintf( stderr, "wineserver: could not save registry branch to %s",
                      save_branch_info[i].filename );
@@ -2290,6 +3309,19 @@ DECL_HANDLER(get_key_value)
     if ((key = get_hkey_obj( req->hkey, KEY_QUERY_VALUE )))
     {
         get_value( key, &name, &reply->type, &reply->total );
+        if (!key->shared && (key->shared = alloc_shared_object()))
+        {
+            SHARED_WRITE_BEGIN( key->shared, key_shm_t )
+            {
+                shared->generation = 0;
+            }
+            SHARED_WRITE_END;
+        }
+        if (key->shared)
+        {
+            reply->locator    = get_shared_object_locator( key->shared );
+            reply->generation = key->shared->generation;
+        }
         release_object( key );
     }
 }
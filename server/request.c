@@ -77,6 +77,9 @@ struct master_socket
     struct fd           *fd;         /* file descriptor of the master socket */
 };
 
+int request_stats_enabled = 0;     /* are request statistics enabled? */
+struct request_stats request_stats[REQ_NB_REQUESTS];
+
 static void master_socket_dump( struct object *obj, int verbose );
 static void master_socket_destroy( struct object *obj );
 static void master_socket_poll_event( struct fd *fd, int event );
@@ -292,6 +295,7 @@ static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    timeout_t start = 0;
 
     current = thread;
     current->reply_size = 0;
@@ -301,7 +305,20 @@ static void call_req_handler( struct thread *thread )
     if (debug_level) trace_request();
 
     if (req < REQ_NB_REQUESTS)
+    {
+        if (request_stats_enabled) start = monotonic_counter();
         req_handlers[req]( &current->req, &reply );
+        if (request_stats_enabled)
+        {
+            struct request_stats *stats = &request_stats[req];
+            timeout_t elapsed = monotonic_counter() - start;
+
+            stats->count++;
+            stats->total_time += elapsed;
+            if (elapsed > stats->max_time) stats->max_time = elapsed;
+            if (current) stats->reply_size += current->reply_size;
+        }
+    }
     else
         set_error( STATUS_NOT_IMPLEMENTED );
 
@@ -323,6 +340,86 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* check whether a request can be part of a batch */
+static int is_batch_request_allowed( enum request req )
+{
+    switch (req)
+    {
+    case REQ_create_key:
+    case REQ_open_key:
+    case REQ_flush_key:
+    case REQ_enum_key:
+    case REQ_set_key_value:
+    case REQ_get_key_value:
+    case REQ_enum_key_value:
+    case REQ_delete_key_value:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* execute a batch of requests */
+DECL_HANDLER(batch)
+{
+    union generic_request batch_req = current->req;  /* req points to current->req */
+    void *batch_data = current->req_data;
+    data_size_t size = get_req_data_size(), max_size = get_reply_max_size();
+    data_size_t pos = 0, reply_pos = 0;
+    unsigned int status = STATUS_SUCCESS;
+    union generic_reply sub_reply;
+    char *reply_data = NULL;
+    enum request sub_req;
+
+    if (max_size && !(reply_data = mem_alloc( max_size ))) return;
+
+    while (pos < size)
+    {
+        if (size - pos < sizeof(current->req))
+        {
+            status = STATUS_INVALID_PARAMETER;
+            break;
+        }
+        memcpy( &current->req, (char *)batch_data + pos, sizeof(current->req) );
+        pos += sizeof(current->req);
+        sub_req = current->req.request_header.req;
+
+        if (!is_batch_request_allowed( sub_req ) ||
+            current->req.request_header.request_size > size - pos ||
+            max_size - reply_pos < sizeof(sub_reply) ||
+            current->req.request_header.reply_size > max_size - reply_pos - sizeof(sub_reply))
+        {
+            status = STATUS_INVALID_PARAMETER;
+            break;
+        }
+        current->req_data = (char *)batch_data + pos;
+        pos += (current->req.request_header.request_size + 7) & ~7;
+
+        current->reply_size = 0;
+        current->reply_data = NULL;
+        clear_error();
+        memset( &sub_reply, 0, sizeof(sub_reply) );
+        if (debug_level) trace_request();
+        req_handlers[sub_req]( &current->req, &sub_reply );
+        sub_reply.reply_header.error = current->error;
+        sub_reply.reply_header.reply_size = current->reply_size;
+        if (debug_level) trace_reply( sub_req, &sub_reply );
+
+        memcpy( reply_data + reply_pos, &sub_reply, sizeof(sub_reply) );
+        reply_pos += sizeof(sub_reply);
+        if (current->reply_size) memcpy( reply_data + reply_pos, current->reply_data, current->reply_size );
+        reply_pos += current->reply_size;
+        free( current->reply_data );
+    }
+
+    /* the replies of the requests that have been executed are returned even on error */
+    current->req = batch_req;
+    current->req_data = batch_data;
+    current->reply_data = reply_data;
+    current->reply_size = reply_pos;
+    set_error( status );
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
@@ -33,6 +33,18 @@
 #define DECL_HANDLER(name) \
     void req_##name( const struct name##_request *req, struct name##_reply *reply )
 
+/* per-request statistics */
+struct request_stats
+{
+    unsigned int       count;       /* number of calls */
+    timeout_t          total_time;  /* total time spent in the handler */
+    timeout_t          max_time;    /* maximum time spent in the handler */
+    unsigned long long reply_size;  /* total size of the reply data */
+};
+
+extern int request_stats_enabled;
+extern struct request_stats request_stats[REQ_NB_REQUESTS];
+
 /* request functions */
 
 #ifdef __GNUC__
@@ -65,6 +77,7 @@ extern int server_dir_fd, config_dir_fd;
 
 extern void trace_request(void);
 extern void trace_reply( enum request req, const union generic_reply *reply );
+extern void dump_request_stats(void);
 
 /* get current tick count to return to client */
 static inline unsigned int get_tick_count(void)
@@ -37,6 +37,8 @@ DECL_HANDLER(set_object_permanence);
 DECL_HANDLER(open_process);
 DECL_HANDLER(open_thread);
 DECL_HANDLER(select);
+DECL_HANDLER(get_inproc_sync_fd);
+DECL_HANDLER(get_inproc_sync);
 DECL_HANDLER(create_event);
 DECL_HANDLER(event_op);
 DECL_HANDLER(query_event);
@@ -64,6 +66,9 @@ DECL_HANDLER(lock_file);
 DECL_HANDLER(unlock_file);
 DECL_HANDLER(recv_socket);
 DECL_HANDLER(send_socket);
+DECL_HANDLER(socket_get_batch);
+DECL_HANDLER(socket_set_batch);
+DECL_HANDLER(get_socket_fast_path);
 DECL_HANDLER(socket_get_events);
 DECL_HANDLER(socket_send_icmp_id);
 DECL_HANDLER(socket_get_icmp_id);
@@ -144,6 +149,9 @@ DECL_HANDLER(get_async_result);
 DECL_HANDLER(set_async_direct_result);
 DECL_HANDLER(read);
 DECL_HANDLER(write);
+DECL_HANDLER(set_io_uring);
+DECL_HANDLER(register_io_uring_async);
+DECL_HANDLER(set_io_uring_result);
 DECL_HANDLER(ioctl);
 DECL_HANDLER(set_irp_result);
 DECL_HANDLER(create_named_pipe);
@@ -273,6 +281,11 @@ DECL_HANDLER(add_completion);
 DECL_HANDLER(remove_completion);
 DECL_HANDLER(get_thread_completion);
 DECL_HANDLER(query_completion);
+DECL_HANDLER(get_completion_ring_fd);
+DECL_HANDLER(get_completion_ring);
+DECL_HANDLER(create_wait_completion_packet);
+DECL_HANDLER(associate_wait_completion_packet);
+DECL_HANDLER(cancel_wait_completion_packet);
 DECL_HANDLER(set_completion_info);
 DECL_HANDLER(add_fd_completion);
 DECL_HANDLER(set_fd_completion_mode);
@@ -300,6 +313,7 @@ DECL_HANDLER(resume_process);
 DECL_HANDLER(get_next_process);
 DECL_HANDLER(get_next_thread);
 DECL_HANDLER(set_keyboard_repeat);
+DECL_HANDLER(batch);
 
 typedef void (*req_handler)( const void *req, void *reply );
 static const req_handler req_handlers[REQ_NB_REQUESTS] =
@@ -334,6 +348,8 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_open_process,
     (req_handler)req_open_thread,
     (req_handler)req_select,
+    (req_handler)req_get_inproc_sync_fd,
+    (req_handler)req_get_inproc_sync,
     (req_handler)req_create_event,
     (req_handler)req_event_op,
     (req_handler)req_query_event,
@@ -361,6 +377,9 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_unlock_file,
     (req_handler)req_recv_socket,
     (req_handler)req_send_socket,
+    (req_handler)req_socket_get_batch,
+    (req_handler)req_socket_set_batch,
+    (req_handler)req_get_socket_fast_path,
     (req_handler)req_socket_get_events,
     (req_handler)req_socket_send_icmp_id,
     (req_handler)req_socket_get_icmp_id,
@@ -441,6 +460,9 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_set_async_direct_result,
     (req_handler)req_read,
     (req_handler)req_write,
+    (req_handler)req_set_io_uring,
+    (req_handler)req_register_io_uring_async,
+    (req_handler)req_set_io_uring_result,
     (req_handler)req_ioctl,
     (req_handler)req_set_irp_result,
     (req_handler)req_create_named_pipe,
@@ -570,6 +592,11 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_remove_completion,
     (req_handler)req_get_thread_completion,
     (req_handler)req_query_completion,
+    (req_handler)req_get_completion_ring_fd,
+    (req_handler)req_get_completion_ring,
+    (req_handler)req_create_wait_completion_packet,
+    (req_handler)req_associate_wait_completion_packet,
+    (req_handler)req_cancel_wait_completion_packet,
     (req_handler)req_set_completion_info,
     (req_handler)req_add_fd_completion,
     (req_handler)req_set_fd_completion_mode,
@@ -597,6 +624,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_get_next_process,
     (req_handler)req_get_next_thread,
     (req_handler)req_set_keyboard_repeat,
+    (req_handler)req_batch,
 };
 
 C_ASSERT( sizeof(abstime_t) == 8 );
@@ -855,6 +883,14 @@ C_ASSERT( sizeof(struct select_request) == 40 );
 C_ASSERT( offsetof(struct select_reply, apc_handle) == 8 );
 C_ASSERT( offsetof(struct select_reply, signaled) == 12 );
 C_ASSERT( sizeof(struct select_reply) == 16 );
+C_ASSERT( sizeof(struct get_inproc_sync_fd_request) == 16 );
+C_ASSERT( offsetof(struct get_inproc_sync_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_inproc_sync_request) == 16 );
+C_ASSERT( offsetof(struct get_inproc_sync_reply, type) == 8 );
+C_ASSERT( offsetof(struct get_inproc_sync_reply, access) == 12 );
+C_ASSERT( offsetof(struct get_inproc_sync_reply, index) == 16 );
+C_ASSERT( offsetof(struct get_inproc_sync_reply, generation) == 20 );
+C_ASSERT( sizeof(struct get_inproc_sync_reply) == 24 );
 C_ASSERT( offsetof(struct create_event_request, access) == 12 );
 C_ASSERT( offsetof(struct create_event_request, manual_reset) == 16 );
 C_ASSERT( offsetof(struct create_event_request, initial_state) == 20 );
@@ -1009,6 +1045,19 @@ C_ASSERT( offsetof(struct send_socket_reply, wait) == 8 );
 C_ASSERT( offsetof(struct send_socket_reply, options) == 12 );
 C_ASSERT( offsetof(struct send_socket_reply, nonblocking) == 16 );
 C_ASSERT( sizeof(struct send_socket_reply) == 24 );
+C_ASSERT( offsetof(struct socket_get_batch_request, handle) == 12 );
+C_ASSERT( offsetof(struct socket_get_batch_request, write) == 16 );
+C_ASSERT( sizeof(struct socket_get_batch_request) == 24 );
+C_ASSERT( sizeof(struct socket_get_batch_reply) == 8 );
+C_ASSERT( offsetof(struct socket_set_batch_request, handle) == 12 );
+C_ASSERT( offsetof(struct socket_set_batch_request, write) == 16 );
+C_ASSERT( sizeof(struct socket_set_batch_request) == 24 );
+C_ASSERT( offsetof(struct get_socket_fast_path_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_socket_fast_path_request) == 16 );
+C_ASSERT( offsetof(struct get_socket_fast_path_reply, flags) == 8 );
+C_ASSERT( offsetof(struct get_socket_fast_path_reply, options) == 12 );
+C_ASSERT( offsetof(struct get_socket_fast_path_reply, locator) == 16 );
+C_ASSERT( sizeof(struct get_socket_fast_path_reply) == 32 );
 C_ASSERT( offsetof(struct socket_get_events_request, handle) == 12 );
 C_ASSERT( offsetof(struct socket_get_events_request, event) == 16 );
 C_ASSERT( sizeof(struct socket_get_events_request) == 24 );
@@ -1189,7 +1238,9 @@ C_ASSERT( offsetof(struct get_key_value_request, hkey) == 12 );
 C_ASSERT( sizeof(struct get_key_value_request) == 16 );
 C_ASSERT( offsetof(struct get_key_value_reply, type) == 8 );
 C_ASSERT( offsetof(struct get_key_value_reply, total) == 12 );
-C_ASSERT( sizeof(struct get_key_value_reply) == 16 );
+C_ASSERT( offsetof(struct get_key_value_reply, locator) == 16 );
+C_ASSERT( offsetof(struct get_key_value_reply, generation) == 32 );
+C_ASSERT( sizeof(struct get_key_value_reply) == 40 );
 C_ASSERT( offsetof(struct enum_key_value_request, hkey) == 12 );
 C_ASSERT( offsetof(struct enum_key_value_request, index) == 16 );
 C_ASSERT( offsetof(struct enum_key_value_request, info_class) == 20 );
@@ -1410,6 +1461,24 @@ C_ASSERT( offsetof(struct write_reply, wait) == 8 );
 C_ASSERT( offsetof(struct write_reply, options) == 12 );
 C_ASSERT( offsetof(struct write_reply, size) == 16 );
 C_ASSERT( sizeof(struct write_reply) == 24 );
+C_ASSERT( offsetof(struct set_io_uring_request, fd) == 12 );
+C_ASSERT( offsetof(struct set_io_uring_request, size) == 16 );
+C_ASSERT( offsetof(struct set_io_uring_request, entries) == 20 );
+C_ASSERT( offsetof(struct set_io_uring_request, head) == 24 );
+C_ASSERT( offsetof(struct set_io_uring_request, tail) == 28 );
+C_ASSERT( offsetof(struct set_io_uring_request, mask) == 32 );
+C_ASSERT( offsetof(struct set_io_uring_request, cqes) == 36 );
+C_ASSERT( sizeof(struct set_io_uring_request) == 40 );
+C_ASSERT( offsetof(struct register_io_uring_async_request, type) == 12 );
+C_ASSERT( offsetof(struct register_io_uring_async_request, count) == 16 );
+C_ASSERT( offsetof(struct register_io_uring_async_request, async) == 24 );
+C_ASSERT( sizeof(struct register_io_uring_async_request) == 64 );
+C_ASSERT( offsetof(struct register_io_uring_async_reply, slot) == 8 );
+C_ASSERT( sizeof(struct register_io_uring_async_reply) == 16 );
+C_ASSERT( offsetof(struct set_io_uring_result_request, slot) == 12 );
+C_ASSERT( offsetof(struct set_io_uring_result_request, status) == 16 );
+C_ASSERT( offsetof(struct set_io_uring_result_request, total) == 20 );
+C_ASSERT( sizeof(struct set_io_uring_result_request) == 24 );
 C_ASSERT( offsetof(struct ioctl_request, code) == 12 );
 C_ASSERT( offsetof(struct ioctl_request, async) == 16 );
 C_ASSERT( sizeof(struct ioctl_request) == 56 );
@@ -2121,6 +2190,7 @@ C_ASSERT( offsetof(struct create_linked_token_reply, linked) == 8 );
 C_ASSERT( sizeof(struct create_linked_token_reply) == 16 );
 C_ASSERT( offsetof(struct create_completion_request, access) == 12 );
 C_ASSERT( offsetof(struct create_completion_request, concurrent) == 16 );
+C_ASSERT( offsetof(struct create_completion_request, ring) == 20 );
 C_ASSERT( sizeof(struct create_completion_request) == 24 );
 C_ASSERT( offsetof(struct create_completion_reply, handle) == 8 );
 C_ASSERT( sizeof(struct create_completion_reply) == 16 );
@@ -2156,6 +2226,29 @@ C_ASSERT( offsetof(struct query_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct query_completion_request) == 16 );
 C_ASSERT( offsetof(struct query_completion_reply, depth) == 8 );
 C_ASSERT( sizeof(struct query_completion_reply) == 16 );
+C_ASSERT( sizeof(struct get_completion_ring_fd_request) == 16 );
+C_ASSERT( offsetof(struct get_completion_ring_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_completion_ring_request) == 16 );
+C_ASSERT( offsetof(struct get_completion_ring_reply, id) == 8 );
+C_ASSERT( offsetof(struct get_completion_ring_reply, index) == 12 );
+C_ASSERT( sizeof(struct get_completion_ring_reply) == 16 );
+C_ASSERT( offsetof(struct create_wait_completion_packet_request, access) == 12 );
+C_ASSERT( sizeof(struct create_wait_completion_packet_request) == 16 );
+C_ASSERT( offsetof(struct create_wait_completion_packet_reply, handle) == 8 );
+C_ASSERT( sizeof(struct create_wait_completion_packet_reply) == 16 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, packet) == 12 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, completion) == 16 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, target) == 20 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, ckey) == 24 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, cvalue) == 32 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, information) == 40 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_request, status) == 48 );
+C_ASSERT( sizeof(struct associate_wait_completion_packet_request) == 56 );
+C_ASSERT( offsetof(struct associate_wait_completion_packet_reply, signaled) == 8 );
+C_ASSERT( sizeof(struct associate_wait_completion_packet_reply) == 16 );
+C_ASSERT( offsetof(struct cancel_wait_completion_packet_request, packet) == 12 );
+C_ASSERT( offsetof(struct cancel_wait_completion_packet_request, remove_signaled) == 16 );
+C_ASSERT( sizeof(struct cancel_wait_completion_packet_request) == 24 );
 C_ASSERT( offsetof(struct set_completion_info_request, handle) == 12 );
 C_ASSERT( offsetof(struct set_completion_info_request, ckey) == 16 );
 C_ASSERT( offsetof(struct set_completion_info_request, chandle) == 24 );
@@ -2281,3 +2374,5 @@ C_ASSERT( offsetof(struct set_keyboard_repeat_request, period) == 20 );
 C_ASSERT( sizeof(struct set_keyboard_repeat_request) == 24 );
 C_ASSERT( offsetof(struct set_keyboard_repeat_reply, enable) == 8 );
 C_ASSERT( sizeof(struct set_keyboard_repeat_reply) == 16 );
+C_ASSERT( sizeof(struct batch_request) == 16 );
+C_ASSERT( sizeof(struct batch_reply) == 8 );
@@ -20,6 +20,7 @@ static void dump_uint64( const char *prefix, const unsigned __int64 *val );
 static void dump_varargs_acl( const char *prefix, data_size_t size );
 static void dump_varargs_apc_call( const char *prefix, data_size_t size );
 static void dump_varargs_apc_result( const char *prefix, data_size_t size );
+static void dump_varargs_async_batch( const char *prefix, data_size_t size );
 static void dump_varargs_bytes( const char *prefix, data_size_t size );
 static void dump_varargs_contexts( const char *prefix, data_size_t size );
 static void dump_varargs_cursor_positions( const char *prefix, data_size_t size );
@@ -447,6 +448,23 @@ static void dump_select_reply( const struct select_reply *req )
     dump_varargs_contexts( ", contexts=", cur_size );
 }
 
+static void dump_get_inproc_sync_fd_request( const struct get_inproc_sync_fd_request *req )
+{
+}
+
+static void dump_get_inproc_sync_request( const struct get_inproc_sync_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_inproc_sync_reply( const struct get_inproc_sync_reply *req )
+{
+    fprintf( stderr, " type=%d", req->type );
+    fprintf( stderr, ", access=%08x", req->access );
+    fprintf( stderr, ", index=%08x", req->index );
+    fprintf( stderr, ", generation=%08x", req->generation );
+}
+
 static void dump_create_event_request( const struct create_event_request *req )
 {
     fprintf( stderr, " access=%08x", req->access );
@@ -775,6 +793,36 @@ static void dump_send_socket_reply( const struct send_socket_reply *req )
     fprintf( stderr, ", nonblocking=%d", req->nonblocking );
 }
 
+static void dump_socket_get_batch_request( const struct socket_get_batch_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", write=%d", req->write );
+}
+
+static void dump_socket_get_batch_reply( const struct socket_get_batch_reply *req )
+{
+    dump_varargs_async_batch( " asyncs=", cur_size );
+}
+
+static void dump_socket_set_batch_request( const struct socket_set_batch_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", write=%d", req->write );
+    dump_varargs_async_batch( ", asyncs=", cur_size );
+}
+
+static void dump_get_socket_fast_path_request( const struct get_socket_fast_path_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_socket_fast_path_reply( const struct get_socket_fast_path_reply *req )
+{
+    fprintf( stderr, " flags=%08x", req->flags );
+    fprintf( stderr, ", options=%08x", req->options );
+    dump_obj_locator( ", locator=", &req->locator );
+}
+
 static void dump_socket_get_events_request( const struct socket_get_events_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -1146,6 +1194,8 @@ static void dump_get_key_value_reply( const struct get_key_value_reply *req )
 {
     fprintf( stderr, " type=%d", req->type );
     fprintf( stderr, ", total=%u", req->total );
+    dump_obj_locator( ", locator=", &req->locator );
+    dump_uint64( ", generation=", &req->generation );
     dump_varargs_bytes( ", data=", cur_size );
 }
 
@@ -1603,6 +1653,36 @@ static void dump_write_reply( const struct write_reply *req )
     fprintf( stderr, ", size=%u", req->size );
 }
 
+static void dump_set_io_uring_request( const struct set_io_uring_request *req )
+{
+    fprintf( stderr, " fd=%d", req->fd );
+    fprintf( stderr, ", size=%u", req->size );
+    fprintf( stderr, ", entries=%08x", req->entries );
+    fprintf( stderr, ", head=%08x", req->head );
+    fprintf( stderr, ", tail=%08x", req->tail );
+    fprintf( stderr, ", mask=%08x", req->mask );
+    fprintf( stderr, ", cqes=%08x", req->cqes );
+}
+
+static void dump_register_io_uring_async_request( const struct register_io_uring_async_request *req )
+{
+    fprintf( stderr, " type=%d", req->type );
+    fprintf( stderr, ", count=%u", req->count );
+    dump_async_data( ", async=", &req->async );
+}
+
+static void dump_register_io_uring_async_reply( const struct register_io_uring_async_reply *req )
+{
+    fprintf( stderr, " slot=%08x", req->slot );
+}
+
+static void dump_set_io_uring_result_request( const struct set_io_uring_result_request *req )
+{
+    fprintf( stderr, " slot=%08x", req->slot );
+    fprintf( stderr, ", status=%08x", req->status );
+    fprintf( stderr, ", total=%u", req->total );
+}
+
 static void dump_ioctl_request( const struct ioctl_request *req )
 {
     dump_ioctl_code( " code=", &req->code );
@@ -3044,6 +3124,7 @@ static void dump_create_completion_request( const struct create_completion_reque
 {
     fprintf( stderr, " access=%08x", req->access );
     fprintf( stderr, ", concurrent=%08x", req->concurrent );
+    fprintf( stderr, ", ring=%d", req->ring );
     dump_varargs_object_attributes( ", objattr=", cur_size );
 }
 
@@ -3112,6 +3193,54 @@ static void dump_query_completion_reply( const struct query_completion_reply *re
     fprintf( stderr, " depth=%08x", req->depth );
 }
 
+static void dump_get_completion_ring_fd_request( const struct get_completion_ring_fd_request *req )
+{
+}
+
+static void dump_get_completion_ring_request( const struct get_completion_ring_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_completion_ring_reply( const struct get_completion_ring_reply *req )
+{
+    fprintf( stderr, " id=%08x", req->id );
+    fprintf( stderr, ", index=%08x", req->index );
+}
+
+static void dump_create_wait_completion_packet_request( const struct create_wait_completion_packet_request *req )
+{
+    fprintf( stderr, " access=%08x", req->access );
+    dump_varargs_object_attributes( ", objattr=", cur_size );
+}
+
+static void dump_create_wait_completion_packet_reply( const struct create_wait_completion_packet_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_associate_wait_completion_packet_request( const struct associate_wait_completion_packet_request *req )
+{
+    fprintf( stderr, " packet=%04x", req->packet );
+    fprintf( stderr, ", completion=%04x", req->completion );
+    fprintf( stderr, ", target=%04x", req->target );
+    dump_uint64( ", ckey=", &req->ckey );
+    dump_uint64( ", cvalue=", &req->cvalue );
+    dump_uint64( ", information=", &req->information );
+    fprintf( stderr, ", status=%08x", req->status );
+}
+
+static void dump_associate_wait_completion_packet_reply( const struct associate_wait_completion_packet_reply *req )
+{
+    fprintf( stderr, " signaled=%d", req->signaled );
+}
+
+static void dump_cancel_wait_completion_packet_request( const struct cancel_wait_completion_packet_request *req )
+{
+    fprintf( stderr, " packet=%04x", req->packet );
+    fprintf( stderr, ", remove_signaled=%d", req->remove_signaled );
+}
+
 static void dump_set_completion_info_request( const struct set_completion_info_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -3359,6 +3488,16 @@ static void dump_set_keyboard_repeat_reply( const struct set_keyboard_repeat_rep
     fprintf( stderr, " enable=%d", req->enable );
 }
 
+static void dump_batch_request( const struct batch_request *req )
+{
+    dump_varargs_bytes( " data=", cur_size );
+}
+
+static void dump_batch_reply( const struct batch_reply *req )
+{
+    dump_varargs_bytes( " data=", cur_size );
+}
+
 typedef void (*dump_func)( const void *req );
 
 static const dump_func req_dumpers[REQ_NB_REQUESTS] =
@@ -3393,6 +3532,8 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_open_process_request,
     (dump_func)dump_open_thread_request,
     (dump_func)dump_select_request,
+    (dump_func)dump_get_inproc_sync_fd_request,
+    (dump_func)dump_get_inproc_sync_request,
     (dump_func)dump_create_event_request,
     (dump_func)dump_event_op_request,
     (dump_func)dump_query_event_request,
@@ -3420,6 +3561,9 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_unlock_file_request,
     (dump_func)dump_recv_socket_request,
     (dump_func)dump_send_socket_request,
+    (dump_func)dump_socket_get_batch_request,
+    (dump_func)dump_socket_set_batch_request,
+    (dump_func)dump_get_socket_fast_path_request,
     (dump_func)dump_socket_get_events_request,
     (dump_func)dump_socket_send_icmp_id_request,
     (dump_func)dump_socket_get_icmp_id_request,
@@ -3500,6 +3644,9 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_set_async_direct_result_request,
     (dump_func)dump_read_request,
     (dump_func)dump_write_request,
+    (dump_func)dump_set_io_uring_request,
+    (dump_func)dump_register_io_uring_async_request,
+    (dump_func)dump_set_io_uring_result_request,
     (dump_func)dump_ioctl_request,
     (dump_func)dump_set_irp_result_request,
     (dump_func)dump_create_named_pipe_request,
@@ -3629,6 +3776,11 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_remove_completion_request,
     (dump_func)dump_get_thread_completion_request,
     (dump_func)dump_query_completion_request,
+    (dump_func)dump_get_completion_ring_fd_request,
+    (dump_func)dump_get_completion_ring_request,
+    (dump_func)dump_create_wait_completion_packet_request,
+    (dump_func)dump_associate_wait_completion_packet_request,
+    (dump_func)dump_cancel_wait_completion_packet_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
     (dump_func)dump_set_fd_completion_mode_request,
@@ -3656,6 +3808,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_get_next_process_request,
     (dump_func)dump_get_next_thread_request,
     (dump_func)dump_set_keyboard_repeat_request,
+    (dump_func)dump_batch_request,
 };
 
 static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
@@ -3690,6 +3843,8 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_open_process_reply,
     (dump_func)dump_open_thread_reply,
     (dump_func)dump_select_reply,
+    NULL,
+    (dump_func)dump_get_inproc_sync_reply,
     (dump_func)dump_create_event_reply,
     (dump_func)dump_event_op_reply,
     (dump_func)dump_query_event_reply,
@@ -3717,6 +3872,9 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
     NULL,
     (dump_func)dump_recv_socket_reply,
     (dump_func)dump_send_socket_reply,
+    (dump_func)dump_socket_get_batch_reply,
+    NULL,
+    (dump_func)dump_get_socket_fast_path_reply,
     (dump_func)dump_socket_get_events_reply,
     NULL,
     (dump_func)dump_socket_get_icmp_id_reply,
@@ -3797,6 +3955,9 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_set_async_direct_result_reply,
     (dump_func)dump_read_reply,
     (dump_func)dump_write_reply,
+    NULL,
+    (dump_func)dump_register_io_uring_async_reply,
+    NULL,
     (dump_func)dump_ioctl_reply,
     NULL,
     (dump_func)dump_create_named_pipe_reply,
@@ -3927,6 +4088,11 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_get_thread_completion_reply,
     (dump_func)dump_query_completion_reply,
     NULL,
+    (dump_func)dump_get_completion_ring_reply,
+    (dump_func)dump_create_wait_completion_packet_reply,
+    (dump_func)dump_associate_wait_completion_packet_reply,
+    NULL,
+    NULL,
     NULL,
     NULL,
     NULL,
@@ -3953,6 +4119,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] =
     (dump_func)dump_get_next_process_reply,
     (dump_func)dump_get_next_thread_reply,
     (dump_func)dump_set_keyboard_repeat_reply,
+    (dump_func)dump_batch_reply,
 };
 
 static const char * const req_names[REQ_NB_REQUESTS] =
@@ -3987,6 +4154,8 @@ static const char * const req_names[REQ_NB_REQUESTS] =
     "open_process",
     "open_thread",
     "select",
+    "get_inproc_sync_fd",
+    "get_inproc_sync",
     "create_event",
     "event_op",
     "query_event",
@@ -4014,6 +4183,9 @@ static const char * const req_names[REQ_NB_REQUESTS] =
     "unlock_file",
     "recv_socket",
     "send_socket",
+    "socket_get_batch",
+    "socket_set_batch",
+    "get_socket_fast_path",
     "socket_get_events",
     "socket_send_icmp_id",
     "socket_get_icmp_id",
@@ -4094,6 +4266,9 @@ static const char * const req_names[REQ_NB_REQUESTS] =
     "set_async_direct_result",
     "read",
     "write",
+    "set_io_uring",
+    "register_io_uring_async",
+    "set_io_uring_result",
     "ioctl",
     "set_irp_result",
     "create_named_pipe",
@@ -4223,6 +4398,11 @@ static const char * const req_names[REQ_NB_REQUESTS] =
     "remove_completion",
     "get_thread_completion",
     "query_completion",
+    "get_completion_ring_fd",
+    "get_completion_ring",
+    "create_wait_completion_packet",
+    "associate_wait_completion_packet",
+    "cancel_wait_completion_packet",
     "set_completion_info",
     "add_fd_completion",
     "set_fd_completion_mode",
@@ -4250,6 +4430,7 @@ static const char * const req_names[REQ_NB_REQUESTS] =
     "get_next_process",
     "get_next_thread",
     "set_keyboard_repeat",
+    "batch",
 };
 
 static const struct
@@ -4280,6 +4461,7 @@ static const struct
     { "DEVICE_NOT_READY",            STATUS_DEVICE_NOT_READY },
     { "DIRECTORY_NOT_EMPTY",         STATUS_DIRECTORY_NOT_EMPTY },
     { "DISK_FULL",                   STATUS_DISK_FULL },
+    { "END_OF_FILE",                 STATUS_END_OF_FILE },
     { "ERROR_CLASS_ALREADY_EXISTS",  0xc0010000 | ERROR_CLASS_ALREADY_EXISTS },
     { "ERROR_CLASS_DOES_NOT_EXIST",  0xc0010000 | ERROR_CLASS_DOES_NOT_EXIST },
     { "ERROR_CLASS_HAS_WINDOWS",     0xc0010000 | ERROR_CLASS_HAS_WINDOWS },
@@ -4322,6 +4504,7 @@ static const struct
     { "INVALID_LOCK_SEQUENCE",       STATUS_INVALID_LOCK_SEQUENCE },
     { "INVALID_OWNER",               STATUS_INVALID_OWNER },
     { "INVALID_PARAMETER",           STATUS_INVALID_PARAMETER },
+    { "INVALID_PARAMETER_1",         STATUS_INVALID_PARAMETER_1 },
     { "INVALID_PIPE_STATE",          STATUS_INVALID_PIPE_STATE },
     { "INVALID_READ_MODE",           STATUS_INVALID_READ_MODE },
     { "INVALID_SECURITY_DESCR",      STATUS_INVALID_SECURITY_DESCR },
@@ -4334,6 +4517,7 @@ static const struct
     { "NAME_TOO_LONG",               STATUS_NAME_TOO_LONG },
     { "NETWORK_BUSY",                STATUS_NETWORK_BUSY },
     { "NETWORK_UNREACHABLE",         STATUS_NETWORK_UNREACHABLE },
+    { "NOTIFY_ENUM_DIR",             STATUS_NOTIFY_ENUM_DIR },
     { "NOT_ALL_ASSIGNED",            STATUS_NOT_ALL_ASSIGNED },
     { "NOT_A_DIRECTORY",             STATUS_NOT_A_DIRECTORY },
     { "NOT_FOUND",                   STATUS_NOT_FOUND },
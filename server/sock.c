@@ -299,8 +299,21 @@ struct sock
     unsigned int        reset : 1;   /* did we get a TCP reset? */
     unsigned int        reuseaddr : 1; /* winsock SO_REUSEADDR option value */
     unsigned int        exclusiveaddruse : 1; /* winsock SO_EXCLUSIVEADDRUSE option value */
+    unsigned int        fast_path : 1; /* may the client do I/O without telling us? */
+    volatile void      *shared;      /* shared object revoking the client fast path cache */
 };
 
+/* the client may have consumed events behind our back, poll for them again */
+static void sock_leave_fast_path( struct sock *sock )
+{
+    static const unsigned int events = AFD_POLL_READ | AFD_POLL_OOB | AFD_POLL_WRITE;
+
+    if (!sock->fast_path) return;
+    sock->pending_events &= ~events;
+    sock->reported_events &= ~events;
+    sock->fast_path = 0;
+}
+
 static int is_tcp_socket( struct sock *sock )
 {
     return sock->type == WS_SOCK_STREAM && (sock->family == WS_AF_INET || sock->family == WS_AF_INET6);
@@ -1298,7 +1311,8 @@ static int sock_dispatch_asyncs( struct sock *sock, int event, int error )
         if (async_waiting( &sock->read_q ))
         {
             if (debug_level) fprintf( stderr, "activating read queue for socket %p\n", sock );
-            async_wake_up( &sock->read_q, STATUS_ALERTED );
+            if (sock->type == WS_SOCK_DGRAM) async_wake_up_batch( &sock->read_q, SOCKET_IO_BATCH_MAX - 1 );
+            else async_wake_up( &sock->read_q, STATUS_ALERTED );
         }
         event &= ~(POLLIN | POLLPRI);
     }
@@ -1308,7 +1322,8 @@ static int sock_dispatch_asyncs( struct sock *sock, int event, int error )
         if (async_waiting( &sock->write_q ))
         {
             if (debug_level) fprintf( stderr, "activating write queue for socket %p\n", sock );
-            async_wake_up( &sock->write_q, STATUS_ALERTED );
+            if (sock->type == WS_SOCK_DGRAM) async_wake_up_batch( &sock->write_q, SOCKET_IO_BATCH_MAX - 1 );
+            else async_wake_up( &sock->write_q, STATUS_ALERTED );
         }
         event &= ~POLLOUT;
     }
@@ -1702,6 +1717,16 @@ static struct fd *sock_get_fd( struct object *obj )
     return (struct fd *)grab_object( sock->fd );
 }
 
+/* another handle to the socket was created, possibly in another process */
+void sock_handle_added( struct object *obj )
+{
+    struct sock *sock = (struct sock *)obj;
+
+    if (obj->ops != &sock_ops || !sock->shared) return;
+    /* the new id makes the client drop its cached fast path state */
+    invalidate_shared_object( sock->shared );
+}
+
 static int sock_close_handle( struct object *obj, struct process *process, obj_handle_t handle )
 {
     struct sock *sock = (struct sock *)obj;
@@ -1775,6 +1800,7 @@ static void sock_destroy( struct object *obj )
     free_async_queue( &sock->poll_q );
     if (sock->event) release_object( sock->event );
     if (sock->fd) release_object( sock->fd );
+    if (sock->shared) free_shared_object( sock->shared );
 }
 
 static struct sock *create_socket(void)
@@ -1814,6 +1840,8 @@ static struct sock *create_socket(void)
     sock->reset = 0;
     sock->reuseaddr = 0;
     sock->exclusiveaddruse = 0;
+    sock->fast_path = 0;
+    sock->shared = NULL;
     sock->rcvbuf = 0;
     sock->sndbuf = 0;
     sock->rcvtimeo = 0;
@@ -2957,6 +2985,7 @@ static void sock_ioctl( struct fd *fd, ioctl_code_t code, struct async *async )
         }
 
         if (sock->event) release_object( sock->event );
+        sock_leave_fast_path( sock );
         sock->event = event;
         sock->mask = mask;
         sock->window = 0;
@@ -2997,6 +3026,7 @@ static void sock_ioctl( struct fd *fd, ioctl_code_t code, struct async *async )
         }
 
         if (sock->event) release_object( sock->event );
+        sock_leave_fast_path( sock );
 
         if (params->window)
         {
@@ -4243,6 +4273,67 @@ DECL_HANDLER(socket_get_icmp_id)
     release_object( sock );
 }
 
+DECL_HANDLER(socket_get_batch)
+{
+    struct sock *sock = (struct sock *)get_handle_obj( current->process, req->handle, 0, &sock_ops );
+    struct async_batch_entry entries[SOCKET_IO_BATCH_MAX];
+    unsigned int count;
+
+    if (!sock) return;
+
+    count = min( get_reply_max_size() / sizeof(entries[0]), ARRAY_SIZE(entries) );
+    count = async_get_batch( req->write ? &sock->write_q : &sock->read_q, current->process, entries, count );
+    set_reply_data( entries, count * sizeof(entries[0]) );
+    release_object( sock );
+}
+
+DECL_HANDLER(socket_set_batch)
+{
+    struct sock *sock = (struct sock *)get_handle_obj( current->process, req->handle, 0, &sock_ops );
+    const struct async_batch_entry *entries = get_req_data();
+    unsigned int i, count = get_req_data_size() / sizeof(*entries);
+
+    if (!sock) return;
+
+    for (i = 0; i < count; i++)
+        async_set_batch_result( req->write ? &sock->write_q : &sock->read_q, current->process, &entries[i] );
+    release_object( sock );
+}
+
+DECL_HANDLER(get_socket_fast_path)
+{
+    struct sock *sock = (struct sock *)get_handle_obj( current->process, req->handle, 0, &sock_ops );
+
+    if (!sock) return;
+
+    reply->flags = 0;
+    reply->options = get_fd_options( sock->fd );
+    reply->locator.id = 0;
+    reply->locator.offset = 0;
+
+    /* the state of these sockets may change without a request of this client;
+     * a cached state is revoked through the shared object when another handle
+     * to the socket is created, see sock_handle_added */
+    if (sock->state != SOCK_UNCONNECTED && sock->state != SOCK_CONNECTING &&
+        (sock->state != SOCK_CONNECTIONLESS || sock->bound) &&
+        !async_queued( &sock->read_q ) && !async_queued( &sock->write_q ) && sock->obj.handle_count == 1)
+    {
+        if (!sock->shared) sock->shared = alloc_shared_object();
+        if (sock->shared) reply->locator = get_shared_object_locator( sock->shared );
+    }
+
+    if ((sock->state == SOCK_CONNECTED || sock->state == SOCK_CONNECTIONLESS) &&
+             (sock->type == WS_SOCK_STREAM || sock->type == WS_SOCK_DGRAM) &&
+             sock->nonblocking && !sock->mask && !sock->event && !sock->window &&
+             !sock->rd_shutdown && !sock->wr_shutdown && !sock->hangup && !sock->aborted && !sock->reset)
+    {
+        sock->fast_path = 1;
+        reply->flags = SOCKET_FAST_IO;
+        if (sock->state == SOCK_CONNECTED) reply->flags |= SOCKET_FAST_CONNECTED;
+    }
+    release_object( sock );
+}
+
 static inline MIB_TCP_STATE tcp_state_to_mib_state( int state )
 {
    switch (state)
@@ -77,6 +77,8 @@ struct thread_wait
     abstime_t               when;
     struct timeout_user    *user;
     int                     status;     /* status to return (unless STATUS_PENDING) */
+    void                  (*callback)( void *, unsigned int ); /* callback for detached waits */
+    void                   *private;    /* callback private data */
     struct wait_queue_entry queues[1];
 };
 
@@ -1003,6 +1005,7 @@ static int wait_on( const union select_op *select_op, unsigned int count, struct
     wait->user    = NULL;
     wait->when = when;
     wait->abandoned = 0;
+    wait->callback = NULL;
     current->wait = wait;
 
     for (i = 0, entry = wait->queues; i < count; i++, entry++)
@@ -1156,6 +1159,66 @@ int wake_thread_queue_entry( struct wait_queue_entry *entry )
     return 1;
 }
 
+/* add a wait on an object that doesn't block the current thread; the callback is
+ * called with the wait status once the object is signaled and the wait satisfied */
+struct thread_wait *add_detached_wait( struct object *obj, void (*callback)( void *, unsigned int ),
+                                       void *private )
+{
+    struct thread_wait *wait;
+
+    if (!(wait = mem_alloc( sizeof(*wait) ))) return NULL;
+    wait->next      = NULL;
+    wait->thread    = (struct thread *)grab_object( current );
+    wait->count     = 1;
+    wait->flags     = 0;
+    wait->abandoned = 0;
+    wait->select    = SELECT_WAIT;
+    wait->key       = 0;
+    wait->cookie    = 0;
+    wait->when      = TIMEOUT_INFINITE;
+    wait->user      = NULL;
+    wait->status    = STATUS_WAIT_0;
+    wait->callback  = callback;
+    wait->private   = private;
+    wait->queues[0].wait = wait;
+
+    if (!obj->ops->add_queue( obj, &wait->queues[0] ))
+    {
+        release_object( wait->thread );
+        free( wait );
+        return NULL;
+    }
+    return wait;
+}
+
+/* remove a detached wait without calling its callback */
+void remove_detached_wait( struct thread_wait *wait )
+{
+    struct wait_queue_entry *entry = &wait->queues[0];
+
+    entry->obj->ops->remove_queue( entry->obj, entry );
+    release_object( wait->thread );
+    free( wait );
+}
+
+/* satisfy a detached wait if its object is signaled; return 1 if the wait is finished */
+int wake_detached_wait( struct thread_wait *wait )
+{
+    struct wait_queue_entry *entry = &wait->queues[0];
+    void (*callback)( void *, unsigned int ) = wait->callback;
+    void *private = wait->private;
+    unsigned int status;
+
+    if (!entry->obj->ops->signaled( entry->obj, entry )) return 0;
+
+    entry->obj->ops->satisfied( entry->obj, entry );
+    status = wait->status;
+    if (wait->abandoned) status += STATUS_ABANDONED_WAIT_0;
+    remove_detached_wait( wait );
+    callback( private, status );
+    return 1;
+}
+
 /* thread wait timeout */
 static void thread_timeout( void *ptr )
 {
@@ -1279,7 +1342,9 @@ void wake_up( struct object *obj, int max )
     LIST_FOR_EACH( ptr, &obj->wait_queue )
     {
         struct wait_queue_entry *entry = LIST_ENTRY( ptr, struct wait_queue_entry, entry );
-        if (!(ret = wake_thread( get_wait_queue_thread( entry )))) continue;
+        if (entry->wait->callback) ret = wake_detached_wait( entry->wait );
+        else ret = wake_thread( get_wait_queue_thread( entry ));
+        if (!ret) continue;
         if (ret > 0 && max && !--max) break;
         /* restart at the head of the list since a wake up can change the object wait queue */
         ptr = &obj->wait_queue;
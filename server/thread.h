@@ -114,6 +114,10 @@ extern void set_wait_status( struct wait_queue_entry *entry, int status );
 extern void stop_thread( struct thread *thread );
 extern int wake_thread( struct thread *thread );
 extern int wake_thread_queue_entry( struct wait_queue_entry *entry );
+extern struct thread_wait *add_detached_wait( struct object *obj, void (*callback)( void *, unsigned int ),
+                                              void *private );
+extern void remove_detached_wait( struct thread_wait *wait );
+extern int wake_detached_wait( struct thread_wait *wait );
 extern int add_queue( struct object *obj, struct wait_queue_entry *entry );
 extern void remove_queue( struct object *obj, struct wait_queue_entry *entry );
 extern void kill_thread( struct thread *thread, int violent_death );
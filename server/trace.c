@@ -23,6 +23,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 
@@ -624,6 +625,24 @@ static void dump_varargs_select_op( const char *prefix, data_size_t size )
     remove_data( size );
 }
 
+static void dump_varargs_async_batch( const char *prefix, data_size_t size )
+{
+    const struct async_batch_entry *entry = cur_data;
+    data_size_t len = size / sizeof(*entry);
+
+    fprintf( stderr, "%s{", prefix );
+    while (len > 0)
+    {
+        dump_uint64( "{user=", &entry->user );
+        dump_uint64( ",sb=", &entry->sb );
+        fprintf( stderr, ",status=%08x,total=%u}", entry->status, entry->total );
+        entry++;
+        if (--len) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+    remove_data( size );
+}
+
 static void dump_varargs_user_handles( const char *prefix, data_size_t size )
 {
     const user_handle_t *data = cur_data;
@@ -1575,6 +1594,43 @@ void trace_request(void)
     else fprintf( stderr, "%04x: %d(?)\n", current->id, req );
 }
 
+static int compare_request_stats( const void *p1, const void *p2 )
+{
+    const struct request_stats *stats1 = &request_stats[*(const enum request *)p1];
+    const struct request_stats *stats2 = &request_stats[*(const enum request *)p2];
+
+    if (stats1->total_time > stats2->total_time) return -1;
+    if (stats1->total_time < stats2->total_time) return 1;
+    return 0;
+}
+
+/* dump the request statistics, sorted by total handler time */
+void dump_request_stats(void)
+{
+    enum request reqs[REQ_NB_REQUESTS];
+    unsigned int i, count = 0;
+
+    if (!request_stats_enabled)
+    {
+        fprintf( stderr, "wineserver: request statistics are not enabled\n" );
+        return;
+    }
+
+    for (i = 0; i < REQ_NB_REQUESTS; i++) if (request_stats[i].count) reqs[count++] = i;
+    qsort( reqs, count, sizeof(reqs[0]), compare_request_stats );
+
+    fprintf( stderr, "%-32s %10s %12s %10s %10s %14s\n",
+             "request", "count", "total(us)", "avg(us)", "max(us)", "reply bytes" );
+    for (i = 0; i < count; i++)
+    {
+        const struct request_stats *stats = &request_stats[reqs[i]];
+        fprintf( stderr, "%-32s %10u %12llu %10llu %10llu %14llu\n", req_names[reqs[i]], stats->count,
+                 (unsigned long long)stats->total_time / 10,
+                 (unsigned long long)stats->total_time / stats->count / 10,
+                 (unsigned long long)stats->max_time / 10, stats->reply_size );
+    }
+}
+
 void trace_reply( enum request req, const union generic_reply *reply )
 {
     if (req < REQ_NB_REQUESTS)